@@ -5,8 +5,10 @@ srwlpy = Extension(
     'srwlpy',
     define_macros=[('MAJOR_VERSION', '1'), ('MINOR_VERSION', '0')],
     include_dirs=[os.path.abspath('../src/lib')],
-    libraries=['srw', 'm', 'fftw'],
+    libraries=['srw', 'm', 'fftw', 'pthread'],
     library_dirs=[os.path.abspath('../gcc'), os.path.abspath('../../ext_lib')],
+    extra_compile_args=['-fopenmp'],
+    extra_link_args=['-fopenmp'], #libsrw.a is compiled with OpenMP (see ../gcc/Makefile)
     sources=[os.path.abspath('../src/clients/python/srwlpy.cpp')])
 
 setup(name='SRW Python interface',
@@ -740,9 +740,9 @@ int srTApplication::PropagateRadiationStokesMultiElec(srTIgorRadPropagStokesMult
 	if(result = Send.GetSRWRadStructAndOptElemNames(pRadPropagInputStruct, &SRWRadStructAccessData, &OptElemInfo)) return CorrectErrorCode(result);
 
 	srTStokesStructAccessData StokesStructAccessData;
-	double PrecPar[2];
+	double PrecPar[] = {1., 0., 0., 1., 0.}; //defaults of the last three (used if the precision wave is shorter): relative error to stop at (0- not used), sampling of electron phase space (1- LPtau, 2- scrambled LPtau), seed of scrambled LPtau (0- from time)
 	if(result = Send.GetStokesStructAccessData(&StokesStructAccessData)) return CorrectErrorCode(result);
-	if(result = Send.GetPropagRadStokesMultiElecDataFormat1(PrecPar)) return CorrectErrorCode(result);
+	if(result = Send.GetPropagRadStokesMultiElecDataFormat1(PrecPar, 5)) return CorrectErrorCode(result);
 
 	srTGenOptElemHndl OptElemHndl;
 	//srTOptElemSummary OptElemSummary;
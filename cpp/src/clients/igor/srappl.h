@@ -50,7 +50,7 @@
 //
 //*************************************************************************
 
-extern srTIntVect gVectWarnNos;
+extern thread_local srTIntVect gVectWarnNos;
 
 //*************************************************************************
 
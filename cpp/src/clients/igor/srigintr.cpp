@@ -38,7 +38,7 @@
 // Global Variables
 srTApplication SR;
 srTYield srYield;
-srTIntVect gVectWarnNos;
+thread_local srTIntVect gVectWarnNos;
 int gCallSpinProcess = 1;
 
 //for compatibility with lib/dll
@@ -75,6 +75,7 @@ static const char strEr_BadOptCryst[] = "Incorrect Optical Crystal structure";
 static const char strEr_BadArg_CalcMagnField[] = "Incorrect arguments for magnetic field calculation/tabulation function";
 static const char strEr_BadArg_CalcPartTraj[] = "Incorrect arguments for trajectory calculation function";
 static const char strEr_BadArg_CalcPartTrajFromKickMatr[] = "Incorrect arguments for trajectory calculation function from kick matrices";
+static const char strEr_BadArg_CalcPartTrajFromKickMatrMult[] = "Incorrect arguments for calculation of multiple trajectories from kick matrices";
 static const char strEr_BadArg_CalcElecFieldSR[] = "Incorrect arguments for SR electric field calculation function";
 static const char strEr_BadPrec_CalcElecFieldSR[] = "Incorrect precision parameters for SR electric field calculation";
 static const char strEr_BadArg_CalcStokesUR[] = "Incorrect arguments for UR Stokes parameters calculation function";
@@ -84,6 +85,11 @@ static const char strEr_BadArg_CalcIntFromElecField[] = "Incorrect arguments for
 static const char strEr_BadArg_ResizeElecField[] = "Incorrect arguments for electric field resizing function";
 static const char strEr_BadArg_SetRepresElecField[] = "Incorrect arguments for changing electric field representation function";
 static const char strEr_BadArg_PropagElecField[] = "Incorrect arguments for electric field wavefront propagation function";
+static const char strEr_BadArg_OptCompile[] = "Incorrect arguments for optical elements container compilation function";
+static const char strEr_BadArg_PropagElecFieldCompiled[] = "Incorrect arguments for electric field wavefront propagation through compiled optical elements container";
+static const char strEr_BadArg_CalcCohModes[] = "Incorrect arguments for coherent-mode decomposition function";
+static const char strEr_BadArg_PropagCohModes[] = "Incorrect arguments for coherent modes propagation function";
+static const char strEr_BadArg_CalcIntFromCohModes[] = "Incorrect arguments for intensity extraction from coherent modes function";
 
 /************************************************************************//**
  * Global objects to be used across different function calls
@@ -3107,8 +3113,8 @@ static PyObject* srwlpy_CalcPartTraj(PyObject *self, PyObject *args)
 		ParseSructSRWLPrtTrj(&trj, oPartTraj, &vBuf);
 		ParseSructSRWLMagFldC(&magCnt, oMagFldCnt, &vBuf);
 
-		double arPrecPar[9]; //to increase if necessary
-		int nPrecPar = 1;
+		double arPrecPar[10] = {0}; //to increase if necessary
+		int nPrecPar = 9; //max. number of parameters to take from the list
 		arPrecPar[1] = 1; //default integration method
 	
 		double *pPrecPar = arPrecPar + 1;
@@ -3196,6 +3202,82 @@ static PyObject* srwlpy_CalcPartTrajFromKickMatr(PyObject *self, PyObject *args)
 	return oPartTraj;
 }
 
+/************************************************************************//**
+ * Calculates trajectories of many charged particles from an array of kick matrices;
+ * see help to srwlCalcPartTrajFromKickMatrMult
+ ***************************************************************************/
+static PyObject* srwlpy_CalcPartTrajFromKickMatrMult(PyObject *self, PyObject *args)
+{
+	PyObject *oListPartTraj=0, *oListKickMatr=0, *oPrecPar=0;
+	vector<Py_buffer> vBuf;
+
+	SRWLPrtTrj *arTrj = 0;
+	SRWLKickM *arKickM = 0;
+
+	try
+	{
+		if(!PyArg_ParseTuple(args, "OOO:CalcPartTrajFromKickMatrMult", &oListPartTraj, &oListKickMatr, &oPrecPar)) throw strEr_BadArg_CalcPartTrajFromKickMatrMult;
+		if((oListPartTraj == 0) || (oListKickMatr == 0) || (oPrecPar == 0)) throw strEr_BadArg_CalcPartTrajFromKickMatrMult;
+		if(!PyList_Check(oListPartTraj)) throw strEr_BadArg_CalcPartTrajFromKickMatrMult;
+
+		int nTrj = (int)PyList_Size(oListPartTraj);
+		if(nTrj <= 0) throw strEr_BadArg_CalcPartTrajFromKickMatrMult;
+		arTrj = new SRWLPrtTrj[nTrj];
+		SRWLPrtTrj trjZero = {0,0,0,0,0,0,0,0,0}; //zero pointers, since SRWL structures are definied in C (no constructors)
+		for(int i=0; i<nTrj; i++)
+		{
+			arTrj[i] = trjZero;
+			PyObject *oPartTraj = PyList_GetItem(oListPartTraj, (Py_ssize_t)i);
+			if(oPartTraj == 0) throw strEr_BadArg_CalcPartTrajFromKickMatrMult;
+
+			ParseSructSRWLPrtTrj(arTrj + i, oPartTraj, &vBuf);
+		}
+
+		int nKickM = 0;
+		if(PyList_Check(oListKickMatr))
+		{
+			nKickM = (int)PyList_Size(oListKickMatr);
+			if(nKickM <= 0) throw strEr_BadArg_CalcPartTrajFromKickMatrMult;
+
+			arKickM = new SRWLKickM[nKickM];
+
+			for(int i=0; i<nKickM; i++)
+			{
+				PyObject *oKickMatr = PyList_GetItem(oListKickMatr, (Py_ssize_t)i);
+				if(oKickMatr == 0) throw strEr_BadArg_CalcPartTrajFromKickMatrMult;
+
+				ParseSructSRWLKickM(arKickM + i, oKickMatr, &vBuf);
+			}
+		}
+		else 
+		{
+			nKickM = 1;
+			arKickM = new SRWLKickM[nKickM];
+			ParseSructSRWLKickM(arKickM, oListKickMatr, &vBuf);
+		}
+
+		double arPrecPar[9]; //to increase if necessary
+		int nPrecPar = 1;
+		arPrecPar[0] = 1; //default: add to pre-existing trajectory data
+		double *pPrecPar = arPrecPar;
+		CopyPyListElemsToNumArray(oPrecPar, 'd', pPrecPar, nPrecPar);
+
+		ProcRes(srwlCalcPartTrajFromKickMatrMult(arTrj, nTrj, arKickM, nKickM, arPrecPar));
+	}
+	catch(const char* erText) 
+	{
+		PyErr_SetString(PyExc_RuntimeError, erText);
+		oListPartTraj = 0;
+	}
+
+	if(arTrj != 0) delete[] arTrj;
+	if(arKickM != 0) delete[] arKickM;
+	ReleasePyBuffers(vBuf);
+
+	if(oListPartTraj) Py_XINCREF(oListPartTraj);
+	return oListPartTraj;
+}
+
 /************************************************************************//**
  * Calculates Wavefront (electric field) of Synchrotron Radiation 
  * by a relativistic charged particle traveling in external (3D) magnetic field;
@@ -3236,9 +3318,9 @@ static PyObject* srwlpy_CalcElecFieldSR(PyObject *self, PyObject *args)
 
 		//double *arPrecPar = (double*)GetPyArrayBuf(vBuf, oPrecPar, PyBUF_SIMPLE);
 		//if(arPrecPar == 0) throw strEr_BadPrec_CalcElecFieldSR;
-		double arPrecPar[7];
+		double arPrecPar[9];
 		double *pPrecPar = arPrecPar;
-		int nPrecPar = 7;
+		int nPrecPar = 9;
 		CopyPyListElemsToNumArray(oPrecPar, 'd', pPrecPar, nPrecPar);
 
 		ProcRes(srwlCalcElecFieldSR(&wfr, pTrj, pMagCnt, arPrecPar, nPrecPar));
@@ -3460,6 +3542,68 @@ static PyObject* srwlpy_CalcIntFromElecField(PyObject *self, PyObject *args)
 	return oInt;
 }
 
+/************************************************************************//**
+ * Calculates/extracts several characteristics from pre-calculated Electric Field at once
+ * see help to srwlCalcIntFromElecFieldMult
+ ***************************************************************************/
+static PyObject* srwlpy_CalcIntFromElecFieldMult(PyObject *self, PyObject *args)
+{
+	PyObject *oInts=0, *oWfr=0, *oPol=0, *oIntType=0, *oDepType=0, *oE=0, *oX=0, *oY=0;
+	vector<Py_buffer> vBuf;
+	SRWLWfr wfr;
+	char **arInt=0, *arPol=0, *arIntType=0, *arDepType=0;
+	double *arE=0, *arX=0, *arY=0;
+
+	try
+	{
+		if(!PyArg_ParseTuple(args, "OOOOOOOO:CalcIntFromElecFieldMult", &oInts, &oWfr, &oPol, &oIntType, &oDepType, &oE, &oX, &oY)) throw strEr_BadArg_CalcIntFromElecField;
+		if((oInts == 0) || (oWfr == 0) || (oPol == 0) || (oIntType == 0) || (oDepType == 0) || (oE == 0) || (oX == 0) || (oY == 0)) throw strEr_BadArg_CalcIntFromElecField;
+		if(!PyList_Check(oInts)) throw strEr_BadArg_CalcIntFromElecField;
+
+		int nInt = (int)PyList_Size(oInts);
+		if(nInt <= 0) throw strEr_BadArg_CalcIntFromElecField;
+		arInt = new char*[nInt];
+		for(int i=0; i<nInt; i++)
+		{
+			arInt[i] = (char*)GetPyArrayBuf(PyList_GetItem(oInts, (Py_ssize_t)i), &vBuf, 0);
+			if(arInt[i] == 0) throw strEr_BadArg_CalcIntFromElecField;
+		}
+
+		ParseSructSRWLWfr(&wfr, oWfr, &vBuf, gmWfrPyPtr);
+
+		int nPol=0, nIntType=0, nDepType=0, nE=0, nX=0, nY=0;
+		CopyPyListElemsToNumArray(oPol, 'i', arPol, nPol);
+		CopyPyListElemsToNumArray(oIntType, 'i', arIntType, nIntType);
+		CopyPyListElemsToNumArray(oDepType, 'i', arDepType, nDepType);
+		CopyPyListElemsToNumArray(oE, 'd', arE, nE);
+		CopyPyListElemsToNumArray(oX, 'd', arX, nX);
+		CopyPyListElemsToNumArray(oY, 'd', arY, nY);
+		if((nPol != nInt) || (nIntType != nInt) || (nDepType != nInt) || (nE != nInt) || (nX != nInt) || (nY != nInt)) throw strEr_BadArg_CalcIntFromElecField;
+
+		ProcRes(srwlCalcIntFromElecFieldMult(arInt, &wfr, nInt, arPol, arIntType, arDepType, arE, arX, arY));
+	}
+	catch(const char* erText) 
+	{
+		PyErr_SetString(PyExc_RuntimeError, erText);
+		//PyErr_PrintEx(1);
+		oInts = 0;
+	}
+
+	if(arInt != 0) delete[] arInt;
+	if(arPol != 0) delete[] arPol;
+	if(arIntType != 0) delete[] arIntType;
+	if(arDepType != 0) delete[] arDepType;
+	if(arE != 0) delete[] arE;
+	if(arX != 0) delete[] arX;
+	if(arY != 0) delete[] arY;
+
+	ReleasePyBuffers(vBuf);
+	EraseElementFromMap(&wfr, gmWfrPyPtr);
+
+	if(oInts) Py_XINCREF(oInts);
+	return oInts;
+}
+
 /************************************************************************//**
  * "Resizes" Electric Field Wavefront vs transverse positions / angles or photon energy / time
  * see help to srwlResizeElecField
@@ -3582,6 +3726,274 @@ static PyObject* srwlpy_PropagElecField(PyObject *self, PyObject *args)
 	return oWfr;
 }
 
+/************************************************************************//**
+ * Compiled container of optical elements, kept in a Python capsule together with
+ * the parsed container and the Python buffers it refers to (which are released only when the capsule is deleted)
+ ***************************************************************************/
+struct AuxStructOptCompiled {
+	void *pOptHndl;
+	SRWLOptC optCnt;
+	vector<Py_buffer> vBuf;
+};
+
+static const char strOptCompiledCapsuleName[] = "srwlpy.OptCompiled";
+
+static void DeleteOptCompiled(PyObject* oCapsule)
+{
+	AuxStructOptCompiled *pOptComp = (AuxStructOptCompiled*)PyCapsule_GetPointer(oCapsule, strOptCompiledCapsuleName);
+	if(pOptComp == 0) return;
+	if(pOptComp->pOptHndl != 0) srwlOptDelete(pOptComp->pOptHndl);
+	DeallocOptCntArrays(&(pOptComp->optCnt));
+	ReleasePyBuffers(pOptComp->vBuf);
+	delete pOptComp;
+}
+
+/************************************************************************//**
+ * "Compiles" container of optical elements for repeated propagations
+ * see help to srwlOptCompile
+ ***************************************************************************/
+static PyObject* srwlpy_OptCompile(PyObject *self, PyObject *args)
+{
+	PyObject *oOptCnt=0, *oRes=0;
+	AuxStructOptCompiled *pOptComp = new AuxStructOptCompiled();
+	SRWLOptC optCntZero = {0,0,0,0,0}; //since SRWL structures are definied in C (no constructors)
+	pOptComp->pOptHndl = 0;
+	pOptComp->optCnt = optCntZero;
+
+	try
+	{
+		if(!PyArg_ParseTuple(args, "O:OptCompile", &oOptCnt)) throw strEr_BadArg_OptCompile;
+		if(oOptCnt == 0) throw strEr_BadArg_OptCompile;
+
+		ParseSructSRWLOptC(&(pOptComp->optCnt), oOptCnt, &(pOptComp->vBuf));
+		ProcRes(srwlOptCompile(&(pOptComp->pOptHndl), &(pOptComp->optCnt)));
+
+		oRes = PyCapsule_New((void*)pOptComp, strOptCompiledCapsuleName, DeleteOptCompiled);
+	}
+	catch(const char* erText) 
+	{
+		PyErr_SetString(PyExc_RuntimeError, erText);
+		oRes = 0;
+	}
+
+	if(oRes == 0)
+	{
+		if(pOptComp->pOptHndl != 0) srwlOptDelete(pOptComp->pOptHndl);
+		DeallocOptCntArrays(&(pOptComp->optCnt));
+		ReleasePyBuffers(pOptComp->vBuf);
+		delete pOptComp;
+	}
+	return oRes;
+}
+
+/************************************************************************//**
+ * "Propagates" Electric Field Wavefront through compiled container of Optical Elements
+ * see help to srwlPropagElecFieldCompiled
+ ***************************************************************************/
+static PyObject* srwlpy_PropagElecFieldCompiled(PyObject *self, PyObject *args)
+{
+	PyObject *oWfr=0, *oOptComp=0;
+	vector<Py_buffer> vBuf;
+	SRWLWfr wfr;
+
+	try
+	{
+		if(!PyArg_ParseTuple(args, "OO:PropagElecFieldCompiled", &oWfr, &oOptComp)) throw strEr_BadArg_PropagElecFieldCompiled;
+		if((oWfr == 0) || (oOptComp == 0)) throw strEr_BadArg_PropagElecFieldCompiled;
+
+		AuxStructOptCompiled *pOptComp = (AuxStructOptCompiled*)PyCapsule_GetPointer(oOptComp, strOptCompiledCapsuleName);
+		if(pOptComp == 0) { PyErr_Clear(); throw strEr_BadArg_PropagElecFieldCompiled;}
+
+		ParseSructSRWLWfr(&wfr, oWfr, &vBuf, gmWfrPyPtr);
+
+		ProcRes(srwlPropagElecFieldCompiled(&wfr, pOptComp->pOptHndl));
+		UpdatePyWfr(oWfr, &wfr);
+	}
+	catch(const char* erText) 
+	{
+		PyErr_SetString(PyExc_RuntimeError, erText);
+		oWfr = 0;
+	}
+
+	ReleasePyBuffers(vBuf);
+	EraseElementFromMap(&wfr, gmWfrPyPtr);
+
+	if(oWfr) Py_XINCREF(oWfr);
+	return oWfr;
+}
+
+/************************************************************************//**
+ * Parses list of Wavefront structures (e.g. coherent modes)
+ ***************************************************************************/
+SRWLWfr* ParseListSRWLWfr(PyObject* oListWfr, int& nWfr, vector<Py_buffer>* pvBuf, const char* strEr)
+{
+	if((oListWfr == 0) || (!PyList_Check(oListWfr))) throw strEr;
+	nWfr = (int)PyList_Size(oListWfr);
+	if(nWfr <= 0) throw strEr;
+
+	SRWLWfr *arWfr = new SRWLWfr[nWfr];
+	for(int i=0; i<nWfr; i++)
+	{
+		PyObject *oWfr = PyList_GetItem(oListWfr, (Py_ssize_t)i);
+		if(oWfr == 0) { delete[] arWfr; throw strEr;}
+		try { ParseSructSRWLWfr(arWfr + i, oWfr, pvBuf, gmWfrPyPtr);}
+		catch(const char* erText) 
+		{
+			for(int j=0; j<=i; j++) EraseElementFromMap(arWfr + j, gmWfrPyPtr);
+			delete[] arWfr; throw erText;
+		}
+	}
+	return arWfr;
+}
+
+/************************************************************************//**
+ * Decomposes Cross-Spectral Density of radiation from finite-emittance electron beam into coherent modes;
+ * see help to srwlCalcCohModes
+ ***************************************************************************/
+static PyObject* srwlpy_CalcCohModes(PyObject *self, PyObject *args)
+{
+	PyObject *oListModes=0, *oOcc=0, *oWfr=0, *oPrecPar=0;
+	vector<Py_buffer> vBuf;
+	SRWLWfr wfr0;
+	SRWLWfr *arModes = 0;
+	int nModes = 0, nModesIn = 0;
+	PyObject *oResNumModes = 0;
+
+	try
+	{
+		if(!PyArg_ParseTuple(args, "OOOO:CalcCohModes", &oListModes, &oOcc, &oWfr, &oPrecPar)) throw strEr_BadArg_CalcCohModes;
+		if((oListModes == 0) || (oOcc == 0) || (oWfr == 0) || (oPrecPar == 0)) throw strEr_BadArg_CalcCohModes;
+
+		double *arOcc = (double*)GetPyArrayBuf(oOcc, &vBuf, 0);
+		if(arOcc == 0) throw strEr_BadArg_CalcCohModes;
+
+		ParseSructSRWLWfr(&wfr0, oWfr, &vBuf, gmWfrPyPtr);
+		arModes = ParseListSRWLWfr(oListModes, nModesIn, &vBuf, strEr_BadArg_CalcCohModes);
+		nModes = nModesIn;
+
+		double arPrecPar[] = {5, 5, 3, 0}; //defaults, see srwlCalcCohModes
+		double *pPrecPar = arPrecPar;
+		int nPrecPar = 4;
+		CopyPyListElemsToNumArray(oPrecPar, 'd', pPrecPar, nPrecPar);
+
+		ProcRes(srwlCalcCohModes(arModes, &nModes, arOcc, &wfr0, arPrecPar));
+
+		for(int i=0; i<nModesIn; i++) UpdatePyWfr(PyList_GetItem(oListModes, (Py_ssize_t)i), arModes + i);
+		oResNumModes = Py_BuildValue("i", nModes);
+	}
+	catch(const char* erText) 
+	{
+		PyErr_SetString(PyExc_RuntimeError, erText);
+		oResNumModes = 0;
+	}
+
+	if(arModes != 0)
+	{
+		for(int i=0; i<nModesIn; i++) EraseElementFromMap(arModes + i, gmWfrPyPtr);
+		delete[] arModes;
+	}
+	ReleasePyBuffers(vBuf);
+	EraseElementFromMap(&wfr0, gmWfrPyPtr);
+	return oResNumModes;
+}
+
+/************************************************************************//**
+ * "Propagates" coherent modes through optical elements and free spaces;
+ * see help to srwlPropagCohModes
+ ***************************************************************************/
+static PyObject* srwlpy_PropagCohModes(PyObject *self, PyObject *args)
+{
+	PyObject *oListModes=0, *oOptCnt=0;
+	vector<Py_buffer> vBuf;
+	SRWLWfr *arModes = 0;
+	int nModes = 0;
+	SRWLOptC optCnt = {0,0,0,0,0}; //since SRWL structures are definied in C (no constructors)
+
+	try
+	{
+		if(!PyArg_ParseTuple(args, "OO:PropagCohModes", &oListModes, &oOptCnt)) throw strEr_BadArg_PropagCohModes;
+		if((oListModes == 0) || (oOptCnt == 0)) throw strEr_BadArg_PropagCohModes;
+
+		arModes = ParseListSRWLWfr(oListModes, nModes, &vBuf, strEr_BadArg_PropagCohModes);
+		ParseSructSRWLOptC(&optCnt, oOptCnt, &vBuf);
+
+		ProcRes(srwlPropagCohModes(arModes, nModes, &optCnt));
+		for(int i=0; i<nModes; i++) UpdatePyWfr(PyList_GetItem(oListModes, (Py_ssize_t)i), arModes + i);
+	}
+	catch(const char* erText) 
+	{
+		PyErr_SetString(PyExc_RuntimeError, erText);
+		oListModes = 0;
+	}
+
+	DeallocOptCntArrays(&optCnt);
+	if(arModes != 0)
+	{
+		for(int i=0; i<nModes; i++) EraseElementFromMap(arModes + i, gmWfrPyPtr);
+		delete[] arModes;
+	}
+	ReleasePyBuffers(vBuf);
+
+	if(oListModes) Py_XINCREF(oListModes);
+	return oListModes;
+}
+
+/************************************************************************//**
+ * Calculates/extracts Intensity or Mutual Intensity from coherent modes;
+ * see help to srwlCalcIntFromCohModes
+ ***************************************************************************/
+static PyObject* srwlpy_CalcIntFromCohModes(PyObject *self, PyObject *args)
+{
+	PyObject *oInt=0, *oListModes=0, *oPol=0, *oIntType=0, *oDepType=0, *oE=0, *oX=0, *oY=0;
+	vector<Py_buffer> vBuf;
+	SRWLWfr *arModes = 0;
+	int nModes = 0;
+
+	try
+	{
+		if(!PyArg_ParseTuple(args, "OOOOOOOO:CalcIntFromCohModes", &oInt, &oListModes, &oPol, &oIntType, &oDepType, &oE, &oX, &oY)) throw strEr_BadArg_CalcIntFromCohModes;
+		if((oInt == 0) || (oListModes == 0) || (oPol == 0) || (oIntType == 0) || (oDepType == 0) || (oE == 0) || (oX == 0) || (oY == 0)) throw strEr_BadArg_CalcIntFromCohModes;
+
+		char *arInt = (char*)GetPyArrayBuf(oInt, &vBuf, 0);
+		arModes = ParseListSRWLWfr(oListModes, nModes, &vBuf, strEr_BadArg_CalcIntFromCohModes);
+
+		if(!PyNumber_Check(oPol)) throw strEr_BadArg_CalcIntFromCohModes;
+		char pol = (char)PyLong_AsLong(oPol);
+
+		if(!PyNumber_Check(oIntType)) throw strEr_BadArg_CalcIntFromCohModes;
+		char intType = (char)PyLong_AsLong(oIntType);
+
+		if(!PyNumber_Check(oDepType)) throw strEr_BadArg_CalcIntFromCohModes;
+		char depType = (char)PyLong_AsLong(oDepType);
+
+		if(!PyNumber_Check(oE)) throw strEr_BadArg_CalcIntFromCohModes;
+		double e = PyFloat_AsDouble(oE);
+
+		if(!PyNumber_Check(oX)) throw strEr_BadArg_CalcIntFromCohModes;
+		double x = PyFloat_AsDouble(oX);
+
+		if(!PyNumber_Check(oY)) throw strEr_BadArg_CalcIntFromCohModes;
+		double y = PyFloat_AsDouble(oY);
+
+		ProcRes(srwlCalcIntFromCohModes(arInt, arModes, nModes, pol, intType, depType, e, x, y));
+	}
+	catch(const char* erText) 
+	{
+		PyErr_SetString(PyExc_RuntimeError, erText);
+		oInt = 0;
+	}
+
+	if(arModes != 0)
+	{
+		for(int i=0; i<nModes; i++) EraseElementFromMap(arModes + i, gmWfrPyPtr);
+		delete[] arModes;
+	}
+	ReleasePyBuffers(vBuf);
+
+	if(oInt) Py_XINCREF(oInt);
+	return oInt;
+}
+
 /************************************************************************//**
  * Python C API stuff: module & method definition2, etc.
  ***************************************************************************/
@@ -3609,14 +4021,21 @@ static PyMethodDef srwlpy_methods[] = {
 	{"CalcMagnField", srwlpy_CalcMagnField, METH_VARARGS, "CalcMagnField() Calculates (tabulates) 3D magnetic field created by multiple elements"},
 	{"CalcPartTraj", srwlpy_CalcPartTraj, METH_VARARGS, "CalcPartTraj() Calculates charged particle trajectory in external 3D magnetic field (in Cartesian laboratory frame)"},
 	{"CalcPartTrajFromKickMatr", srwlpy_CalcPartTrajFromKickMatr, METH_VARARGS, "CalcPartTrajFromKickMatr() Calculates charged particle trajectory from an array of kick matrices"},
+	{"CalcPartTrajFromKickMatrMult", srwlpy_CalcPartTrajFromKickMatrMult, METH_VARARGS, "CalcPartTrajFromKickMatrMult() Calculates trajectories of many charged particles from an array of kick matrices"},
 	{"CalcElecFieldSR", srwlpy_CalcElecFieldSR, METH_VARARGS, "CalcElecFieldSR() Calculates Electric Field (Wavefront) of Synchrotron Radiation by a relativistic charged particle traveling in external 3D magnetic field"},
 	{"CalcElecFieldGaussian", srwlpy_CalcElecFieldGaussian, METH_VARARGS, "CalcElecFieldGaussian() Calculates Electric Field (Wavefront) of a coherent Gaussian Beam"},
 	{"CalcStokesUR", srwlpy_CalcStokesUR, METH_VARARGS, "CalcStokesUR() Calculates Stokes parameters of Synchrotron Radiation by a relativistic finite-emittance electron beam traveling in periodic magnetic field of an undulator"},
 	{"CalcPowDenSR", srwlpy_CalcPowDenSR, METH_VARARGS, "CalcPowDenSR() Calculates Power Density distribution of Synchrotron Radiation by a relativistic finite-emittance electron beam traveling in arbitrary magnetic field"},
 	{"CalcIntFromElecField", srwlpy_CalcIntFromElecField, METH_VARARGS, "CalcIntFromElecField() Calculates/extracts Intensity from pre-calculated Electric Field"},
+	{"CalcIntFromElecFieldMult", srwlpy_CalcIntFromElecFieldMult, METH_VARARGS, "CalcIntFromElecFieldMult() Calculates/extracts several characteristics (e.g. Intensity cuts) from pre-calculated Electric Field at once"},
 	{"ResizeElecField", srwlpy_ResizeElecField, METH_VARARGS, "ResizeElecField() \"Resizes\" Electric Field Wavefront vs transverse positions / angles or photon energy / time"},
 	{"SetRepresElecField", srwlpy_SetRepresElecField, METH_VARARGS, "SetRepresElecField() Changes Representation of Electric Field: coordinates<->angles, frequency<->time"},
 	{"PropagElecField", srwlpy_PropagElecField, METH_VARARGS, "PropagElecField() \"Propagates\" Electric Field Wavefront through Optical Elements and free space"},
+	{"OptCompile", srwlpy_OptCompile, METH_VARARGS, "OptCompile() \"Compiles\" container of Optical Elements into a native object to be reused by PropagElecFieldCompiled for many wavefronts"},
+	{"PropagElecFieldCompiled", srwlpy_PropagElecFieldCompiled, METH_VARARGS, "PropagElecFieldCompiled() \"Propagates\" Electric Field Wavefront through container of Optical Elements compiled by OptCompile"},
+	{"CalcCohModes", srwlpy_CalcCohModes, METH_VARARGS, "CalcCohModes() Decomposes Cross-Spectral Density of radiation from finite-emittance electron beam into coherent modes"},
+	{"PropagCohModes", srwlpy_PropagCohModes, METH_VARARGS, "PropagCohModes() \"Propagates\" coherent modes through Optical Elements and free space"},
+	{"CalcIntFromCohModes", srwlpy_CalcIntFromCohModes, METH_VARARGS, "CalcIntFromCohModes() Calculates/extracts Intensity or Mutual Intensity of partially-coherent radiation from coherent modes"},
 	{NULL, NULL}
 };
 
@@ -502,6 +502,7 @@ void srTCSR::computeElectricFieldFreqDomain()
 
 	srTGenOptElem GenOptElem;
 	int res = 0;
+	m_Wfr.NoteFieldModif(); //the field was computed above
 	if(res = GenOptElem.ComputeRadMoments(&m_Wfr)) throw res;
 }
 
@@ -230,6 +230,11 @@
 #define FAILED_DETERMINE_OPTICAL_AXIS 177 + FIRST_XOP_ERR
 #define FAILED_INTERPOL_ELEC_FLD 178 + FIRST_XOP_ERR
 #define SRWL_INCORRECT_PARAM_FOR_MAG_FLD_COMP 179 + FIRST_XOP_ERR
+#define SRWL_INCORRECT_PARAM_FOR_COH_MODES 180 + FIRST_XOP_ERR
+#define SRWL_INCORRECT_JOB 181 + FIRST_XOP_ERR
+#define SRWL_INCORRECT_OPT_HNDL 182 + FIRST_XOP_ERR
+#define CRYSTAL_REQUIRES_BOTH_POLARIZ 183 + FIRST_XOP_ERR
+#define SRWL_TOO_MANY_SAMPLES_FOR_COH_MODES 184 + FIRST_XOP_ERR
 
 //-------------------------------------------------------------------------
 /* Warning codes */
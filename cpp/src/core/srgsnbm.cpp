@@ -96,10 +96,15 @@ double srTGsnBeam::Factorial(long n)
 //*************************************************************************
 
 double srTGsnBeam::HermitePolynomial(int n, double x)
-{
+{//by the recurrence H(n) = 2*(x*H(n-1) - (n-1)*H(n-2))
 	if(n == 0) return 1.;
-	if(n == 1) return 2.*x;
-	return 2.*(x*HermitePolynomial(n - 1, x) - (n - 1)*HermitePolynomial(n - 2, x));
+	double Hm2 = 1., Hm1 = 2.*x;
+	for(int k=2; k<=n; k++)
+	{
+		double H = 2.*(x*Hm1 - (k - 1)*Hm2);
+		Hm2 = Hm1; Hm1 = H;
+	}
+	return Hm1;
 }
 
 //*************************************************************************
@@ -219,6 +224,7 @@ void srTGsnBeam::ComputeElectricField(srTWfrSmp* pWfrSmp, srTSRWRadStructAccessD
 	pWfr->SetNonZeroWavefrontLimitsToFullRange();
 
 	srTGenOptElem GenOptElem;
+	pWfr->NoteFieldModif(); //the field was computed above
 	if(res = GenOptElem.ComputeRadMoments(pWfr)) throw res;
 }
 
@@ -228,99 +234,142 @@ int srTGsnBeam::CreateWavefrontElFieldFreqDomain(srTSRWRadStructAccessData& RadA
 {// m, eV or s!
 //can create frequency- or time-domain electric field
 	int result;
-	const double TwoPI = 6.28318530717959;
-	const double InvTwoPI = 1./TwoPI;
-	const double enMult = 2.53384080189E+06;
 
 	RadAccessData.SetAvgPhotEnergyFromLimits(); //OC180314
 
 	if(result = CheckInputConsistency()) return result;
 	SetupSourceConstantsFreqDomain();
 
-	//x0Prop = EbmDat.x0 + EbmDat.dxds0*LongDist;
-	//z0Prop = EbmDat.z0 + EbmDat.dzds0*LongDist;
-
-	double InvLongDist = 1./LongDist;
-
-	float* tRadX = RadAccessData.pBaseRadX;
-	float* tRadZ = RadAccessData.pBaseRadZ;
+	double PolXRe, PolXIm, PolZRe, PolZIm;
+	if(!SetupPolarizCoefs(PolXRe, PolXIm, PolZRe, PolZIm)) return 0;
 
-	double z = RadAccessData.zStart - z0Prop;
-	double z_mi_z0 = RadAccessData.zStart - EbmDat.z0; //OC210413
+	//The Hermite-Gaussian field is a product of factors depending on (e, x), on (e, z) and on e only;
+	//the transcendental functions are evaluated for these factors, which are then multiplied at each point
+	long ne = RadAccessData.ne, nx = RadAccessData.nx, nz = RadAccessData.nz;
+	double *arFactX = new double[(ne*(nx + nz)) << 1];
+	if(arFactX == 0) return MEMORY_ALLOCATION_FAILURE;
+	double *arFactZ = arFactX + ((ne*nx) << 1);
+	double *arMultE = new double[ne];
+	if(arMultE == 0) { delete[] arFactX; return MEMORY_ALLOCATION_FAILURE;}
 
-	for(int iz=0; iz<RadAccessData.nz; iz++)
+	double en = RadAccessData.eStart;
+	for(long ie=0; ie<ne; ie++)
 	{
-		double ze2 = z*z;
-		double z_mi_z0_e2 = z_mi_z0*z_mi_z0; //OC210413
-		double zz = z_mi_z0 + EbmDat.z0; //OC210413
-
-		double x = RadAccessData.xStart - x0Prop;
-		double x_mi_x0 = RadAccessData.xStart - EbmDat.x0; //OC210413
-
-		for(int ix=0; ix<RadAccessData.nx; ix++)
+		double argForExp = 0.;
+		if(m_AvgPhotEn > 0) 
 		{
-			double xe2 = x*x;
-			double x_mi_x0_e2 = x_mi_x0*x_mi_x0; //OC210413
-			double xx = x_mi_x0 + EbmDat.x0; //OC210413
+			double dPhotEn = en - m_AvgPhotEn;
+			argForExp = -dPhotEn*dPhotEn*m_InvTwoSigPhotEnE2;
+		}
+		arMultE[ie] = NormConstElField*exp(argForExp);
+		en += RadAccessData.eStep;
+	}
 
-			double en = RadAccessData.eStart;
-			for(int ie=0; ie<RadAccessData.ne; ie++)
-			{
-				double PropRatX = en*PropagMultX, PropRatZ = en*PropagMultZ;
-				double PropRatXe2 = PropRatX*PropRatX, PropRatZe2 = PropRatZ*PropRatZ;
-				double InvPropRatX = 1./PropRatX, InvPropRatZ = 1./PropRatZ;
+	//x0Prop = EbmDat.x0 + EbmDat.dxds0*LongDist;
+	//z0Prop = EbmDat.z0 + EbmDat.dzds0*LongDist;
+	if((result = SetupSepFactorFreqDomain(RadAccessData.xStart, RadAccessData.xStep, nx, EbmDat.x0, x0Prop, EbmDat.dxds0, PropagMultX, InvTwoSigXe2, mx, RadAccessData.eStart, RadAccessData.eStep, ne, 0, arFactX)) ||
+	   (result = SetupSepFactorFreqDomain(RadAccessData.zStart, RadAccessData.zStep, nz, EbmDat.z0, z0Prop, EbmDat.dzds0, PropagMultZ, InvTwoSigZe2, mz, RadAccessData.eStart, RadAccessData.eStep, ne, arMultE, arFactZ)))
+	{
+		delete[] arFactX; delete[] arMultE;
+		return result;
+	}
 
-				double SigMultX = 1. + InvPropRatX*InvPropRatX, SigMultZ = 1. + InvPropRatZ*InvPropRatZ;
-				double DisMultX = 1. + PropRatXe2, DisMultZ = 1. + PropRatZe2;
+	FillElFieldFromSepFactors(RadAccessData.pBaseRadX, RadAccessData.pBaseRadZ, arFactX, nx, arFactZ, nz, ne, PolXRe, PolXIm, PolZRe, PolZIm);
 
-				double PropInvTwoSigXe2 = InvTwoSigXe2/SigMultX, PropInvTwoSigZe2 = InvTwoSigZe2/SigMultZ;
-				double PropInvSigX = sqrt(2.*PropInvTwoSigXe2), PropInvSigZ = sqrt(2.*PropInvTwoSigZe2);
-				double PropInvRx = InvLongDist/DisMultX, PropInvRz = InvLongDist/DisMultZ;
+	delete[] arFactX;
+	delete[] arMultE;
+	RadAccessData.Pres = 0;
+	RadAccessData.PresT = 0;
+	return 0;
+}
 
-				double xpMult = (1./PropInvRx - LongDist)*EbmDat.dxds0, zpMult = (1./PropInvRz - LongDist)*EbmDat.dzds0; //OC210413
+//*************************************************************************
 
-				double NuX = atan(InvPropRatX), NuZ = atan(InvPropRatZ);
+int srTGsnBeam::SetupSepFactorFreqDomain(double cStart, double cStep, long nc, double c0, double c0Prop, double dcds0, double PropagMult, double InvTwoSigE2, int m, double eStart, double eStep, long ne, double* arMultE, double* arFact)
+{//Factor of electric field depending on one transverse coordinate (x or z) and photon energy, vs (c, e), photon energy being the fastest index
+	const double TwoPI = 6.28318530717959;
+	const double InvTwoPI = 1./TwoPI;
+	const double enMult = 2.53384080189E+06;
 
-				//double Phase = en*enMult*(xe2*PropInvRx + ze2*PropInvRz) + (mx + 0.5)*NuX + (mz + 0.5)*NuZ;
-				double Phase = en*enMult*((x_mi_x0_e2 + 2*LongDist*EbmDat.x0*EbmDat.dxds0 + xpMult*(2*xx - LongDist*EbmDat.dxds0))*PropInvRx 
-										+ (z_mi_z0_e2 + 2*LongDist*EbmDat.z0*EbmDat.dzds0 + zpMult*(2*zz - LongDist*EbmDat.dzds0))*PropInvRz) 
-							   + (mx + 0.5)*NuX + (mz + 0.5)*NuZ; //OC210413 //??
+	double InvLongDist = 1./LongDist;
 
-				Phase -= TwoPI*long(Phase*InvTwoPI);
-				double CosPh = cos(Phase), SinPh = sin(Phase);
+	const int nAux = 5;
+	double *arAux = new double[nAux*ne];
+	if(arAux == 0) return MEMORY_ALLOCATION_FAILURE;
 
-				//double ExpAr = exp(-xe2*PropInvTwoSigXe2 - ze2*PropInvTwoSigZe2);
-				double argForExp = -xe2*PropInvTwoSigXe2 - ze2*PropInvTwoSigZe2;
-				if(m_AvgPhotEn > 0) 
-				{
-					double dPhotEn = en - m_AvgPhotEn;
-					argForExp -= dPhotEn*dPhotEn*m_InvTwoSigPhotEnE2;
-				}
+	double en = eStart, *tAux = arAux;
+	for(long ie=0; ie<ne; ie++)
+	{
+		double PropRat = en*PropagMult;
+		double InvPropRat = 1./PropRat;
+		double SigMult = 1. + InvPropRat*InvPropRat, DisMult = 1. + PropRat*PropRat;
+		double PropInvTwoSigE2 = InvTwoSigE2/SigMult;
+		double PropInvR = InvLongDist/DisMult;
+		double cpMult = (1./PropInvR - LongDist)*dcds0; //OC210413
+		double PhMult = en*enMult*PropInvR;
+
+		*(tAux++) = PropInvTwoSigE2;
+		*(tAux++) = sqrt(2.*PropInvTwoSigE2); //PropInvSig
+		*(tAux++) = PhMult;
+		*(tAux++) = 2.*cpMult;
+		*(tAux++) = PhMult*(2*LongDist*c0*dcds0 - cpMult*LongDist*dcds0) + (m + 0.5)*atan(InvPropRat); //phase terms independent of c
+		en += eStep;
+	}
 
-				double ExpAr = exp(argForExp);
-				double HermX = HermitePolynomial(mx, x*PropInvSigX), HermZ = HermitePolynomial(mz, z*PropInvSigZ);
+	double c = cStart - c0Prop;
+	double c_mi_c0 = cStart - c0; //OC210413
+	double *tFact = arFact;
+	for(long ic=0; ic<nc; ic++)
+	{
+		double ce2 = c*c;
+		double c_mi_c0_e2 = c_mi_c0*c_mi_c0; //OC210413
+		double cc = c_mi_c0 + c0; //OC210413
 
-				double BufA = NormConstElField*sqrt(PropInvSigX*PropInvSigZ)*ExpAr*HermX*HermZ;
-				double ReA = BufA*CosPh, ImA = BufA*SinPh;
+		tAux = arAux;
+		for(long ie=0; ie<ne; ie++)
+		{
+			double PropInvTwoSigE2 = *(tAux++), PropInvSig = *(tAux++), PhMult = *(tAux++), TwoCpMult = *(tAux++), Ph0 = *(tAux++);
 
-				SetupProperPolariz(ReA, ImA, tRadX, tRadZ);
+			double Phase = PhMult*(c_mi_c0_e2 + TwoCpMult*cc) + Ph0;
+			Phase -= TwoPI*long(Phase*InvTwoPI);
 
-				tRadX += 2; tRadZ += 2;
-				en += RadAccessData.eStep;
-			}
-			x += RadAccessData.xStep;
-			x_mi_x0 += RadAccessData.xStep; //OC210413
+			double Ampl = sqrt(PropInvSig)*exp(-ce2*PropInvTwoSigE2)*HermitePolynomial(m, c*PropInvSig);
+			if(arMultE != 0) Ampl *= arMultE[ie];
+			*(tFact++) = Ampl*cos(Phase); *(tFact++) = Ampl*sin(Phase);
 		}
-		z += RadAccessData.zStep;
-		z_mi_z0 += RadAccessData.zStep; //OC210413
+		c += cStep;
+		c_mi_c0 += cStep; //OC210413
 	}
-	RadAccessData.Pres = 0;
-	RadAccessData.PresT = 0;
+	delete[] arAux;
 	return 0;
 }
 
 //*************************************************************************
 
+void srTGsnBeam::FillElFieldFromSepFactors(float* pEX, float* pEZ, double* arFactX, long nx, double* arFactZ, long nz, long ne, double PolXRe, double PolXIm, double PolZRe, double PolZIm)
+{//E(e,x,z) = FactX(e,x)*FactZ(e,z)*Polariz, photon energy (or time) being the fastest index
+	long TwoNe = ne << 1;
+	float *tEX = pEX, *tEZ = pEZ;
+	double *tFactZ = arFactZ;
+	for(long iz=0; iz<nz; iz++)
+	{
+		double *tFactX = arFactX;
+		for(long ix=0; ix<nx; ix++)
+		{
+			for(long i=0; i<TwoNe; i += 2)
+			{
+				double FxRe = tFactX[i], FxIm = tFactX[i + 1], FzRe = tFactZ[i], FzIm = tFactZ[i + 1];
+				double ReA = FxRe*FzRe - FxIm*FzIm, ImA = FxRe*FzIm + FxIm*FzRe;
+				tEX[i] = (float)(ReA*PolXRe - ImA*PolXIm); tEX[i + 1] = (float)(ReA*PolXIm + ImA*PolXRe);
+				tEZ[i] = (float)(ReA*PolZRe - ImA*PolZIm); tEZ[i + 1] = (float)(ReA*PolZIm + ImA*PolZRe);
+			}
+			tFactX += TwoNe; tEX += TwoNe; tEZ += TwoNe;
+		}
+		tFactZ += TwoNe;
+	}
+}
+
+//*************************************************************************
 int srTGsnBeam::CreateWavefrontElFieldTimeDomain(srTSRWRadStructAccessData& RadAccessData)
 {// m, eV or s!
 //can create frequency- or time-domain electric field
@@ -328,55 +377,64 @@ int srTGsnBeam::CreateWavefrontElFieldTimeDomain(srTSRWRadStructAccessData& RadA
 
 	RadAccessData.avgPhotEn = m_AvgPhotEn; 
 
-	const double TwoPI = 6.28318530717959;
-	const double InvTwoPI = 1./TwoPI;
-	//const double enMult = 2.53384080189E+06;
-
 	if(result = CheckInputConsistency()) return result;
 	SetupSourceConstantsTimeDomain();
 
-	//double InvLongDist = 1./LongDist;
+	double PolXRe, PolXIm, PolZRe, PolZIm;
+	if(!SetupPolarizCoefs(PolXRe, PolXIm, PolZRe, PolZIm)) return 0;
 
-	float* tRadX = RadAccessData.pBaseRadX;
-	float* tRadZ = RadAccessData.pBaseRadZ;
+	//The field is a product of factors depending on x, on z and on t; the factor vs t is included into the one vs x
+	long nt = RadAccessData.ne, nx = RadAccessData.nx, nz = RadAccessData.nz;
+	double *arFactX = new double[(nt*(nx + nz) + nt) << 1];
+	if(arFactX == 0) return MEMORY_ALLOCATION_FAILURE;
+	double *arFactZ = arFactX + ((nt*nx) << 1);
+	double *arMultT = arFactZ + ((nt*nz) << 1);
 
-	double z = RadAccessData.zStart - z0Prop;
-	for(int iz=0; iz<RadAccessData.nz; iz++)
+	double t = RadAccessData.eStart; //en is actually time here
+	for(long it=0; it<nt; it++)
 	{
-		double ze2 = z*z;
-
-		double x = RadAccessData.xStart - x0Prop;
-		for(int ix=0; ix<RadAccessData.nx; ix++)
-		{
-			double xe2 = x*x;
+		arMultT[it] = m_NormConstElecFldT_Prop*exp(-t*t*m_InvTwoSigTe2);
+		t += RadAccessData.eStep;
+	}
 
-			double Phase_T = m_AvgPhotEn_enMult_PropInvRx_T*xe2 + m_AvgPhotEn_enMult_PropInvRz_T*ze2 + m_PhaseLongDelay_T;
-			Phase_T -= TwoPI*long(Phase_T*InvTwoPI);
-			double CosPh_T = cos(Phase_T), SinPh_T = sin(Phase_T);
-			double argForExp0_T = -xe2*m_PropInvTwoSigXe2_T - ze2*m_PropInvTwoSigZe2_T;
+	SetupSepFactorTimeDomain(RadAccessData.xStart - x0Prop, RadAccessData.xStep, nx, m_AvgPhotEn_enMult_PropInvRx_T, m_PhaseLongDelay_T, m_PropInvTwoSigXe2_T, m_PropInvSigX_T, mx, nt, arMultT, arFactX);
+	SetupSepFactorTimeDomain(RadAccessData.zStart - z0Prop, RadAccessData.zStep, nz, m_AvgPhotEn_enMult_PropInvRz_T, 0., m_PropInvTwoSigZe2_T, m_PropInvSigZ_T, mz, nt, 0, arFactZ);
 
-			double HermX_T = HermitePolynomial(mx, x*m_PropInvSigX_T);
-			double HermZ_T = HermitePolynomial(mz, z*m_PropInvSigZ_T);
+	FillElFieldFromSepFactors(RadAccessData.pBaseRadX, RadAccessData.pBaseRadZ, arFactX, nx, arFactZ, nz, nt, PolXRe, PolXIm, PolZRe, PolZIm);
 
-			double t = RadAccessData.eStart; //en is actually time here
-			for(int it=0; it<RadAccessData.ne; it++)
-			{
-				double argForExp_T = argForExp0_T - t*t*m_InvTwoSigTe2;
-				double ExpAr_T = exp(argForExp_T);
-				double BufA_T = m_NormConstElecFldT_Prop*ExpAr_T*HermX_T*HermZ_T;
-				double ReA_T = BufA_T*CosPh_T, ImA_T = BufA_T*SinPh_T;
-				SetupProperPolariz(ReA_T, ImA_T, tRadX, tRadZ);
-
-				tRadX += 2; tRadZ += 2;
-				t += RadAccessData.eStep;
-			}
-			x += RadAccessData.xStep;
-		}
-		z += RadAccessData.zStep;
-	}
+	delete[] arFactX;
 	RadAccessData.Pres = 0;
 	RadAccessData.PresT = 1;
 	return 0;
 }
 
 //*************************************************************************
+
+void srTGsnBeam::SetupSepFactorTimeDomain(double cStart, double cStep, long nc, double PhMult, double Ph0, double PropInvTwoSigE2, double PropInvSig, int m, long nt, double* arMultT, double* arFact)
+{//Factor of time-domain electric field depending on one transverse coordinate (x or z), vs (c, t), time being the fastest index
+	const double TwoPI = 6.28318530717959;
+	const double InvTwoPI = 1./TwoPI;
+
+	double c = cStart;
+	double *tFact = arFact;
+	for(long ic=0; ic<nc; ic++)
+	{
+		double ce2 = c*c;
+		double Phase = PhMult*ce2 + Ph0;
+		Phase -= TwoPI*long(Phase*InvTwoPI);
+		double Ampl = exp(-ce2*PropInvTwoSigE2)*HermitePolynomial(m, c*PropInvSig);
+		double ReF = Ampl*cos(Phase), ImF = Ampl*sin(Phase);
+
+		if(arMultT != 0)
+		{
+			for(long it=0; it<nt; it++) { *(tFact++) = ReF*arMultT[it]; *(tFact++) = ImF*arMultT[it];}
+		}
+		else
+		{
+			for(long it=0; it<nt; it++) { *(tFact++) = ReF; *(tFact++) = ImF;}
+		}
+		c += cStep;
+	}
+}
+
+//*************************************************************************
@@ -64,6 +64,9 @@ public:
 	void SetupSourceConstantsTimeDomain();
 	int CreateWavefrontElFieldFreqDomain(srTSRWRadStructAccessData&);
 	int CreateWavefrontElFieldTimeDomain(srTSRWRadStructAccessData&);
+	int SetupSepFactorFreqDomain(double cStart, double cStep, long nc, double c0, double c0Prop, double dcds0, double PropagMult, double InvTwoSigE2, int m, double eStart, double eStep, long ne, double* arMultE, double* arFact);
+	void SetupSepFactorTimeDomain(double cStart, double cStep, long nc, double PhMult, double Ph0, double PropInvTwoSigE2, double PropInvSig, int m, long nt, double* arMultT, double* arFact);
+	void FillElFieldFromSepFactors(float* pEX, float* pEZ, double* arFactX, long nx, double* arFactZ, long nz, long ne, double PolXRe, double PolXIm, double PolZRe, double PolZIm);
 
 	//void ComputeElectricFieldFreqDomain(srTWfrSmp* pWfrSmp, srTSRWRadStructAccessData* pWfr);
 	void ComputeElectricField(srTWfrSmp* pWfrSmp, srTSRWRadStructAccessData* pWfr);
@@ -71,6 +74,23 @@ public:
 	double Factorial(long n);
 	double HermitePolynomial(int n, double x);
 
+	bool SetupPolarizCoefs(double& PolXRe, double& PolXIm, double& PolZRe, double& PolZIm)
+	{//Complex coefficients of horizontal and vertical field components, in line with SetupProperPolariz
+		const double c = 0.70710678118655;
+		PolXRe = c; PolXIm = 0.; PolZRe = 0.; PolZIm = 0.;
+		switch(Polar) 
+		{
+		case 1: PolXRe = 1.; break; // Lin. Hor.
+		case 2: PolXRe = 0.; PolZRe = 1.; break; // Lin. Vert.
+		case 3: PolZRe = c; break; // Lin. 45
+		case 4: PolZRe = -c; break; // Lin. 135
+		case 5: PolZIm = c; break; // Circ. Right
+		case 6: PolZIm = -c; break; // Circ. Left
+		default: return false;
+		}
+		return true;
+	}
+
 	void SetupProperPolariz(double ReA, double ImA, float* tRadX, float* tRadZ)
 	{// Same for Isotropic Source and Gaussian Beam
 		const double c = 0.70710678118655;
@@ -64,26 +64,36 @@ void srTGenTrjDat::CompTrjCrdVelRK(double sStart, double sEnd, long ns, double*
 	const int numEq = 5;
 	
 	bool onPrcRK = false;
+	double arDefAbsPrecPar[] = {1.e-09, 1.e-09, 1.e-09, 1.e-09, 1.e-09}; //default absolute precision values for X[m],X'[rad],Y[m],Y'[rad],Z[m]
 	double *pAbsPrecParLoc = 0;
 	double epsTol = 1.;
 	int maxAutoSteps = 5000;
+	int methNo = 1;
+	double maxStepDP = 0.;
 	if(pPrecPar != 0) 
 	{
 		int numPrecPar = (int)pPrecPar[0];
 		if(numPrecPar > 0)
 		{
-			int methNo = (int)pPrecPar[1];
+			methNo = (int)pPrecPar[1];
 			if(methNo > 1) //to keep updated when new methods will be added
 			{
 				onPrcRK = true;
-				pAbsPrecParLoc = pPrecPar + 2;
+				pAbsPrecParLoc = (numPrecPar > 5)? (pPrecPar + 2) : arDefAbsPrecPar;
 			}
 			if(numPrecPar > 6) epsTol = pPrecPar[7];
 			if(numPrecPar > 7) maxAutoSteps = (int)pPrecPar[8];
+			if(numPrecPar > 8) maxStepDP = pPrecPar[9];
 		}
 	}
 
 	CGenMathIntRungeKutta<srTGenTrjDat> gmIntRK(this, &srTGenTrjDat::funcDerivRK, numEq, onPrcRK, pAbsPrecParLoc, epsTol, maxAutoSteps); // manual mode, based on number of points
+	if(methNo == 3)
+	{//Dormand-Prince with dense output; by default, the step is limited to a few mesh steps, not to "jump over" short magnetic elements in long drifts
+		const double defMaxStepInMeshSteps = 10.;
+		if(maxStepDP <= 0.) maxStepDP = defMaxStepInMeshSteps*fabs(sStep);
+		gmIntRK.setDenseOutput(maxStepDP);
+	}
 	//CGenMathIntRungeKutta<srTGenTrjDat> gmIntRK(this, &srTGenTrjDat::funcDerivRK, numEq, onPrcRK, pAbsPrecParLoc); // manual mode, based on number of points
 	//CGenMathIntRungeKutta(T* ptrT, void (T::*pFuncDerivF)(double, double*, double*), int amOfEq, bool onPrc, double* precArray, double epsTol =1., int maxAutoStp =5000)
 	//check how to define epsTol, maxAutoStp
@@ -350,9 +360,27 @@ void srTGenTrjDat::CompTrjCrdVelRK(double sStart, double sEnd, long ns, double*
 //*************************************************************************
 
 void srTGenTrjDat::CompTrjKickMatr(SRWLKickM* arKickM, int nKickM, double sStart, double sEnd, long ns, double* pInPrecPar, double* pOutBtX, double* pOutX, double* pOutBtY, double* pOutY, double* pOutBtZ, double* pOutZ)
+{
+	double initCond[] = {EbmDat.x0, EbmDat.dxds0, EbmDat.z0, EbmDat.dzds0, EbmDat.s0}; //?
+	double inv_B_pho = EbmDat.Inv_B_rho(); //[1/(T*m)]
+	double gamEm2 = EbmDat.GammaEm2;
+
+	CompTrjKickMatrMult(arKickM, nKickM, sStart, sEnd, ns, pInPrecPar, 1, initCond, &inv_B_pho, &gamEm2, &pOutBtX, &pOutX, &pOutBtY, &pOutY, &pOutBtZ, &pOutZ);
+}
+
+//*************************************************************************
+// Calculates trajectories of many particles from kick matrices, on the same longitudinal mesh
+// nPart - number of particles
+// arInitCond - initial conditions of all particles (5 values per particle, as in IntegrateKicks; longitudinal position should be the same)
+// arInvBrho - 1/(B*rho) [1/(T*m)] of each particle
+// arGamEm2 - 1/gamma^2 of each particle
+// arOutBtX, ... - arrays of pointers to resulting trajectory arrays of each particle (arOutBtZ[i], arOutZ[i] can be 0)
+//-------------------------------------------------------------------------
+void srTGenTrjDat::CompTrjKickMatrMult(SRWLKickM* arKickM, int nKickM, double sStart, double sEnd, long ns, double* pInPrecPar, int nPart, double* arInitCond, double* arInvBrho, double* arGamEm2, double** arOutBtX, double** arOutX, double** arOutBtY, double** arOutY, double** arOutBtZ, double** arOutZ)
 {
 	if((arKickM == 0) || (nKickM <= 0)) throw SRWL_INCORRECT_PARAM_FOR_TRJ_COMP;
 	if(ns <= 0) throw SRWL_INCORRECT_PARAM_FOR_TRJ_COMP;
+	if((nPart <= 0) || (arInitCond == 0) || (arInvBrho == 0) || (arGamEm2 == 0)) throw SRWL_INCORRECT_PARAM_FOR_TRJ_COMP;
 
 	//sort arKickM to find groups of kick-matrices with non-overlapping longitudinal intervals
 	vector<pair<int, pair<double, double> > > vKickStInd;
@@ -405,261 +433,238 @@ void srTGenTrjDat::CompTrjKickMatr(SRWLKickM* arKickM, int nKickM, double sStart
 	}
 	//sorting completed
 
-	bool trjShouldBeAdded = (pInPrecPar[0] == 1);
+	bool trjShouldBeAdded = (pInPrecPar == 0) || (pInPrecPar[0] == 1);
 	const double sResEdgeToler = 1.E-12;
 	double sAbsEdgeToler = (sEnd - sStart)*sResEdgeToler;
 	bool integOnLeftIsNeeded = (sStart < -sAbsEdgeToler);
 	bool integOnRightIsNeeded = (sEnd > sAbsEdgeToler);
 
 	double sStep = (ns <= 1)? 0 : (sEnd - sStart)/(ns - 1);
-	double initCond[] = {EbmDat.x0, EbmDat.dxds0, EbmDat.z0, EbmDat.dzds0, EbmDat.s0}; //?
-	double inv_B_pho = EbmDat.Inv_B_rho(); //[1/(T*m)]
-
-	double gamEm2 = EbmDat.GammaEm2, btx, bty;
 	long is0 = 0;
 	double s0Act = 0.;
-
-	if(integOnLeftIsNeeded)
+	if(integOnLeftIsNeeded && (sEnd >= -sAbsEdgeToler))
 	{
-		double *tOutBtX = pOutBtX, *tOutX = pOutX;
-		double *tOutBtY = pOutBtY, *tOutY = pOutY;
-		double *tOutBtZ = pOutBtZ, *tOutZ = pOutZ;
-		
-		if(sEnd < -sAbsEdgeToler) //i.e. < 0
-		{//need to "arrive" to sEnd without storing trajectory data; step can be re-adjusted
-			long auxNp = (long)fabs(sEnd/sStep) + 1;
-			if(auxNp <= 1) auxNp = 2;
+		is0 = (int)fabs((-sStart + sAbsEdgeToler)/sStep);
+		if(is0 >= ns) is0 = ns - 1;
+		s0Act = sStart + is0*sStep;
+	}
 
-			double *auxTrjRes = new double[(auxNp + ns)*5];
-			if(auxTrjRes == 0) throw MEMORY_ALLOCATION_FAILURE;
+	//particles are processed by "chunks": all particles of a chunk are pushed through each kick-matrix at once,
+	//the size of a chunk is limited by the memory required for auxiliary trajectory data
+	const long maxAuxTrjResSize = 262144; //number of doubles (to steer): the auxiliary data of a chunk should rather stay in cache
+	long nsMaxAux = ns;
+	if(integOnLeftIsNeeded && (sEnd < -sAbsEdgeToler)) nsMaxAux += (long)fabs(sEnd/sStep) + 2;
+	else if(integOnRightIsNeeded && (sStart > sAbsEdgeToler)) nsMaxAux += (long)fabs(sStart/sStep) + 2;
+	int nPartChunk = (int)(maxAuxTrjResSize/(5*nsMaxAux));
+	if(nPartChunk < 1) nPartChunk = 1;
+	if(nPartChunk > nPart) nPartChunk = nPart;
 
-			IntegrateKicks(arKickM, vIndNonOverlapKickGroups, vIndNonOverlapKickGroupRanges, inv_B_pho, initCond, 0., sEnd, auxNp, auxTrjRes);
-			//gmIntRK.solve(initCond, 0., sMax, auxNp, auxTrjRes);
+	double *arInitCondChunk = new double[5*nPartChunk];
+	if(arInitCondChunk == 0) throw MEMORY_ALLOCATION_FAILURE;
 
-			double *pResEnd = auxTrjRes + (auxNp - 1)*5;
-			for(int i=0; i<5; i++) initCond[i] = pResEnd[i];
+	for(int iPartSt=0; iPartSt<nPart; iPartSt+=nPartChunk)
+	{
+		int nP = nPart - iPartSt;
+		if(nP > nPartChunk) nP = nPartChunk;
+		long perPt = 5*nP;
+
+		double *initCond = arInitCondChunk;
+		double *pInitCondSt = arInitCond + 5*iPartSt;
+		for(long i=0; i<perPt; i++) initCond[i] = pInitCondSt[i];
+		double *inv_B_pho = arInvBrho + iPartSt, *gamEm2 = arGamEm2 + iPartSt;
+		double **outBtX = arOutBtX + iPartSt, **outX = arOutX + iPartSt, **outBtY = arOutBtY + iPartSt, **outY = arOutY + iPartSt;
+		double **outBtZ = arOutBtZ + iPartSt, **outZ = arOutZ + iPartSt;
+
+		if(integOnLeftIsNeeded)
+		{
+			if(sEnd < -sAbsEdgeToler) //i.e. < 0
+			{//need to "arrive" to sEnd without storing trajectory data; step can be re-adjusted
+				long auxNp = (long)fabs(sEnd/sStep) + 1;
+				if(auxNp <= 1) auxNp = 2;
 
-			//arrived to sMax; now solve for the entire main trajectory:
-			if(ns <= 1)
-			{
-				double *t_auxTrjRes = auxTrjRes;
-				for(int i=0; i<5; i++) *(t_auxTrjRes++) = initCond[i];
-			}
-			else IntegrateKicks(arKickM, vIndNonOverlapKickGroups, vIndNonOverlapKickGroupRanges, inv_B_pho, initCond, sEnd, sStart, ns, auxTrjRes);
-			//else gmIntRK.solve(initCond, sMax, sMin, ns, auxTrjRes);
+				double *auxTrjRes = new double[(auxNp + ns)*perPt];
+				if(auxTrjRes == 0) { delete[] arInitCondChunk; throw MEMORY_ALLOCATION_FAILURE;}
 
-			double *t_auxTrjRes = auxTrjRes + (ns*5 - 1);
-			for(int j=0; j<ns; j++)
-			{
-				if(trjShouldBeAdded)
+				IntegrateKicks(arKickM, vIndNonOverlapKickGroups, vIndNonOverlapKickGroupRanges, nP, inv_B_pho, initCond, 0., sEnd, auxNp, auxTrjRes);
+
+				for(int ip=0; ip<nP; ip++)
 				{
-					//if(pOutZ) *(tOutZ++) += *t_auxTrjRes; //longitudinal position is not modified in this case
-					t_auxTrjRes--;
-					*tOutBtY += *(t_auxTrjRes--); bty = *(tOutBtY++);
-					*(tOutY++) += *(t_auxTrjRes--);
-					*tOutBtX += *(t_auxTrjRes--); btx = *(tOutBtX++);
-					*(tOutX++) += *(t_auxTrjRes--);
-					if(pOutBtZ) *(tOutBtZ++) = CGenMathMeth::radicalOnePlusSmall(-(gamEm2 + btx*btx + bty*bty));
+					double *pResEnd = auxTrjRes + (ip + 1)*5*auxNp - 5, *pInitCond = initCond + 5*ip;
+					for(int i=0; i<5; i++) pInitCond[i] = pResEnd[i];
 				}
-				else
+
+				//arrived to sMax; now solve for the entire main trajectory:
+				if(ns <= 1)
 				{
-					if(pOutZ) *(tOutZ++) = *t_auxTrjRes;
-					t_auxTrjRes--;
-					bty = *(t_auxTrjRes--); *(tOutBtY++) = bty;
-					*(tOutY++) = *(t_auxTrjRes--);
-					btx = *(t_auxTrjRes--); *(tOutBtX++) = btx;
-					*(tOutX++) = *(t_auxTrjRes--);
-					if(pOutBtZ) *(tOutBtZ++) = CGenMathMeth::radicalOnePlusSmall(-(gamEm2 + btx*btx + bty*bty));
+					for(long i=0; i<perPt; i++) auxTrjRes[i] = initCond[i];
 				}
-			}
-			delete[] auxTrjRes;
-		}
-		else
-		{
-			is0 = (int)fabs((-sStart + sAbsEdgeToler)/sStep);
-			if(is0 >= ns) is0 = ns - 1;
+				else IntegrateKicks(arKickM, vIndNonOverlapKickGroups, vIndNonOverlapKickGroupRanges, nP, inv_B_pho, initCond, sEnd, sStart, ns, auxTrjRes);
 
-			s0Act = sStart + is0*sStep;
-			if(s0Act < -sAbsEdgeToler)
-			{//one small step to s0Act
-				double twoPtTrjRes[2*5];
-				IntegrateKicks(arKickM, vIndNonOverlapKickGroups, vIndNonOverlapKickGroupRanges, inv_B_pho, initCond, 0., s0Act, 2, twoPtTrjRes);
-				//gmIntRK.solve(initCond, 0., s0Act, 2, twoPtTrjRes);
-
-				double *pResEnd = twoPtTrjRes + 5;
-				for(int i=0; i<5; i++) initCond[i] = pResEnd[i];
+				CopyKickTrjRes(auxTrjRes, ns, true, nP, 0, trjShouldBeAdded, gamEm2, outBtX, outX, outBtY, outY, outBtZ, outZ);
+				delete[] auxTrjRes;
 			}
-
-			//arrived to s0Act; now solve for the left part of the trajectory:
-			int nsLeft = is0 + 1;
-			double *auxTrjRes = new double[nsLeft*5];
-			if(auxTrjRes == 0) throw MEMORY_ALLOCATION_FAILURE;
-	
-			if(nsLeft <= 1)
+			else
 			{
-				double *t_auxTrjRes = auxTrjRes;
-				//*(t_auxTrjRes++) = s0Act;
-				for(int i=0; i<5; i++) *(t_auxTrjRes++) = initCond[i];
-			}
-			else IntegrateKicks(arKickM, vIndNonOverlapKickGroups, vIndNonOverlapKickGroupRanges, inv_B_pho, initCond, s0Act, sStart, nsLeft, auxTrjRes);
-			//else gmIntRK.solve(initCond, s0Act, sMin, nsLeft, auxTrjRes);
+				if(s0Act < -sAbsEdgeToler)
+				{//one small step to s0Act
+					double *twoPtTrjRes = new double[2*perPt];
+					if(twoPtTrjRes == 0) { delete[] arInitCondChunk; throw MEMORY_ALLOCATION_FAILURE;}
+					IntegrateKicks(arKickM, vIndNonOverlapKickGroups, vIndNonOverlapKickGroupRanges, nP, inv_B_pho, initCond, 0., s0Act, 2, twoPtTrjRes);
 
-			double *t_auxTrjRes = auxTrjRes + nsLeft*5 - 1;
-			for(int j=0; j<nsLeft; j++)
-			{
-				if(trjShouldBeAdded)
-				{
-					//if(pOutZ) *(tOutZ++) += *t_auxTrjRes; //longitudinal position is not modified in this case
-					t_auxTrjRes--;
-					*tOutBtY += *(t_auxTrjRes--); bty = *(tOutBtY++);
-					*(tOutY++) += *(t_auxTrjRes--);
-					*tOutBtX += *(t_auxTrjRes--); btx = *(tOutBtX++);
-					*(tOutX++) += *(t_auxTrjRes--);
-					if(pOutBtZ) *(tOutBtZ++) = CGenMathMeth::radicalOnePlusSmall(-(gamEm2 + btx*btx + bty*bty));
+					for(int ip=0; ip<nP; ip++)
+					{
+						double *pResEnd = twoPtTrjRes + 10*ip + 5, *pInitCond = initCond + 5*ip;
+						for(int i=0; i<5; i++) pInitCond[i] = pResEnd[i];
+					}
+					delete[] twoPtTrjRes;
 				}
-				else
+
+				//arrived to s0Act; now solve for the left part of the trajectory:
+				long nsLeft = is0 + 1;
+				double *auxTrjRes = new double[nsLeft*perPt];
+				if(auxTrjRes == 0) { delete[] arInitCondChunk; throw MEMORY_ALLOCATION_FAILURE;}
+	
+				if(nsLeft <= 1)
 				{
-					if(pOutZ) *(tOutZ++) = *t_auxTrjRes;
-					t_auxTrjRes--;
-					bty = *(t_auxTrjRes--); *(tOutBtY++) = bty;
-					*(tOutY++) = *(t_auxTrjRes--);
-					btx = *(t_auxTrjRes--); *(tOutBtX++) = btx;
-					*(tOutX++) = *(t_auxTrjRes--);
-					if(pOutBtZ) *(tOutBtZ++) = CGenMathMeth::radicalOnePlusSmall(-(gamEm2 + btx*btx + bty*bty));
+					for(long i=0; i<perPt; i++) auxTrjRes[i] = initCond[i];
 				}
+				else IntegrateKicks(arKickM, vIndNonOverlapKickGroups, vIndNonOverlapKickGroupRanges, nP, inv_B_pho, initCond, s0Act, sStart, nsLeft, auxTrjRes);
+
+				CopyKickTrjRes(auxTrjRes, nsLeft, true, nP, 0, trjShouldBeAdded, gamEm2, outBtX, outX, outBtY, outY, outBtZ, outZ);
+				delete[] auxTrjRes;
 			}
-			delete[] auxTrjRes;
 		}
-	}
 
-	if(integOnRightIsNeeded)
-	{
-		double *tOutBtX = pOutBtX + is0, *tOutX = pOutX + is0;
-		double *tOutBtY = pOutBtY + is0, *tOutY = pOutY + is0;
-		double *tOutBtZ = pOutBtZ + is0, *tOutZ = pOutZ + is0;
+		if(integOnRightIsNeeded)
+		{
+			if(sStart > sAbsEdgeToler)
+			{//need to "arrive" to sMin without storing trajectory data; step can be re-adjusted
+				long auxNp = (long)fabs(sStart/sStep) + 1;
+				if(auxNp <= 1) auxNp = 2;
 
-		if(sStart > sAbsEdgeToler)
-		{//need to "arrive" to sMin without storing trajectory data; step can be re-adjusted
-			int auxNp = (int)fabs(sStart/sStep) + 1;
-			if(auxNp <= 1) auxNp = 2;
+				double *auxTrjRes = new double[(auxNp + ns)*perPt];
+				if(auxTrjRes == 0) { delete[] arInitCondChunk; throw MEMORY_ALLOCATION_FAILURE;}
 
-			double *auxTrjRes = new double[(auxNp + ns)*5];
-			if(auxTrjRes == 0) throw MEMORY_ALLOCATION_FAILURE;
+				IntegrateKicks(arKickM, vIndNonOverlapKickGroups, vIndNonOverlapKickGroupRanges, nP, inv_B_pho, initCond, 0., sStart, auxNp, auxTrjRes);
 
-			IntegrateKicks(arKickM, vIndNonOverlapKickGroups, vIndNonOverlapKickGroupRanges, inv_B_pho, initCond, 0., sStart, auxNp, auxTrjRes);
-			//gmIntRK.solve(initCond, 0., sMin, auxNp, auxTrjRes);
+				for(int ip=0; ip<nP; ip++)
+				{
+					double *pResEnd = auxTrjRes + (ip + 1)*5*auxNp - 5, *pInitCond = initCond + 5*ip;
+					for(int i=0; i<5; i++) pInitCond[i] = pResEnd[i];
+				}
 
-			double *pResEnd = auxTrjRes + (auxNp - 1)*5;
-			for(int i=0; i<5; i++) initCond[i] = pResEnd[i];
+				//arrived to sMax; now solve for the entire main trajectory:
+				if(ns <= 1)
+				{
+					for(long i=0; i<perPt; i++) auxTrjRes[i] = initCond[i];
+				}
+				else IntegrateKicks(arKickM, vIndNonOverlapKickGroups, vIndNonOverlapKickGroupRanges, nP, inv_B_pho, initCond, sStart, sEnd, ns, auxTrjRes);
 
-			//arrived to sMax; now solve for the entire main trajectory:
-			if(ns <= 1)
-			{
-				double *t_auxTrjRes = auxTrjRes;
-				//*(t_auxTrjRes++) = sMin;
-				for(int i=0; i<5; i++) *(t_auxTrjRes++) = initCond[i];
+				CopyKickTrjRes(auxTrjRes, ns, false, nP, is0, trjShouldBeAdded, gamEm2, outBtX, outX, outBtY, outY, outBtZ, outZ);
+				delete[] auxTrjRes;
 			}
-			else IntegrateKicks(arKickM, vIndNonOverlapKickGroups, vIndNonOverlapKickGroupRanges, inv_B_pho, initCond, sStart, sEnd, ns, auxTrjRes);
-			//else gmIntRK.solve(initCond, sMin, sMax, ns, auxTrjRes);
-
-			double *t_auxTrjRes = auxTrjRes;
-			for(int j=0; j<ns; j++)
+			else
 			{
-				if(trjShouldBeAdded)
-				{
-					*(tOutX++) += *(t_auxTrjRes++);
-					*tOutBtX += *(t_auxTrjRes++); btx = *(tOutBtX++);
-					*(tOutY++) += *(t_auxTrjRes++);
-					*tOutBtY += *(t_auxTrjRes++); bty = *(tOutBtY++);
-					//if(pOutZ) *(tOutZ++) += *t_auxTrjRes; //longitudinal position is not modified in this case
-					t_auxTrjRes++;
-					if(pOutBtZ) *(tOutBtZ++) = CGenMathMeth::radicalOnePlusSmall(-(gamEm2 + btx*btx + bty*bty));
-				}
-				else
+				//normally, initial conditions should be already set here
+				long nsRight = ns - is0;
+				if(nsRight < 1) nsRight = 1;
+				double *auxTrjRes = new double[nsRight*perPt];
+				if(auxTrjRes == 0) { delete[] arInitCondChunk; throw MEMORY_ALLOCATION_FAILURE;}
+
+				if(nsRight <= 1)
 				{
-					*(tOutX++) = *(t_auxTrjRes++);
-					btx = *(t_auxTrjRes++); *(tOutBtX++) = btx;
-					*(tOutY++) = *(t_auxTrjRes++);
-					bty = *(t_auxTrjRes++); *(tOutBtY++) = bty;
-					if(pOutZ) *(tOutZ++) = *t_auxTrjRes;
-					t_auxTrjRes++;
-					if(pOutBtZ) *(tOutBtZ++) = CGenMathMeth::radicalOnePlusSmall(-(gamEm2 + btx*btx + bty*bty));
+					for(long i=0; i<perPt; i++) auxTrjRes[i] = initCond[i];
 				}
+				//s0Act has been defined above!
+				else IntegrateKicks(arKickM, vIndNonOverlapKickGroups, vIndNonOverlapKickGroupRanges, nP, inv_B_pho, initCond, s0Act, sEnd, nsRight, auxTrjRes);
+
+				CopyKickTrjRes(auxTrjRes, nsRight, false, nP, is0, trjShouldBeAdded, gamEm2, outBtX, outX, outBtY, outY, outBtZ, outZ);
+				delete[] auxTrjRes;
 			}
-			delete[] auxTrjRes;
 		}
-		else
-		{
-			//normally, initial conditions should be already set here
-			int nsRight = ns - is0;
-			if(nsRight < 1) nsRight = 1;
-			double *auxTrjRes = new double[nsRight*5];
-			if(auxTrjRes == 0) throw MEMORY_ALLOCATION_FAILURE;
+	}
+	delete[] arInitCondChunk;
+}
 
-			if(nsRight <= 1)
+//*************************************************************************
+// Copies (or adds) trajectory data of nPart particles, obtained by IntegrateKicks, to resulting arrays
+// auxTrjRes - flat array of results, 5 values per point, trajectory of each particle occupying 5*np values
+// np - number of points; if(reverse) the points are copied in reverse order
+// iOutSt - index of first point in resulting arrays
+//-------------------------------------------------------------------------
+void srTGenTrjDat::CopyKickTrjRes(double* auxTrjRes, long np, bool reverse, int nPart, long iOutSt, bool add, double* arGamEm2, double** arOutBtX, double** arOutX, double** arOutBtY, double** arOutY, double** arOutBtZ, double** arOutZ)
+{
+	long perPart = 5*np;
+	for(int ip=0; ip<nPart; ip++)
+	{
+		double *tOutBtX = arOutBtX[ip] + iOutSt, *tOutX = arOutX[ip] + iOutSt;
+		double *tOutBtY = arOutBtY[ip] + iOutSt, *tOutY = arOutY[ip] + iOutSt;
+		double *pOutBtZ = arOutBtZ[ip], *pOutZ = arOutZ[ip];
+		double *tOutBtZ = (pOutBtZ == 0)? 0 : pOutBtZ + iOutSt, *tOutZ = (pOutZ == 0)? 0 : pOutZ + iOutSt;
+		double gamEm2 = arGamEm2[ip], btx, bty;
+
+		double *t_auxTrjRes = auxTrjRes + ip*perPart + (reverse? (np - 1)*5 : 0);
+		long dPt = reverse? -5 : 5;
+		for(long j=0; j<np; j++)
+		{
+			if(add)
 			{
-				double *t_auxTrjRes = auxTrjRes;
-				//*(t_auxTrjRes++) = s0Act;
-				for(int i=0; i<5; i++) *(t_auxTrjRes++) = initCond[i];
+				*(tOutX++) += t_auxTrjRes[0];
+				*tOutBtX += t_auxTrjRes[1]; btx = *(tOutBtX++);
+				*(tOutY++) += t_auxTrjRes[2];
+				*tOutBtY += t_auxTrjRes[3]; bty = *(tOutBtY++);
+				//longitudinal position is not modified in this case
 			}
-			//s0Act has been defined above!
-			else IntegrateKicks(arKickM, vIndNonOverlapKickGroups, vIndNonOverlapKickGroupRanges, inv_B_pho, initCond, s0Act, sEnd, nsRight, auxTrjRes);
-			//else gmIntRK.solve(initCond, s0Act, sMax, nsRight, auxTrjRes);
-
-			double *t_auxTrjRes = auxTrjRes;
-			for(int j=0; j<nsRight; j++)
+			else
 			{
-				if(trjShouldBeAdded)
-				{
-					*(tOutX++) += *(t_auxTrjRes++);
-					*tOutBtX += *(t_auxTrjRes++); btx = *(tOutBtX++);
-					*(tOutY++) += *(t_auxTrjRes++);
-					*tOutBtY += *(t_auxTrjRes++); bty = *(tOutBtY++);
-					//if(pOutZ) *(tOutZ++) += *t_auxTrjRes; //longitudinal position is not modified in this case
-					t_auxTrjRes++;
-					if(pOutBtZ) *(tOutBtZ++) = CGenMathMeth::radicalOnePlusSmall(-(gamEm2 + btx*btx + bty*bty));
-				}
-				else
-				{
-					*(tOutX++) = *(t_auxTrjRes++);
-					btx = *(t_auxTrjRes++); *(tOutBtX++) = btx;
-					*(tOutY++) = *(t_auxTrjRes++);
-					bty = *(t_auxTrjRes++); *(tOutBtY++) = bty;
-					if(pOutZ) *(tOutZ++) = *t_auxTrjRes;
-					t_auxTrjRes++;
-					if(pOutBtZ) *(tOutBtZ++) = CGenMathMeth::radicalOnePlusSmall(-(gamEm2 + btx*btx + bty*bty));
-				}
+				*(tOutX++) = t_auxTrjRes[0];
+				btx = t_auxTrjRes[1]; *(tOutBtX++) = btx;
+				*(tOutY++) = t_auxTrjRes[2];
+				bty = t_auxTrjRes[3]; *(tOutBtY++) = bty;
+				if(tOutZ) *(tOutZ++) = t_auxTrjRes[4];
 			}
-			delete[] auxTrjRes;
+			if(tOutBtZ) *(tOutBtZ++) = CGenMathMeth::radicalOnePlusSmall(-(gamEm2 + btx*btx + bty*bty));
+			t_auxTrjRes += dPt;
 		}
 	}
 }
 
 //*************************************************************************
-// Performs integration of trajectory based on kicks
-// initCond[5] - array of initial conditions, defined at s = sStart
+// Performs integration of trajectories of nPart particles based on kicks
+// inv_B_pho[nPart] - 1/(B*rho) of each particle
+// initCond[5*nPart] - array of initial conditions, defined at s = sStart (longitudinal position should be the same for all particles)
 // sStart - initial argument
 // sEnd - final argument
 // ns - number of points
-// pTrjRes - resulting flat trajectory array, length is equal to 5*ns
+// pTrjRes - resulting flat trajectory array, length is equal to 5*ns*nPart (trajectory of each particle occupies 5*ns values)
+// For each step, every kick-matrix is interpolated for all particles at once, with its data being reused from cache.
 //-------------------------------------------------------------------------
-void srTGenTrjDat::IntegrateKicks(SRWLKickM* arKickM, vector<vector<int> >& vIndNonOverlapKickGroups, vector<pair<double, double> >& vIndNonOverlapKickGroupRanges, double inv_B_pho, double* initCond, double sStart, double sEnd, int ns, double* pTrjRes)
+void srTGenTrjDat::IntegrateKicks(SRWLKickM* arKickM, vector<vector<int> >& vIndNonOverlapKickGroups, vector<pair<double, double> >& vIndNonOverlapKickGroupRanges, int nPart, double* inv_B_pho, double* initCond, double sStart, double sEnd, long ns, double* pTrjRes)
 {
 	int nGroups = (int)vIndNonOverlapKickGroups.size();
-	if((arKickM == 0) || (nGroups <= 0) || (initCond == 0) || (pTrjRes == 0)) return;
+	if((arKickM == 0) || (nGroups <= 0) || (nPart <= 0) || (initCond == 0) || (pTrjRes == 0)) return;
 
-	double *tX = pTrjRes, *tBtX = pTrjRes + 1, *tY = pTrjRes + 2, *tBtY = pTrjRes + 3, *tZ = pTrjRes + 4;
-	*tX = initCond[0]; *tBtX = initCond[1]; *tY = initCond[2]; *tBtY = initCond[3]; *tZ = initCond[4];
+	long perPart = 5*ns;
+	double *arAuxKicks = new double[13*nPart]; //current X, BtX, Y, BtY, Z; dX, dBtX, dY, dBtY (total) and kx_ds, kx, ky_ds, ky (current group) for each particle
+	if(arAuxKicks == 0) throw MEMORY_ALLOCATION_FAILURE;
+	double *arCur = arAuxKicks, *arD = arAuxKicks + 5*nPart, *arK = arAuxKicks + 9*nPart;
 
-	map<int, pair<double, pair<double, double> > >  mAuxPrevKick; //to keep previous kick values and longitudinal positions at which these values were obtained by interpolation
+	double *tCur = arCur, *tInitCond = initCond, *tRes = pTrjRes;
+	for(int ip=0; ip<nPart; ip++)
+	{
+		for(int k=0; k<5; k++) { tRes[k] = *tInitCond; *(tCur++) = *(tInitCond++);}
+		tRes += perPart;
+	}
+
+	map<int, pair<double, vector<double> > > mAuxPrevKick; //to keep previous kick values (for all particles) and longitudinal positions at which these values were obtained by interpolation
 	double arF[12];
 	double sStep = (ns > 1)? (sEnd - sStart)/(ns - 1) : 0.;
 	//s is longitudinal position from here on!
 	double s = initCond[4]; //sStart; // + sStep;
-	for(int is=0; is<(ns-1); is++)
+	for(long is=0; is<(ns-1); is++)
 	{
-		//double Xprev = *tX, BtXprev = *tBtX, Yprev = *tY, BtYprev = *tBtY, Zprev = *tZ;
-		double dX = 0., dBtX = 0., dY = 0., dBtY = 0., dZ = 0.;
+		double *tD = arD;
+		for(int ip=0; ip<nPart; ip++) { *(tD++) = 0.; *(tD++) = 0.; *(tD++) = 0.; *(tD++) = 0.;}
 
 		for(int i=0; i<nGroups; i++)
 		{//"non-overlapping groups"
@@ -670,7 +675,9 @@ void srTGenTrjDat::IntegrateKicks(SRWLKickM* arKickM, vector<vector<int> >& vInd
 				vector<int>& curVectIndKicks = vIndNonOverlapKickGroups[i];
 				int nKickInGroup = (int)curVectIndKicks.size();
 
-				double kx_ds = 0., ky_ds = 0., kx = 0., ky = 0.;
+				double *tK = arK;
+				for(int ip=0; ip<nPart; ip++) { *(tK++) = 0.; *(tK++) = 0.; *(tK++) = 0.; *(tK++) = 0.;}
+
 				for(int j=0; j<nKickInGroup; j++)
 				{//sum-up current kicks from this group
 					int indCurKick = curVectIndKicks[j];
@@ -681,163 +688,56 @@ void srTGenTrjDat::IntegrateKicks(SRWLKickM* arKickM, vector<vector<int> >& vInd
 					double sEndCurKick = pCurKickM->z + sHalfRange;
 
 					double dsTest = s + sStep - sStartCurKick;
-					//if((sStartCurKick < (s + sStep)) && (s < sEndCurKick))
 					if((0. < dsTest) && (s < sEndCurKick))
 					{
 						double dsKick = sStep;
 						if(dsKick > dsTest) dsKick = dsTest;
-
-						double yHalfRange = 0.5*pCurKickM->ry;
-						double yStartCurKick = pCurKickM->y - yHalfRange;
-						double yEndCurKick = pCurKickM->y + yHalfRange;
-						//if((yStartCurKick <= *tY) && (*tY < yEndCurKick))
-						//{
-							int iy0 = 0;
-							double yStep = 0., yt = 0.;
-							int Ny = pCurKickM->ny;
-							if(Ny > 1) 
+						double multKick = dsKick/pCurKickM->rz;
+
+						bool calcNewKickVals = true;
+						map<int, pair<double, vector<double> > >::iterator itPrevKick = mAuxPrevKick.find(indCurKick);
+						if(itPrevKick != mAuxPrevKick.end())
+						{//to save time: don't interpolate (use previous interpolated kick values) if the current kick step is not exceeded
+							double sPrevKick = itPrevKick->second.first;
+							double sStepKick = (pCurKickM->nz > 1)? pCurKickM->rz/(pCurKickM->nz - 1) : 0.;
+							if((s - sPrevKick) <= sStepKick) calcNewKickVals = false;
+						}
+						pair<double, vector<double> > &pairKickInf = mAuxPrevKick[indCurKick];
+						if(calcNewKickVals)
+						{
+							pairKickInf.first = s;
+							pairKickInf.second.resize(2*nPart);
+							double *tNewKick = &(pairKickInf.second[0]), *tPrev = arCur;
+							for(int ip=0; ip<nPart; ip++)
 							{
-								yStep = pCurKickM->ry/(Ny - 1);
-								iy0 = (int)((*tY - yStartCurKick)/yStep + 1.e-09);
-								yt = (*tY - (yStartCurKick + iy0*yStep))/yStep;
-								if(iy0 < 0) 
-								{
-									iy0 = 0; yt = 0.;
-								}
-								else if(iy0 >= Ny) 
-								{
-									iy0 = Ny - 1; yt = 0.;
-								}
+								InterpKickMatr(pCurKickM, tPrev[0], tPrev[2], tNewKick, arF);
+								tNewKick += 2; tPrev += 5;
 							}
-
-							double xHalfRange = 0.5*pCurKickM->rx;
-							double xStartCurKick = pCurKickM->x - xHalfRange;
-							double xEndCurKick = pCurKickM->x + xHalfRange;
-							//if((xStartCurKick <= *tX) && (*tX < xEndCurKick))
-							//{
-								double mult = inv_B_pho;
-								if(pCurKickM->order == 2) mult *= mult;
-
-								mult *= dsKick/pCurKickM->rz;
-
-								bool calcNewKickVals = false;
-								map<int, pair<double, pair<double, double> > >::iterator itPrevKick = mAuxPrevKick.find(indCurKick);
-								if(itPrevKick != mAuxPrevKick.end())
-								{//to save time: don't interpolate (use previous interpolated kick value) if the current kick step is not exceeded
-									pair<double, pair<double, double> > &pairKickInf = itPrevKick->second;
-									double sPrevKick = pairKickInf.first;
-									double sStepKick = (pCurKickM->nz > 1)? pCurKickM->rz/(pCurKickM->nz - 1) : 0.;
-									if((s - sPrevKick) <= sStepKick)
-									{
-										if(pCurKickM->arKickMx != 0) 
-										{
-											double dkx = mult*pairKickInf.second.first; 
-											kx += dkx;
-											kx_ds += dkx*dsKick; 
-										}
-										if(pCurKickM->arKickMy != 0) 
-										{
-											double dky = mult*pairKickInf.second.second; 
-											ky += dky;
-											ky_ds += dky*dsKick; 
-										}
-									}
-									else calcNewKickVals = true;
-								}
-								else calcNewKickVals = true;
-
-								if(calcNewKickVals)
-								{
-									int ix0 = 0;
-									double xStep = 0., xt = 0.;
-									int Nx = pCurKickM->nx;
-									if(Nx > 1) 
-									{
-										xStep = pCurKickM->rx/(Nx - 1);
-										ix0 = (int)((*tX - xStartCurKick)/xStep + 1.e-09);
-										xt = (*tX - (xStartCurKick + ix0*xStep))/xStep;
-										if(ix0 < 0) 
-										{
-											ix0 = 0; xt = 0.;
-										}
-										else if(ix0 >= Nx) 
-										{
-											ix0 = Nx - 1; xt = 0.;
-										}
-									}
-									int ixm1 = ix0 - 1; if(ixm1 < 0) ixm1 = 0;
-									int ix1 = ix0 + 1; if(ix1 >= Nx) ix1 = Nx - 1;
-									int ix2 = ix1 + 1; if(ix2 >= Nx) ix2 = Nx - 1;
-									int iym1 = iy0 - 1; if(iym1 < 0) iym1 = 0;
-									int iy1 = iy0 + 1; if(iy1 >= Ny) iy1 = Ny - 1;
-									int iy2 = iy1 + 1; if(iy2 >= Ny) iy2 = Ny - 1;
-
-									//find current contributions to kx, ky by interpolation, taking into account kick order
-									long Nx_iym1 = Nx*iym1;
-									long i0m1 = ix0 + Nx_iym1; //f0m1
-									long i1m1 = ix1 + Nx_iym1; //f1m1
-									long Nx_iy0 = Nx*iy0;
-									long im10 = ixm1 + Nx_iy0; //fm10
-									long i00 = ix0 + Nx_iy0; //f00
-									long i10 = ix1 + Nx_iy0; //f10
-									long i20 = ix2 + Nx_iy0; //f20
-									long Nx_iy1 = Nx*iy1;
-									long im11 = ixm1 + Nx_iy1; //fm11
-									long i01 = ix0 + Nx_iy1; //f01
-									long i11 = ix1 + Nx_iy1; //f11
-									long i21 = ix2 + Nx_iy1; //f21
-									long Nx_iy2 = Nx*iy2;
-									long i02 = ix0 + Nx_iy2; //f02
-									long i12 = ix1 + Nx_iy2; //f12
-
-									double newKickX = 0., newKickY = 0.;
-									double *pM = pCurKickM->arKickMx;
-									if(pM != 0)
-									{
-										double *tF = arF;
-										*(tF++) = *(pM + i0m1); //f0m1
-										*(tF++) = *(pM + i1m1); //f1m1
-										*(tF++) = *(pM + im10); //fm10
-										*(tF++) = *(pM + i00); //f00
-										*(tF++) = *(pM + i10); //f10
-										*(tF++) = *(pM + i20); //f20
-										*(tF++) = *(pM + im11); //fm11
-										*(tF++) = *(pM + i01); //f01
-										*(tF++) = *(pM + i11); //f11
-										*(tF++) = *(pM + i21); //f21
-										*(tF++) = *(pM + i02); //f02
-										*(tF++) = *(pM + i12); //f12
-										newKickX = CGenMathInterp::Interp2dBiCubic12pRel(xt, yt, arF);
-										double dkx = mult*newKickX;
-										kx += dkx;
-										kx_ds += dkx*dsKick;
-									}
-									pM = pCurKickM->arKickMy;
-									if(pM != 0)
-									{
-										double *tF = arF;
-										*(tF++) = *(pM + i0m1); //f0m1
-										*(tF++) = *(pM + i1m1); //f1m1
-										*(tF++) = *(pM + im10); //fm10
-										*(tF++) = *(pM + i00); //f00
-										*(tF++) = *(pM + i10); //f10
-										*(tF++) = *(pM + i20); //f20
-										*(tF++) = *(pM + im11); //fm11
-										*(tF++) = *(pM + i01); //f01
-										*(tF++) = *(pM + i11); //f11
-										*(tF++) = *(pM + i21); //f21
-										*(tF++) = *(pM + i02); //f02
-										*(tF++) = *(pM + i12); //f12
-										newKickY = CGenMathInterp::Interp2dBiCubic12pRel(xt, yt, arF);
-										double dky = mult*newKickY;
-										ky += dky;
-										ky_ds += dky*dsKick;
-									}
-									pair<double, pair<double, double> > pairNewKickInf(s, pair<double, double>(newKickX, newKickY));
-									mAuxPrevKick[indCurKick] = pairNewKickInf;
-								}
-							//}
-						//}
+						}
+
+						bool kickXisDefined = (pCurKickM->arKickMx != 0), kickYisDefined = (pCurKickM->arKickMy != 0);
+						double *tKick = &(pairKickInf.second[0]);
+						tK = arK;
+						for(int ip=0; ip<nPart; ip++)
+						{
+							double mult = inv_B_pho[ip];
+							if(pCurKickM->order == 2) mult *= mult;
+							mult *= multKick;
+
+							if(kickXisDefined) 
+							{
+								double dkx = mult*tKick[0]; 
+								tK[1] += dkx;
+								tK[0] += dkx*dsKick; 
+							}
+							if(kickYisDefined) 
+							{
+								double dky = mult*tKick[1]; 
+								tK[3] += dky;
+								tK[2] += dky*dsKick; 
+							}
+							tKick += 2; tK += 4;
+						}
 					}
 					else if(s >= sEndCurKick)
 					{
@@ -845,22 +745,106 @@ void srTGenTrjDat::IntegrateKicks(SRWLKickM* arKickM, vector<vector<int> >& vInd
 					}
 				}
 				//to add kicks to trajectory here:
-				//Xprev += kx_ds; BtXprev += kx; Yprev += ky_ds; BtYprev += ky;
-				dX += kx_ds; dBtX += kx; dY += ky_ds; dBtY += ky;
+				tD = arD; tK = arK;
+				for(int ip=0; ip<nPart; ip++)
+				{
+					*(tD++) += *(tK++); *(tD++) += *(tK++); *(tD++) += *(tK++); *(tD++) += *(tK++);
+				}
 			}
 			else if(s < curGroupStartS) break;
 		}
-		double Xprev = *tX, BtXprev = *tBtX, Yprev = *tY, BtYprev = *tBtY, Zprev = *tZ;
-		tX += 5; tBtX += 5; tY += 5; tBtY += 5; tZ += 5;
-		//*tX = Xprev; *tBtX = BtXprev; *tY = Yprev; *tBtY = BtYprev; *tZ = Zprev + sStep;
-		*tX = Xprev + dX + BtXprev*sStep; 
-		*tBtX = BtXprev + dBtX; 
-		*tY = Yprev + dY + BtYprev*sStep; 
-		*tBtY = BtYprev + dBtY; 
-		*tZ = Zprev + sStep;
 
+		double *pNew = pTrjRes + (is + 1)*5;
+		tCur = arCur; tD = arD;
+		for(int ip=0; ip<nPart; ip++)
+		{
+			double Xprev = tCur[0], BtXprev = tCur[1], Yprev = tCur[2], BtYprev = tCur[3], Zprev = tCur[4];
+			tCur[0] = Xprev + tD[0] + BtXprev*sStep; 
+			tCur[1] = BtXprev + tD[1]; 
+			tCur[2] = Yprev + tD[2] + BtYprev*sStep; 
+			tCur[3] = BtYprev + tD[3]; 
+			tCur[4] = Zprev + sStep;
+			for(int k=0; k<5; k++) pNew[k] = tCur[k];
+			tCur += 5; pNew += perPart; tD += 4;
+		}
 		s += sStep;
 	}
+	delete[] arAuxKicks;
+}
+
+//*************************************************************************
+// Interpolates horizontal and vertical kicks (arKick[0], arKick[1]) from kick-matrix at transverse position (x, y)
+// arF - auxiliary array of 12 values
+//-------------------------------------------------------------------------
+void srTGenTrjDat::InterpKickMatr(SRWLKickM* pKickM, double x, double y, double* arKick, double* arF)
+{
+	arKick[0] = arKick[1] = 0.;
+
+	int iy0 = 0;
+	double yStep = 0., yt = 0.;
+	int Ny = pKickM->ny;
+	if(Ny > 1) 
+	{
+		double yStartKick = pKickM->y - 0.5*pKickM->ry;
+		yStep = pKickM->ry/(Ny - 1);
+		iy0 = (int)((y - yStartKick)/yStep + 1.e-09);
+		yt = (y - (yStartKick + iy0*yStep))/yStep;
+		if(iy0 < 0) 
+		{
+			iy0 = 0; yt = 0.;
+		}
+		else if(iy0 >= Ny) 
+		{
+			iy0 = Ny - 1; yt = 0.;
+		}
+	}
+
+	int ix0 = 0;
+	double xStep = 0., xt = 0.;
+	int Nx = pKickM->nx;
+	if(Nx > 1) 
+	{
+		double xStartKick = pKickM->x - 0.5*pKickM->rx;
+		xStep = pKickM->rx/(Nx - 1);
+		ix0 = (int)((x - xStartKick)/xStep + 1.e-09);
+		xt = (x - (xStartKick + ix0*xStep))/xStep;
+		if(ix0 < 0) 
+		{
+			ix0 = 0; xt = 0.;
+		}
+		else if(ix0 >= Nx) 
+		{
+			ix0 = Nx - 1; xt = 0.;
+		}
+	}
+	int ixm1 = ix0 - 1; if(ixm1 < 0) ixm1 = 0;
+	int ix1 = ix0 + 1; if(ix1 >= Nx) ix1 = Nx - 1;
+	int ix2 = ix1 + 1; if(ix2 >= Nx) ix2 = Nx - 1;
+	int iym1 = iy0 - 1; if(iym1 < 0) iym1 = 0;
+	int iy1 = iy0 + 1; if(iy1 >= Ny) iy1 = Ny - 1;
+	int iy2 = iy1 + 1; if(iy2 >= Ny) iy2 = Ny - 1;
+
+	//find current contributions to kx, ky by interpolation
+	long Nx_iym1 = Nx*iym1, Nx_iy0 = Nx*iy0, Nx_iy1 = Nx*iy1, Nx_iy2 = Nx*iy2;
+	long arInd[] = {
+		ix0 + Nx_iym1, ix1 + Nx_iym1, //f0m1, f1m1
+		ixm1 + Nx_iy0, ix0 + Nx_iy0, ix1 + Nx_iy0, ix2 + Nx_iy0, //fm10, f00, f10, f20
+		ixm1 + Nx_iy1, ix0 + Nx_iy1, ix1 + Nx_iy1, ix2 + Nx_iy1, //fm11, f01, f11, f21
+		ix0 + Nx_iy2, ix1 + Nx_iy2 //f02, f12
+	};
+
+	double *pM = pKickM->arKickMx;
+	if(pM != 0)
+	{
+		for(int k=0; k<12; k++) arF[k] = pM[arInd[k]];
+		arKick[0] = CGenMathInterp::Interp2dBiCubic12pRel(xt, yt, arF);
+	}
+	pM = pKickM->arKickMy;
+	if(pM != 0)
+	{
+		for(int k=0; k<12; k++) arF[k] = pM[arInd[k]];
+		arKick[1] = CGenMathInterp::Interp2dBiCubic12pRel(xt, yt, arF);
+	}
 }
 
 //*************************************************************************
@@ -223,7 +223,10 @@ public:
 
 	void CompTrjCrdVelRK(double sSt, double sEn, long np, double* pInPrecPar, double* pOutBtxData, double* pOutXData, double* pOutBtyData, double* pOutYData, double* pOutBtzData, double* pOutZData, double* pOutBxData, double* pOutByData, double* pOutBzData);
 	void CompTrjKickMatr(SRWLKickM* arKickM, int nKickM, double sSt, double sEn, long np, double* pInPrecPar, double* pOutBtxData, double* pOutXData, double* pOutBtyData, double* pOutYData, double* pOutBtzData, double* pOutZData);
-	void IntegrateKicks(SRWLKickM* arKickM, vector<vector<int> >& vIndNonOverlapKickGroups, vector<pair<double, double> >& vIndNonOverlapKickGroupRanges, double inv_B_pho, double* initCond, double sStart, double sEnd, int ns, double* pTrjRes);
+	static void CompTrjKickMatrMult(SRWLKickM* arKickM, int nKickM, double sSt, double sEn, long np, double* pInPrecPar, int nPart, double* arInitCond, double* arInvBrho, double* arGamEm2, double** arOutBtX, double** arOutX, double** arOutBtY, double** arOutY, double** arOutBtZ, double** arOutZ);
+	static void CopyKickTrjRes(double* auxTrjRes, long np, bool reverse, int nPart, long iOutSt, bool add, double* arGamEm2, double** arOutBtX, double** arOutX, double** arOutBtY, double** arOutY, double** arOutBtZ, double** arOutZ);
+	static void IntegrateKicks(SRWLKickM* arKickM, vector<vector<int> >& vIndNonOverlapKickGroups, vector<pair<double, double> >& vIndNonOverlapKickGroupRanges, int nPart, double* inv_B_pho, double* initCond, double sStart, double sEnd, long ns, double* pTrjRes);
+	static void InterpKickMatr(SRWLKickM* pKickM, double x, double y, double* arKick, double* arF);
 
 	virtual long EstimMinNpForRadInteg(char typeInt)
 	{//typeInt == 1: monochromatic emission in frequency domain
@@ -248,6 +251,7 @@ public:
 	{
 		int methNo = 1; //RK4
 		//methNo = 2; //RK5
+		//methNo = 3; //Dormand-Prince RK5(4) with dense output
 		double *pPrec=0;
 		if(pInPrecPar != 0)
 		{
@@ -258,7 +262,7 @@ public:
 			}
 		}
 
-		if((methNo == 1) || (methNo == 2)) CompTrjCrdVelRK(sSt, sEn, np, pPrec, pOutBtxData, pOutXData, pOutBtyData, pOutYData, pOutBtzData, pOutZData, pOutBxData, pOutByData, pOutBzData);
+		if((methNo >= 1) && (methNo <= 3)) CompTrjCrdVelRK(sSt, sEn, np, pPrec, pOutBtxData, pOutXData, pOutBtyData, pOutYData, pOutBtzData, pOutZData, pOutBxData, pOutByData, pOutBzData);
 		//else ...
 	}
 
@@ -98,6 +98,7 @@ srTMagFldCont::srTMagFldCont(const SRWLMagFldC& inMagCnt, const TVector3d& inCen
 		t_arMagFldTypes++;
 		t_arXc++; t_arYc++; t_arZc++;
 	}
+	SetupLongIntervIndex();
 }
 
 //*************************************************************************
@@ -18,6 +18,8 @@
 #include "objcont.h"
 #include "srmagfld.h"
 
+#include <algorithm>
+
 //-------------------------------------------------------------------------
 
 extern CObjCont<CGenObject> gSRObjects;
@@ -32,6 +34,14 @@ class srTMagFldCont : public srTMagElem {
 	CObjCont<CGenObject> gMagElems;
 	//vector<TVector3d> mVectCenP;
 
+	//Longitudinal interval index used by compB: the longitudinal axis is split at the limits of field support of all members,
+	//and for each interval, the members which may contribute to the field in it are listed (in the order of the container).
+	//It is rebuilt whenever the members change (constructors, AddElement(s), PrepareContForParticlePropag, SortContVsStartPos),
+	//so that compB only reads it and the same container may be used by several threads / jobs.
+	vector<double> m_vLongIntervLim; //limits of the intervals, sorted
+	vector<int> m_vLongIntervFirstElem; //index of the first member of each interval in m_vLongIntervElem (one more element at the end)
+	vector<srTMagElem*> m_vLongIntervElem;
+
 public:
 
 	srTMagFldCont(int* pMagElem, int nMagElem)
@@ -54,11 +64,13 @@ public:
 			if(dynamic_cast<srTMagElem*>(hObj.ptr()) == 0) throw OBJECT_IS_NOT_MAG;
 			gMagElems.insert(*tInd, hObj);
 		}
+		SetupLongIntervIndex();
 	}
 
 	void AddElement(const CHGenObj& hMagElem)
 	{
 		gMagElems.insert(hMagElem);
+		SetupLongIntervIndex();
 	}
 
 	int AmountOfMembers() { return gMagElems.size();}
@@ -81,14 +93,36 @@ public:
 	}
 
 	void compB(TVector3d& inP, TVector3d& outB) //virtual in srTMagElem
-	{
+	{//only the members which may contribute to the field at the longitudinal position of the point are called
 		if(gMagElems.data.empty()) return;
 
 		TVector3d relP = inP - mCenP;
-		for(CMHGenObj::const_iterator iter = gMagElems.data.begin(); iter != gMagElems.data.end(); ++iter)
-		{
-			((srTMagElem*)((*iter).second.rep))->compB(relP, outB);
-		}
+		int iInterv = FindLongInterv(relP.z);
+		if(iInterv < 0) return;
+
+		srTMagElem **tElem = &(m_vLongIntervElem[0]) + m_vLongIntervFirstElem[iInterv];
+		int nElem = m_vLongIntervFirstElem[iInterv + 1] - m_vLongIntervFirstElem[iInterv];
+		for(int i=0; i<nElem; i++) (*(tElem++))->compB(relP, outB);
+	}
+
+	int FindLongInterv(double z) const
+	{//returns -1 if z is out of all intervals
+		int nInterv = (int)m_vLongIntervLim.size() - 1;
+		if(nInterv <= 0) return -1;
+		const double *arLim = &(m_vLongIntervLim[0]);
+		if((z < arLim[0]) || (z > arLim[nInterv])) return -1;
+
+		int i = (int)(upper_bound(arLim, arLim + nInterv, z) - arLim) - 1;
+		if(i < 0) i = 0;
+		return i;
+	}
+
+	void GetLongLimOfFieldSupport(double& zMin, double& zMax) //virtual in srTMagElem
+	{
+		zMin = 1.e+23; zMax = -1.e+23;
+		int nLim = (int)m_vLongIntervLim.size();
+		if(nLim <= 0) return;
+		zMin = m_vLongIntervLim[0] + mCenP.z; zMax = m_vLongIntervLim[nLim - 1] + mCenP.z;
 	}
 
     void ComputeSR_Stokes(srTEbmDat* pElecBeam, srTWfrSmp* pWfrSmp, void* pPrcPar, srTStokesStructAccessData* pStokes); //virtual
@@ -96,6 +130,7 @@ public:
 	void PrepareContForParticlePropag();
 	void SortContVsStartPos();
 	void DetermineLongStartAndEndPos();
+	void SetupLongIntervIndex();
 };
 
 //-------------------------------------------------------------------------
@@ -63,6 +63,7 @@ public:
 	virtual void ComputeSR_Stokes(srTEbmDat* pElecBeam, srTWfrSmp* pWfrSmp, void* pPrcPar, srTStokesStructAccessData* pStokes) { throw SR_COMP_NOT_IMPLEMENTED_FOR_GIVEN_MAG_FLD;}
 	virtual void ComputeParticlePropagMatrix(double s, TMatrix2d& Mx, TMatrix2d& Mz) {}
 	virtual void compB(TVector3d& inP, TVector3d& outB) {}
+	virtual void GetLongLimOfFieldSupport(double& zMin, double& zMax) { zMin = -1.e+23; zMax = 1.e+23;} //conservative longitudinal limits of the region where compB may add non-zero field (in the frame of the point submitted to compB)
 
 	static int FindMagElemWithSmallestLongPos(CObjCont<CGenObject>& AuxCont);
 	void GetMagnFieldLongLim(double& sSt, double& sEn) { sSt = gsStart; sEn = gsEnd;} //SRWLIB
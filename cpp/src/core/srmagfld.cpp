@@ -28,7 +28,7 @@
 
 //*************************************************************************
 
-extern srTIntVect gVectWarnNos;
+extern thread_local srTIntVect gVectWarnNos;
 
 //*************************************************************************
 
@@ -725,10 +725,10 @@ void srTMagFldTrUnif::AnalyzeForHarmonics(double* pB, int AmOfPts, double Per, d
 	double *CkArr=0, *PhikArr=0;
 	int *HarmNoArr=0;
 
-	AuxDataContIn = new float[AmOfPts << 1];
+	AuxDataContIn = new float[AmOfPts];
 	if(AuxDataContIn == 0) throw MEMORY_ALLOCATION_FAILURE;
 
-	AuxDataContOut = new float[AmOfPts << 1];
+	AuxDataContOut = new float[AmOfPts + 2]; //half-spectrum of real data
 	if(AuxDataContOut == 0) throw MEMORY_ALLOCATION_FAILURE;
 
 	double *tB = pB;
@@ -737,7 +737,7 @@ void srTMagFldTrUnif::AnalyzeForHarmonics(double* pB, int AmOfPts, double Per, d
 	for(int i=0; i<AmOfPts; i++) 
 	{
 		double CurB = *(tB++);
-		*(tIn++) = (float)CurB; *(tIn++) = 0.;
+		*(tIn++) = (float)CurB;
 		
 		double CurAbsB = ::fabs(CurB);
 		if(MaxAbsB < CurAbsB) MaxAbsB = CurAbsB;
@@ -762,7 +762,7 @@ void srTMagFldTrUnif::AnalyzeForHarmonics(double* pB, int AmOfPts, double Per, d
 	FFT1DInfo.UseGivenStartTrValue = 0;
 
 	CGenMathFFT1D FFT1D;
-	FFT1D.Make1DFFT(FFT1DInfo);
+	FFT1D.Make1DFFT_RealToCompl(FFT1DInfo);
 
 	int HalfAmOfPts = AmOfPts >> 1;
 	int MaxAmOfHarm = AmOfHarm;
@@ -780,7 +780,7 @@ void srTMagFldTrUnif::AnalyzeForHarmonics(double* pB, int AmOfPts, double Per, d
 	double CoefMult = 2./Per;
 	double AbsThreshold = RelPrec*MaxAbsB/CoefMult;
 
-	float *tOutFFT = AuxDataContOut + AmOfPts + 2;
+	float *tOutFFT = AuxDataContOut + 2;
 	double *tCkArr = CkArr, *tPhikArr = PhikArr;
 	int *tHarmNoArr = HarmNoArr;
 	int HarmCount = 0;
@@ -1093,6 +1093,7 @@ void srTMagFldCont::PrepareContForParticlePropag()
 	{
         gMagElems.erase();
         gMagElems.copy(LocMagElems);
+		SetupLongIntervIndex();
 	}
 }
 
@@ -1117,6 +1118,7 @@ void srTMagFldCont::SortContVsStartPos()
 		gMagElems.insert(hCurElem);
 		LocMagElems.erase(IndCurElem);
 	}
+	SetupLongIntervIndex();
 }
 
 //*************************************************************************
@@ -1143,3 +1145,56 @@ void srTMagFldCont::DetermineLongStartAndEndPos()
 
 //*************************************************************************
 
+void srTMagFldCont::SetupLongIntervIndex()
+{//Limits of field support of the members are taken with a small margin, to be on the safe side with respect to rounding in compB of the members.
+ //Members with unknown limits of field support are included in all intervals.
+	const double RelTolLim = 1.e-09, AbsTolLim = 1.e-12; //[m]
+	const double AbsLim = 1.e+23;
+
+	m_vLongIntervLim.erase(m_vLongIntervLim.begin(), m_vLongIntervLim.end());
+	m_vLongIntervFirstElem.erase(m_vLongIntervFirstElem.begin(), m_vLongIntervFirstElem.end());
+	m_vLongIntervElem.erase(m_vLongIntervElem.begin(), m_vLongIntervElem.end());
+
+	vector<srTMagElem*> vElem;
+	vector<double> vElemMin, vElemMax;
+	for(CMHGenObj::const_iterator iter = gMagElems.data.begin(); iter != gMagElems.data.end(); ++iter)
+	{
+		srTMagElem* pMagElem = (srTMagElem*)((*iter).second.rep);
+		if(pMagElem == 0) continue;
+
+		double zMin = -AbsLim, zMax = AbsLim;
+		pMagElem->GetLongLimOfFieldSupport(zMin, zMax);
+		if(!(zMin <= zMax)) { zMin = -AbsLim; zMax = AbsLim;} //also NaN
+		double dLim = RelTolLim*(::fabs(zMin) + ::fabs(zMax)) + AbsTolLim;
+		zMin -= dLim; zMax += dLim;
+		if(zMin < -AbsLim) zMin = -AbsLim;
+		if(zMax > AbsLim) zMax = AbsLim;
+
+		vElem.push_back(pMagElem);
+		vElemMin.push_back(zMin);
+		vElemMax.push_back(zMax);
+		m_vLongIntervLim.push_back(zMin);
+		m_vLongIntervLim.push_back(zMax);
+	}
+	if(vElem.empty()) return;
+
+	sort(m_vLongIntervLim.begin(), m_vLongIntervLim.end());
+	m_vLongIntervLim.erase(unique(m_vLongIntervLim.begin(), m_vLongIntervLim.end()), m_vLongIntervLim.end());
+	if(m_vLongIntervLim.size() == 1) m_vLongIntervLim.push_back(m_vLongIntervLim[0]);
+
+	int nInterv = (int)m_vLongIntervLim.size() - 1;
+	int nElem = (int)vElem.size();
+	for(int i=0; i<nInterv; i++)
+	{
+		m_vLongIntervFirstElem.push_back((int)m_vLongIntervElem.size());
+		double zSt = m_vLongIntervLim[i], zFi = m_vLongIntervLim[i + 1];
+		for(int j=0; j<nElem; j++)
+		{
+			if((vElemMin[j] <= zFi) && (vElemMax[j] >= zSt)) m_vLongIntervElem.push_back(vElem[j]);
+		}
+	}
+	m_vLongIntervFirstElem.push_back((int)m_vLongIntervElem.size());
+}
+
+//*************************************************************************
+
@@ -20,6 +20,7 @@
 #include "srmagelem.h"
 #include "gmvect.h"
 #include <vector>
+#include <new>
 
 #include "srobject.h"
 #include "srtrjdat.h"
@@ -379,6 +380,12 @@ public:
 		x0Gam *= lu_d_TwoPi; z0Gam *= lu_d_TwoPi;
 	}
 
+	void GetLongLimOfFieldSupport(double& zMin, double& zMax) //virtual
+	{//consistent with compB
+		double HalfTotLenWithTerm = 0.5*TotLength + 4*PerLength;
+		zMin = mCenP.z - HalfTotLenWithTerm; zMax = mCenP.z + HalfTotLenWithTerm;
+	}
+
 	void compB(TVector3d& inP, TVector3d& outB) //virtual
 	{//this adds field to any previous value already in outB (as in Radia)
 	 //"3/4 - 1/4" terminations are assumed
@@ -498,6 +505,7 @@ class srTMagFld3d : public srTMagElem {
 	int m_nx_mi_2, m_ny_mi_2, m_nz_mi_2;
 
 	map<pair<int, int>, CGenMathInterp*> mAuxSplineDataB;
+	double *mAuxSplineTabB; //for mInterp == 4: values and 2nd derivatives of Bx, By, Bz vs z, precomputed for all (ix, iy): [((ix + iy*nx)*nz + iz)*6 + (0..5)]
 
 public:
 
@@ -506,6 +514,8 @@ public:
 	{
 		SetupGrid(_xStart, _xStep, _nx, _yStart, _yStep, _ny, _zStart, _zStep, _nz, _pBx, _pBy, _pBz, _nRep, _arraysShouldBeAllocated);
 		mInterp = _interp;
+		mAuxSplineTabB = 0;
+		SetupAuxSplineTab();
 	}
 	//srTMagFld3d(double _xStart, double _xStep, int _nx, double _yStart, double _yStep, int _ny, double _zStart, double _zStep, int _nz, double* _pBx, double* _pBy, double* _pBz, int _nRep, char _arraysShouldBeAllocated, const TVector3d& inCenP) : srTMagElem(inCenP)
 	//srTMagFld3d(double _xRange, int _nx, double _yRange, int _ny, double _zRange, int _nz, double* _pBx, double* _pBy, double* _pBz, int _nRep, char _arraysShouldBeAllocated, const TVector3d& inCenP) : srTMagElem(inCenP)
@@ -514,6 +524,8 @@ public:
 	{
 		SetupGridFromRange(_xRange, _nx, _yRange, _ny, _zRange, _nz, _pX, _pY, _pZ, _pBx, _pBy, _pBz, _nRep, _arraysShouldBeAllocated, inCenP);
 		mInterp = _interp;
+		mAuxSplineTabB = 0;
+		SetupAuxSplineTab();
 	}
 
 	srTMagFld3d()
@@ -523,6 +535,7 @@ public:
 		nx = ny = nz = 0;
 		m_nx_mi_2 = m_ny_mi_2 = m_nz_mi_2 = 0;
 		mInterp = 1;
+		mAuxSplineTabB = 0;
 
 		xStart = xStep = yStart = yStep = zStart = zStep = 0;
 		ArraysWereAllocated = 0;
@@ -614,6 +627,15 @@ public:
 	srTGenTrjDat* CreateAndSetupNewTrjDat(srTEbmDat*); //virtual
     //void SetupTrjDat(srTTrjDat3d*);
 	
+	void GetLongLimOfFieldSupport(double& zMin, double& zMax) //virtual
+	{//consistent with compB
+		zMin = -1.e+23; zMax = 1.e+23;
+		if(zStart >= zEnd) return;
+		double halfExtraLen = 0.;
+		if(nRep > 1) halfExtraLen = 0.5*(zEnd - zStart)*(nRep - 1);
+		zMin = mCenP.z + zStart - halfExtraLen; zMax = mCenP.z + zEnd + halfExtraLen;
+	}
+
 	void compB(TVector3d& inP, TVector3d& outB) //virtual
 	{//this adds field to any previous value already in outB (as in Radia)
 		const double smallRelConst = 1.e-12;
@@ -1011,60 +1033,78 @@ public:
 			};
 
 			double arCellBx[12], arCellBy[12], arCellBz[12];
-			map<pair<int, int>, CGenMathInterp*>::const_iterator it;
-			for(int i=0; i<12; i++)
+			if(mAuxSplineTabB != 0)
+			{//precomputed tables: read-only, no allocation or search here
+				double az = 1. - zt, bz = zt;
+				double ca = az*az*az - az, cb = bz*bz*bz - bz;
+				double hE2 = (zArr == 0)? zStep*zStep : zStepLocVar*zStepLocVar;
+				long perCol = 6*nz, ofstZ = 6*iz0;
+				for(int i=0; i<12; i++)
+				{
+					pair<int,int> *pCurPairInd = arPairInd + i;
+					const double *p = mAuxSplineTabB + (pCurPairInd->first + (pCurPairInd->second)*perY)*perCol + ofstZ;
+					arCellBx[i] = az*p[0] + bz*p[6] + (ca*p[3] + cb*p[9])*hE2/6.0;
+					arCellBy[i] = az*p[1] + bz*p[7] + (ca*p[4] + cb*p[10])*hE2/6.0;
+					arCellBz[i] = az*p[2] + bz*p[8] + (ca*p[5] + cb*p[11])*hE2/6.0;
+				}
+			}
+			else
 			{
-				pair<int,int> *pCurPairInd = arPairInd + i;
-				//long ofst = pCurPairInd->first + (pCurPairInd->second)*perY + izm1*perZ;
-				long ofst0 = pCurPairInd->first + (pCurPairInd->second)*perY;
-
-				CGenMathInterp *curSplineDataB = 0;
-				it = mAuxSplineDataB.find(*pCurPairInd);
-				if(it == mAuxSplineDataB.end())
+				map<pair<int, int>, CGenMathInterp*>::const_iterator it;
+				for(int i=0; i<12; i++)
 				{
-					curSplineDataB = new CGenMathInterp[3];
-					if(BxArr != 0)
+					pair<int,int> *pCurPairInd = arPairInd + i;
+					//long ofst = pCurPairInd->first + (pCurPairInd->second)*perY + izm1*perZ;
+					long ofst0 = pCurPairInd->first + (pCurPairInd->second)*perY;
+
+					CGenMathInterp *curSplineDataB = 0;
+					it = mAuxSplineDataB.find(*pCurPairInd);
+					if(it == mAuxSplineDataB.end())
 					{
-						if(arAuxBx_vs_Z == 0) arAuxBx_vs_Z = new double[nz];
-						double *tBx = arAuxBx_vs_Z, *tBxOrig = BxArr + ofst0;
-						for(int iz=0; iz<nz; iz++) { *(tBx++) = *tBxOrig; tBxOrig += perZ;}
+						curSplineDataB = new CGenMathInterp[3];
+						if(BxArr != 0)
+						{
+							if(arAuxBx_vs_Z == 0) arAuxBx_vs_Z = new double[nz];
+							double *tBx = arAuxBx_vs_Z, *tBxOrig = BxArr + ofst0;
+							for(int iz=0; iz<nz; iz++) { *(tBx++) = *tBxOrig; tBxOrig += perZ;}
+
+							if(zArr == 0) curSplineDataB->InitCubicSplineU(zStart, zStep, arAuxBx_vs_Z, nz);
+							else curSplineDataB->InitCubicSpline(zArr, arAuxBx_vs_Z, nz);
+						}
+						if(ByArr != 0)
+						{
+							if(arAuxBy_vs_Z == 0) arAuxBy_vs_Z = new double[nz];
+							double *tBy = arAuxBy_vs_Z, *tByOrig = ByArr + ofst0;
+							for(int iz=0; iz<nz; iz++) { *(tBy++) = *tByOrig; tByOrig += perZ;}
 
-						if(zArr == 0) curSplineDataB->InitCubicSplineU(zStart, zStep, arAuxBx_vs_Z, nz);
-						else curSplineDataB->InitCubicSpline(zArr, arAuxBx_vs_Z, nz);
+							if(zArr == 0) (curSplineDataB + 1)->InitCubicSplineU(zStart, zStep, arAuxBy_vs_Z, nz);
+							else (curSplineDataB + 1)->InitCubicSpline(zArr, arAuxBy_vs_Z, nz);
+						}
+						if(BzArr != 0)
+						{
+							if(arAuxBz_vs_Z == 0) arAuxBz_vs_Z = new double[nz];
+							double *tBz = arAuxBz_vs_Z, *tBzOrig = BzArr + ofst0;
+							for(int iz=0; iz<nz; iz++) { *(tBz++) = *tBzOrig; tBzOrig += perZ;}
+
+							if(zArr == 0) (curSplineDataB + 2)->InitCubicSplineU(zStart, zStep, arAuxBz_vs_Z, nz);
+							else (curSplineDataB + 2)->InitCubicSpline(zArr, arAuxBz_vs_Z, nz);
+						}
+						mAuxSplineDataB[*pCurPairInd] = curSplineDataB;
+					}
+					else curSplineDataB = it->second;
+
+					if(BxArr != 0)
+					{
+						arCellBx[i] = (zArr == 0)? curSplineDataB->InterpRelCubicSplineU(zt, iz0) : curSplineDataB->InterpRelCubicSpline(zt, iz0, zStepLocVar);
 					}
 					if(ByArr != 0)
 					{
-						if(arAuxBy_vs_Z == 0) arAuxBy_vs_Z = new double[nz];
-						double *tBy = arAuxBy_vs_Z, *tByOrig = ByArr + ofst0;
-						for(int iz=0; iz<nz; iz++) { *(tBy++) = *tByOrig; tByOrig += perZ;}
-
-						if(zArr == 0) (curSplineDataB + 1)->InitCubicSplineU(zStart, zStep, arAuxBy_vs_Z, nz);
-						else (curSplineDataB + 1)->InitCubicSpline(zArr, arAuxBy_vs_Z, nz);
+						arCellBy[i] = (zArr == 0)? (curSplineDataB + 1)->InterpRelCubicSplineU(zt, iz0) : (curSplineDataB + 1)->InterpRelCubicSpline(zt, iz0, zStepLocVar);
 					}
 					if(BzArr != 0)
 					{
-						if(arAuxBz_vs_Z == 0) arAuxBz_vs_Z = new double[nz];
-						double *tBz = arAuxBz_vs_Z, *tBzOrig = BzArr + ofst0;
-						for(int iz=0; iz<nz; iz++) { *(tBz++) = *tBzOrig; tBzOrig += perZ;}
-
-						if(zArr == 0) (curSplineDataB + 2)->InitCubicSplineU(zStart, zStep, arAuxBz_vs_Z, nz);
-						else (curSplineDataB + 2)->InitCubicSpline(zArr, arAuxBy_vs_Z, nz);
+						arCellBz[i] = (zArr == 0)? (curSplineDataB + 2)->InterpRelCubicSplineU(zt, iz0) : (curSplineDataB + 2)->InterpRelCubicSpline(zt, iz0, zStepLocVar);
 					}
-					mAuxSplineDataB[*pCurPairInd] = curSplineDataB;
-				}
-				else curSplineDataB = it->second;
-
-				if(BxArr != 0)
-				{
-					arCellBx[i] = (zArr == 0)? curSplineDataB->InterpRelCubicSplineU(zt, iz0) : curSplineDataB->InterpRelCubicSpline(zt, iz0, zStepLocVar);
-				}
-				if(ByArr != 0)
-				{
-					arCellBy[i] = (zArr == 0)? (curSplineDataB + 1)->InterpRelCubicSplineU(zt, iz0) : (curSplineDataB + 1)->InterpRelCubicSpline(zt, iz0, zStepLocVar);
-				}
-				if(BzArr != 0)
-				{
-					arCellBz[i] = (zArr == 0)? (curSplineDataB + 2)->InterpRelCubicSplineU(zt, iz0) : (curSplineDataB + 2)->InterpRelCubicSpline(zt, iz0, zStepLocVar);
 				}
 			}
 
@@ -1113,6 +1153,8 @@ public:
 			}
 			z += zStep;
 		}
+
+		if(mAuxSplineTabB != 0) SetupAuxSplineTab(); //tables of the previous field values are obsolete
 	}
 
 	//void DeallocAuxData() //virtual in srTMagElem
@@ -1178,8 +1220,54 @@ public:
 
 		ArraysWereAllocated = 0;
 	}
+	void SetupAuxSplineTab()
+	{//Precomputes spline tables vs z for all (ix, iy) at once, when the field is set up, so that compB (mInterp == 4) only reads contiguous memory and doesn't modify the object.
+	 //Memory: 6*nx*ny*nz doubles, i.e. twice the size of the field arrays. If this can't be allocated, compB falls back to the per-column splines created on demand.
+		DeleteAuxSplineTab();
+		if((mInterp != 4) || (nz < 2) || (nx <= 0) || (ny <= 0)) return;
+
+		long nCol = ((long)nx)*((long)ny);
+		long perZ = nCol;
+		mAuxSplineTabB = new(nothrow) double[6*nCol*nz];
+		double *arAuxB = new(nothrow) double[2*nz];
+		if((mAuxSplineTabB == 0) || (arAuxB == 0))
+		{
+			DeleteAuxSplineTab();
+			if(arAuxB != 0) delete[] arAuxB;
+			return;
+		}
+		double *arAuxY2 = arAuxB + nz;
+
+		double *arB[] = {BxArr, ByArr, BzArr};
+		for(long iCol=0; iCol<nCol; iCol++)
+		{
+			double *pTabCol = mAuxSplineTabB + iCol*6*nz;
+			for(int iComp=0; iComp<3; iComp++)
+			{
+				double *pB = arB[iComp], *tTab = pTabCol + iComp;
+				if(pB == 0)
+				{
+					for(int iz=0; iz<nz; iz++) { *tTab = 0.; *(tTab + 3) = 0.; tTab += 6;}
+					continue;
+				}
+				double *tB = arAuxB, *tBOrig = pB + iCol;
+				for(int iz=0; iz<nz; iz++) { *(tB++) = *tBOrig; tBOrig += perZ;}
+
+				if(zArr == 0) CGenMathInterp::InterpCubicSplinePrepU(zStart, zStep, arAuxB, nz, arAuxY2);
+				else CGenMathInterp::InterpCubicSplinePrep(zArr, arAuxB, nz, arAuxY2);
+
+				for(int iz=0; iz<nz; iz++) { *tTab = arAuxB[iz]; *(tTab + 3) = arAuxY2[iz]; tTab += 6;}
+			}
+		}
+		delete[] arAuxB;
+	}
+	void DeleteAuxSplineTab()
+	{
+		if(mAuxSplineTabB != 0) { delete[] mAuxSplineTabB; mAuxSplineTabB = 0;}
+	}
 	void DeleteAuxSplineData()
 	{
+		DeleteAuxSplineTab();
 		if(mAuxSplineDataB.empty()) return;
 
 		for(map<pair<int, int>, CGenMathInterp*>::iterator it = mAuxSplineDataB.begin(); it != mAuxSplineDataB.end(); ++it)
@@ -1279,6 +1367,13 @@ public:
 		//to implement !!!
 	}
 
+	void GetLongLimOfFieldSupport(double& zMin, double& zMax) //virtual
+	{//consistent with compB
+		double halfLenSupp = m_HalfLenModConst;
+		if(m_LenModEdge > 0) halfLenSupp += 15*m_LenModEdge;
+		zMin = mCenP.z - halfLenSupp; zMax = mCenP.z + halfLenSupp;
+	}
+
 	void compB(TVector3d& inP, TVector3d& outB) //virtual, used by SRWLIB
 	{//this adds field to any previous value already in outB (as in Radia)
 		//Z is longitudinal coord. here
@@ -1382,6 +1477,11 @@ public:
 		m_LenModEdge = InLenEdge;
 	}
 
+	void GetLongLimOfFieldSupport(double& zMin, double& zMax) //virtual
+	{
+		zMin = mCenP.z - m_HalfLenModConst; zMax = mCenP.z + m_HalfLenModConst;
+	}
+
 	void compB(TVector3d& inP, TVector3d& outB) //virtual, used by SRWLIB
 	{//this adds field to any previous value already in outB (as in Radia)
 		//Z is longitudinal coord. here
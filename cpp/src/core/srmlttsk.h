@@ -25,6 +25,7 @@
 //#endif
 
 #include <time.h>
+#include "srprgind.h"
 
 //*************************************************************************
 
@@ -47,6 +48,7 @@ public:
 
 inline int srTYield::Check() 
 {
+	if(CompJobCancelIsRequested()) return SR_COMP_PROC_ABORTED;
 	if(delta <= 0) return 0;
 	if((clock() > oldtime) && gCallSpinProcess) 
 	{
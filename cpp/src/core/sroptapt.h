@@ -28,6 +28,12 @@ class srTAperture : public srTShapedOptElem {
 public:
 	srTAperture () {}
 
+	void UpdateMirrorSym(srTSRWRadStructAccessData* pRadAccessData)
+	{//rectangular and circular apertures / obstacles keep the symmetry if centered
+		if(TransvCenPoint.x != 0.) pRadAccessData->MirrorSymX = 0;
+		if(TransvCenPoint.y != 0.) pRadAccessData->MirrorSymZ = 0;
+	}
+
 	//int PropagateRadiation(srTSRWRadStructAccessData* pRadAccessData, int MethNo, srTRadResizeVect& ResBeforeAndAfterVect)
 	int PropagateRadiation(srTSRWRadStructAccessData* pRadAccessData, srTParPrecWfrPropag& ParPrecWfrPropag, srTRadResizeVect& ResBeforeAndAfterVect)
 	{
@@ -12,6 +12,7 @@
  ***************************************************************************/
 
 #include "sroptcnt.h"
+#include "srprgind.h"
 #include "sroptdrf.h"
 #include "sroptapt.h"
 #include "sroptfoc.h"
@@ -252,6 +253,14 @@ int srTCompositeOptElem::PropagateRadiationGuided(srTSRWRadStructAccessData& wfr
 	int numResizeInst = (int)GenOptElemPropResizeVect.size();
 	const double tolRes = 1.e-04;
 	int res = 0, elemCount = 0;
+
+	//Mirror symmetry of the field vs x = 0 and/or z = 0 is kept by some elements; while it holds, only a half of the FFTs is done at changing representation
+	wfr.FindMirrorSym();
+
+	srTCompProgressIndicator CompProgressInd;
+	char showProgressInd = ((gpCompJob != 0) && (numElem > 1))? 1 : 0; //progress (number of elements passed) is only reported to the job run by this thread (see srwlJobStart)
+	if(showProgressInd) if(res = CompProgressInd.InitializeIndicator(numElem, 0.5)) return res;
+
 	for(srTGenOptElemHndlList::iterator it = GenOptElemList.begin(); it != GenOptElemList.end(); ++it)
 	{
 		int methNo = 0;
@@ -287,12 +296,37 @@ int srTCompositeOptElem::PropagateRadiationGuided(srTSRWRadStructAccessData& wfr
 			vHyO = curPropResizeInst.vHyOut;
 		}
 
+		//Lazy change of representation: an element working in Ang. repres. may leave the wavefront in it, 
+		//if the next element works in Ang. repres. too and no resizing is required in between (the last element always returns to Coord. repres.)
+		wfr.PresAngMayBeKept = 0;
+		srTGenOptElemHndlList::iterator itNext = it; ++itNext;
+		bool startTrIsUsed = (wfr.AuxLong4 == 7777777) || wfr.UseStartTrToShiftAtChangingRepresToCoord;
+		if((methNo == 0) && (!startTrIsUsed) && (itNext != GenOptElemList.end()) && ((srTGenOptElem*)(it->rep))->WorksInAngRepres(analTreatment))
+		{
+			char analTreatmentNext = 0;
+			bool resizeNext = false;
+			if(elemCount + 1 < numResizeInst)
+			{
+				srTRadResize &nextPropResizeInst = GenOptElemPropResizeVect[elemCount + 1];
+				resizeNext = nextPropResizeInst.propAutoResizeBefore() || nextPropResizeInst.propAutoResizeAfter() ||
+					(::fabs(nextPropResizeInst.pxd - 1.) > tolRes) || (::fabs(nextPropResizeInst.pxm - 1.) > tolRes) ||
+					(::fabs(nextPropResizeInst.pzd - 1.) > tolRes) || (::fabs(nextPropResizeInst.pzm - 1.) > tolRes);
+				analTreatmentNext = nextPropResizeInst.propAllowUnderSamp();
+			}
+			if((!resizeNext) && ((srTGenOptElem*)(itNext->rep))->WorksInAngRepres(analTreatmentNext)) wfr.PresAngMayBeKept = 1;
+		}
+
 		srTParPrecWfrPropag precParWfrPropag(methNo, useResizeBefore, useResizeAfter, precFact, underSampThresh, analTreatment, (char)0, vLxO, vLyO, vLzO, vHxO, vHyO);
 		srTRadResizeVect auxResizeVect;
-		if(res = ((srTGenOptElem*)(it->rep))->PropagateRadiation(&wfr, precParWfrPropag, auxResizeVect)) return res;
+		((srTGenOptElem*)(it->rep))->UpdateMirrorSym(&wfr);
+		res = ((srTGenOptElem*)(it->rep))->PropagateRadiation(&wfr, precParWfrPropag, auxResizeVect);
+		wfr.PresAngMayBeKept = 0;
+		wfr.NoteFieldModif(); //in case the element modified the field directly
+		if(res) return res;
 		//maybe to use "PropagateRadiationGuided" for srTCompositeOptElem?
 
 		elemCount++;
+		if(showProgressInd) if(res = CompProgressInd.UpdateIndicator(elemCount)) return res;
 	}
 	if(elemCount < numResizeInst)
 	{//post-resize
@@ -303,6 +337,7 @@ int srTCompositeOptElem::PropagateRadiationGuided(srTSRWRadStructAccessData& wfr
 		   (::fabs(postResize.pzd - 1.) > tolRes) || (::fabs(postResize.pzm - 1.) > tolRes))
 			if(res = RadResizeGen(wfr, postResize)) return res;
 	}
+	wfr.MirrorSymX = wfr.MirrorSymZ = 0;
 	return 0;
 }
 
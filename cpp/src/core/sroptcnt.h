@@ -62,11 +62,24 @@ public:
 
 			//if(result = ((srTGenOptElem*)((*iter).rep))->PropagateRadiation(pRadAccessData, MethNo, ResizeBeforeAndAfterVect)) return result;
 			if(result = ((srTGenOptElem*)((*iter).rep))->PropagateRadiation(pRadAccessData, ParPrecWfrPropag, ResizeBeforeAndAfterVect)) return result;
+			pRadAccessData->NoteFieldModif(); //in case the element modified the field directly
 		}
 		ParPrecWfrPropag.UseResAfter = GenUseResAfter; //OC110104
 		return 0;
 	}
 
+	void UpdateMirrorSym(srTSRWRadStructAccessData* pRadAccessData)
+	{
+		for(srTGenOptElemHndlList::iterator iter = GenOptElemList.begin(); iter != GenOptElemList.end(); ++iter)
+			((srTGenOptElem*)((*iter).rep))->UpdateMirrorSym(pRadAccessData);
+	}
+
+	void SetDataIsFixed()
+	{
+		for(srTGenOptElemHndlList::iterator iter = GenOptElemList.begin(); iter != GenOptElemList.end(); ++iter)
+			((srTGenOptElem*)((*iter).rep))->SetDataIsFixed();
+	}
+
 	void AddPtrOfActualOptElem(srTGenOptElemPtrList& ActOptElemsList)
 	{
 		for(srTGenOptElemHndlList::iterator iter = GenOptElemList.begin(); iter != GenOptElemList.end(); ++iter)
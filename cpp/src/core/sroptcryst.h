@@ -17,12 +17,17 @@
 
 #include "sroptelm.h"
 #include "srwlib.h"
+#include "srmlttsk.h"
 
 #undef max //to avoid name conflict of numeric_limits<double>::max() and #define max(a, b) to allow for compilation with VC++2013
 #include <limits>
 
 //*************************************************************************
 
+extern srTYield srYield;
+
+//*************************************************************************
+
 struct srTOptCrystMeshTrf {
 	double xStart, xStep;
 	double zStart, zStep;
@@ -32,6 +37,27 @@ struct srTOptCrystMeshTrf {
 
 //*************************************************************************
 
+struct srTOptCrystEnSliceAux {//quantities required for RadPointModifier, which depend on photon energy only
+	double k0Ai, invk0AiE2;
+	double asymFact;
+	complex<double> aux_phC; //2*pi*i*k0*thickness, to be divided by gamma0
+	double sgH[3], piH[3]; //polarization vectors of the diffracted beam in the frame of the output beam
+};
+
+//*************************************************************************
+
+struct srTOptCrystReflTab {//complex reflection coefficients tabulated on a band of rows of the angular mesh, for one photon energy
+	complex<float> *arDHsg, *arDHpi;
+	char *arStat; //0- not defined yet, 1- interpolated, 2- calculated exactly
+	long nx;
+	double xStart, xStep, zStart, zStep;
+	double RelTol, AbsTol; //tolerances of the interpolation of the coefficients
+	double MaxRelVar; //cells where the coefficients vary more than this (relative to their max. abs. value at the corners) are bisected without testing the interpolation
+	srTOptCrystEnSliceAux *pEnSlice;
+};
+
+//*************************************************************************
+
 class srTOptCryst : public srTGenOptElem {
 
 	double m_dA; /* crystal reflecting planes d-spacing (units?) */
@@ -71,6 +97,10 @@ class srTOptCryst : public srTGenOptElem {
 
 	srTOptCrystMeshTrf *m_pMeshTrf;
 	double m_eStartAux, m_eStepAux, m_ne;
+	double m_PrecFactTab; //precision factor of the tabulation of reflection coefficients (from the propagation parameters)
+
+	double m_logDBMax; //threshold for the exponents in the reflection coefficients
+	double m_invdAE2; //1/d^2
 
 public:
 
@@ -100,6 +130,11 @@ public:
 		// Input #7: Whether to calculate the transmitted beam as well as the diffracted 
 		// beam. itrans = 0 for NO, itrans = 1 for YES. 
 		m_itrans = 0; //OC: make it input variable
+		m_PrecFactTab = 1.;
+
+		const double DBMaxFact = 0.1; //to tune
+		m_logDBMax = log(DBMaxFact*(numeric_limits<double>::max()));
+		m_invdAE2 = 1./(m_dA*m_dA);
 
 		// From Input #5: reciprocal lattice vector coordinates 
 		m_HXAi[0] = 0.;
@@ -489,6 +524,7 @@ public:
 	int PropagateRadiation(srTSRWRadStructAccessData* pRadAccessData, srTParPrecWfrPropag& ParPrecWfrPropag, srTRadResizeVect& ResBeforeAndAfterVect) //virtual in srTGenOptElem
 	{
 		m_eStartAux = pRadAccessData->eStart; m_eStepAux = pRadAccessData->eStep; m_ne = pRadAccessData->ne; //required for RadPointModifier
+		m_PrecFactTab = (ParPrecWfrPropag.PrecFact > 0.)? ParPrecWfrPropag.PrecFact : 1.;
 
 		if((ParPrecWfrPropag.vLxOut != 0) || (ParPrecWfrPropag.vLyOut != 0) || (ParPrecWfrPropag.vLzOut != 0)) 
 		{//Process the case when the based vectors of the output beam frame are defined "manually"
@@ -513,6 +549,8 @@ public:
 		return PropagateRadiationSingleE_Meth_0(pRadAccessData, 0);
 	}
 
+	int WorksInAngRepres(char /*AnalTreatment*/) { return 1;} //virtual in srTGenOptElem
+
 	//int PropagateRadiationMeth_0(srTSRWRadStructAccessData* pRadAccessData) //virtual in srTGenOptElem
 	//{//because for Crystal (the same way as for the Drift) the following works for many photon energies too!
 	//	return PropagateRadiationSingleE_Meth_0(pRadAccessData, 0);
@@ -549,6 +587,7 @@ public:
 		{//Switch to Angular representation
 			if(result = SetRadRepres(pRadAccessData, 1)) return result;
 		}
+		else if(result = TreatCoordStartPendInAngRepres(pRadAccessData)) return result; //wavefront left in Ang. repres. by previous element
 
 		srTOptCrystMeshTrf meshTrf;
 		m_pMeshTrf = &meshTrf;
@@ -560,7 +599,7 @@ public:
 		}
 		if(result = FindAngMeshTrf(pRadAccessData, m_pMeshTrf)) return result;
 
-		if(result = TraverseRadZXE(pRadAccessData)) return result;
+		if(result = ApplyReflCoefsOnAngMesh(pRadAccessData)) return result;
 
 		//if(pRadAccessData->UseStartTrToShiftAtChangingRepresToCoord)
 		//{
@@ -570,8 +609,11 @@ public:
 
 		if(result = CorrectAngMesh(pRadAccessData, m_pMeshTrf)) return result;
 
-		//Switch to Coordinate representation -- make optional?
-		if(result = SetRadRepres(pRadAccessData, 0)) return result;
+		//Switch to Coordinate representation, unless the next element works in Angular one too
+		if(!pRadAccessData->PresAngMayBeKept)
+		{
+			if(result = SetRadRepres(pRadAccessData, 0)) return result;
+		}
 
 		//pRadAccessData->xStart = xStartOld; pRadAccessData->zStart = zStartOld;
 		//if(pRadAccessData->UseStartTrToShiftAtChangingRepresToCoord)
@@ -586,216 +628,282 @@ public:
 		return 0;
 	}
 
-	void RadPointModifier(srTEXZ& EXZ, srTEFieldPtrs& EPtrs)
-	//void RadPointModifier_AngRepres(srTEXZ& EXZ, srTEFieldPtrs& EPtrs)
-	{// E in eV; Length in m !!!
-		// Operates on Angles side !!!
-		// EXZ.x = angX_rad/wavelength_m, EXZ.z = angY_rad/wavelength_m
-
-		int ie = 0;
-		if(m_ne > 1) ie = int((EXZ.e - m_eStartAux)/m_eStepAux + 1e-06) + 1;
-		srTOptCrystMeshTrf &meshTrf = m_pMeshTrf[ie];
-		double &a11 = (meshTrf.matrKLabRef)[0][0], &a12 = (meshTrf.matrKLabRef)[0][1];
-		double &a21 = (meshTrf.matrKLabRef)[1][0], &a22 = (meshTrf.matrKLabRef)[1][1];
-		double asymFact = ::fabs(a11*a22 - a12*a21);
-		if(asymFact > 0) asymFact = 1./asymFact;
-		else asymFact = 1.;
-
-		// Conversion factor: wavelength [A] <-> energy [eV] ?
-		const double eAconv = 12398.4193009;
-		const double pi = 4.*atan(1.);
-		const complex<double> iC(0., 1.);
-
-		const double DBMaxFact = 0.1; //to tune
-		const double logDBMax = log(DBMaxFact*(numeric_limits<double>::max()));
-
-		double alamA = eAconv/EXZ.e; //alamA = eAconv / EceV; //OC: wavelength in [A]?
-		double k0Ai = 1./alamA;
-
-		// Wave vector components: hard-coded for this test only! 
-		//kxAi = 0.0; 
-		//kyAi = (-50.e-6 + 100.e-6*(double)(ik)/(double)(nk-1))/alamA; 
+	int ApplyReflCoefsOnAngMesh(srTSRWRadStructAccessData* pRadAccessData)
+	{//Does the same as TraverseRadZXE with RadPointModifier, but for each photon energy the reflection coefficients are first tabulated on the angular mesh
+	 //by calculating them exactly only at the nodes of a coarse sub-mesh and at the points where the bilinear interpolation fails to reproduce them within tolerance.
+	 //The step of the coarse sub-mesh is chosen from the estimated Darwin width (see FindStepCoarseReflTab), so that the curve can't pass between the test points unnoticed.
+	 //The mesh is processed in bands of rows, to keep the auxiliary memory small.
+	 //The tolerances are divided by the precision factor of the propagation parameters (m_PrecFactTab, 1 by default).
+		const long nStepCoarseMax = 8; //to steer: max. step (in points of the wavefront mesh) of the coarse sub-mesh, at which the coefficients are always calculated exactly
+		const double RelTolTab = 1.E-04, AbsTolTab = 1.E-06; //to steer: tolerances of the interpolation of the coefficients (at precision factor 1)
+		const double MaxRelVarTab = 0.1; //to steer: max. relative variation of the coefficients between the corners of a cell, above which the interpolation is not tried
+
+		long nx = pRadAccessData->nx, nz = pRadAccessData->nz, ne = pRadAccessData->ne;
+		if((nx <= 0) || (nz <= 0) || (ne <= 0)) return 0;
+		pRadAccessData->NoteFieldModif();
+		float *pEx0 = pRadAccessData->pBaseRadX, *pEz0 = pRadAccessData->pBaseRadZ;
+		if((pEx0 == 0) || (pEz0 == 0)) return CRYSTAL_REQUIRES_BOTH_POLARIZ; //the crystal mixes the polarization components, so both have to be stored
+
+		long nStepCoarse = FindStepCoarseReflTab(pRadAccessData, nStepCoarseMax);
+		long nzBand = nStepCoarse + 1;
+		if(nzBand > nz) nzBand = nz;
+		long nTab = nx*nzBand;
+		srTOptCrystReflTab tab;
+		tab.arDHsg = new complex<float>[nTab];
+		tab.arDHpi = new complex<float>[nTab];
+		tab.arStat = new char[nTab];
+		if((tab.arDHsg == 0) || (tab.arDHpi == 0) || (tab.arStat == 0))
+		{
+			if(tab.arDHsg != 0) delete[] tab.arDHsg;
+			if(tab.arDHpi != 0) delete[] tab.arDHpi;
+			if(tab.arStat != 0) delete[] tab.arStat;
+			return MEMORY_ALLOCATION_FAILURE;
+		}
+		tab.nx = nx;
+		tab.xStart = pRadAccessData->xStart; tab.xStep = pRadAccessData->xStep;
+		tab.zStep = pRadAccessData->zStep;
+		tab.RelTol = RelTolTab/m_PrecFactTab; tab.AbsTol = AbsTolTab/m_PrecFactTab;
+		tab.MaxRelVar = MaxRelVarTab;
+
+		srTOptCrystEnSliceAux enSlice;
+		tab.pEnSlice = &enSlice;
+
+		long PerX = ne << 1;
+		long PerZ = PerX*nx;
+		srTEFieldPtrs EPtrs;
+		int result = 0;
+		for(long ie=0; ie<ne; ie++)
+		{
+			double ePh = pRadAccessData->eStart + ie*pRadAccessData->eStep;
+			SetupEnSliceAux(ePh, m_pMeshTrf[(ne > 1)? (ie + 1) : 0], enSlice);
 
-		double angXrad = EXZ.x*alamA*1.e-10, angYrad = EXZ.z*alamA*1.e-10;
-		//double kxAi = angXrad/alamA, kyAi = angYrad/alamA;
-		double kxAi = EXZ.x*1.e-10; //OC: ??
-		double kyAi = EXZ.z*1.e-10;
+			char *tStat = tab.arStat;
+			for(long i=0; i<nx; i++) *(tStat++) = 0;
 
-		// Electric field amplitudes in k-space: hard-coded for this test only! 
-		//Eox = complex<double>(1.,0.); 
-		//Eoy = complex<double>(1.,0.); 
-		complex<double> Eox = complex<double>(*(EPtrs.pExRe), *(EPtrs.pExIm));
-		complex<double> Eoy = complex<double>(*(EPtrs.pEzRe), *(EPtrs.pEzIm));
+			long iz0 = 0;
+			for(;;)
+			{
+				if(result = srYield.Check()) break;
 
-		// k0wvAi = incident beam wave vector (kx,ky,kz). 
-		double kzAi = sqrt(k0Ai*k0Ai - kxAi*kxAi - kyAi*kyAi); //OC: possible loss of precision?
+				long iz1 = iz0 + nStepCoarse;
+				if(iz1 > nz - 1) iz1 = nz - 1;
+				long izLocMax = iz1 - iz0;
+				tab.zStart = pRadAccessData->zStart + iz0*pRadAccessData->zStep;
 
-		//k0wAi[0] = kxAi; 
-		//k0wAi[1] = kyAi; 
-		//k0wAi[2] = kzAi; 
-		double k0wAi[] = { kxAi, kyAi, kzAi };
+				tStat = tab.arStat + nx;
+				for(long i=nx; i<(izLocMax + 1)*nx; i++) *(tStat++) = 0;
 
-		//printf("Incident wave vector components in Lab frame: \n"); 
-		//printf("%e %e %e\n",k0wAi[0],k0wAi[1],k0wAi[2]); 
-		//u0[0] = kxAi/k0Ai; 
-		//u0[1] = kyAi/k0Ai; 
-		//u0[2] = kzAi/k0Ai;
-		double u0[] = { kxAi / k0Ai, kyAi / k0Ai, kzAi / k0Ai };
+				long ix0 = 0;
+				for(;;)
+				{
+					long ix1 = ix0 + nStepCoarse;
+					if(ix1 > nx - 1) ix1 = nx - 1;
+					FindReflCoefsAtTabPoint(tab, ix0, 0); FindReflCoefsAtTabPoint(tab, ix1, 0);
+					FindReflCoefsAtTabPoint(tab, ix0, izLocMax); FindReflCoefsAtTabPoint(tab, ix1, izLocMax);
+					TabulateReflCoefsInCell(tab, ix0, ix1, 0, izLocMax);
+					if(ix1 >= nx - 1) break;
+					ix0 = ix1;
+				}
 
-		// Conversion of wave vector components to crystal frame: 
-		//k0wXAi[0] = RLabXt[0][0]*k0wAi[0] + RLabXt[0][1]*k0wAi[1] + RLabXt[0][2]*k0wAi[2]; 
-		//k0wXAi[1] = RLabXt[1][0]*k0wAi[0] + RLabXt[1][1]*k0wAi[1] + RLabXt[1][2]*k0wAi[2]; 
-		//k0wXAi[2] = RLabXt[2][0]*k0wAi[0] + RLabXt[2][1]*k0wAi[1] + RLabXt[2][2]*k0wAi[2]; 
-		double k0wXAi[] = {
-			m_RLabXt[0][0] * k0wAi[0] + m_RLabXt[0][1] * k0wAi[1] + m_RLabXt[0][2] * k0wAi[2],
-			m_RLabXt[1][0] * k0wAi[0] + m_RLabXt[1][1] * k0wAi[1] + m_RLabXt[1][2] * k0wAi[2],
-			m_RLabXt[2][0] * k0wAi[0] + m_RLabXt[2][1] * k0wAi[1] + m_RLabXt[2][2] * k0wAi[2]
-		};
+				//the last row of the band is applied together with the next band, where it may still be refined
+				long izLocFi = (iz1 >= nz - 1)? izLocMax : (izLocMax - 1);
+				for(long izLoc=0; izLoc<=izLocFi; izLoc++)
+				{
+					long ofst = (iz0 + izLoc)*PerZ + (ie << 1);
+					complex<float> *tDHsg = tab.arDHsg + izLoc*nx, *tDHpi = tab.arDHpi + izLoc*nx;
+					for(long ix=0; ix<nx; ix++)
+					{
+						EPtrs.pExRe = pEx0 + ofst; EPtrs.pExIm = EPtrs.pExRe + 1;
+						EPtrs.pEzRe = pEz0 + ofst; EPtrs.pEzIm = EPtrs.pEzRe + 1;
+						ApplyReflCoefs(enSlice, complex<double>(*(tDHsg++)), complex<double>(*(tDHpi++)), EPtrs);
+						ofst += PerX;
+					}
+				}
+				if(iz1 >= nz - 1) break;
 
-		//printf("Incident wave vector components in Crystal frame: \n"); 
-		//printf("%e %e %e\n",k0wXAi[0],k0wXAi[1],k0wXAi[2]); 
-		//u0X[0] = k0wXAi[0]/k0Ai; 
-		//u0X[1] = k0wXAi[1]/k0Ai; 
-		//u0X[2] = k0wXAi[2]/k0Ai; 
-		double u0X[] = { k0wXAi[0] / k0Ai, k0wXAi[1] / k0Ai, k0wXAi[2] / k0Ai };
+				long ofstLast = izLocMax*nx;
+				for(long ix=0; ix<nx; ix++)
+				{
+					tab.arDHsg[ix] = tab.arDHsg[ofstLast + ix];
+					tab.arDHpi[ix] = tab.arDHpi[ofstLast + ix];
+					tab.arStat[ix] = tab.arStat[ofstLast + ix];
+				}
+				iz0 = iz1;
+			}
+			if(result) break;
+		}
 
-		// Convert components of incident beam polarization from (e1X,e2X) to (sg0X,pi0X): 
-		//EInSPs = PolTrn[0][0]*Eox + PolTrn[0][1]*Eoy; 
-		//EInSPp = PolTrn[1][0]*Eox + PolTrn[1][1]*Eoy; 
-		complex<double> EInSPs = m_PolTrn[0][0] * Eox + m_PolTrn[0][1] * Eoy;
-		complex<double> EInSPp = m_PolTrn[1][0] * Eox + m_PolTrn[1][1] * Eoy;
+		delete[] tab.arDHsg;
+		delete[] tab.arDHpi;
+		delete[] tab.arStat;
+		return result;
+	}
 
-		// Calculate the wave vector for the diffracted beam. Note that here the index of 
-		// refraction corrections are included. 
-		//kHtXAi[0] = k0wXAi[0] + HXAi[0]; 
-		//kHtXAi[1] = 0.; 
-		//kHtXAi[2] = k0wXAi[2] + HXAi[2]; 
-		double kHtXAi[] = { k0wXAi[0] + m_HXAi[0], 0., k0wXAi[2] + m_HXAi[2] };
-		double kHt2 = kHtXAi[0] * kHtXAi[0] + kHtXAi[2] * kHtXAi[2];
+	long FindStepCoarseReflTab(srTSRWRadStructAccessData* pRadAccessData, long nStepCoarseMax)
+	{//Step of the coarse sub-mesh of ApplyReflCoefsOnAngMesh: the coefficients are tested every half step (corners, middles of the edges and centers of the cells),
+	 //so the step should not exceed the estimated Darwin width expressed in points of the angular mesh; if the mesh is too coarse to resolve the curve, 1 is returned, i.e. all points are calculated exactly.
+	 //The estimate is that of the two-beam dynamical theory: 2*|C|*sqrt(|psiH*psiHb|)/(sin(2*thB)*sqrt(|b|)), with |C| = |cos(2*thB)| (pi-polarization, narrower),
+	 //and the asymmetry factor |b| or 1/|b|, whichever reduces the width.
+		const double eAconv = 12398.4193009;
 
-		//kmHXAi[0] = kHtXAi[0]; 
-		//kmHXAi[1] = sqrt(k0Ai*k0Ai-kHt2); 
-		//kmHXAi[2] = kHtXAi[2]; 
-		double kmHXAi[] = { kHtXAi[0], sqrt(k0Ai*k0Ai - kHt2), kHtXAi[2] }; //OC: can it happen (k0Ai*k0Ai - kHt2) < 0?
+		double absPsiH = sqrt(abs(m_psihc*m_psimhc));
+		if(absPsiH <= 0.) return nStepCoarseMax;
+		double sin2t = sqrt(::fabs(1. - m_cos2t*m_cos2t));
+		if(sin2t < sqrt(absPsiH)) sin2t = sqrt(absPsiH); //close to back-scattering, where the Darwin width is ~2*sqrt(|psiH|)
+		double angDarw = 2.*absPsiH*(::fabs(m_cos2t))/sin2t;
+
+		double thB = 0.5*acos(m_cos2t), alph = atan2(-m_HXAi[2], m_HXAi[1]);
+		double sinIn = ::fabs(sin(thB + alph)), sinOut = ::fabs(sin(thB - alph));
+		if((sinIn <= 0.) || (sinOut <= 0.)) return 1;
+		double absB = sinIn/sinOut;
+		if(absB > 1.) absB = 1./absB;
+		angDarw *= sqrt(absB);
+
+		//max. angular step of the mesh, at the lowest photon energy (i.e. at the longest wavelength)
+		double eMin = pRadAccessData->eStart, eMax = pRadAccessData->eStart + (pRadAccessData->ne - 1)*pRadAccessData->eStep;
+		if(eMin > eMax) eMin = eMax;
+		if(eMin <= 0.) return 1;
+		double absStepX = ::fabs(pRadAccessData->xStep), absStepZ = ::fabs(pRadAccessData->zStep);
+		double angStep = ((absStepX > absStepZ)? absStepX : absStepZ)*eAconv*1.e-10/eMin; //the angular mesh is in [1/m], i.e. in units of angle/wavelength
+		if(angStep <= 0.) return nStepCoarseMax;
+
+		double nPtDarw = angDarw/angStep;
+		if(nPtDarw < 2.) return 1;
+		if(nPtDarw >= (double)nStepCoarseMax) return nStepCoarseMax;
+		return (long)nPtDarw;
+	}
 
-		// Calculate direction cosine gamma0, reflection asymmetry parameter bee, 
-		// deviation parameter Adev and normalized deviation parameter zeeC (as 
-		// defined by Zachariasen gamma0, b, alpha and z.) 
-		double gamma0 = -u0X[1];
-		double bee = 1. / (1. + m_HXAi[1] / k0wXAi[1]);
-		double dotkH = k0wXAi[0] * m_HXAi[0] + k0wXAi[1] * m_HXAi[1] + k0wXAi[2] * m_HXAi[2];
-		double Adev = (2.*dotkH + 1. / (m_dA*m_dA)) / (k0Ai*k0Ai);
-		complex<double> zeeC = 0.5*((1. - bee)*m_psi0c + bee*Adev);
+	void FindReflCoefsAtTabPoint(srTOptCrystReflTab& tab, long ix, long izLoc)
+	{
+		long ofst = izLoc*tab.nx + ix;
+		if(tab.arStat[ofst] == 2) return;
+		complex<double> DHsgC, DHpiC;
+		FindReflCoefs(*(tab.pEnSlice), (tab.xStart + ix*tab.xStep)*1.e-10, (tab.zStart + izLoc*tab.zStep)*1.e-10, DHsgC, DHpiC);
+		tab.arDHsg[ofst] = complex<float>(DHsgC);
+		tab.arDHpi[ofst] = complex<float>(DHpiC);
+		tab.arStat[ofst] = 2;
+	}
 
-		// Calculate the complex reflectivity DHsgC for sigma polarization: 
-		complex<double> queC = bee*m_psihc*m_psimhc;
-		complex<double> sqrqzC = sqrt(queC + zeeC*zeeC);
-		complex<double> del1C = 0.5*(m_psi0c - zeeC + sqrqzC);
-		complex<double> del2C = 0.5*(m_psi0c - zeeC - sqrqzC);
-		complex<double> x1C = (-zeeC + sqrqzC) / m_psimhc;
-		complex<double> x2C = (-zeeC - sqrqzC) / m_psimhc;
-		//complex<double> ph1C = 2.*pi*iC*k0Ai*del1C*(m_thicum*1.E+04)/gamma0;
-		//complex<double> ph2C = 2.*pi*iC*k0Ai*del2C*(m_thicum*1.E+04)/gamma0;
-		complex<double> aux_phC = 2.*pi*iC*k0Ai*(m_thicum*1.E+04) / gamma0;
-		complex<double> ph1C = aux_phC*del1C;
-		complex<double> ph2C = aux_phC*del2C;
+	void InterpolReflCoefsInCell(srTOptCrystReflTab& tab, long ix0, long ix1, long iz0, long iz1, long ix, long iz, complex<double>& DHsgC, complex<double>& DHpiC)
+	{//bilinear interpolation from the corners of the cell
+		double tx = (ix1 > ix0)? double(ix - ix0)/double(ix1 - ix0) : 0.;
+		double tz = (iz1 > iz0)? double(iz - iz0)/double(iz1 - iz0) : 0.;
+		double w00 = (1. - tx)*(1. - tz), w10 = tx*(1. - tz), w01 = (1. - tx)*tz, w11 = tx*tz;
+		long o00 = iz0*tab.nx + ix0, o10 = iz0*tab.nx + ix1, o01 = iz1*tab.nx + ix0, o11 = iz1*tab.nx + ix1;
+		DHsgC = w00*complex<double>(tab.arDHsg[o00]) + w10*complex<double>(tab.arDHsg[o10]) + w01*complex<double>(tab.arDHsg[o01]) + w11*complex<double>(tab.arDHsg[o11]);
+		DHpiC = w00*complex<double>(tab.arDHpi[o00]) + w10*complex<double>(tab.arDHpi[o10]) + w01*complex<double>(tab.arDHpi[o01]) + w11*complex<double>(tab.arDHpi[o11]);
+	}
 
-		complex<double> DHsgC, Cph1C, Cph2C, D0trsC;
-		if(real(ph1C) > logDBMax) DHsgC = x2C;
-		else if(real(ph2C) > logDBMax) DHsgC = x1C;
-		else
+	void TabulateReflCoefsInCell(srTOptCrystReflTab& tab, long ix0, long ix1, long iz0, long iz1)
+	{//Assumes the coefficients at the corners of the cell to be calculated exactly.
+	 //The coefficients at the center and in the middles of the edges are calculated exactly and compared with the bilinear interpolation from the corners;
+	 //if the interpolation is within tolerance, it is used for the rest of the cell, otherwise the cell is bisected and the procedure is repeated for the new cells.
+		long dx = ix1 - ix0, dz = iz1 - iz0;
+		if((dx <= 1) && (dz <= 1)) return;
+		long ixm = (ix0 + ix1) >> 1, izm = (iz0 + iz1) >> 1;
+
+		//test points: middles of the edges parallel to x (0, 1), middles of the edges parallel to z (2, 3) and center (4)
+		long arTestX[] = { ixm, ixm, ix0, ix1, ixm };
+		long arTestZ[] = { iz0, iz1, izm, izm, izm };
+		bool arTestIsReq[] = { (dx > 1), (dx > 1) && (dz > 0), (dz > 1), (dz > 1) && (dx > 0), (dx > 1) && (dz > 1) };
+
+		bool interpolFailsX = false, interpolFailsZ = false;
+		complex<double> DHsgC, DHpiC;
+
+		//too large variation between the corners: the coefficients (e.g. close to the edges of the Darwin curve) are not trusted to be reproduced by the interpolation, even if it is accurate at the test points
+		long o00 = iz0*tab.nx + ix0, o10 = iz0*tab.nx + ix1, o01 = iz1*tab.nx + ix0, o11 = iz1*tab.nx + ix1;
+		complex<float> *arTabC[] = { tab.arDHsg, tab.arDHpi };
+		for(int j=0; j<2; j++)
 		{
-			Cph1C = exp(ph1C);
-			Cph2C = exp(ph2C);
-			DHsgC = x1C*x2C*(Cph2C - Cph1C)/(Cph2C*x2C - Cph1C*x1C);
+			complex<float> *c = arTabC[j];
+			double maxAbsC = abs(c[o00]);
+			if(maxAbsC < abs(c[o10])) maxAbsC = abs(c[o10]);
+			if(maxAbsC < abs(c[o01])) maxAbsC = abs(c[o01]);
+			if(maxAbsC < abs(c[o11])) maxAbsC = abs(c[o11]);
+			double maxVar = tab.MaxRelVar*maxAbsC + tab.AbsTol;
+			if((abs(c[o10] - c[o00]) > maxVar) || (abs(c[o11] - c[o01]) > maxVar)) interpolFailsX = true;
+			if((abs(c[o01] - c[o00]) > maxVar) || (abs(c[o11] - c[o10]) > maxVar)) interpolFailsZ = true;
 		}
+		if(dx <= 1) interpolFailsX = false;
+		if(dz <= 1) interpolFailsZ = false;
 
-		//double re_ph1C = real(ph1C), re_ph2C = real(ph2C);
-		//if(re_ph1C > logDBMax) DHsgC = x2C;
-		//else if(re_ph2C > logDBMax) DHsgC = x1C;
-		//else
-		//{
-		//	if(re_ph1C < -logDBMax) 
-		//	{
-		//		Cph1C = complex<double>(0, 0);
-		//	}
-		//	else Cph1C = exp(ph1C);
-
-		//	if(re_ph2C < -logDBMax) 
-		//	{
-		//		Cph2C = complex<double>(0, 0);
-		//	}
-		//	else Cph2C = exp(ph2C);
-
-		//	if((re_ph1C < -logDBMax) && (re_ph2C < -logDBMax)) 
-		//	{
-		//		DHsgC = complex<double>(0, 0); //?
-		//	}
-		//	else DHsgC = x1C*x2C*(Cph2C - Cph1C)/(Cph2C*x2C - Cph1C*x1C);
-		//}
-
-		if(m_itrans == 1)
+		for(int i=0; i<5; i++)
 		{
-			// calculate the complex reflectivity D0trsC of the transmitted beam. 
-			if(real(ph1C) > logDBMax)
+			if(!arTestIsReq[i]) continue;
+			long ix = arTestX[i], iz = arTestZ[i];
+			FindReflCoefsAtTabPoint(tab, ix, iz); //done in any case, since these are the corners of the cells after bisection
+			if(interpolFailsX && interpolFailsZ) continue;
+
+			InterpolReflCoefsInCell(tab, ix0, ix1, iz0, iz1, ix, iz, DHsgC, DHpiC);
+			long ofst = iz*tab.nx + ix;
+			complex<double> DHsgExC(tab.arDHsg[ofst]), DHpiExC(tab.arDHpi[ofst]);
+			if((abs(DHsgC - DHsgExC) > tab.RelTol*abs(DHsgExC) + tab.AbsTol) || (abs(DHpiC - DHpiExC) > tab.RelTol*abs(DHpiExC) + tab.AbsTol))
 			{
-				Cph2C = exp(ph2C);
-				D0trsC = -Cph2C*(x2C - x1C)/x1C;
+				if(i < 2) interpolFailsX = true;
+				else if(i < 4) interpolFailsZ = true;
+				else if(!(interpolFailsX || interpolFailsZ)) interpolFailsX = interpolFailsZ = true; //failure at center only, e.g. because of cross-term
 			}
-			else if(real(ph2C) > logDBMax)
+		}
+
+		if(!(interpolFailsX || interpolFailsZ))
+		{
+			for(long iz=iz0; iz<=iz1; iz++)
 			{
-				Cph1C = exp(ph1C);
-				D0trsC = +Cph1C*(x2C - x1C)/x2C;
+				long ofst = iz*tab.nx + ix0;
+				for(long ix=ix0; ix<=ix1; ix++)
+				{
+					if(tab.arStat[ofst] != 2)
+					{
+						InterpolReflCoefsInCell(tab, ix0, ix1, iz0, iz1, ix, iz, DHsgC, DHpiC);
+						tab.arDHsg[ofst] = complex<float>(DHsgC);
+						tab.arDHpi[ofst] = complex<float>(DHpiC);
+						tab.arStat[ofst] = 1;
+					}
+					ofst++;
+				}
 			}
-			else D0trsC = Cph1C*Cph2C*(x2C - x1C)/(Cph2C*x2C - Cph1C*x1C);
+			return;
 		}
 
-		// Calculate the complex reflectivity DHpiC for pi polarization: 
-		//cos2t = cos(2.*thBrd); //OC: moved to members m_cos2t
-		queC = bee*m_psihc*m_psimhc*m_cos2t*m_cos2t;
-		sqrqzC = sqrt(queC + zeeC*zeeC);
-		del1C = 0.5*(m_psi0c - zeeC + sqrqzC);
-		del2C = 0.5*(m_psi0c - zeeC - sqrqzC);
-		x1C = (-zeeC + sqrqzC) / (m_psimhc*m_cos2t);
-		x2C = (-zeeC - sqrqzC) / (m_psimhc*m_cos2t);
-		ph1C = 2.*pi*iC*k0Ai*del1C*(m_thicum*1.E+04) / gamma0;
-		ph2C = 2.*pi*iC*k0Ai*del2C*(m_thicum*1.E+04) / gamma0;
-
-		complex<double> DHpiC, D0trpC;
-		if(real(ph1C) > logDBMax) DHpiC = x2C;
-		else if(real(ph2C) > logDBMax) DHpiC = x1C;
-		else
+		//the cell is bisected only across the directions where the interpolation fails (the coefficients of a crystal usually vary fast vs one angle only)
+		if(interpolFailsX && interpolFailsZ)
 		{
-			Cph1C = exp(ph1C);
-			Cph2C = exp(ph2C);
-			DHpiC = x1C*x2C*(Cph2C - Cph1C)/(Cph2C*x2C - Cph1C*x1C);
+			TabulateReflCoefsInCell(tab, ix0, ixm, iz0, izm);
+			TabulateReflCoefsInCell(tab, ixm, ix1, iz0, izm);
+			TabulateReflCoefsInCell(tab, ix0, ixm, izm, iz1);
+			TabulateReflCoefsInCell(tab, ixm, ix1, izm, iz1);
 		}
-
-		if(m_itrans == 1)
+		else if(interpolFailsZ)
 		{
-			// calculate the complex reflectivity D0trpC of the transmitted beam. 
-			if (real(ph1C) > logDBMax)
-			{
-				Cph2C = exp(ph2C);
-				D0trpC = -Cph2C*(x2C - x1C)/x1C;
-			}
-			else if (real(ph2C) > logDBMax)
-			{
-				Cph1C = exp(ph1C);
-				D0trpC = +Cph1C*(x2C - x1C)/x2C;
-			}
-			else D0trpC = Cph1C*Cph2C*(x2C - x1C)/(Cph2C*x2C - Cph1C*x1C);
+			TabulateReflCoefsInCell(tab, ix0, ix1, iz0, izm);
+			TabulateReflCoefsInCell(tab, ix0, ix1, izm, iz1);
 		}
-
-		// Calculate the diffracted amplitudes: 
-		complex<double> EHSPCs = DHsgC*EInSPs;
-		complex<double> EHSPCp = DHpiC*EInSPp;
-		complex<double> E0tSPs, E0tSPp;
-		if(m_itrans == 1)
+		else
 		{
-			E0tSPs = D0trsC*EInSPs;
-			E0tSPp = D0trpC*EInSPp;
+			TabulateReflCoefsInCell(tab, ix0, ixm, iz0, iz1);
+			TabulateReflCoefsInCell(tab, ixm, ix1, iz0, iz1);
 		}
+	}
+
+	void SetupEnSliceAux(double ePh, srTOptCrystMeshTrf& meshTrf, srTOptCrystEnSliceAux& s)
+	{// E in eV
+		double &a11 = (meshTrf.matrKLabRef)[0][0], &a12 = (meshTrf.matrKLabRef)[0][1];
+		double &a21 = (meshTrf.matrKLabRef)[1][0], &a22 = (meshTrf.matrKLabRef)[1][1];
+		double asymFact = ::fabs(a11*a22 - a12*a21);
+		if(asymFact > 0) asymFact = 1./asymFact;
+		else asymFact = 1.;
+		s.asymFact = asymFact;
+
+		// Conversion factor: wavelength [A] <-> energy [eV] ?
+		const double eAconv = 12398.4193009;
+		const double pi = 4.*atan(1.);
+		const complex<double> iC(0., 1.);
+
+		double alamA = eAconv/ePh; //OC: wavelength in [A]?
+		double k0Ai = 1./alamA;
+		s.k0Ai = k0Ai;
+		s.invk0AiE2 = 1./(k0Ai*k0Ai);
+		s.aux_phC = 2.*pi*iC*k0Ai*(m_thicum*1.E+04);
 
 		//kc0XAi[0] = k0Ai*RLabXt[0][2]; 
 		//kc0XAi[1] = k0Ai*RLabXt[1][2]; 
@@ -828,77 +936,122 @@ public:
 		};
 
 		// Transform the diffracted beam polarization vectors into the diffracted beam frame: 
-		double sgH[3], piH[3];
 		for(int i = 0; i < 3; i++)
 		{
-			sgH[i] = m_RXtRef[i][0]*sgHX[0] + m_RXtRef[i][1]*sgHX[1] + m_RXtRef[i][2]*sgHX[2];
-			piH[i] = m_RXtRef[i][0]*piHX[0] + m_RXtRef[i][1]*piHX[1] + m_RXtRef[i][2]*piHX[2];
+			s.sgH[i] = m_RXtRef[i][0]*sgHX[0] + m_RXtRef[i][1]*sgHX[1] + m_RXtRef[i][2]*sgHX[2];
+			s.piH[i] = m_RXtRef[i][0]*piHX[0] + m_RXtRef[i][1]*piHX[1] + m_RXtRef[i][2]*piHX[2];
+		}
+	}
+
+	void FindTwoBeamCoefs(const complex<double>& queC, const complex<double>& zeeC, const complex<double>& psimhEffC, const complex<double>& aux_phC, complex<double>& DHC, complex<double>* pD0trC)
+	{//Complex reflectivity (and, optionally, transmissivity) for one polarization component
+		complex<double> sqrqzC = sqrt(queC + zeeC*zeeC);
+		complex<double> del1C = 0.5*(m_psi0c - zeeC + sqrqzC);
+		complex<double> del2C = 0.5*(m_psi0c - zeeC - sqrqzC);
+		complex<double> x1C = (-zeeC + sqrqzC) / psimhEffC;
+		complex<double> x2C = (-zeeC - sqrqzC) / psimhEffC;
+		complex<double> ph1C = aux_phC*del1C;
+		complex<double> ph2C = aux_phC*del2C;
+
+		complex<double> Cph1C, Cph2C;
+		if(real(ph1C) > m_logDBMax) DHC = x2C;
+		else if(real(ph2C) > m_logDBMax) DHC = x1C;
+		else
+		{
+			Cph1C = exp(ph1C);
+			Cph2C = exp(ph2C);
+			DHC = x1C*x2C*(Cph2C - Cph1C)/(Cph2C*x2C - Cph1C*x1C);
+		}
+
+		if(pD0trC != 0)
+		{
+			// calculate the complex reflectivity of the transmitted beam. 
+			if(real(ph1C) > m_logDBMax)
+			{
+				Cph2C = exp(ph2C);
+				*pD0trC = -Cph2C*(x2C - x1C)/x1C;
+			}
+			else if(real(ph2C) > m_logDBMax)
+			{
+				Cph1C = exp(ph1C);
+				*pD0trC = +Cph1C*(x2C - x1C)/x2C;
+			}
+			else *pD0trC = Cph1C*Cph2C*(x2C - x1C)/(Cph2C*x2C - Cph1C*x1C);
 		}
+	}
+
+	void FindReflCoefs(const srTOptCrystEnSliceAux& s, double kxAi, double kyAi, complex<double>& DHsgC, complex<double>& DHpiC, complex<double>* pD0trsC=0, complex<double>* pD0trpC=0)
+	{// kxAi, kyAi: transverse components of incident wave vector in the Lab frame [1/A]
+		double k0Ai = s.k0Ai;
+
+		// k0wvAi = incident beam wave vector (kx,ky,kz). 
+		double kzAi = sqrt(k0Ai*k0Ai - kxAi*kxAi - kyAi*kyAi); //OC: possible loss of precision?
+
+		// Conversion of wave vector components to crystal frame: 
+		double k0wXAi[] = {
+			m_RLabXt[0][0] * kxAi + m_RLabXt[0][1] * kyAi + m_RLabXt[0][2] * kzAi,
+			m_RLabXt[1][0] * kxAi + m_RLabXt[1][1] * kyAi + m_RLabXt[1][2] * kzAi,
+			m_RLabXt[2][0] * kxAi + m_RLabXt[2][1] * kyAi + m_RLabXt[2][2] * kzAi
+		};
+
+		// Calculate direction cosine gamma0, reflection asymmetry parameter bee, 
+		// deviation parameter Adev and normalized deviation parameter zeeC (as 
+		// defined by Zachariasen gamma0, b, alpha and z.) 
+		double gamma0 = -k0wXAi[1] / k0Ai;
+		double bee = 1. / (1. + m_HXAi[1] / k0wXAi[1]);
+		double dotkH = k0wXAi[0] * m_HXAi[0] + k0wXAi[1] * m_HXAi[1] + k0wXAi[2] * m_HXAi[2];
+		double Adev = (2.*dotkH + m_invdAE2)*s.invk0AiE2;
+		complex<double> zeeC = 0.5*((1. - bee)*m_psi0c + bee*Adev);
+		complex<double> aux_phC = s.aux_phC / gamma0;
+
+		// Calculate the complex reflectivity DHsgC for sigma polarization: 
+		complex<double> queC = bee*m_psihc*m_psimhc;
+		FindTwoBeamCoefs(queC, zeeC, m_psimhc, aux_phC, DHsgC, pD0trsC);
+
+		// Calculate the complex reflectivity DHpiC for pi polarization: 
+		FindTwoBeamCoefs(queC*m_cos2t*m_cos2t, zeeC, m_psimhc*m_cos2t, aux_phC, DHpiC, pD0trpC);
+	}
+
+	void ApplyReflCoefs(const srTOptCrystEnSliceAux& s, const complex<double>& DHsgC, const complex<double>& DHpiC, srTEFieldPtrs& EPtrs)
+	{
+		complex<double> Eox = complex<double>(*(EPtrs.pExRe), *(EPtrs.pExIm));
+		complex<double> Eoy = complex<double>(*(EPtrs.pEzRe), *(EPtrs.pEzIm));
+
+		// Convert components of incident beam polarization from (e1X,e2X) to (sg0X,pi0X): 
+		complex<double> EInSPs = m_PolTrn[0][0] * Eox + m_PolTrn[0][1] * Eoy;
+		complex<double> EInSPp = m_PolTrn[1][0] * Eox + m_PolTrn[1][1] * Eoy;
+
+		// Calculate the diffracted amplitudes: 
+		complex<double> EHSPCs = DHsgC*EInSPs;
+		complex<double> EHSPCp = DHpiC*EInSPp;
 
 		// Calculate diffracted amplitudes in the diffracted beam frame
-		complex<double> Ehx = sgH[0]*EHSPCs + piH[0]*EHSPCp;
-		complex<double> Ehy = sgH[1]*EHSPCs + piH[1]*EHSPCp;
-		complex<double> Ehz = sgH[2]*EHSPCs + piH[2]*EHSPCp; //Longitudinal component not used (?)
+		complex<double> Ehx = s.sgH[0]*EHSPCs + s.piH[0]*EHSPCp;
+		complex<double> Ehy = s.sgH[1]*EHSPCs + s.piH[1]*EHSPCp;
 
 		// Transverse components of the output electric field in the frame of the output beam:
-		*(EPtrs.pExRe) = (float)(asymFact*Ehx.real());
-		*(EPtrs.pExIm) = (float)(asymFact*Ehx.imag());
-		*(EPtrs.pEzRe) = (float)(asymFact*Ehy.real());
-		*(EPtrs.pEzIm) = (float)(asymFact*Ehy.imag());
+		*(EPtrs.pExRe) = (float)(s.asymFact*Ehx.real());
+		*(EPtrs.pExIm) = (float)(s.asymFact*Ehx.imag());
+		*(EPtrs.pEzRe) = (float)(s.asymFact*Ehy.real());
+		*(EPtrs.pEzIm) = (float)(s.asymFact*Ehy.imag());
+	}
 
-		//complex<double> Etx, Ety, Etz;
-		//if(m_itrans == 1)
-		//{
-		//	Etx = sgH[0]*E0tSPs + piH[0]*E0tSPp;
-		//	Ety = sgH[1]*E0tSPs + piH[1]*E0tSPp;
-		//	Etz = sgH[2]*E0tSPs + piH[2]*E0tSPp;
-		//}
+	void RadPointModifier(srTEXZ& EXZ, srTEFieldPtrs& EPtrs)
+	//void RadPointModifier_AngRepres(srTEXZ& EXZ, srTEFieldPtrs& EPtrs)
+	{// E in eV; Length in m !!!
+		// Operates on Angles side !!!
+		// EXZ.x = angX_rad/wavelength_m, EXZ.z = angY_rad/wavelength_m
+		// Not used by PropagateRadiationSimple_AngRepres, which processes the whole mesh in ApplyReflCoefsOnAngMesh; kept for point-by-point processing.
 
-		// Convert the diffracted beam's wave vector from the crystal frame to the diffracted beam frame.
-		//kmHAi[0] = RXtRef[0][0]*kmHXAi[0] + RXtRef[0][1]*kmHXAi[1] + RXtRef[0][2]*kmHXAi[2];
-		//kmHAi[1] = RXtRef[1][0]*kmHXAi[0] + RXtRef[1][1]*kmHXAi[1] + RXtRef[1][2]*kmHXAi[2];
-		//kmHAi[2] = RXtRef[2][0]*kmHXAi[0] + RXtRef[2][1]*kmHXAi[1] + RXtRef[2][2]*kmHXAi[2];
-		//double kmHAi[] = {
-		//	m_RXtRef[0][0]*kmHXAi[0] + m_RXtRef[0][1]*kmHXAi[1] + m_RXtRef[0][2]*kmHXAi[2],
-		//	m_RXtRef[1][0]*kmHXAi[0] + m_RXtRef[1][1]*kmHXAi[1] + m_RXtRef[1][2]*kmHXAi[2],
-		//	m_RXtRef[2][0]*kmHXAi[0] + m_RXtRef[2][1]*kmHXAi[1] + m_RXtRef[2][2]*kmHXAi[2]
-		//};
-
-		/**
-		//printf("Reflected wave vector components in Lab frame: \n");
-		//printf("%e %e %e\n",kmHAi[0],kmHAi[1],kmHAi[2]);
-		//
-		// For test output only:
-		dangur = -asin(kyAi/k0Ai)*1.E+06;
-		//uref[0] = 0.;
-		//uref[1] = sin(2.*thBrd);
-		//uref[2] = cos(2.*thBrd);
-		//urkmH = uref[0]*kmHAi[0] + uref[1]*kmHAi[1] + uref[2]*kmHAi[2];
-		//if (urkmH > k0Ai)
-		//kangur = 0.;
-		//else
-		//kangur = acos(urkmH/k0Ai)*1.E+06;
-		//ukcrAi[0] = uref[1]*kmHAi[2] - uref[2]*kmHAi[1];
-		//ukcrAi[1] = uref[2]*kmHAi[0] - uref[0]*kmHAi[2];
-		//ukcrAi[2] = uref[0]*kmHAi[1] - uref[1]*kmHAi[0];
-		//if (ukcrAi[0] > 0.)
-		//kangur = -kangur;
-		//mgkmk0 = sqrt( kmHAi[0]*kmHAi[0] + kmHAi[1]*kmHAi[1] + kmHAi[2]*kmHAi[2] )/k0Ai;
-		//mgDHsg = abs(DHsgC);
-		//mgDHpi = abs(DHpiC);
-		//mgEHs = abs(EHSPCs);
-		//mgEHp = abs(EHSPCp);
-		//fprintf(TestK,"%e %e %e\n",dangur,mgkmk0,kangur);
-		//fprintf(TestRef,"%e %e %e %e %e\n",dangur,mgDHsg*mgDHsg,arg(DHsgC),mgDHpi*mgDHpi,arg(DHpiC));
-		fprintf(TestAmpH,"%e %e %e %e %e %e %e\n",dangur,real(Ehx),imag(Ehx),real(Ehy),imag(Ehy),1.e6*kyAi,1.e6*kmHAi[1]);
-		//
-		if (itrans == 1){
-		//mgE0ts = abs(E0tSPs);
-		//mgE0tp = abs(E0tSPp);
-		fprintf(TestAmpO,"%e %e %e %e %e\n",dangur,real(E0tSPs),imag(E0tSPs),real(E0tSPp),imag(E0tSPp));
-		//fprintf(TestTrns,"%e %e %e %e %e\n",dangur,mgE0ts*mgE0ts,arg(E0tSPs),mgE0tp*mgE0tp,arg(E0tSPp));
-		}
-		**/
+		int ie = 0;
+		if(m_ne > 1) ie = int((EXZ.e - m_eStartAux)/m_eStepAux + 1e-06) + 1;
+
+		srTOptCrystEnSliceAux enSlice;
+		SetupEnSliceAux(EXZ.e, m_pMeshTrf[ie], enSlice);
+
+		complex<double> DHsgC, DHpiC;
+		FindReflCoefs(enSlice, EXZ.x*1.e-10, EXZ.z*1.e-10, DHsgC, DHpiC);
+		ApplyReflCoefs(enSlice, DHsgC, DHpiC, EPtrs);
 	}
 
 	int PropagateRadMoments(srTSRWRadStructAccessData* pRadAccessData, srTMomentsRatios* MomRatArray)
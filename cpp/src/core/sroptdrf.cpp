@@ -14,6 +14,11 @@
 #include "sroptdrf.h"
 #include "gmfft.h"
 #include "srradmnp.h"
+#include "srmlttsk.h"
+
+//*************************************************************************
+
+extern srTYield srYield;
 
 //*************************************************************************
 
@@ -376,6 +381,8 @@ int srTDriftSpace::PropagateRadiationSimple_PropToWaist(srTSRWRadStructAccessDat
 	FFT2DInfo.Ny = pRadAccessData->nz;
 	FFT2DInfo.Dir = 1;
 	FFT2DInfo.UseGivenStartTrValues = 0;
+	FFT2DInfo.SymX = pRadAccessData->MirrorSymX;
+	FFT2DInfo.SymY = pRadAccessData->MirrorSymZ;
 
 	CGenMathFFT2D FFT2D;
 
@@ -383,6 +390,7 @@ int srTDriftSpace::PropagateRadiationSimple_PropToWaist(srTSRWRadStructAccessDat
 	srTDataPtrsForWfrEdgeCorr DataPtrsForWfrEdgeCorr;
 	if(result = SetupWfrEdgeCorrData(pRadAccessData, pRadAccessData->pBaseRadX, pRadAccessData->pBaseRadZ, DataPtrsForWfrEdgeCorr)) return result;
 
+	pRadAccessData->NoteFieldModif();
 	FFT2DInfo.pData = pRadAccessData->pBaseRadX;
 	if(result = FFT2D.Make2DFFT(FFT2DInfo)) return result;
 	FFT2DInfo.pData = pRadAccessData->pBaseRadZ;
@@ -439,11 +447,14 @@ int srTDriftSpace::PropagateRadiationSimple_PropFromWaist(srTSRWRadStructAccessD
 	FFT2DInfo.Ny = pRadAccessData->nz;
 	FFT2DInfo.Dir = 1;
 	FFT2DInfo.UseGivenStartTrValues = 0;
+	FFT2DInfo.SymX = pRadAccessData->MirrorSymX;
+	FFT2DInfo.SymY = pRadAccessData->MirrorSymZ;
 
 	srTDataPtrsForWfrEdgeCorr DataPtrsForWfrEdgeCorr;
 	if(result = SetupWfrEdgeCorrData(pRadAccessData, pRadAccessData->pBaseRadX, pRadAccessData->pBaseRadZ, DataPtrsForWfrEdgeCorr)) return result;
 
 	CGenMathFFT2D FFT2D;
+	pRadAccessData->NoteFieldModif();
 	FFT2DInfo.pData = pRadAccessData->pBaseRadX;
 	if(result = FFT2D.Make2DFFT(FFT2DInfo)) return result;
 	FFT2DInfo.pData = pRadAccessData->pBaseRadZ;
@@ -470,20 +481,18 @@ int srTDriftSpace::PropagateRadiationSimple_PropFromWaist(srTSRWRadStructAccessD
 
 int srTDriftSpace::PropagateRadiationSimple_AnalytTreatQuadPhaseTerm(srTSRWRadStructAccessData* pRadAccessData)
 {// e in eV; Length in m !!!
+ //The phase terms removed in coord. repres., applied in ang. repres. and added back in coord. repres. are separable vs x and z,
+ //so they are applied as multipliers within the passes done by the FFTs (see CGenMathFFT2DInfo), instead of separate traversals of the wavefront.
 	int result = 0;
 
 	SetupPropBufVars_AnalytTreatQuadPhaseTerm(pRadAccessData);
 	if(pRadAccessData->Pres != 0) if(result = SetRadRepres(pRadAccessData, 0)) return result;
-		
-	PropBufVars.PassNo = 1; //Remove quadratic term from the Phase in coord. repres.
-	if(result = TraverseRadZXE(pRadAccessData)) return result;
-
-		//testOC09302011
-		//if(Length == 34.63) return 0;
 
+	long nx = pRadAccessData->nx, nz = pRadAccessData->nz, ne = pRadAccessData->ne;
 	double xStartOld = pRadAccessData->xStart, zStartOld = pRadAccessData->zStart;
-	pRadAccessData->xStart = -(pRadAccessData->nx >> 1)*pRadAccessData->xStep;
-	pRadAccessData->zStart = -(pRadAccessData->nz >> 1)*pRadAccessData->zStep;
+	double xStepOld = pRadAccessData->xStep, zStepOld = pRadAccessData->zStep;
+	pRadAccessData->xStart = -(nx >> 1)*pRadAccessData->xStep;
+	pRadAccessData->zStart = -(nz >> 1)*pRadAccessData->zStep;
 	double xShift = pRadAccessData->xStart - xStartOld, zShift = pRadAccessData->zStart - zStartOld;
 
 	pRadAccessData->xWfrMin += xShift; pRadAccessData->xWfrMax += xShift;
@@ -491,17 +500,45 @@ int srTDriftSpace::PropagateRadiationSimple_AnalytTreatQuadPhaseTerm(srTSRWRadSt
 
 		pRadAccessData->WfrEdgeCorrShouldBeDone = 0;
 
-	if(result = SetRadRepres(pRadAccessData, 1)) return result; //To angular repres.
+	//Meshes are set up as in SetRadRepres (to ang. repres. and back)
+	CGenMathFFT2D FFT2D;
+	CGenMathFFT2DInfo FFT2DInfoToAng;
+	FFT2DInfoToAng.xStep = pRadAccessData->xStep; FFT2DInfoToAng.yStep = pRadAccessData->zStep;
+	FFT2DInfoToAng.xStart = pRadAccessData->xStart; FFT2DInfoToAng.yStart = pRadAccessData->zStart;
+	FFT2DInfoToAng.Nx = nx; FFT2DInfoToAng.Ny = nz;
+	FFT2DInfoToAng.Dir = 1;
+	FFT2DInfoToAng.SymX = pRadAccessData->MirrorSymX; FFT2DInfoToAng.SymY = pRadAccessData->MirrorSymZ;
+	if(pRadAccessData->AuxLong4 == 7777777)
+	{
+		FFT2DInfoToAng.UseGivenStartTrValues = 1;
+		FFT2DInfoToAng.xStartTr = pRadAccessData->xStartTr;
+		FFT2DInfoToAng.yStartTr = pRadAccessData->zStartTr;
+	}
+	FFT2D.SetupLimitsTr(FFT2DInfoToAng);
 
-	PropBufVars.PassNo = 2; //Loop in angular repres.
-	if(result = TraverseRadZXE(pRadAccessData)) return result;
 		if(pRadAccessData->UseStartTrToShiftAtChangingRepresToCoord)
 		{
 			pRadAccessData->xStartTr += xShift;
 			pRadAccessData->zStartTr += zShift;
 		}
 
-	if(result = SetRadRepres(pRadAccessData, 0)) return result; //Back to coord. repres.
+	CGenMathFFT2DInfo FFT2DInfoToCoord;
+	FFT2DInfoToCoord.xStep = FFT2DInfoToAng.xStepTr; FFT2DInfoToCoord.yStep = FFT2DInfoToAng.yStepTr;
+	FFT2DInfoToCoord.xStart = FFT2DInfoToAng.xStartTr; FFT2DInfoToCoord.yStart = FFT2DInfoToAng.yStartTr;
+	FFT2DInfoToCoord.Nx = nx; FFT2DInfoToCoord.Ny = nz;
+	FFT2DInfoToCoord.Dir = -1;
+	FFT2DInfoToCoord.SymX = pRadAccessData->MirrorSymX; FFT2DInfoToCoord.SymY = pRadAccessData->MirrorSymZ;
+	if((pRadAccessData->AuxLong4 == 7777777) || pRadAccessData->UseStartTrToShiftAtChangingRepresToCoord)
+	{
+		FFT2DInfoToCoord.UseGivenStartTrValues = 1;
+		FFT2DInfoToCoord.xStartTr = pRadAccessData->xStartTr;
+		FFT2DInfoToCoord.yStartTr = pRadAccessData->zStartTr;
+	}
+	FFT2D.SetupLimitsTr(FFT2DInfoToCoord);
+
+	pRadAccessData->xStep = FFT2DInfoToCoord.xStepTr;
+	pRadAccessData->zStep = FFT2DInfoToCoord.yStepTr;
+	pRadAccessData->Pres = 0;
 
 	pRadAccessData->xStart = xStartOld; pRadAccessData->zStart = zStartOld;
 		if(pRadAccessData->UseStartTrToShiftAtChangingRepresToCoord)
@@ -511,20 +548,79 @@ int srTDriftSpace::PropagateRadiationSimple_AnalytTreatQuadPhaseTerm(srTSRWRadSt
 		}
 
 	//Change scale
-	//double kx = (pRadAccessData->RobsX + Length)/pRadAccessData->RobsX;
-	//pRadAccessData->xStart = kx*(pRadAccessData->xStart) - (Length/pRadAccessData->RobsX)*(pRadAccessData->xc);
-	//pRadAccessData->xStep *= kx;
 	pRadAccessData->xStart = PropBufVars.kx_AnalytTreatQuadPhaseTerm*(pRadAccessData->xStart) - PropBufVars.kxc_AnalytTreatQuadPhaseTerm*(pRadAccessData->xc);
 	pRadAccessData->xStep *= PropBufVars.kx_AnalytTreatQuadPhaseTerm;
-
-	//double kz = (pRadAccessData->RobsZ + Length)/pRadAccessData->RobsZ;
-	//pRadAccessData->zStart = kz*(pRadAccessData->zStart) - (Length/pRadAccessData->RobsZ)*(pRadAccessData->zc);
-	//pRadAccessData->zStep *= kz;
 	pRadAccessData->zStart = PropBufVars.kz_AnalytTreatQuadPhaseTerm*(pRadAccessData->zStart) - PropBufVars.kzc_AnalytTreatQuadPhaseTerm*(pRadAccessData->zc);
 	pRadAccessData->zStep *= PropBufVars.kz_AnalytTreatQuadPhaseTerm;
 
-	PropBufVars.PassNo = 3; //Add new quadratic term to the Phase in coord. repres.
-	if(result = TraverseRadZXE(pRadAccessData)) return result;
+	//Multipliers: 1- removing quad. term in coord. repres.; 2- loop in ang. repres.; 3- adding new quad. term in coord. repres.
+	long TwoNx = nx << 1, TwoNz = nz << 1;
+	float *arMult = new float[3*(TwoNx + TwoNz)];
+	if(arMult == 0) return MEMORY_ALLOCATION_FAILURE;
+	float *arMultX1 = arMult, *arMultX2 = arMultX1 + TwoNx, *arMultX3 = arMultX2 + TwoNx;
+	float *arMultZ1 = arMultX3 + TwoNx, *arMultZ2 = arMultZ1 + TwoNz, *arMultZ3 = arMultZ2 + TwoNz;
+	FFT2DInfoToAng.pMultBeforeX = arMultX1; FFT2DInfoToAng.pMultBeforeY = arMultZ1;
+	FFT2DInfoToAng.pMultAfterX = arMultX2; FFT2DInfoToAng.pMultAfterY = arMultZ2;
+	FFT2DInfoToCoord.pMultAfterX = arMultX3; FFT2DInfoToCoord.pMultAfterY = arMultZ3;
+
+	float *AuxEx = 0, *AuxEz = 0;
+	if(ne > 1)
+	{
+		long TwoNxNz = (nx*nz) << 1;
+		AuxEx = new float[TwoNxNz];
+		AuxEz = new float[TwoNxNz];
+		if((AuxEx == 0) || (AuxEz == 0)) 
+		{
+			if(AuxEx != 0) delete[] AuxEx;
+			delete[] arMult; return MEMORY_ALLOCATION_FAILURE;
+		}
+	}
+
+	const double Pi = 3.1415926536;
+	double e = pRadAccessData->eStart;
+	for(long ie=0; ie<ne; ie++)
+	{
+		if(result = srYield.Check()) break;
+
+		//double Lambda_m = 1.239854e-06/e;
+		double Lambda_m = 1.239842e-06/e;
+		double Pi_d_Lambda_m = Pi/Lambda_m, Pi_Lambda_m = Pi*Lambda_m;
+		SetupQuadPhaseMult1D_AnalytTreatQuadPhaseTerm(arMultX1, nx, xStartOld, xStepOld, PropBufVars.xc, -Pi_d_Lambda_m*PropBufVars.invRx, 0., 1.);
+		SetupQuadPhaseMult1D_AnalytTreatQuadPhaseTerm(arMultZ1, nz, zStartOld, zStepOld, PropBufVars.zc, -Pi_d_Lambda_m*PropBufVars.invRz, 0., 1.);
+		SetupQuadPhaseMult1D_AnalytTreatQuadPhaseTerm(arMultX2, nx, FFT2DInfoToAng.xStartTr, FFT2DInfoToAng.xStepTr, 0., -Pi_Lambda_m*PropBufVars.Lx, PropBufVars.phase_term_signLxLz, PropBufVars.sqrt_LxLz_d_L);
+		SetupQuadPhaseMult1D_AnalytTreatQuadPhaseTerm(arMultZ2, nz, FFT2DInfoToAng.yStartTr, FFT2DInfoToAng.yStepTr, 0., -Pi_Lambda_m*PropBufVars.Lz, 0., 1.);
+		double PhPath = (TreatPath == 1)? 2*Pi_d_Lambda_m*Length : 0.; //OC010813
+		SetupQuadPhaseMult1D_AnalytTreatQuadPhaseTerm(arMultX3, nx, pRadAccessData->xStart, pRadAccessData->xStep, PropBufVars.xc, Pi_d_Lambda_m*PropBufVars.invRxL, PhPath, 1.);
+		SetupQuadPhaseMult1D_AnalytTreatQuadPhaseTerm(arMultZ3, nz, pRadAccessData->zStart, pRadAccessData->zStep, PropBufVars.zc, Pi_d_Lambda_m*PropBufVars.invRzL, 0., 1.);
+
+		pRadAccessData->NoteFieldModif();
+		float *pEx = pRadAccessData->pBaseRadX, *pEz = pRadAccessData->pBaseRadZ;
+		if(ne > 1)
+		{
+			pEx = AuxEx; pEz = AuxEz;
+			if(result = ExtractRadSliceConstE(pRadAccessData, ie, pEx, pEz)) break;
+		}
+
+		FFT2DInfoToAng.pData = pEx;
+		if(result = FFT2D.Make2DFFT(FFT2DInfoToAng)) break;
+		FFT2DInfoToAng.pData = pEz;
+		if(result = FFT2D.Make2DFFT(FFT2DInfoToAng)) break;
+		FFT2DInfoToCoord.pData = pEx;
+		if(result = FFT2D.Make2DFFT(FFT2DInfoToCoord)) break;
+		FFT2DInfoToCoord.pData = pEz;
+		if(result = FFT2D.Make2DFFT(FFT2DInfoToCoord)) break;
+
+		if(ne > 1)
+		{
+			if(result = SetupRadSliceConstE(pRadAccessData, ie, pEx, pEz)) break;
+		}
+		e += pRadAccessData->eStep;
+	}
+
+	delete[] arMult;
+	if(AuxEx != 0) delete[] AuxEx;
+	if(AuxEz != 0) delete[] AuxEz;
+	if(result) return result;
 
 	//pRadAccessData->MirrorFieldData(sign(kx), sign(kz));
 	pRadAccessData->MirrorFieldData((int)sign(PropBufVars.kx_AnalytTreatQuadPhaseTerm), (int)sign(PropBufVars.kz_AnalytTreatQuadPhaseTerm));
@@ -189,6 +189,9 @@ public:
 		else if(ParPrecWfrPropag.AnalTreatment == 4) LocalPropMode = 1; //Propagation To Waist
 	}
 
+	int WorksInAngRepres(char AnalTreatment) { return (AnalTreatment == 0);} //LocalPropMode = 0 (see ChooseLocalPropMode)
+	void UpdateMirrorSym(srTSRWRadStructAccessData*) {} //drift keeps the symmetry
+
 	int PropToWaistCanBeApplied(srTSRWRadStructAccessData* pRadAccessData)
 	{
 		if(!AllowPropToWaist) return 0;
@@ -229,6 +232,31 @@ public:
 	int PropagateRadiationSimple_AngRepres(srTSRWRadStructAccessData* pRadAccessData)
 	{
 		int result;
+		if((pRadAccessData->AuxLong4 != 7777777) && (!pRadAccessData->UseStartTrToShiftAtChangingRepresToCoord))
+		{//The start values of the centered Coord. mesh are kept pending in pRadAccessData and restored by SetRadRepres, 
+		 //so that the wavefront may be left in Ang. repres. if the next element works in it too
+			if(pRadAccessData->Pres != 1) 
+			{
+				double xStartOld = pRadAccessData->xStart, zStartOld = pRadAccessData->zStart;
+				pRadAccessData->xStart = -(pRadAccessData->nx >> 1)*pRadAccessData->xStep;
+				pRadAccessData->zStart = -(pRadAccessData->nz >> 1)*pRadAccessData->zStep;
+				pRadAccessData->xWfrMin += pRadAccessData->xStart - xStartOld; pRadAccessData->xWfrMax += pRadAccessData->xStart - xStartOld;
+				pRadAccessData->zWfrMin += pRadAccessData->zStart - zStartOld; pRadAccessData->zWfrMax += pRadAccessData->zStart - zStartOld;
+
+				pRadAccessData->xStartCoordPend = xStartOld; pRadAccessData->zStartCoordPend = zStartOld;
+				pRadAccessData->CoordStartIsPend = 1;
+				pRadAccessData->WfrEdgeCorrShouldBeDone = 0;
+				if(result = SetRadRepres(pRadAccessData, 1)) return result;
+			}
+			if(result = TraverseRadZXE(pRadAccessData)) return result;
+			if(!pRadAccessData->PresAngMayBeKept)
+			{
+				if(result = SetRadRepres(pRadAccessData, 0)) return result;
+			}
+			pRadAccessData->SetNonZeroWavefrontLimitsToFullRange();
+			return 0;
+		}
+
 		double xStartOld = pRadAccessData->xStart, zStartOld = pRadAccessData->zStart;
 		pRadAccessData->xStart = -(pRadAccessData->nx >> 1)*pRadAccessData->xStep;
 		pRadAccessData->zStart = -(pRadAccessData->nz >> 1)*pRadAccessData->zStep;
@@ -551,6 +579,19 @@ public:
 		*(EPtrs.pEzRe) = NewEzRe; *(EPtrs.pEzIm) = NewEzIm; 
 	}
 
+	void SetupQuadPhaseMult1D_AnalytTreatQuadPhaseTerm(float* pMult, long np, double argStart, double argStep, double argCen, double coefQuad, double phConst, double mult)
+	{//Multiplier vs one coordinate: mult*exp(i*(coefQuad*(arg - argCen)^2 + phConst))
+		float *t = pMult;
+		double arg = argStart;
+		for(long i=0; i<np; i++)
+		{
+			double r = arg - argCen;
+			float CosPh, SinPh; CosAndSin(coefQuad*r*r + phConst, CosPh, SinPh);
+			*(t++) = (float)(mult*CosPh); *(t++) = (float)(mult*SinPh);
+			arg += argStep;
+		}
+	}
+
 	void RadPointModifier1D(srTEXZ& EXZ, srTEFieldPtrs& EPtrs)
 	{
 		if(LocalPropMode == 0) { RadPointModifier1D_AngRepres(EXZ, EPtrs); return; }
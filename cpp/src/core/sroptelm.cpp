@@ -134,6 +134,7 @@ int srTGenOptElem::SetupOpticalElement(srTStringVect* pOptElemInfo, srTDataMD* p
 
 int srTGenOptElem::TraverseRadZXE(srTSRWRadStructAccessData* pRadAccessData)
 {
+	pRadAccessData->NoteFieldModif();
 	float *pEx0 = pRadAccessData->pBaseRadX;
 	float *pEz0 = pRadAccessData->pBaseRadZ;
 	long PerX = pRadAccessData->ne << 1;
@@ -289,6 +290,7 @@ int srTGenOptElem::ExtractRadSliceConstE(srTSRWRadStructAccessData* pRadAccessDa
 
 int srTGenOptElem::SetupRadSliceConstE(srTSRWRadStructAccessData* pRadAccessData, long ie, float* pInEx, float* pInEz)
 {
+	pRadAccessData->NoteFieldModif();
 	float *pEx0 = pRadAccessData->pBaseRadX;
 	float *pEz0 = pRadAccessData->pBaseRadZ;
 	long PerX = pRadAccessData->ne << 1;
@@ -492,6 +494,7 @@ int srTGenOptElem::UpdateGenRadStructFromSlicesConstE_Meth_0(srTSRWRadStructAcce
 
 int srTGenOptElem::UpdateGenRadStructSliceConstE_Meth_0(srTSRWRadStructAccessData* pRadDataSliceConstE, int ie, srTSRWRadStructAccessData* pRadAccessData)
 {//Compose the Electric Field of the pRadAccessData from the slices ConstE.
+	pRadAccessData->NoteFieldModif();
  //The slices are assumed to have same dimensions over nx and nz. 
 	if((pRadAccessData == 0) || (pRadDataSliceConstE == 0) || (ie < 0)) return 0;
 
@@ -561,6 +564,7 @@ int srTGenOptElem::UpdateGenRadStructSliceConstE_Meth_0(srTSRWRadStructAccessDat
 
 int srTGenOptElem::UpdateGenRadStructSliceConstE_Meth_2(srTSRWRadStructAccessData* pRadDataSliceConstE, int ie, srTSRWRadStructAccessData* pRadAccessData)
 {//To implement:
+	pRadAccessData->NoteFieldModif();
  // Undate the Electric Field of the pRadAccessData from the slice ConstE.
 // The slice can have different dimensions over nx and nz, compared to general pRadAccessData. 
 // In such a case, maximum nx and nz (over Range and Resolution) are taken and Resizing is performed on pRadAccessData.
@@ -591,6 +595,7 @@ int srTGenOptElem::UpdateGenRadStructSliceConstE_Meth_2(srTSRWRadStructAccessDat
 
 int srTGenOptElem::RemoveSliceConstE_FromGenRadStruct(srTSRWRadStructAccessData* pRadAccessData, long ie)
 {
+	pRadAccessData->NoteFieldModif();
 	if(pRadAccessData->ne == 1) return 0;
 
 // Remove an Electric Field slice ConstE from the general Electric Field arrays.
@@ -1066,6 +1071,7 @@ int srTGenOptElem::SetRadRepres(srTSRWRadStructAccessData* pRadAccessData, char
 	char WfrEdgeCorrShouldBeTreated = pRadAccessData->WfrEdgeCorrShouldBeDone; // Turn on/off here
 
 	if(pRadAccessData->Pres == CoordOrAng) return 0;
+	pRadAccessData->NoteFieldModif();
 	char DirFFT = (CoordOrAng == 0)? -1 : 1;
 
 	CGenMathFFT2DInfo FFT2DInfo;
@@ -1077,6 +1083,8 @@ int srTGenOptElem::SetRadRepres(srTSRWRadStructAccessData* pRadAccessData, char
 	FFT2DInfo.Ny = pRadAccessData->nz;
 	FFT2DInfo.Dir = DirFFT;
 	FFT2DInfo.UseGivenStartTrValues = 0;
+	FFT2DInfo.SymX = pRadAccessData->MirrorSymX; //the symmetry is checked in Make2DFFT
+	FFT2DInfo.SymY = pRadAccessData->MirrorSymZ;
 //New
 	if((pRadAccessData->AuxLong4 == 7777777) || ((CoordOrAng == 0) && pRadAccessData->UseStartTrToShiftAtChangingRepresToCoord))
 	{
@@ -1116,8 +1124,16 @@ int srTGenOptElem::SetRadRepres(srTSRWRadStructAccessData* pRadAccessData, char
 			}
 		}
 	}
+	else if(!(WfrEdgeCorrShouldBeTreated && (CoordOrAng == 1)))
+	{//all photon energy slices are transformed at once, directly in the wavefront arrays
+		FFT2DInfo.HowMany = pRadAccessData->ne;
+		FFT2DInfo.pData = pRadAccessData->pBaseRadX;
+		if(result = FFT2D.Make2DFFT(FFT2DInfo)) return result;
+		FFT2DInfo.pData = pRadAccessData->pBaseRadZ;
+		if(result = FFT2D.Make2DFFT(FFT2DInfo)) return result;
+	}
 	else
-	{
+	{//edge correction data is set up per slice
 		long TwoNxNz = (pRadAccessData->nx*pRadAccessData->nz) << 1;
 		float* AuxEx = new float[TwoNxNz];
 		if(AuxEx == 0) return MEMORY_ALLOCATION_FAILURE;
@@ -1166,6 +1182,12 @@ int srTGenOptElem::SetRadRepres(srTSRWRadStructAccessData* pRadAccessData, char
 	pRadAccessData->xStart = FFT2DInfo.xStartTr;
 	pRadAccessData->zStart = FFT2DInfo.yStartTr;
 	pRadAccessData->Pres = CoordOrAng;
+	if((CoordOrAng == 0) && pRadAccessData->CoordStartIsPend)
+	{//restoring start values of Coord. mesh centered before change to Ang. repres. (see srTDriftSpace::PropagateRadiationSimple_AngRepres)
+		pRadAccessData->xStart = pRadAccessData->xStartCoordPend;
+		pRadAccessData->zStart = pRadAccessData->zStartCoordPend;
+		pRadAccessData->CoordStartIsPend = 0;
+	}
 
 	pRadAccessData->SetNonZeroWavefrontLimitsToFullRange();
 
@@ -1174,6 +1196,74 @@ int srTGenOptElem::SetRadRepres(srTSRWRadStructAccessData* pRadAccessData, char
 
 //*************************************************************************
 
+int srTGenOptElem::TreatCoordStartPendInAngRepres(srTSRWRadStructAccessData* pRadAccessData)
+{//Applies in Ang. repres. the linear phase that the change to Coord. repres. with restoring the pending Coord. mesh start values, 
+ //followed by the change back to Ang. repres., would produce (see Make2DFFT); 
+ //required by elements that do not center the Coord. mesh themselves before processing in Ang. repres.
+	if((pRadAccessData->Pres != 1) || (!pRadAccessData->CoordStartIsPend)) return 0;
+	pRadAccessData->CoordStartIsPend = 0;
+
+	const double RelShiftTol = 1.E-06; //as in Make2DFFT
+	const double TwoPi = 6.2831853071796;
+	long nx = pRadAccessData->nx, nz = pRadAccessData->nz, ne = pRadAccessData->ne;
+	double xStepCoord = 1./(nx*pRadAccessData->xStep), zStepCoord = 1./(nz*pRadAccessData->zStep);
+	double x0 = pRadAccessData->xStartCoordPend + 0.5*nx*xStepCoord;
+	double z0 = pRadAccessData->zStartCoordPend + 0.5*nz*zStepCoord;
+	char NeedsShiftX = (::fabs(x0) > RelShiftTol*nx*xStepCoord);
+	char NeedsShiftZ = (::fabs(z0) > RelShiftTol*nz*zStepCoord);
+	if((!NeedsShiftX) && (!NeedsShiftZ)) return 0;
+
+	float *arMult = new float[(nx + nz) << 1];
+	if(arMult == 0) return MEMORY_ALLOCATION_FAILURE;
+	float *arMultX = arMult, *arMultZ = arMult + (nx << 1);
+	float *t = arMultX;
+	double q = pRadAccessData->xStart;
+	for(long ix=0; ix<nx; ix++) 
+	{
+		if(NeedsShiftX) CosAndSin(-TwoPi*x0*q, *t, *(t+1));
+		else { *t = 1.; *(t+1) = 0.;}
+		t += 2; q += pRadAccessData->xStep;
+	}
+	q = pRadAccessData->zStart;
+	for(long iz=0; iz<nz; iz++) 
+	{
+		if(NeedsShiftZ) CosAndSin(-TwoPi*z0*q, *t, *(t+1));
+		else { *t = 1.; *(t+1) = 0.;}
+		t += 2; q += pRadAccessData->zStep;
+	}
+
+	float *tEx = pRadAccessData->pBaseRadX, *tEz = pRadAccessData->pBaseRadZ;
+	float *tMultZ = arMultZ;
+	for(long iz=0; iz<nz; iz++)
+	{
+		float MultZ_Re = *(tMultZ++), MultZ_Im = *(tMultZ++);
+		float *tMultX = arMultX;
+		for(long ix=0; ix<nx; ix++)
+		{
+			float MultX_Re = *(tMultX++), MultX_Im = *(tMultX++);
+			float MultRe = MultX_Re*MultZ_Re - MultX_Im*MultZ_Im;
+			float MultIm = MultX_Re*MultZ_Im + MultX_Im*MultZ_Re;
+			for(long ie=0; ie<ne; ie++)
+			{
+				if(tEx != 0)
+				{
+					float NewRe = (*tEx)*MultRe - (*(tEx+1))*MultIm;
+					*(tEx+1) = (*tEx)*MultIm + (*(tEx+1))*MultRe; *tEx = NewRe; tEx += 2;
+				}
+				if(tEz != 0)
+				{
+					float NewRe = (*tEz)*MultRe - (*(tEz+1))*MultIm;
+					*(tEz+1) = (*tEz)*MultIm + (*(tEz+1))*MultRe; *tEz = NewRe; tEz += 2;
+				}
+			}
+		}
+	}
+	delete[] arMult;
+	return 0;
+}
+
+//*************************************************************************
+
 int srTGenOptElem::SetRadRepres1D(srTRadSect1D* pRadSect1D, char CoordOrAng)
 {// 0- to coord.; 1- to ang.
 	int result;
@@ -1274,22 +1364,26 @@ int srTGenOptElem::ComputeRadMoments(srTSRWRadStructAccessData* pSRWRadStructAcc
 	bool IsCoordRepres = (pSRWRadStructAccessData->Pres == 0);
 	bool IsFreqRepres = (pSRWRadStructAccessData->PresT == 0);
 
-	char WaveFrontTermWasTreated = 0;
-	if(IsFreqRepres && IsCoordRepres && WaveFrontTermCanBeTreated(*pSRWRadStructAccessData))
-	{
-		TreatStronglyOscillatingTerm(*pSRWRadStructAccessData, 'r');
-		WaveFrontTermWasTreated = 1;
-	}
+	//The quadratic phase term is removed "on the fly" (vs rows of the mesh), without modifying the wavefront
+	char WaveFrontTermIsTreated = 0;
+	if(IsFreqRepres && IsCoordRepres && WaveFrontTermCanBeTreated(*pSRWRadStructAccessData)) WaveFrontTermIsTreated = 1;
 
-	double SumsX[22], SumsZ[22], ff[22];
+	//The moments are not recomputed if neither the field (see srTSRWRadStructAccessData::NoteFieldModif) nor the mesh nor the moments were changed since the last computation
+	unsigned long long HashPar = FindHashOfRadParForMoments(pSRWRadStructAccessData);
+	unsigned long long HashMom = FindHashOfRadMoments(pSRWRadStructAccessData);
+	if(pSRWRadStructAccessData->MomWereCalcNum && (pSRWRadStructAccessData->FldModifCount == pSRWRadStructAccessData->MomFldModifCount) && 
+	   (HashPar == pSRWRadStructAccessData->MomHashPar) && (HashMom == pSRWRadStructAccessData->MomHashMom)) return 0;
+
+	double SumsZ[22];
 
 	float *fpX0 = pSRWRadStructAccessData->pBaseRadX;
 	float *fpZ0 = pSRWRadStructAccessData->pBaseRadZ;
 	bool ExIsOK = fpX0 != 0; //13112011
 	bool EzIsOK = fpZ0 != 0;
 
+	long nx = pSRWRadStructAccessData->nx, nz = pSRWRadStructAccessData->nz;
 	long PerX = pSRWRadStructAccessData->ne << 1;
-	long PerZ = PerX*pSRWRadStructAccessData->nx;
+	long PerZ = PerX*nx;
 
 	int nx_mi_1 = pSRWRadStructAccessData->nx - 1;
 	int nz_mi_1 = pSRWRadStructAccessData->nz - 1;
@@ -1309,12 +1403,24 @@ int srTGenOptElem::ComputeRadMoments(srTSRWRadStructAccessData* pSRWRadStructAcc
 	char ActualScanZ = (pSRWRadStructAccessData->nz > 1);
 	char ActualScansXZ = (ActualScanX && ActualScanZ);
 
+	//Sums vs x for each row, and phase factors removing the quadratic term (as in TreatStronglyOscillatingTerm)
+	double *arSumsRow = new double[22*nz];
+	if(arSumsRow == 0) return MEMORY_ALLOCATION_FAILURE;
+	double *arPhFactX = 0, *arPhFactZ = 0;
+	if(WaveFrontTermIsTreated)
+	{
+		arPhFactX = new double[(nx + nz) << 1];
+		if(arPhFactX == 0) { delete[] arSumsRow; return MEMORY_ALLOCATION_FAILURE;}
+		arPhFactZ = arPhFactX + (nx << 1);
+	}
+
 	for(int ie=0; ie<pSRWRadStructAccessData->ne; ie++)
 	{
 		if(!IsFreqRepres)
 		{
 			ePh = pSRWRadStructAccessData->avgPhotEn; //?? OC041108
 		}
+		if(result = srYield.Check()) break;
 
 		long Two_ie = ie << 1;
 		for(int k=0; k<22; k++) SumsZ[k] = 0.;
@@ -1326,8 +1432,6 @@ int srTGenOptElem::ComputeRadMoments(srTSRWRadStructAccessData* pSRWRadStructAcc
 		double Lamb_m = Lamb_d_FourPi*FourPi;
 
 		double FourPi_d_Lamb = 1./Lamb_d_FourPi;
-		//double FourPi_d_Lamb_d_Rx = FourPi_d_Lamb/pSRWRadStructAccessData->RobsX;
-		//double FourPi_d_Lamb_d_Rz = FourPi_d_Lamb/pSRWRadStructAccessData->RobsZ;
 
 		double LocRobsX = pSRWRadStructAccessData->RobsX; //OC030409
 		if(LocRobsX == 0.) LocRobsX = 100.*Lamb_m;
@@ -1349,193 +1453,112 @@ int srTGenOptElem::ComputeRadMoments(srTSRWRadStructAccessData* pSRWRadStructAcc
 
 		AuxMatStat.FindIntensityLimitsInds(hRad, ie, RelPowForLimits, IndLims);
 
-		//AuxMatStat.FindIntensityLimitsInds(*pSRWRadStructAccessData, ie, RelPowForLimits, IndLims);
-		//not good for computing precisely intensity
-		//make decision
-		for(int iz=0; iz<pSRWRadStructAccessData->nz; iz++)
-		//for(int iz=IndLims[2]; iz<=IndLims[3]; iz++)
-		{
-			if(result = srYield.Check()) return result;
+		if(WaveFrontTermIsTreated) SetupPhaseFactToRemoveQuadTerm(*pSRWRadStructAccessData, ePh, arPhFactX, arPhFactZ);
 
-			bool vertCoordInsidePowLim = ((iz >= IndLims[2]) && (iz <= IndLims[3]));
-
-			for(int k=0; k<22; k++) SumsX[k] = 0.;
-
-			long izPerZ = iz*PerZ;
-			float *fpX_StartForX = fpX0 + izPerZ;
-			float *fpZ_StartForX = fpZ0 + izPerZ;
-
-			double z = pSRWRadStructAccessData->zStart + iz*pSRWRadStructAccessData->zStep;
-
-			for(int ix=0; ix<pSRWRadStructAccessData->nx; ix++)
-			//for(int ix=IndLims[0]; ix<=IndLims[1]; ix++)
+		bool MemAllocFailed = false;
+#ifdef _OPENMP
+		#pragma omp parallel
+#endif
+		{
+			//Current and previous rows of the field (after removing the quadratic phase term): ExRe, ExIm, EzRe, EzIm for each x
+			double *arRowBuf = new(nothrow) double[nx << 3]; //exceptions must not leave the parallel region
+			if(arRowBuf == 0) MemAllocFailed = true;
+			else
 			{
-				bool horCoordInsidePowLim = ((ix >= IndLims[0]) && (ix <= IndLims[1]));
-				bool coordInsidePowLim = vertCoordInsidePowLim && horCoordInsidePowLim;
-
-				long ixPerX_p_Two_ie = ix*PerX + Two_ie;
-				float *fpX = fpX_StartForX + ixPerX_p_Two_ie;
-				float *fpZ = fpZ_StartForX + ixPerX_p_Two_ie;
-
-				double ExRe = 0., ExIm = 0., EzRe = 0., EzIm = 0.;
-				if(ExIsOK)
-				{
-					ExRe = *fpX;
-					ExIm = *(fpX+1);
-				}
-				if(EzIsOK)
-				{
-					EzRe = *fpZ;
-					EzIm = *(fpZ+1);
-				}
-
-				double x = pSRWRadStructAccessData->xStart + ix*pSRWRadStructAccessData->xStep;
-				ff[0] = ExRe*ExRe + ExIm*ExIm; // NormX
-				ff[11] = EzRe*EzRe + EzIm*EzIm; // NormZ
-
-				ff[1] = x*ff[0]; // <x>
-				ff[3] = z*ff[0]; // <z>
-				ff[12] = x*ff[11]; // <x>
-				ff[14] = z*ff[11]; // <z>
-
-				if(coordInsidePowLim) //OC13112010
-				{
-					ff[5] = x*ff[1]; // <xx>
-					ff[8] = z*ff[3]; // <zz>
-					ff[16] = x*ff[12]; // <xx>
-					ff[19] = z*ff[14]; // <zz>
-				}
-				else
-				{
-					ff[5] = 0.; // <xx>
-					ff[8] = 0.; // <zz>
-					ff[16] = 0.; // <xx>
-					ff[19] = 0.; // <zz>
-				}
-
-				if(IsCoordRepres && (ix > 0))
-				{
-					float *fpX_Prev = fpX - PerX;
-					float *fpZ_Prev = fpZ - PerX;
-
-					double ExReM = 0., ExImM = 0., EzReM = 0., EzImM = 0.;
-					if(ExIsOK)
-					{
-						ExReM = *fpX_Prev; ExImM = *(fpX_Prev+1);
-					}
-					if(EzIsOK)
-					{
-						EzReM = *fpZ_Prev; EzImM = *(fpZ_Prev+1);
-					}
-
-					double ExReP_mi_ExReM = ExRe - ExReM;
-					double ExImP_mi_ExImM = ExIm - ExImM;
-					double EzReP_mi_EzReM = EzRe - EzReM;
-					double EzImP_mi_EzImM = EzIm - EzImM;
-
-					double ExImP_mi_ExImM_ExRe_mi_ExReP_mi_ExReM_ExIm = ExImP_mi_ExImM*ExRe - ExReP_mi_ExReM*ExIm;
-					ff[2] = ExImP_mi_ExImM_ExRe_mi_ExReP_mi_ExReM_ExIm + TwoPi_d_Lamb_d_Rx_xStep*x*ff[0]; // <x'>
-
-					double EzImP_mi_EzImM_EzRe_mi_EzReP_mi_EzReM_EzIm = EzImP_mi_EzImM*EzRe - EzReP_mi_EzReM*EzIm;
-					ff[13] = EzImP_mi_EzImM_EzRe_mi_EzReP_mi_EzReM_EzIm + TwoPi_d_Lamb_d_Rx_xStep*x*ff[11]; // <x'>
-
-					if(coordInsidePowLim) //OC13112010
-					{
-						ff[6] = x*ff[2]; // <xx'>
-						ff[7] = (ExReP_mi_ExReM*ExReP_mi_ExReM + ExImP_mi_ExImM*ExImP_mi_ExImM) 
-								+ ExImP_mi_ExImM_ExRe_mi_ExReP_mi_ExReM_ExIm*TwoPi_d_Lamb_d_Rx_xStep*x
-								+ TwoPi_d_Lamb_d_Rx_xStepE2*x*x*ff[0]; // <x'x'>
-						ff[17] = x*ff[13]; // <xx'>
-						ff[18] = EzReP_mi_EzReM*EzReP_mi_EzReM + EzImP_mi_EzImM*EzImP_mi_EzImM
-								+ EzImP_mi_EzImM_EzRe_mi_EzReP_mi_EzReM_EzIm*TwoPi_d_Lamb_d_Rx_xStep*x
-								+ TwoPi_d_Lamb_d_Rx_xStepE2*x*x*ff[11]; // <x'x'>
-					}
-					else
-					{
-						ff[6] = 0.; // <xx'>
-						ff[7] = 0.; // <x'x'>
-						ff[17] = 0.; // <xx'>
-						ff[18] = 0.; // <x'x'>
-					}
-				}
-				else
-				{
-					ff[2] = 0.; // <x'>
-					ff[6] = 0.; // <xx'>
-					ff[7] = 0.; // <x'x'>
-					ff[13] = 0.; // <x'>
-					ff[17] = 0.; // <xx'>
-					ff[18] = 0.; // <x'x'>
-				}
-
-				if(IsCoordRepres && (iz > 0))
+				double *arRowCur = arRowBuf, *arRowPrev = arRowBuf + (nx << 2);
+				long izLoaded = -2;
+#ifdef _OPENMP
+				#pragma omp for schedule(static)
+#endif
+				for(long iz=0; iz<nz; iz++)
 				{
-					float *fpX_Prev = fpX - PerZ;
-					float *fpZ_Prev = fpZ - PerZ;
-
-					double ExReM = 0., ExImM = 0, EzReM = 0., EzImM = 0.;
-					if(ExIsOK)
-					{
-						ExReM = *fpX_Prev; ExImM = *(fpX_Prev+1);
-					}
-					if(EzIsOK)
+					if(izLoaded == iz - 1) { double *t = arRowPrev; arRowPrev = arRowCur; arRowCur = t;}
+					else if(iz > 0) SetupRowForRadMoments(fpX0, fpZ0, (iz - 1)*PerZ + Two_ie, PerX, nx, arPhFactX, arPhFactZ, iz - 1, arRowPrev);
+					SetupRowForRadMoments(fpX0, fpZ0, iz*PerZ + Two_ie, PerX, nx, arPhFactX, arPhFactZ, iz, arRowCur);
+					izLoaded = iz;
+
+					bool vertCoordInsidePowLim = ((iz >= IndLims[2]) && (iz <= IndLims[3]));
+					double z = pSRWRadStructAccessData->zStart + iz*pSRWRadStructAccessData->zStep;
+					double *SumsX = arSumsRow + 22*iz;
+					for(int k=0; k<22; k++) SumsX[k] = 0.;
+
+					double *tCur = arRowCur, *tPrev = arRowPrev;
+					for(long ix=0; ix<nx; ix++)
 					{
-						EzReM = *fpZ_Prev; EzImM = *(fpZ_Prev+1);
-					}
-
-					double ExReP_mi_ExReM = ExRe - ExReM;
-					double ExImP_mi_ExImM = ExIm - ExImM;
-					double EzReP_mi_EzReM = EzRe - EzReM;
-					double EzImP_mi_EzImM = EzIm - EzImM;
-
-					double ExImP_mi_ExImM_ExRe_mi_ExReP_mi_ExReM_ExIm = ExImP_mi_ExImM*ExRe - ExReP_mi_ExReM*ExIm;
-					ff[4] = ExImP_mi_ExImM_ExRe_mi_ExReP_mi_ExReM_ExIm + TwoPi_d_Lamb_d_Rz_zStep*z*ff[0]; // <z'>
+						double ExRe = *tCur, ExIm = *(tCur+1), EzRe = *(tCur+2), EzIm = *(tCur+3);
+						bool coordInsidePowLim = vertCoordInsidePowLim && (ix >= IndLims[0]) && (ix <= IndLims[1]);
+						double wx = ((ix == 0) || (ix == nx_mi_1))? 0.5 : 1.;
+
+						double x = pSRWRadStructAccessData->xStart + ix*pSRWRadStructAccessData->xStep;
+						double ff0 = wx*(ExRe*ExRe + ExIm*ExIm); // NormX
+						double ff11 = wx*(EzRe*EzRe + EzIm*EzIm); // NormZ
+						SumsX[0] += ff0; SumsX[11] += ff11;
+						SumsX[1] += x*ff0; SumsX[3] += z*ff0; // <x>, <z>
+						SumsX[12] += x*ff11; SumsX[14] += z*ff11;
+						if(coordInsidePowLim) //OC13112010
+						{
+							SumsX[5] += x*x*ff0; SumsX[8] += z*z*ff0; // <xx>, <zz>
+							SumsX[16] += x*x*ff11; SumsX[19] += z*z*ff11;
+						}
 
-					double EzImP_mi_EzImM_EzRe_mi_EzReP_mi_EzReM_EzIm = EzImP_mi_EzImM*EzRe - EzReP_mi_EzReM*EzIm;
-					ff[15] = EzImP_mi_EzImM_EzRe_mi_EzReP_mi_EzReM_EzIm + TwoPi_d_Lamb_d_Rz_zStep*z*ff[11]; // <z'>
+						if(IsCoordRepres && (ix > 0))
+						{
+							double wxp = (ix == 1)? 0.5*wx : wx;
+							double ExReP_mi_ExReM = ExRe - *(tCur-4), ExImP_mi_ExImM = ExIm - *(tCur-3);
+							double EzReP_mi_EzReM = EzRe - *(tCur-2), EzImP_mi_EzImM = EzIm - *(tCur-1);
+							double ExImP_mi_ExImM_ExRe_mi_ExReP_mi_ExReM_ExIm = ExImP_mi_ExImM*ExRe - ExReP_mi_ExReM*ExIm;
+							double EzImP_mi_EzImM_EzRe_mi_EzReP_mi_EzReM_EzIm = EzImP_mi_EzImM*EzRe - EzReP_mi_EzReM*EzIm;
+							double NormX = ExRe*ExRe + ExIm*ExIm, NormZ = EzRe*EzRe + EzIm*EzIm;
+							double ff2 = wxp*(ExImP_mi_ExImM_ExRe_mi_ExReP_mi_ExReM_ExIm + TwoPi_d_Lamb_d_Rx_xStep*x*NormX); // <x'>
+							double ff13 = wxp*(EzImP_mi_EzImM_EzRe_mi_EzReP_mi_EzReM_EzIm + TwoPi_d_Lamb_d_Rx_xStep*x*NormZ); // <x'>
+							SumsX[2] += ff2; SumsX[13] += ff13;
+							if(coordInsidePowLim) //OC13112010
+							{
+								SumsX[6] += x*ff2; // <xx'>
+								SumsX[7] += wxp*((ExReP_mi_ExReM*ExReP_mi_ExReM + ExImP_mi_ExImM*ExImP_mi_ExImM) 
+									+ ExImP_mi_ExImM_ExRe_mi_ExReP_mi_ExReM_ExIm*TwoPi_d_Lamb_d_Rx_xStep*x
+									+ TwoPi_d_Lamb_d_Rx_xStepE2*x*x*NormX); // <x'x'>
+								SumsX[17] += x*ff13; // <xx'>
+								SumsX[18] += wxp*(EzReP_mi_EzReM*EzReP_mi_EzReM + EzImP_mi_EzImM*EzImP_mi_EzImM
+									+ EzImP_mi_EzImM_EzRe_mi_EzReP_mi_EzReM_EzIm*TwoPi_d_Lamb_d_Rx_xStep*x
+									+ TwoPi_d_Lamb_d_Rx_xStepE2*x*x*NormZ); // <x'x'>
+							}
+						}
 
-					if(coordInsidePowLim) //OC13112010
-					{
-						ff[9] = z*ff[4]; // <zz'>
-						ff[10] = ExReP_mi_ExReM*ExReP_mi_ExReM + ExImP_mi_ExImM*ExImP_mi_ExImM
-								+ ExImP_mi_ExImM_ExRe_mi_ExReP_mi_ExReM_ExIm*TwoPi_d_Lamb_d_Rz_zStep*z
-								+ TwoPi_d_Lamb_d_Rz_zStepE2*z*z*ff[0]; // <z'z'>
-						ff[20] = z*ff[15]; // <zz'>
-						ff[21] = EzReP_mi_EzReM*EzReP_mi_EzReM + EzImP_mi_EzImM*EzImP_mi_EzImM
-								+ EzImP_mi_EzImM_EzRe_mi_EzReP_mi_EzReM_EzIm*TwoPi_d_Lamb_d_Rz_zStep*z
-								+ TwoPi_d_Lamb_d_Rz_zStepE2*z*z*ff[11]; // <z'z'>
-					}
-					else
-					{
-						ff[9] = 0.; // <zz'>
-						ff[10] = 0.; // <z'z'>
-						ff[20] = 0.; // <zz'>
-						ff[21] = 0.;
+						if(IsCoordRepres && (iz > 0))
+						{
+							double ExReP_mi_ExReM = ExRe - *tPrev, ExImP_mi_ExImM = ExIm - *(tPrev+1);
+							double EzReP_mi_EzReM = EzRe - *(tPrev+2), EzImP_mi_EzImM = EzIm - *(tPrev+3);
+							double ExImP_mi_ExImM_ExRe_mi_ExReP_mi_ExReM_ExIm = ExImP_mi_ExImM*ExRe - ExReP_mi_ExReM*ExIm;
+							double EzImP_mi_EzImM_EzRe_mi_EzReP_mi_EzReM_EzIm = EzImP_mi_EzImM*EzRe - EzReP_mi_EzReM*EzIm;
+							double NormX = ExRe*ExRe + ExIm*ExIm, NormZ = EzRe*EzRe + EzIm*EzIm;
+							double ff4 = wx*(ExImP_mi_ExImM_ExRe_mi_ExReP_mi_ExReM_ExIm + TwoPi_d_Lamb_d_Rz_zStep*z*NormX); // <z'>
+							double ff15 = wx*(EzImP_mi_EzImM_EzRe_mi_EzReP_mi_EzReM_EzIm + TwoPi_d_Lamb_d_Rz_zStep*z*NormZ); // <z'>
+							SumsX[4] += ff4; SumsX[15] += ff15;
+							if(coordInsidePowLim) //OC13112010
+							{
+								SumsX[9] += z*ff4; // <zz'>
+								SumsX[10] += wx*(ExReP_mi_ExReM*ExReP_mi_ExReM + ExImP_mi_ExImM*ExImP_mi_ExImM
+									+ ExImP_mi_ExImM_ExRe_mi_ExReP_mi_ExReM_ExIm*TwoPi_d_Lamb_d_Rz_zStep*z
+									+ TwoPi_d_Lamb_d_Rz_zStepE2*z*z*NormX); // <z'z'>
+								SumsX[20] += z*ff15; // <zz'>
+								SumsX[21] += wx*(EzReP_mi_EzReM*EzReP_mi_EzReM + EzImP_mi_EzImM*EzImP_mi_EzImM
+									+ EzImP_mi_EzImM_EzRe_mi_EzReP_mi_EzReM_EzIm*TwoPi_d_Lamb_d_Rz_zStep*z
+									+ TwoPi_d_Lamb_d_Rz_zStepE2*z*z*NormZ); // <z'z'>
+							}
+						}
+						tCur += 4; tPrev += 4;
 					}
 				}
-				else
-				{
-					ff[4] = 0.; // <z'>
-					ff[9] = 0.; // <zz'>
-					ff[10] = 0.; // <z'z'>
-					ff[15] = 0.; // <z'>
-					ff[20] = 0.; // <zz'>
-					ff[21] = 0.; // <z'z'>
-				}
-
-				if((ix == 0) || (ix == nx_mi_1)) for(int k=0; k<22; k++) ff[k] *= 0.5;
-				if(ix == 1)
-				{
-					ff[2] *= 0.5; // <x'>
-					ff[6] *= 0.5; // <xx'>
-					ff[7] *= 0.5; // <x'x'>
-					ff[13] *= 0.5; // <x'>
-					ff[17] *= 0.5; // <xx'>
-					ff[18] *= 0.5; // <x'x'>
-				}
-				for(int k1=0; k1<22; k1++) SumsX[k1] += ff[k1];
+				delete[] arRowBuf;
 			}
-			
+		}
+		if(MemAllocFailed) { result = MEMORY_ALLOCATION_FAILURE; break;}
+
+		//Summing-up rows in fixed order (so that the result does not depend on the number of threads)
+		for(long iz=0; iz<nz; iz++)
+		{
+			double *SumsX = arSumsRow + 22*iz;
 			if((iz == 0) || (iz == nz_mi_1)) for(int k2=0; k2<22; k2++) SumsX[k2] *= 0.5;
 			if(iz == 1)
 			{
@@ -1546,7 +1569,6 @@ int srTGenOptElem::ComputeRadMoments(srTSRWRadStructAccessData* pSRWRadStructAcc
 				SumsX[20] *= 0.5; // <zz'>
 				SumsX[21] *= 0.5; // <z'z'>
 			}
-
 			for(int kk=0; kk<22; kk++) SumsZ[kk] += SumsX[kk];
 		}
 
@@ -1680,13 +1702,123 @@ int srTGenOptElem::ComputeRadMoments(srTSRWRadStructAccessData* pSRWRadStructAcc
 		fpMomX += AmOfMom; fpMomZ += AmOfMom;
 	}
 
-	if(WaveFrontTermWasTreated) TreatStronglyOscillatingTerm(*pSRWRadStructAccessData, 'a');
+	delete[] arSumsRow;
+	if(arPhFactX != 0) delete[] arPhFactX;
+	if(result) return result;
+
 	pSRWRadStructAccessData->MomWereCalcNum = true;
+	pSRWRadStructAccessData->MomFldModifCount = pSRWRadStructAccessData->FldModifCount;
+	pSRWRadStructAccessData->MomHashPar = HashPar;
+	pSRWRadStructAccessData->MomHashMom = FindHashOfRadMoments(pSRWRadStructAccessData);
 	return 0;
 }
 
 //*************************************************************************
 
+void srTGenOptElem::SetupPhaseFactToRemoveQuadTerm(srTSRWRadStructAccessData& RadAccessData, double ePh, double* arPhFactX, double* arPhFactZ)
+{//Separable factors (Re, Im vs x and vs z) removing the quadratic phase term in Coord. repres., as TreatStronglyOscillatingTerm(RadAccessData, 'r') does
+	const double Pi = 3.14159265358979;
+	double Const = Pi*1.E+06/1.239854; // Assumes m and eV
+	double ConstRxE = -Const*ePh/RadAccessData.RobsX;
+	double ConstRzE = -Const*ePh/RadAccessData.RobsZ;
+
+	double *t = arPhFactX;
+	for(long ix=0; ix<RadAccessData.nx; ix++)
+	{
+		double x = RadAccessData.xStart + ix*RadAccessData.xStep - RadAccessData.xc;
+		float CosPh = 1., SinPh = 0.;
+		if(RadAccessData.WfrQuadTermCanBeTreatedAtResizeX) CosAndSin(ConstRxE*x*x, CosPh, SinPh);
+		*(t++) = CosPh; *(t++) = SinPh;
+	}
+	t = arPhFactZ;
+	for(long iz=0; iz<RadAccessData.nz; iz++)
+	{
+		double z = RadAccessData.zStart + iz*RadAccessData.zStep - RadAccessData.zc;
+		float CosPh = 1., SinPh = 0.;
+		if(RadAccessData.WfrQuadTermCanBeTreatedAtResizeZ) CosAndSin(ConstRzE*z*z, CosPh, SinPh);
+		*(t++) = CosPh; *(t++) = SinPh;
+	}
+}
+
+//*************************************************************************
+
+void srTGenOptElem::SetupRowForRadMoments(float* pEx0, float* pEz0, long Offset, long PerX, long nx, double* arPhFactX, double* arPhFactZ, long iz, double* arRow)
+{//Copies one row of the field (one photon energy) to arRow (ExRe, ExIm, EzRe, EzIm for each x), multiplying it by the phase factors if they are defined
+	float *tEx = (pEx0 != 0)? (pEx0 + Offset) : 0;
+	float *tEz = (pEz0 != 0)? (pEz0 + Offset) : 0;
+	double *t = arRow;
+	if(arPhFactX == 0)
+	{
+		for(long ix=0; ix<nx; ix++)
+		{
+			if(tEx != 0) { *t = *tEx; *(t+1) = *(tEx+1); tEx += PerX;}
+			else { *t = 0.; *(t+1) = 0.;}
+			if(tEz != 0) { *(t+2) = *tEz; *(t+3) = *(tEz+1); tEz += PerX;}
+			else { *(t+2) = 0.; *(t+3) = 0.;}
+			t += 4;
+		}
+		return;
+	}
+
+	double FactZRe = arPhFactZ[iz << 1], FactZIm = arPhFactZ[(iz << 1) + 1];
+	double *tFactX = arPhFactX;
+	for(long ix=0; ix<nx; ix++)
+	{
+		double FactXRe = *(tFactX++), FactXIm = *(tFactX++);
+		double FactRe = FactXRe*FactZRe - FactXIm*FactZIm;
+		double FactIm = FactXRe*FactZIm + FactXIm*FactZRe;
+		if(tEx != 0) 
+		{ 
+			double ERe = *tEx, EIm = *(tEx+1);
+			*t = ERe*FactRe - EIm*FactIm; *(t+1) = ERe*FactIm + EIm*FactRe; tEx += PerX;
+		}
+		else { *t = 0.; *(t+1) = 0.;}
+		if(tEz != 0) 
+		{ 
+			double ERe = *tEz, EIm = *(tEz+1);
+			*(t+2) = ERe*FactRe - EIm*FactIm; *(t+3) = ERe*FactIm + EIm*FactRe; tEz += PerX;
+		}
+		else { *(t+2) = 0.; *(t+3) = 0.;}
+		t += 4;
+	}
+}
+
+//*************************************************************************
+
+unsigned long long srTGenOptElem::FindHashOfRadParForMoments(srTSRWRadStructAccessData* pRad)
+{//Hash (FNV-1a) of the mesh and other wavefront parameters ComputeRadMoments depends on; modifications of the field data itself are tracked by pRad->FldModifCount
+	const unsigned long long Prime = 1099511628211ULL;
+	unsigned long long h = 14695981039346656037ULL;
+
+	double arPar[] = { (double)pRad->nx, (double)pRad->nz, (double)pRad->ne, pRad->xStart, pRad->xStep, pRad->zStart, pRad->zStep, pRad->eStart, pRad->eStep, 
+		pRad->RobsX, pRad->RobsZ, pRad->RobsXAbsErr, pRad->RobsZAbsErr, pRad->xc, pRad->zc, pRad->avgPhotEn, 
+		(double)pRad->Pres, (double)pRad->PresT, (double)pRad->WfrQuadTermCanBeTreatedAtResizeX, (double)pRad->WfrQuadTermCanBeTreatedAtResizeZ};
+	const unsigned char *tPar = (const unsigned char*)arPar;
+	for(unsigned int i=0; i<sizeof(arPar); i++) h = (h ^ *(tPar++))*Prime;
+	h = (h ^ (unsigned long long)(size_t)(pRad->pBaseRadX))*Prime; //field arrays replaced
+	h = (h ^ (unsigned long long)(size_t)(pRad->pBaseRadZ))*Prime;
+	return h;
+}
+
+//*************************************************************************
+
+unsigned long long srTGenOptElem::FindHashOfRadMoments(srTSRWRadStructAccessData* pRad)
+{//Hash of the moments arrays (to detect their modification after they were computed)
+	const unsigned long long Prime = 1099511628211ULL;
+	unsigned long long h = 14695981039346656037ULL;
+	long nMom = 11*pRad->ne;
+	double* arPtrs[] = { pRad->pMomX, pRad->pMomZ };
+	for(int iPol=0; iPol<2; iPol++)
+	{
+		if(arPtrs[iPol] == 0) continue;
+		const unsigned char *t = (const unsigned char*)(arPtrs[iPol]);
+		for(long i=0; i<nMom*(long)sizeof(double); i++) h = (h ^ *(t++))*Prime;
+	}
+	return h;
+}
+
+//*************************************************************************
+
 //int srTGenOptElem::GenAuxPropagateRadMoments(srTSRWRadStructAccessData* pRadAccessData, float** ax, float** az, srTMomentsRatios* MomRatArray)
 int srTGenOptElem::GenAuxPropagateRadMoments(srTSRWRadStructAccessData* pRadAccessData, double** ax, double** az, srTMomentsRatios* MomRatArray) //OC130311
 {// Drift Space has its own realization of this function
@@ -1836,6 +1968,7 @@ void srTGenOptElem::FindMinMaxRatio(double* Arr1, double* Arr2, int n, double& M
 
 int srTGenOptElem::RadResizeGen(srTSRWRadStructAccessData& SRWRadStructAccessData, srTRadResize& RadResizeStruct)
 {
+	SRWRadStructAccessData.NoteFieldModif();
 	if((RadResizeStruct.pxm == 1.) && (RadResizeStruct.pxd == 1.) && (RadResizeStruct.pzm == 1.) && (RadResizeStruct.pzd == 1.)) return 0;
 	int result = 0;
 
@@ -2542,6 +2675,7 @@ int srTGenOptElem::RadResizeCore(srTSRWRadStructAccessData& OldRadAccessData, sr
 
 int srTGenOptElem::RadResizeGenE(srTSRWRadStructAccessData& SRWRadStructAccessData, srTRadResize& RadResizeStruct)
 {
+	SRWRadStructAccessData.NoteFieldModif();
 	if((RadResizeStruct.pem == 1.) && (RadResizeStruct.ped == 1.)) return 0;
 	int result = 0;
 
@@ -3834,6 +3968,7 @@ char srTGenOptElem::WaveFrontTermCanBeTreated(srTSRWRadStructAccessData& RadAcce
 
 void srTGenOptElem::TreatStronglyOscillatingTerm(srTSRWRadStructAccessData& RadAccessData, char AddOrRem, char PolComp, int ieOnly)
 {
+	RadAccessData.NoteFieldModif();
 	//Later treat X and Z coordinates separately here!!!
 
 	char TreatPolCompX = ((PolComp == 0) || (PolComp == 'x')) && (RadAccessData.pBaseRadX != 0); //OC13112011
@@ -3952,6 +4087,7 @@ void srTGenOptElem::TreatStronglyOscillatingTerm(srTSRWRadStructAccessData& RadA
 //void srTGenOptElem::TreatStronglyOscillatingTermIrregMesh(srTSRWRadStructAccessData& RadAccessData, double* arRayTrCoord, double xMin, double xMax, double zMin, double zMax, char AddOrRem, char PolComp, int ieOnly, double anamorphMagnX, double anamorphMagnZ)
 void srTGenOptElem::TreatStronglyOscillatingTermIrregMesh(srTSRWRadStructAccessData& RadAccessData, double* arRayTrCoord, double xMin, double xMax, double zMin, double zMax, char AddOrRem, char PolComp, int ieOnly)
 {
+	RadAccessData.NoteFieldModif();
 	//Later treat X and Z coordinates separately here!!!
 
 	char TreatPolCompX = ((PolComp == 0) || (PolComp == 'x')) && (RadAccessData.pBaseRadX != 0); //OC13112011
@@ -39,7 +39,7 @@
 
 //*************************************************************************
 
-extern srTIntVect gVectWarnNos;
+extern thread_local srTIntVect gVectWarnNos;
 
 class srTGenOptElem;
 //struct srTParPrecWfrPropag;
@@ -112,6 +112,9 @@ public:
 	virtual int PropagateRadiationSingleE_Meth_0(srTSRWRadStructAccessData* pRadAccessData, srTSRWRadStructAccessData* pPrevRadData) { return 0;}
 
 	virtual int RangeShouldBeAdjustedAtPropag() { return 1;}
+	virtual int WorksInAngRepres(char /*AnalTreatment*/) { return 0;} //1- element accepts wavefront in Ang. repres. and may leave it there (see srTSRWRadStructAccessData::PresAngMayBeKept)
+	virtual void UpdateMirrorSym(srTSRWRadStructAccessData* pRadAccessData) { pRadAccessData->MirrorSymX = pRadAccessData->MirrorSymZ = 0;} //called before propagation; elements keeping mirror symmetry of the field vs x = 0 and/or z = 0 override this (see srTSRWRadStructAccessData::MirrorSymX)
+	virtual void SetDataIsFixed() {} //called for elements kept between propagations (see srwlOptCompile, srTPropagMultiE): their input data is not modified during their life, so auxiliary data derived from it may be kept by the element (see srTGenTransmission)
 	virtual int ResolutionShouldBeAdjustedAtPropag() { return 1;}
 
 	virtual void RadPointModifier(srTEXZ&, srTEFieldPtrs&) {}
@@ -223,6 +226,7 @@ public:
 	int RemoveSliceConstE_FromGenRadStruct(srTSRWRadStructAccessData*, long);
 
 	int SetRadRepres(srTSRWRadStructAccessData*, char);
+	int TreatCoordStartPendInAngRepres(srTSRWRadStructAccessData*);
 	int SetRadRepres1D(srTRadSect1D*, char);
 
 	int SetupWfrEdgeCorrData(srTSRWRadStructAccessData*, float*, float*, srTDataPtrsForWfrEdgeCorr&);
@@ -233,6 +237,10 @@ public:
 	void MakeWfrEdgeCorrection1D(srTRadSect1D*, float*, float*, srTDataPtrsForWfrEdgeCorr1D&);
 
 	int ComputeRadMoments(srTSRWRadStructAccessData*);
+	void SetupPhaseFactToRemoveQuadTerm(srTSRWRadStructAccessData&, double, double*, double*);
+	void SetupRowForRadMoments(float*, float*, long, long, long, double*, double*, long, double*);
+	unsigned long long FindHashOfRadParForMoments(srTSRWRadStructAccessData*);
+	unsigned long long FindHashOfRadMoments(srTSRWRadStructAccessData*);
 
 	int RadResizeGen(srTSRWRadStructAccessData&, srTRadResize&);
 	int RadResizeGenE(srTSRWRadStructAccessData&, srTRadResize&);
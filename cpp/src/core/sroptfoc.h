@@ -147,6 +147,12 @@ public:
 	}
 	srTThinLens() {}
 
+	void UpdateMirrorSym(srTSRWRadStructAccessData* pRadAccessData)
+	{
+		if(TransvCenPoint.x != 0.) pRadAccessData->MirrorSymX = 0;
+		if(TransvCenPoint.y != 0.) pRadAccessData->MirrorSymZ = 0;
+	}
+
 	//int PropagateRadiation(srTSRWRadStructAccessData* pRadAccessData, int MethNo, srTRadResizeVect& ResBeforeAndAfterVect)
 	int PropagateRadiation(srTSRWRadStructAccessData* pRadAccessData, srTParPrecWfrPropag& ParPrecWfrPropag, srTRadResizeVect& ResBeforeAndAfterVect)
 	{
@@ -17,6 +17,9 @@
 #include "srradmnp.h"
 #include "srerror.h"
 #include "srwlib.h"
+#include "srmlttsk.h"
+
+extern srTYield srYield;
 
 //*************************************************************************
 
@@ -24,6 +27,7 @@ srTGenTransmission::srTGenTransmission(srTStringVect* pElemInfo, srTDataMD* pExt
 {
 	ErrorCode = 0;
 	GenTransNumData.pData = 0;
+	m_TrMap.arTr = 0; m_DataIsFixed = 0;
 
 	char NumStructName[256];
 	strcpy(NumStructName, (*pElemInfo)[1]);
@@ -135,6 +139,7 @@ srTGenTransmission::srTGenTransmission(srTStringVect* pElemInfo, srTDataMD* pExt
 
 srTGenTransmission::srTGenTransmission(const SRWLOptT& tr)
 {
+	m_TrMap.arTr = 0; m_DataIsFixed = 0;
 	OptPathOrPhase = 1; //opt. path dif.
 	OuterTransmIs = tr.extTr + 1;
 	
@@ -1128,11 +1133,9 @@ int srTGenTransmission::DetermineFocalDistByPropag1D(srTRadSect1D& Sect1D, doubl
 
 //*************************************************************************
 
-void srTGenTransmission::RadPointModifier(srTEXZ& EXZ, srTEFieldPtrs& EPtrs)
+bool srTGenTransmission::TransmAtPoint(double xRel, double zRel, double e, double& T, double& Ph)
 {// e in eV; Length in m !!!
- // Operates on Coord. side !!!
-	//double xRel = EXZ.x - TransvCenPoint.x, zRel = EXZ.z - TransvCenPoint.y;
-	double xRel = EXZ.x, zRel = EXZ.z; //OC080311
+ // Returns amplitude transmission and phase shift; false if the point is outside the transmission mesh and the outer transmission is zero
 
 	long Ne = 1, Nemi2 = -1;
 	long iDimX = 0, iDimZ = 1;
@@ -1157,16 +1160,11 @@ void srTGenTransmission::RadPointModifier(srTEXZ& EXZ, srTEFieldPtrs& EPtrs)
 	double AbsTolX = xStep*0.001, AbsTolZ = zStep*0.001; // To steer
 	if(OuterTransmIs == 1)
 	{
-		if((xRel < xStart - AbsTolX) || (xRel > xEnd + AbsTolX) || (zRel < zStart - AbsTolZ) || (zRel > zEnd + AbsTolZ))
-		{
-			if(EPtrs.pExRe != 0) { *(EPtrs.pExRe) = 0.; *(EPtrs.pExIm) = 0.;}
-			if(EPtrs.pEzRe != 0) { *(EPtrs.pEzRe) = 0.; *(EPtrs.pEzIm) = 0.;}
-			return;
-		}
+		if((xRel < xStart - AbsTolX) || (xRel > xEnd + AbsTolX) || (zRel < zStart - AbsTolZ) || (zRel > zEnd + AbsTolZ)) return false;
 	}
 
 	double xr = 0., zr = 0.;
-	double T = 1., Ph = 0.;
+	T = 1.; Ph = 0.;
 	//char NotExactRightEdgeX = 1, NotExactRightEdgeZ = 1;
 
 	long ix = long((xRel - xStart)/xStep);
@@ -1223,11 +1221,11 @@ void srTGenTransmission::RadPointModifier(srTEXZ& EXZ, srTEFieldPtrs& EPtrs)
 		double eStart = (GenTransNumData.DimStartValues)[0];
 		double eStep = (GenTransNumData.DimSteps)[0];
 
-		long ie = long((EXZ.e - eStart)/eStep + 1.e-10);
+		long ie = long((e - eStart)/eStep + 1.e-10);
 		if(ie < 0) ie = 0;
 		else if(ie > Nemi2) ie = Nemi2;
 
-		double er = (EXZ.e - (ie*eStep + eStart))/eStep;
+		double er = (e - (ie*eStep + eStart))/eStep;
 		//double erxr = er*xr, erzr = er*zr;
 		//double erxrzr = erxr*zr;
 
@@ -1257,7 +1255,24 @@ void srTGenTransmission::RadPointModifier(srTEXZ& EXZ, srTEFieldPtrs& EPtrs)
 		//	+ inArFunc[7]*xt*yt*zt;
 	}
 
-	if(OptPathOrPhase == 1) Ph *= EXZ.e*5.0676816042E+06; // TwoPi_d_Lambda_m
+	if(OptPathOrPhase == 1) Ph *= e*5.0676816042E+06; // TwoPi_d_Lambda_m
+	return true;
+}
+
+//*************************************************************************
+
+void srTGenTransmission::RadPointModifier(srTEXZ& EXZ, srTEFieldPtrs& EPtrs)
+{// e in eV; Length in m !!!
+ // Operates on Coord. side !!!
+	//double xRel = EXZ.x - TransvCenPoint.x, zRel = EXZ.z - TransvCenPoint.y;
+	double T = 1., Ph = 0.;
+	if(!TransmAtPoint(EXZ.x, EXZ.z, EXZ.e, T, Ph))
+	{
+		if(EPtrs.pExRe != 0) { *(EPtrs.pExRe) = 0.; *(EPtrs.pExIm) = 0.;}
+		if(EPtrs.pEzRe != 0) { *(EPtrs.pEzRe) = 0.; *(EPtrs.pEzIm) = 0.;}
+		return;
+	}
+
 	float CosPh, SinPh; CosAndSin(Ph, CosPh, SinPh);
 	if(EPtrs.pExRe != 0)
 	{
@@ -1275,6 +1290,125 @@ void srTGenTransmission::RadPointModifier(srTEXZ& EXZ, srTEFieldPtrs& EPtrs)
 
 //*************************************************************************
 
+int srTGenTransmission::PropagateRadiationSimple(srTSRWRadStructAccessData* pRadAccessData)
+{//Applies transmission resampled on the wavefront mesh (one complex multiplication per point);
+ //the resampling (RadPointModifier-like interpolation) is done once per transmission data and wavefront mesh if the element is kept between propagations (SetDataIsFixed)
+	int result;
+	if(pRadAccessData->Pres != 0) if(result = SetRadRepres(pRadAccessData, 0)) return result;
+
+	float *arTr = 0;
+	if(result = FindOrComputeTransmOnMesh(pRadAccessData, arTr)) return result;
+
+	long nTot = (pRadAccessData->ne)*(pRadAccessData->nx)*(pRadAccessData->nz);
+	pRadAccessData->NoteFieldModif();
+	float *pEx = pRadAccessData->pBaseRadX, *pEz = pRadAccessData->pBaseRadZ;
+	float *tTr = arTr;
+	for(long i=0; i<nTot; i++)
+	{
+		double TrRe = *tTr, TrIm = *(tTr + 1);
+		if(pEx != 0)
+		{
+			double ExRe = *pEx, ExIm = *(pEx + 1);
+			*(pEx++) = (float)(TrRe*ExRe - TrIm*ExIm);
+			*(pEx++) = (float)(TrIm*ExRe + TrRe*ExIm);
+		}
+		if(pEz != 0)
+		{
+			double EzRe = *pEz, EzIm = *(pEz + 1);
+			*(pEz++) = (float)(TrRe*EzRe - TrIm*EzIm);
+			*(pEz++) = (float)(TrIm*EzRe + TrRe*EzIm);
+		}
+		tTr += 2;
+	}
+	if(!m_DataIsFixed) InvalidateTransmMap(); //the element isn't reused, so the map would only add to the peak memory
+	return 0;
+}
+
+//*************************************************************************
+
+void srTGenTransmission::SetupTransmMapKey(srTSRWRadStructAccessData* pRadAccessData, srTGenTransmMapKey& Key)
+{
+	Key.pTrData = GenTransNumData.pData;
+	Key.OptPathOrPhase = OptPathOrPhase;
+	Key.OuterTransmIs = OuterTransmIs;
+
+	for(int i=0; i<3; i++)
+	{
+		if(i < GenTransNumData.AmOfDims)
+		{
+			Key.TrDimSizes[i] = (GenTransNumData.DimSizes)[i];
+			Key.TrDimStartValues[i] = (GenTransNumData.DimStartValues)[i];
+			Key.TrDimSteps[i] = (GenTransNumData.DimSteps)[i];
+		}
+		else
+		{
+			Key.TrDimSizes[i] = 1; Key.TrDimStartValues[i] = 0.; Key.TrDimSteps[i] = 0.;
+		}
+	}
+
+	Key.ne = pRadAccessData->ne; Key.nx = pRadAccessData->nx; Key.nz = pRadAccessData->nz;
+	Key.eStart = pRadAccessData->eStart; Key.eStep = pRadAccessData->eStep;
+	Key.xStart = pRadAccessData->xStart; Key.xStep = pRadAccessData->xStep;
+	Key.zStart = pRadAccessData->zStart; Key.zStep = pRadAccessData->zStep;
+}
+
+//*************************************************************************
+
+int srTGenTransmission::FindOrComputeTransmOnMesh(srTSRWRadStructAccessData* pRadAccessData, float*& arTr)
+{//The map kept from the previous call (see SetDataIsFixed) is recomputed only if the wavefront mesh changes
+	srTGenTransmMapKey Key;
+	SetupTransmMapKey(pRadAccessData, Key);
+	if((m_TrMap.arTr != 0) && m_TrMap.Key.IsSameAs(Key)) { arTr = m_TrMap.arTr; return 0;}
+
+	InvalidateTransmMap();
+	int result = 0;
+	float *arNewTr = 0;
+	if(result = ComputeTransmOnMesh(pRadAccessData, arNewTr)) return result;
+	m_TrMap.Key = Key;
+	m_TrMap.arTr = arTr = arNewTr;
+	return 0;
+}
+
+//*************************************************************************
+
+int srTGenTransmission::ComputeTransmOnMesh(srTSRWRadStructAccessData* pRadAccessData, float*& arTr)
+{//Allocates and fills T*exp(i*Ph) on the wavefront mesh
+	long nTot = (pRadAccessData->ne)*(pRadAccessData->nx)*(pRadAccessData->nz);
+	float *arNewTr = new float[nTot << 1];
+	if(arNewTr == 0) return MEMORY_ALLOCATION_FAILURE;
+
+	int result = 0;
+	float *tTr = arNewTr;
+	double z = pRadAccessData->zStart;
+	for(long iz=0; iz<pRadAccessData->nz; iz++)
+	{
+		if(result = srYield.Check()) { delete[] arNewTr; return result;}
+
+		double x = pRadAccessData->xStart;
+		for(long ix=0; ix<pRadAccessData->nx; ix++)
+		{
+			double e = pRadAccessData->eStart;
+			for(long ie=0; ie<pRadAccessData->ne; ie++)
+			{
+				double T = 1., Ph = 0.;
+				if(TransmAtPoint(x, z, e, T, Ph))
+				{
+					float CosPh, SinPh; CosAndSin(Ph, CosPh, SinPh);
+					*(tTr++) = (float)(T*CosPh); *(tTr++) = (float)(T*SinPh);
+				}
+				else { *(tTr++) = 0.; *(tTr++) = 0.;}
+				e += pRadAccessData->eStep;
+			}
+			x += pRadAccessData->xStep;
+		}
+		z += pRadAccessData->zStep;
+	}
+	arTr = arNewTr;
+	return 0;
+}
+
+//*************************************************************************
+
 void srTGenTransmission::RadPointModifier1D(srTEXZ& EXZ, srTEFieldPtrs& EPtrs)
 {// e in eV; Length in m !!!
  // Operates on Coord. side !!!
@@ -21,6 +21,35 @@ typedef struct SRWLStructOpticsTransmission SRWLOptT;
 
 //*************************************************************************
 
+struct srTGenTransmMapKey {
+//Identifies complex transmission resampled on a wavefront mesh:
+//transmission data (address and mesh) and the wavefront mesh
+	char *pTrData;
+	long TrDimSizes[3];
+	double TrDimStartValues[3], TrDimSteps[3];
+	char OptPathOrPhase, OuterTransmIs;
+
+	long ne, nx, nz;
+	double eStart, eStep, xStart, xStep, zStart, zStep;
+
+	bool IsSameAs(const srTGenTransmMapKey& k) const
+	{
+		if((pTrData != k.pTrData) || (OptPathOrPhase != k.OptPathOrPhase) || (OuterTransmIs != k.OuterTransmIs)) return false;
+		for(int i=0; i<3; i++)
+		{
+			if((TrDimSizes[i] != k.TrDimSizes[i]) || (TrDimStartValues[i] != k.TrDimStartValues[i]) || (TrDimSteps[i] != k.TrDimSteps[i])) return false;
+		}
+		return (ne == k.ne) && (nx == k.nx) && (nz == k.nz) && (eStart == k.eStart) && (eStep == k.eStep) && (xStart == k.xStart) && (xStep == k.xStep) && (zStart == k.zStart) && (zStep == k.zStep);
+	}
+};
+
+struct srTGenTransmMap {
+	srTGenTransmMapKey Key;
+	float *arTr; //T*exp(i*Ph) (Re and Im) on the wavefront mesh, with the same strides as the electric field
+};
+
+//*************************************************************************
+
 class srTGenTransmission : public srTFocusingElem {
 
 	//srTWaveAccessData GenTransNumData;
@@ -31,12 +60,23 @@ class srTGenTransmission : public srTFocusingElem {
 	double eMid;
 	double DxContin, DzContin; // Minimal intervals between discontinuties
 
+	//Transmission resampled on the last wavefront mesh; kept by the object only after SetDataIsFixed (compiled container, see srwlOptCompile,
+	//or multi-electron propagation), as long as the mesh does not change; otherwise it is released after being applied
+	srTGenTransmMap m_TrMap;
+	char m_DataIsFixed;
+
+	void SetupTransmMapKey(srTSRWRadStructAccessData* pRadAccessData, srTGenTransmMapKey& Key);
+	int FindOrComputeTransmOnMesh(srTSRWRadStructAccessData* pRadAccessData, float*& arTr);
+	int ComputeTransmOnMesh(srTSRWRadStructAccessData* pRadAccessData, float*& arTr);
+	bool TransmAtPoint(double xRel, double zRel, double e, double& T, double& Ph);
+
 public:
 
 	srTGenTransmission(srTStringVect* pElemInfo, srTDataMD* pExtraData);
 	srTGenTransmission(const SRWLOptT& tr);
 	~srTGenTransmission()
 	{
+		InvalidateTransmMap();
 		if(GenTransNumData.pData != 0)
 		{
 			//srTSend Send; Send.FinishWorkingWithWave(&GenTransNumData);
@@ -44,6 +84,11 @@ public:
 		}
 	}
 
+	void InvalidateTransmMap()
+	{
+		if(m_TrMap.arTr != 0) { delete[] m_TrMap.arTr; m_TrMap.arTr = 0;}
+	}
+	void SetDataIsFixed() { m_DataIsFixed = 1;}
 	void EnsureTransmissionForField();
 	double DetermineAppropriatePhotEnergyForFocDistTest(double Rx, double Rz);
 	int EstimateFocalDistancesAndCheckSampling();
@@ -106,12 +151,7 @@ public:
 		return 0;
 	}
 
-	int PropagateRadiationSimple(srTSRWRadStructAccessData* pRadAccessData)
-	{
-		int result;
-		if(pRadAccessData->Pres != 0) if(result = SetRadRepres(pRadAccessData, 0)) return result;
-		return TraverseRadZXE(pRadAccessData);
-	}
+	int PropagateRadiationSimple(srTSRWRadStructAccessData* pRadAccessData);
   	int PropagateRadiationSimple1D(srTRadSect1D* pSect1D)
 	{
 		int result;
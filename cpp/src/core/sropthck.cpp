@@ -15,6 +15,7 @@
 #include "sropthck.h"
 #include "sroptdrf.h"
 #include "gminterp.h"
+#include "srprgind.h"
 
 //*************************************************************************
 
@@ -556,6 +557,7 @@ int srTMirror::WfrInterpolOnOrigGrid(srTSRWRadStructAccessData* pWfr, double* ar
 		waveFrontTermWasTreated = true;
 	}
 
+	pWfr->NoteFieldModif();
 	float *t_ExRes = pWfr->pBaseRadX;
 	float *t_EzRes = pWfr->pBaseRadZ;
 
@@ -587,6 +589,52 @@ int srTMirror::WfrInterpolOnOrigGrid(srTSRWRadStructAccessData* pWfr, double* ar
 	const double dMax = 1.E+20;
 	double dx, dz, dTest, dTest0, dTestPrev;
 
+	//Spatial index of the irregular (ray-traced) mesh: the rectangle [xMin, xMax]x[zMin, zMax] is split into buckets of ~2x2 cells of the regular mesh,
+	//and for each bucket (and photon energy) the irregular mesh point closest to the bucket center is stored.
+	//This point is used as a starting point of the local search below, if the point found for the previous target point is farther than ~2 buckets from the target
+	//(this avoids long searches vs ix, iz when the previous search was unsuccessful, or when the irregular mesh is inverted / strongly distorted).
+	long nxBuck = (pWfr->nx >> 1) + 1, nzBuck = (pWfr->nz >> 1) + 1;
+	long nBuckPerE = nxBuck*nzBuck;
+	double xStepBuck = (xMax - xMin)/nxBuck, zStepBuck = (zMax - zMin)/nzBuck;
+	if((xStepBuck <= 0.) || (zStepBuck <= 0.)) nBuckPerE = 0;
+	double dE2MaxWarmStart = 4.*(xStepBuck*xStepBuck + zStepBuck*zStepBuck);
+	long *arBuckInd = 0;
+	if(nBuckPerE > 0)
+	{
+		long nBuckTot = nBuckPerE*pWfr->ne;
+		arBuckInd = new long[nBuckTot];
+		if(arBuckInd == 0) return NOT_ENOUGH_MEMORY_FOR_SR_COMP;
+		for(long i=0; i<nBuckTot; i++) arBuckInd[i] = -1;
+
+		for(long iz=0; iz<pWfr->nz; iz++)
+		{
+			for(long ix=0; ix<pWfr->nx; ix++)
+			{
+				long ofstXZ = iz*PerZ + ix*PerX;
+				for(long ie=0; ie<pWfr->ne; ie++)
+				{
+					double xr = arRayTrCoord[ofstXZ + 2*ie], zr = arRayTrCoord[ofstXZ + 2*ie + 1];
+					if((xr < xMin) || (xr > xMax) || (zr < zMin) || (zr > zMax)) continue;
+
+					long ixb = (long)((xr - xMin)/xStepBuck), izb = (long)((zr - zMin)/zStepBuck);
+					if(ixb >= nxBuck) ixb = nxBuck - 1;
+					if(izb >= nzBuck) izb = nzBuck - 1;
+					long *pBuck = arBuckInd + (ie*nBuckPerE + izb*nxBuck + ixb);
+
+					double xcb = xMin + (ixb + 0.5)*xStepBuck, zcb = zMin + (izb + 0.5)*zStepBuck;
+					if(*pBuck >= 0)
+					{
+						long ofstPrev = (*pBuck/pWfr->nx)*PerZ + (*pBuck%pWfr->nx)*PerX + 2*ie;
+						double dxPrev = arRayTrCoord[ofstPrev] - xcb, dzPrev = arRayTrCoord[ofstPrev + 1] - zcb;
+						dx = xr - xcb; dz = zr - zcb;
+						if(dx*dx + dz*dz >= dxPrev*dxPrev + dzPrev*dzPrev) continue;
+					}
+					*pBuck = iz*pWfr->nx + ix;
+				}
+			}
+		}
+	}
+
 	for(long iz=0; iz<pWfr->nz; iz++)
 	{
 		x = pWfr->xStart;
@@ -617,6 +665,28 @@ int srTMirror::WfrInterpolOnOrigGrid(srTSRWRadStructAccessData* pWfr, double* ar
 					if(ix0 < 0) ix0 = ix;
 					if(iz0 < 0) iz0 = iz;
 
+					if(arBuckInd != 0)
+					{//choosing the starting point of the search
+						long ixb = (long)((x - xMin)/xStepBuck), izb = (long)((z - zMin)/zStepBuck);
+						if(ixb >= nxBuck) ixb = nxBuck - 1;
+						if(izb >= nzBuck) izb = nzBuck - 1;
+						long iCand = arBuckInd[ie*nBuckPerE + izb*nxBuck + ixb];
+						if(iCand >= 0)
+						{
+							long ixCand = iCand%(pWfr->nx), izCand = iCand/(pWfr->nx);
+							if((ixCand != ix0) || (izCand != iz0))
+							{
+								long ofstCand = izCand*PerZ + ixCand*PerX + two_ie;
+								dx = x - arRayTrCoord[ofstCand]; dz = z - arRayTrCoord[ofstCand + 1];
+								double dE2Cand = dx*dx + dz*dz;
+								long ofstCur = iz0*PerZ + ix0*PerX + two_ie;
+								dx = x - arRayTrCoord[ofstCur]; dz = z - arRayTrCoord[ofstCur + 1];
+								double dE2Cur = dx*dx + dz*dz;
+								if((dE2Cur > dE2MaxWarmStart) && (dE2Cand < dE2Cur)) { ix0 = ixCand; iz0 = izCand;}
+							}
+						}
+					}
+
 					bool pointFound = false, candPointFound = false;
 					//bool isLeftBordX = false, isRightBordX = false;
 					//bool isLeftBordZ = false, isRightBordZ = false;
@@ -1140,6 +1210,8 @@ int srTMirror::WfrInterpolOnOrigGrid(srTSRWRadStructAccessData* pWfr, double* ar
 		z += pWfr->zStep;
 	}
 
+	if(arBuckInd != 0) delete[] arBuckInd;
+
 	if(waveFrontTermWasTreated) TreatStronglyOscillatingTerm(*pWfr, 'a');
 	return 0;
 }
@@ -1291,15 +1363,9 @@ int srTMirror::PropagateRadiationSimple_LocRayTracing(srTSRWRadStructAccessData*
 	//	ampFactE2 *= RzInWfr*RzOutCor/(RzInCor*RzOutWfr);
 	//	ampFact = sqrt(fabs(ampFactE2));
 	//}
-	double ampFact, ampFactE2, RxInCor, RzInCor, RxOutCor, RzOutCor;
 
 	gmTrans *pTrans = TransHndl.rep;
 
-	TVector3d rayLocFr[2]; //ray[2], , RayOut[2], arIntersectP[3];
-	TVector3d &rayLocFrP = rayLocFr[0], &rayLocFrV = rayLocFr[1];
-	TVector3d vIntersPtLocFr, vSurfNormLocFr;
-	TVector3d vAuxIntersectP, vAuxOptPath, vRayIn, vSig, vPi, vTrAux;
-
 	TVector3d planeBeforeLocFr[2]; // vAuxIntersectP, vAuxDif;
 	TVector3d &planeBeforeLocFrP = planeBeforeLocFr[0], &planeBeforeLocFrV = planeBeforeLocFr[1];
 	
@@ -1331,9 +1397,10 @@ int srTMirror::PropagateRadiationSimple_LocRayTracing(srTSRWRadStructAccessData*
 	planeCenOutLocFrP = planeAfterLocFrP;
 	planeAfterLocFrP += m_extAlongOptAxOut*m_vOutLoc;
 
+	pRadAccessData->NoteFieldModif();
 	float *pEX0 = pRadAccessData->pBaseRadX;
 	float *pEZ0 = pRadAccessData->pBaseRadZ;
-	double ePh = pRadAccessData->eStart, x, y;
+	double ePh = pRadAccessData->eStart;
 
 	long PerX = pRadAccessData->ne << 1;
 	long PerY = PerX*pRadAccessData->nx;
@@ -1359,28 +1426,45 @@ int srTMirror::PropagateRadiationSimple_LocRayTracing(srTSRWRadStructAccessData*
 	double xRelOutMin = 1.E+23, xRelOutMax = -1.E+23;
 	double yRelOutMin = 1.E+23, yRelOutMax = -1.E+23;
 
-	long ixMin = pRadAccessData->nx - 1, ixMax = 0;
-	long iyMin = pRadAccessData->nz - 1, iyMax = 0;
-	//float cosPh, sinPh;
-	double cosPh, sinPh;
-	double EsigRe, EsigIm, EpiRe, EpiIm;
-	double grMult;
-
 	//OCTEST
 	//double auxPathAfter;
 	//END OCTEST
 
+	long nx = pRadAccessData->nx, nz = pRadAccessData->nz;
+	double xStart = pRadAccessData->xStart, xStep = pRadAccessData->xStep;
+	double zStart = pRadAccessData->zStart, zStep = pRadAccessData->zStep;
+
+	srTCompJob *pJob = gpCompJob; //to check for cancellation in the worker threads too
+	bool CompIsAborted = false;
+
 	for(long ie=0; ie<pRadAccessData->ne; ie++)
 	{
 		double TwoPi_d_LambdaM = ePh*5.067730652e+06;
 		long Two_ie = ie << 1;
 
+		double grMult = 0.;
 		if(m_isGrating) grMult = m_grM/(806554.3835*ePh);
-	
-		y = pRadAccessData->zStart;
 
-		for(long iy=0; iy<pRadAccessData->nz; iy++)
+		//The rays are independent of each other: all the per-ray variables are local to the loop body,
+		//so the rows (vs vertical position) can be traced by different threads (if compiled with OpenMP).
+		//Extents of the output irregular mesh are accumulated per thread and merged at the end.
+#ifdef _OPENMP
+		#pragma omp parallel
+#endif
+		{
+		srTCompJobOfThread compJobOfThread(pJob);
+		double xRelOutMinLoc = 1.E+23, xRelOutMaxLoc = -1.E+23;
+		double yRelOutMinLoc = 1.E+23, yRelOutMaxLoc = -1.E+23;
+
+#ifdef _OPENMP
+		#pragma omp for schedule(dynamic)
+#endif
+		for(long iy=0; iy<nz; iy++)
 		{
+			if(CompIsAborted) continue;
+			if(CompJobCancelIsRequested()) { CompIsAborted = true; continue;}
+
+			double y = zStart + iy*zStep;
 			long iyPerY = iy*PerY;
 			float *pEX_StartForX = pEX0 + iyPerY;
 			float *pEZ_StartForX = pEZ0 + iyPerY;
@@ -1391,8 +1475,8 @@ int srTMirror::PropagateRadiationSimple_LocRayTracing(srTSRWRadStructAccessData*
 			//float *pAuxRayTrCoord = arAuxRayTrCoord + iyPerY;
 			double *pAuxRayTrCoord = arAuxRayTrCoord + iyPerY;
 
-			x = pRadAccessData->xStart;
-			for(long ix=0; ix<pRadAccessData->nx; ix++)
+			double x = xStart;
+			for(long ix=0; ix<nx; ix++)
 			{
 				long ixPerX_p_Two_ie = ix*PerX + Two_ie;
 				float *pExRe = pEX_StartForX + ixPerX_p_Two_ie;
@@ -1435,6 +1519,10 @@ int srTMirror::PropagateRadiationSimple_LocRayTracing(srTSRWRadStructAccessData*
 						//tgAngX = 0.; tgAngY = 0.;
 						//end OCtest
 
+					TVector3d rayLocFr[2];
+					TVector3d &rayLocFrP = rayLocFr[0], &rayLocFrV = rayLocFr[1];
+					TVector3d vIntersPtLocFr, vSurfNormLocFr;
+
 					rayLocFrV.x = tgAngX;
 					rayLocFrV.y = tgAngY;
 					rayLocFrV.z = sqrt(1. - rayLocFrV.x*rayLocFrV.x - rayLocFrV.y*rayLocFrV.y);
@@ -1450,7 +1538,7 @@ int srTMirror::PropagateRadiationSimple_LocRayTracing(srTSRWRadStructAccessData*
 						rayLocFrP = pTrans->TrPoint_inv(rayLocFrP);
 						rayLocFrV = pTrans->TrBiPoint_inv(rayLocFrV);
 					}
-					vRayIn = rayLocFrV;
+					TVector3d vRayIn = rayLocFrV;
 
 					//if((m_treatIn == 1) && (m_extAlongOptAxIn != 0.)) //check sign?
 					//{//propagate back to a plane before optical element, using geometrical ray-tracing
@@ -1467,7 +1555,7 @@ int srTMirror::PropagateRadiationSimple_LocRayTracing(srTSRWRadStructAccessData*
 							//FindRayIntersectWithSurfInLocFrame(rayLocFrP, rayLocFrV, vIntersPtLocFr, &vSurfNormLocFr);
 							//intersectHappened = true;
 
-							vAuxOptPath = vIntersPtLocFr - rayLocFrP;
+							TVector3d vAuxOptPath = vIntersPtLocFr - rayLocFrP;
 							//double optPath = vAuxOptPath.Abs();
 
 							double optPath = vAuxOptPath*rayLocFrV;
@@ -1476,7 +1564,7 @@ int srTMirror::PropagateRadiationSimple_LocRayTracing(srTSRWRadStructAccessData*
 							//Finding the Ray after the reflection (in local frame):
 							rayLocFrP = vIntersPtLocFr;
 							
-							ampFact = 1.; //OC100314
+							double ampFact = 1.; //OC100314
 							double phShiftGr = 0.;
 							if(m_isGrating)
 							{
@@ -1510,6 +1598,7 @@ int srTMirror::PropagateRadiationSimple_LocRayTracing(srTSRWRadStructAccessData*
 								rayLocFrV.Normalize();
 							}
 
+							TVector3d vAuxIntersectP;
 							if((m_treatInOut == 0) || (m_treatInOut == 2))
 							{
 								FindLineIntersectWithPlane(planeAfterLocFr, rayLocFr, vAuxIntersectP);
@@ -1539,20 +1628,20 @@ int srTMirror::PropagateRadiationSimple_LocRayTracing(srTSRWRadStructAccessData*
 							//double RzOutCor = (RzOutWfr > 0)? (RzOutWfr + optPathAfter) : (RzOutWfr - optPathAfter);
 
 							//ampFact = 1.; //OC100314
-							RxInCor = RxInWfr + optPathBefore; //to check signs
-							RzInCor = RzInWfr + optPathBefore;
-							RxOutCor = RxOutWfr - optPathAfter;
-							RzOutCor = RzOutWfr - optPathAfter;
+							double RxInCor = RxInWfr + optPathBefore; //to check signs
+							double RzInCor = RzInWfr + optPathBefore;
+							double RxOutCor = RxOutWfr - optPathAfter;
+							double RzOutCor = RzOutWfr - optPathAfter;
 							if((RxInCor != 0.) && (RzInCor != 0.) && (RxOutWfr != 0.) && (RzOutCor != 0.))
 							{
-								ampFactE2 = RxInWfr*RxOutCor/(RxInCor*RxOutWfr);
+								double ampFactE2 = RxInWfr*RxOutCor/(RxInCor*RxOutWfr);
 								ampFactE2 *= RzInWfr*RzOutCor/(RzInCor*RzOutWfr);
 								//ampFact = sqrt(fabs(ampFactE2));
 								ampFact *= sqrt(fabs(ampFactE2)); //OC100314
 							}
 
 							//Calculating transverse coordinates of intersection point of the ray with the output plane (or central plane) in the frame of the output beam
-							vTrAux = vAuxIntersectP - planeCenOutLocFrP;
+							TVector3d vTrAux = vAuxIntersectP - planeCenOutLocFrP;
 							if(pTrans != 0)
 							{//from local frame to input beam frame
 								vTrAux = pTrans->TrBiPoint(vTrAux);
@@ -1566,22 +1655,10 @@ int srTMirror::PropagateRadiationSimple_LocRayTracing(srTSRWRadStructAccessData*
 							*pAuxRayTrCoordX = xRelOut;
 							*pAuxRayTrCoordY = yRelOut;
 
-							if(xRelOutMin > xRelOut) 
-							{
-								xRelOutMin = xRelOut; ixMin = ix;
-							}
-							if(xRelOutMax < xRelOut) 
-							{
-								xRelOutMax = xRelOut; ixMax = ix;
-							}
-							if(yRelOutMin > yRelOut) 
-							{
-								yRelOutMin = yRelOut; iyMin = iy;
-							}
-							if(yRelOutMax < yRelOut) 
-							{
-								yRelOutMax = yRelOut; iyMax = iy;
-							}
+							if(xRelOutMinLoc > xRelOut) xRelOutMinLoc = xRelOut;
+							if(xRelOutMaxLoc < xRelOut) xRelOutMaxLoc = xRelOut;
+							if(yRelOutMinLoc > yRelOut) yRelOutMinLoc = yRelOut;
+							if(yRelOutMaxLoc < yRelOut) yRelOutMaxLoc = yRelOut;
 
 							//double angE2 = tgAngX*tgAngX + tgAngY*tgAngY;
 							//double angFact = 1. + angE2*(0.5 + angE2*((5./24.) + (61./720.)*angE2));
@@ -1597,7 +1674,7 @@ int srTMirror::PropagateRadiationSimple_LocRayTracing(srTSRWRadStructAccessData*
 							double phShift = TwoPi_d_LambdaM*optPath + phShiftGr;
 
 							//CosAndSin(phShift, cosPh, sinPh);
-							cosPh = cos(phShift); sinPh = sin(phShift); //OC260114
+							double cosPh = cos(phShift), sinPh = sin(phShift); //OC260114
 
 							if(m_reflData.pData == 0) //no reflectivity defined
 							//if(true) //no reflectivity defined
@@ -1644,7 +1721,7 @@ int srTMirror::PropagateRadiationSimple_LocRayTracing(srTSRWRadStructAccessData*
 							//if(m_reflData.pData != 0)
 							{//Calculate change of the electric field due to reflectivity...
 								vRayIn.Normalize();
-								vSig = (-1)*(vRayIn^vSurfNormLocFr); //sigma unit vector in Local frame; check sign
+								TVector3d vSig = (-1)*(vRayIn^vSurfNormLocFr), vPi; //sigma unit vector in Local frame; check sign
 								double grazAng = 1.5707963268;
 								if(vSig.isZero())
 								{//In the frame of incident beam
@@ -1665,7 +1742,7 @@ int srTMirror::PropagateRadiationSimple_LocRayTracing(srTSRWRadStructAccessData*
 									}
 								}
 
-								EsigRe = EsigIm = EpiRe = EpiIm = 0.;
+								double EsigRe = 0., EsigIm = 0., EpiRe = 0., EpiIm = 0.;
 								if(pEX0 != 0)
 								{
 									EsigRe = (*pExRe)*vSig.x;
@@ -1726,12 +1803,30 @@ int srTMirror::PropagateRadiationSimple_LocRayTracing(srTSRWRadStructAccessData*
 						}
 					}
 				}
-				x += pRadAccessData->xStep;
+				x += xStep;
 			}
-			y += pRadAccessData->zStep;
 		}
+
+#ifdef _OPENMP
+		#pragma omp critical
+#endif
+		{
+		if(xRelOutMin > xRelOutMinLoc) xRelOutMin = xRelOutMinLoc;
+		if(xRelOutMax < xRelOutMaxLoc) xRelOutMax = xRelOutMaxLoc;
+		if(yRelOutMin > yRelOutMinLoc) yRelOutMin = yRelOutMinLoc;
+		if(yRelOutMax < yRelOutMaxLoc) yRelOutMax = yRelOutMaxLoc;
+		}
+		}
+		if(CompIsAborted) break;
 		ePh += pRadAccessData->eStep;
 	}
+	if(CompIsAborted)
+	{
+		if(arAuxEX != 0) delete[] arAuxEX;
+		if(arAuxEY != 0) delete[] arAuxEY;
+		delete[] arAuxRayTrCoord;
+		return SR_COMP_PROC_ABORTED;
+	}
 
 	//Re-interpolate the output wavefront (at fixed photon energy) on the initial equidistant grid:
 	if(res = WfrInterpolOnOrigGrid(pRadAccessData, arAuxRayTrCoord, arAuxEX, arAuxEY, xRelOutMin, xRelOutMax, yRelOutMin, yRelOutMax)) return res;
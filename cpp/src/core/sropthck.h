@@ -308,6 +308,7 @@ class srTMirrorEllipsoid : public srTMirror {
 
 	double m_ax, m_ay, m_az; //ellipsoid parameters in Local frame (derived)
 	double m_axE2, m_ayE2, m_azE2; //ellipsoid parameters in Local frame (derived)
+	double m_ayE2_azE2, m_axE2_azE2, m_axE2_ayE2, m_ax_ay_az, m_invAxE2, m_invAyE2, m_invAzE2; //auxiliary products of ellipsoid parameters, used at ray tracing (derived)
 	double m_xcLocNorm, m_zcLocNorm; //coordinates of mirror center in the "Local Normal" frame, where the elipse is described by x^2/m_ax^2 + y^2/m_ay^2 + z^2/m_az^2 = 1
 	double m_ellPhiMin, m_ellPhiMax; //angle coordinate of mirror edges in the "Local Normal" frame
 	//double m_cosAngGraz, m_sinAngGraz;
@@ -345,6 +346,10 @@ public:
 		m_ay = sqrt(m_radSag*azt)/dd;
 		m_ayE2 = m_ay*m_ay;
 
+		m_ayE2_azE2 = m_ayE2*m_azE2; m_axE2_azE2 = m_axE2*m_azE2; m_axE2_ayE2 = m_axE2*m_ayE2;
+		m_ax_ay_az = m_ax*m_ay*m_az;
+		m_invAxE2 = 1./m_axE2; m_invAyE2 = 1./m_ayE2; m_invAzE2 = 1./m_azE2;
+
 		m_xcLocNorm = x0; //coordinates of mirror center in the "Local Normal" frame, where the elipse is described by x^2/m_ax^2 + y^2/m_ay^2 + z^2/m_az^2 = 1
 		m_zcLocNorm = z0;
 		//m_cosAngGraz = cos(m_angGraz);
@@ -444,14 +449,15 @@ public:
 		double vy_x0_mi_vx_y0 = vy*x0 - vx*y0;
 		double vz_x0_mi_vx_z0 = vz*x0 - vx*z0;
 		double vz_y0_mi_vy_z0 = vz*y0 - vy*z0;
-		double argRoot = -m_azE2*vy_x0_mi_vx_y0*vy_x0_mi_vx_y0 + m_ayE2*(m_azE2*vxE2 + m_axE2*vzE2 - vz_x0_mi_vx_z0*vz_x0_mi_vx_z0) + m_axE2*(m_azE2*vyE2 - vz_y0_mi_vy_z0*vz_y0_mi_vy_z0);
+		double azE2_vxE2_p_axE2_vzE2 = m_azE2*vxE2 + m_axE2*vzE2;
+		double argRoot = -m_azE2*vy_x0_mi_vx_y0*vy_x0_mi_vx_y0 + m_ayE2*(azE2_vxE2_p_axE2_vzE2 - vz_x0_mi_vx_z0*vz_x0_mi_vx_z0) + m_axE2*(m_azE2*vyE2 - vz_y0_mi_vy_z0*vz_y0_mi_vy_z0);
 		if(argRoot < 0) return false;
 		
-		double ax_ay_az = m_ax*m_ay*m_az;
-		double a = m_ayE2*m_azE2*vx*x0 + m_axE2*m_azE2*vy*y0 + m_axE2*m_ayE2*vz*z0;
-		double b = m_axE2*m_azE2*vyE2 + m_ayE2*(m_azE2*vxE2 + m_axE2*vzE2);
+		double a = m_ayE2_azE2*vx*x0 + m_axE2_azE2*vy*y0 + m_axE2_ayE2*vz*z0;
+		double b = m_axE2_azE2*vyE2 + m_ayE2*azE2_vxE2_p_axE2_vzE2;
 
-		double t0 = (m_p < m_q)? -(a + ax_ay_az*sqrt(argRoot))/b : -(a - ax_ay_az*sqrt(argRoot))/b; //to check
+		double ax_ay_az_sqrtArg = m_ax_ay_az*sqrt(argRoot);
+		double t0 = (m_p < m_q)? -(a + ax_ay_az_sqrtArg)/b : -(a - ax_ay_az_sqrtArg)/b; //to check
 		//double t0 = (m_p >= m_q)? -(a + sqrt(argRoot))/b : -(a - sqrt(argRoot))/b; //to check
 
 		//Coordinates of the Intersection Point in the "Local Normal" frame:
@@ -504,7 +510,7 @@ public:
 
 		if(pResN != 0)
 		{   //Components of the normal vector in the frame where the elipse is described by x^2/m_ax^2 + y^2/m_ay^2 + z^2/m_az^2 = 1:
-			double xnLocNorm = -xi/m_axE2, ynLocNorm = -yi/m_ayE2, znLocNorm = -zi/m_azE2;
+			double xnLocNorm = -xi*m_invAxE2, ynLocNorm = -yi*m_invAyE2, znLocNorm = -zi*m_invAzE2;
 			double invNorm = 1./sqrt(xnLocNorm*xnLocNorm + ynLocNorm*ynLocNorm + znLocNorm*znLocNorm);
 			xnLocNorm *= invNorm; ynLocNorm *= invNorm; znLocNorm *= invNorm;
 
@@ -599,6 +605,40 @@ public:
 		vN.z = inv_norm;
 	}
 
+	bool FindRayIntersectWithSurfInLocFrame(TVector3d& inP, TVector3d& inV, TVector3d& resP, TVector3d* pResN=0) //virtual in srTMirror
+	{//Same iterations as in srTMirror::FindRayIntersectWithSurfInLocFrame, but with the surface height (SurfHeightInLocFrame) evaluated in place,
+	 //and stopped as soon as the height is converged (for grazing incidence this usually happens much earlier than after maxIt iterations)
+		const double absTolZ = 0.; //[m]
+		const int maxIt = 15;
+		double ax = inV.x/inV.z, ay = inV.y/inV.z;
+		double x0 = inP.x - ax*inP.z, y0 = inP.y - ay*inP.z;
+		double invRs = 1./m_Rs, invRt = 1./m_Rt, Rs_d_Rt = m_Rs*invRt;
+		double z = 0.;
+		for(int i=0; i<maxIt; i++)
+		{
+			double x = ax*z + x0, y = ay*z + y0;
+			double ry = y*invRs;
+			double rye2 = ry*ry;
+			if(rye2 > 1.) return false;
+			double a1 = (CGenMathMeth::radicalOnePlusSmallMinusOne(-rye2))*Rs_d_Rt;
+			double rx = x*invRt;
+			double a2 = a1*(a1 + 2.) - rx*rx;
+			if(a2 < -1.) return false;
+			double zNew = -m_Rt*(CGenMathMeth::radicalOnePlusSmallMinusOne(a2));
+			bool heightIsConverged = (::fabs(zNew - z) <= absTolZ);
+			z = zNew;
+			if(heightIsConverged) break;
+		}
+		resP.x = ax*z + x0;
+		resP.y = ay*z + y0;
+		resP.z = z;
+
+		if(pResN != 0)
+		{
+			FindSurfNormalInLocFrame(resP.x, resP.y, *pResN);
+		}
+		return true;
+	}
 };
 
 
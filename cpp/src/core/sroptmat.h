@@ -21,7 +21,7 @@
 
 //*************************************************************************
 
-extern srTIntVect gVectWarnNos;
+extern thread_local srTIntVect gVectWarnNos;
 
 //*************************************************************************
 
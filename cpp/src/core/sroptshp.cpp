@@ -156,6 +156,7 @@ int srTShapedOptElem::PropagateByRays(srTSRWRadStructAccessData* pRadAccessData)
 	double *arAuxRayTrCoord = new double[((pRadAccessData->nx)*(pRadAccessData->nz)) << 1];
 	if(arAuxRayTrCoord == 0) return NOT_ENOUGH_MEMORY_FOR_SR_COMP;
 
+	pRadAccessData->NoteFieldModif();
 	float *pEX0 = pRadAccessData->pBaseRadX;
 	float *pEZ0 = pRadAccessData->pBaseRadZ;
 	long PerX = pRadAccessData->ne << 1;
@@ -147,6 +147,7 @@ int srTWaveguideRect::FillInSymmetricalPartsOutsideWaveguide(srTSRWRadStructAcce
 
 	long iz, ix, OffsetAux;
 
+	Wfr.NoteFieldModif();
 	float *pEx0 = Wfr.pBaseRadX;
 	float *pEz0 = Wfr.pBaseRadZ;
 	float *pEx, *pEz;
@@ -664,6 +665,7 @@ int srTDriftSpace::PropagateRadiationSimple_PropToWaist(srTSRWRadStructAccessDat
 	srTDataPtrsForWfrEdgeCorr DataPtrsForWfrEdgeCorr;
 	if(result = SetupWfrEdgeCorrData(pRadAccessData, pRadAccessData->pBaseRadX, pRadAccessData->pBaseRadZ, DataPtrsForWfrEdgeCorr)) return result;
 
+	pRadAccessData->NoteFieldModif();
 	FFT2DInfo.pData = pRadAccessData->pBaseRadX;
 	if(result = FFT2D.Make2DFFT(FFT2DInfo)) return result;
 	FFT2DInfo.pData = pRadAccessData->pBaseRadZ;
@@ -724,6 +726,7 @@ int srTDriftSpace::PropagateRadiationSimple_PropFromWaist(srTSRWRadStructAccessD
 	if(result = SetupWfrEdgeCorrData(pRadAccessData, pRadAccessData->pBaseRadX, pRadAccessData->pBaseRadZ, DataPtrsForWfrEdgeCorr)) return result;
 
 	srTFFT2D FFT2D;
+	pRadAccessData->NoteFieldModif();
 	FFT2DInfo.pData = pRadAccessData->pBaseRadX;
 	if(result = FFT2D.Make2DFFT(FFT2DInfo)) return result;
 	FFT2DInfo.pData = pRadAccessData->pBaseRadZ;
@@ -18,7 +18,7 @@
 
 //*************************************************************************
 
-extern srTIntVect gVectWarnNos;
+extern thread_local srTIntVect gVectWarnNos;
 
 //*************************************************************************
 
@@ -16,10 +16,11 @@
 #include "srctrjdt.h"
 #include "srinterf.h"
 #include "gmmeth.h"
+#include "gmconv.h"
 
 //*************************************************************************
 
-extern srTIntVect gVectWarnNos;
+extern thread_local srTIntVect gVectWarnNos;
 
 //*************************************************************************
 
@@ -877,27 +878,22 @@ int srTRadIntPowerDensity::TreatFiniteElecBeamEmittance(srTPowDensStructAccessDa
 		//MzzElecEff = vLocProjElecDims.z*vLocProjElecDims.z;
 	}
 
-	double MxxPowSingleE, MzzPowSingleE;
-	DetermineSingleElecPowDensEffSizes(PowDensAccessData, MxxPowSingleE, MzzPowSingleE);
-	srTRadResize Resize;
-	DetermineResizeBeforeConv(MxxElecEff, MzzElecEff, MxxPowSingleE, MzzPowSingleE, Resize);
+	CGenMathConvGaussInfo ConvInfo;
+	ConvInfo.pData = PowDensAccessData.pBasePowDens;
+	ConvInfo.Nx = PowDensAccessData.nx;
+	ConvInfo.Ny = PowDensAccessData.nz;
+	ConvInfo.PerX = 1;
+	ConvInfo.PerY = PowDensAccessData.nx;
+	ConvInfo.xStep = (DistrInfoDat.nx > 1)? (DistrInfoDat.xEnd - DistrInfoDat.xStart)/(DistrInfoDat.nx - 1) : 0.;
+	ConvInfo.yStep = (DistrInfoDat.nz > 1)? (DistrInfoDat.zEnd - DistrInfoDat.zStart)/(DistrInfoDat.nz - 1) : 0.;
+	ConvInfo.Mxx = MxxElecEff;
+	ConvInfo.Myy = MzzElecEff;
+	ConvInfo.PadWithEdgeValues = 1;
 
-	long NxAux = (long)(Resize.pxm*PowDensAccessData.nx);
-	long NzAux = (long)(Resize.pzm*PowDensAccessData.nz);
-	CGenMathFFT2D FFT;
-	FFT.NextCorrectNumberForFFT(NxAux);
-	FFT.NextCorrectNumberForFFT(NzAux);
-
-	float* AuxConvData = new float[NxAux*NzAux << 1];
-	if(AuxConvData == 0) return MEMORY_ALLOCATION_FAILURE;
-
-	ConstructDataForConv(PowDensAccessData, AuxConvData, NxAux, NzAux);
-	if(result = PerformConvolutionWithGaussian(AuxConvData, NxAux, NzAux, MxxElecEff, MzzElecEff)) return result;
-	ExtractFinalDataAfterConv(AuxConvData, NxAux, NzAux, PowDensAccessData);
+	CGenMathConvGauss ConvGauss;
+	if(result = ConvGauss.Convolve(ConvInfo)) return result;
 
 	PowDensAccessData.EnsureNonNegativeValues(); //OC
-
-	if(AuxConvData != 0) delete[] AuxConvData;
 	return 0;
 }
 
@@ -913,231 +909,3 @@ int srTRadIntPowerDensity::TreatFiniteElecBeamEmittance1D(srTPowDensStructAccess
 }
 
 //*************************************************************************
-
-void srTRadIntPowerDensity::DetermineSingleElecPowDensEffSizes(srTPowDensStructAccessData& PowDensAccessData, double& MxxPowSingleE, double& MzzPowSingleE)
-{// Compute central moments
-	float Sm0 = 0., SmX = 0., SmZ = 0., SmXX = 0., SmZZ = 0.;
-	float xStep = (float)((DistrInfoDat.nx > 1)? (DistrInfoDat.xEnd - DistrInfoDat.xStart)/(DistrInfoDat.nx - 1) : 0.);
-	float zStep = (float)((DistrInfoDat.nz > 1)? (DistrInfoDat.zEnd - DistrInfoDat.zStart)/(DistrInfoDat.nz - 1) : 0.);
-
-	long nz_mi_1 = DistrInfoDat.nz - 1, nx_mi_1 = DistrInfoDat.nx - 1;
-	float *tPowDens = PowDensAccessData.pBasePowDens;
-	float z = (float)DistrInfoDat.zStart;
-	float ze2 = z*z;
-	float wz = 0.5;
-	for(int iz=0; iz<DistrInfoDat.nz; iz++)
-	{
-		if(iz == nz_mi_1) wz = 0.5;
-		
-		float x = (float)DistrInfoDat.xStart;
-		float xe2 = x*x;
-		for(int ix=0; ix<DistrInfoDat.nx; ix++)
-		{
-			//float PowDens = wz*(*tPowDens);
-			float PowDens = wz*(*(tPowDens++)); // ??
-			if((ix == nx_mi_1) || (iz == nz_mi_1)) PowDens *= 0.5;
-
-			Sm0 += PowDens;
-			SmX += x*PowDens;
-			SmXX += xe2*PowDens;
-			SmZ += z*PowDens;
-			SmZZ += ze2*PowDens;
-
-			x += xStep;
-			xe2 = x*x;
-		}
-		wz = 1.;
-		z += zStep;
-		ze2 = z*z;
-	}
-	float Norm = (float)(1./Sm0);
-	float Mx = SmX*Norm, Mxx = SmXX*Norm;
-	float Mz = SmZ*Norm, Mzz = SmZZ*Norm;
-
-	MxxPowSingleE = Mxx - Mx*Mx;
-	MzzPowSingleE = Mzz - Mz*Mz;
-}
-
-//*************************************************************************
-
-void srTRadIntPowerDensity::DetermineResizeBeforeConv(double MxxElecEff, double MzzElecEff, double MxxPowSingleE, double MzzPowSingleE, srTRadResize& Resize)
-{
-	const double DoNotResizeRatio = 5.; //3.; // To steer
-	const double AmOfExtraSig = 6.; //2.5;
-
-	if(MxxPowSingleE*DoNotResizeRatio > MxxElecEff)
-	{
-		double ExtraRange = 2.*AmOfExtraSig*sqrt(MxxElecEff);
-		double CurrentRange = DistrInfoDat.xEnd - DistrInfoDat.xStart;
-		Resize.pxm = (CurrentRange + ExtraRange)/CurrentRange;
-	}
-	if(MzzPowSingleE*DoNotResizeRatio > MzzElecEff)
-	{
-		double ExtraRange = 2.*AmOfExtraSig*sqrt(MzzElecEff);
-		double CurrentRange = DistrInfoDat.zEnd - DistrInfoDat.zStart;
-		Resize.pzm = (CurrentRange + ExtraRange)/CurrentRange;
-	}
-}
-
-//*************************************************************************
-
-void srTRadIntPowerDensity::ConstructDataForConv(srTPowDensStructAccessData& PowDensAccessData, float* NewData, long NewNx, long NewNz)
-{
-	long ixDat = (NewNx - PowDensAccessData.nx) >> 1;
-	long izDat = (NewNz - PowDensAccessData.nz) >> 1;
-
-	long OffsetXp = ixDat + PowDensAccessData.nx;
-	long OffsetZp = izDat + PowDensAccessData.nz;
-
-	long NewPerZ = NewNx << 1;
-	long ix, iz;
-	float V = *(PowDensAccessData.pBasePowDens);
-	for(iz=0; iz<izDat; iz++)
-	{
-		float *tNew = NewData + iz*NewPerZ;
-		for(ix=0; ix<ixDat; ix++) { *(tNew++) = V; *(tNew++) = 0;}
-	}
-	V = *(PowDensAccessData.pBasePowDens + PowDensAccessData.nx - 1);
-	for(iz=0; iz<izDat; iz++)
-	{
-		float *tNew = NewData + iz*NewPerZ + (OffsetXp << 1);
-		for(ix=OffsetXp; ix<NewNx; ix++) { *(tNew++) = V; *(tNew++) = 0;}
-	}
-	V = *(PowDensAccessData.pBasePowDens + (PowDensAccessData.nz - 1)*PowDensAccessData.nx);
-	for(iz=OffsetZp; iz<NewNz; iz++)
-	{
-		float *tNew = NewData + iz*NewPerZ;
-		for(ix=0; ix<ixDat; ix++) { *(tNew++) = V; *(tNew++) = 0;}
-	}
-	V = *(PowDensAccessData.pBasePowDens + PowDensAccessData.nz*PowDensAccessData.nx - 1);
-	for(iz=OffsetZp; iz<NewNz; iz++)
-	{
-		float *tNew = NewData + iz*NewPerZ + (OffsetXp << 1);
-		for(ix=OffsetXp; ix<NewNx; ix++) { *(tNew++) = V; *(tNew++) = 0;}
-	}
-
-	float *tOldL = PowDensAccessData.pBasePowDens;
-	float *tOldR = PowDensAccessData.pBasePowDens + PowDensAccessData.nx - 1;
-	for(iz=izDat; iz<(izDat + PowDensAccessData.nz); iz++)
-	{
-		V = *tOldL;
-		long izNewPerZ = iz*NewPerZ;
-		float *tNew = NewData + izNewPerZ;
-		for(ix=0; ix<ixDat; ix++) { *(tNew++) = V; *(tNew++) = 0;}
-		tOldL += PowDensAccessData.nx;
-
-		V = *tOldR;
-		tNew = NewData + izNewPerZ + (OffsetXp << 1);
-		for(ix=OffsetXp; ix<NewNx; ix++) { *(tNew++) = V; *(tNew++) = 0;}
-		tOldR += PowDensAccessData.nx;
-	}
-
-	float *tOldD = PowDensAccessData.pBasePowDens;
-	float *tOldU = PowDensAccessData.pBasePowDens + (PowDensAccessData.nz - 1)*PowDensAccessData.nx;
-	for(ix=ixDat; ix<(ixDat + PowDensAccessData.nx); ix++)
-	{
-		V = *(tOldD++);
-		float *tNew = NewData + (ix << 1);
-		for(iz=0; iz<izDat; iz++) { *tNew = V; *(tNew+1) = 0; tNew += NewPerZ;}
-
-		V = *(tOldU++);
-		tNew = NewData + OffsetZp*NewPerZ + (ix << 1);
-		for(iz=OffsetZp; iz<NewNz; iz++) { *tNew = V; *(tNew+1) = 0; tNew += NewPerZ;}
-	}
-
-	float *tOld = PowDensAccessData.pBasePowDens;
-	for(iz=izDat; iz<(izDat + PowDensAccessData.nz); iz++)
-	{
-		float *tNew = NewData + iz*NewPerZ + (ixDat << 1);
-		for(ix=ixDat; ix<(ixDat + PowDensAccessData.nx); ix++)
-		{
-			*(tNew++) = *(tOld++); *(tNew++) = 0.;
-		}
-	}
-}
-
-//*************************************************************************
-
-int srTRadIntPowerDensity::PerformConvolutionWithGaussian(float* ConvData, long NewNx, long NewNz, double MxxElecEff, double MzzElecEff)
-{
-	int result;
-	double xStep = (DistrInfoDat.nx > 1)? (DistrInfoDat.xEnd - DistrInfoDat.xStart)/(DistrInfoDat.nx - 1) : 0.;
-	double zStep = (DistrInfoDat.nz > 1)? (DistrInfoDat.zEnd - DistrInfoDat.zStart)/(DistrInfoDat.nz - 1) : 0.;
-
-	double xStartFict = -xStep*(NewNx >> 1);
-	double zStartFict = -zStep*(NewNz >> 1);
-
-	CGenMathFFT2DInfo FFT2DInfo;
-	FFT2DInfo.pData = ConvData;
-	FFT2DInfo.Dir = 1;
-	FFT2DInfo.xStep = xStep;
-	FFT2DInfo.yStep = zStep;
-	FFT2DInfo.xStart = xStartFict;
-	FFT2DInfo.yStart = zStartFict;
-	FFT2DInfo.Nx = NewNx;
-	FFT2DInfo.Ny = NewNz;
-	FFT2DInfo.UseGivenStartTrValues = 0;
-
-	CGenMathFFT2D FFT2D;
-	if(result = FFT2D.Make2DFFT(FFT2DInfo)) return result;
-
-	const double Pi = 3.14159265358979;
-	const double TwoPi = Pi*2.;
-	const double TwoPiE2 = TwoPi*Pi;
-
-	double C2x = TwoPiE2*MxxElecEff;
-	double C2z = TwoPiE2*MzzElecEff;
-
-	float* tData = ConvData;
-	double qz = FFT2DInfo.yStartTr;
-
-	for(long iz=0; iz<NewNz; iz++)
-	{
-		double C2zqzE2 = C2z*qz*qz;
-		double qx = FFT2DInfo.xStartTr;
-
-		for(long ix=0; ix<NewNx; ix++)
-		{
-			double Magn = exp(-C2x*qx*qx - C2zqzE2);
-			*(tData++) *= (float)Magn; // Re
-			*(tData++) *= (float)Magn; // Im
-
-			qx += FFT2DInfo.xStepTr;
-		}
-		qz += FFT2DInfo.yStepTr;
-	}
-
-	FFT2DInfo.pData = ConvData;
-	FFT2DInfo.Dir = -1;
-	FFT2DInfo.xStep = FFT2DInfo.xStepTr; FFT2DInfo.xStepTr = xStep;
-	FFT2DInfo.yStep = FFT2DInfo.yStepTr; FFT2DInfo.yStepTr = zStep;
-	FFT2DInfo.xStart = FFT2DInfo.xStartTr; FFT2DInfo.xStartTr = xStartFict;
-	FFT2DInfo.yStart = FFT2DInfo.yStartTr; FFT2DInfo.yStartTr = zStartFict;
-	FFT2DInfo.UseGivenStartTrValues = 1;
-
-	if(result = FFT2D.Make2DFFT(FFT2DInfo)) return result;
-	return 0;
-}
-
-//*************************************************************************
-
-void srTRadIntPowerDensity::ExtractFinalDataAfterConv(float* AuxConvData, long NxAux, long NzAux, srTPowDensStructAccessData& PowDensAccessData)
-{
-	long ixDat = (NxAux - PowDensAccessData.nx) >> 1;
-	long izDat = (NzAux - PowDensAccessData.nz) >> 1;
-
-	long Two_ixDat = ixDat << 1;
-	long AuxPerZ = NxAux << 1;
-
-	float *tPow = PowDensAccessData.pBasePowDens;
-	for(long iz=0; iz<PowDensAccessData.nz; iz++)
-	{
-		float *tAux = AuxConvData + (izDat + iz)*AuxPerZ + Two_ixDat;
-		for(long ix=0; ix<PowDensAccessData.nx; ix++)
-		{
-			*(tPow++) = *tAux; tAux += 2;
-		}
-	}
-}
-
-//*************************************************************************
@@ -102,11 +102,6 @@ public:
 	void SetupNotCompIntervBorders(double MinValNotComp, double sStart, double sStep, long Np, long& AmOfInterv);
 	int TreatFiniteElecBeamEmittance(srTPowDensStructAccessData&, gmTrans* pTrfObsPl =0);
 	int TreatFiniteElecBeamEmittance1D(srTPowDensStructAccessData&, char);
-	void DetermineSingleElecPowDensEffSizes(srTPowDensStructAccessData&, double& MxxPowSingleE, double& MzzPowSingleE);
-	void DetermineResizeBeforeConv(double MxxElecEff, double MzzElecEff, double MxxPowSingleE, double MzzPowSingleE, srTRadResize& Resize);
-	void ConstructDataForConv(srTPowDensStructAccessData& PowDensAccessData, float* NewData, long NewNx, long NewNz);
-	int PerformConvolutionWithGaussian(float* AuxConvData, long NxAux, long NzAux, double MxxElecEff, double MzzElecEff);
-	void ExtractFinalDataAfterConv(float* AuxConvData, long NxAux, long NzAux, srTPowDensStructAccessData& PowDensAccessData);
 
 	void SetPrecParams(srTParPrecPowDens* pPrecPowDens);
 	int TryToReduceIntegLimits();
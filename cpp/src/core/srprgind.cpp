@@ -15,10 +15,25 @@
 
 //*************************************************************************
 
+thread_local srTCompJob* gpCompJob = 0;
+
+//*************************************************************************
+
 int srTCompProgressIndicator::InitializeIndicator(long InTotalAmOfOutPoints, double InUpdateTimeInt_s, char CountCallsInside)
 {
 	TotalAmOfOutPoints = InTotalAmOfOutPoints;
 
+	if((m_pJob == 0) && (gpCompJob != 0))
+	{//only the outermost indicator of the job reports progress; nested ones (e.g. of the elements of a container) would reset it
+		m_pJob = gpCompJob;
+		m_ReportsToJob = (m_pJob->NumIndicators.fetch_add(1, std::memory_order_relaxed) == 0);
+	}
+	if(m_ReportsToJob)
+	{
+		m_pJob->CurPoint.store(0, std::memory_order_relaxed);
+		m_pJob->TotPoints.store(TotalAmOfOutPoints, std::memory_order_relaxed);
+	}
+
 #ifdef __VC__
 #ifdef __IGOR_PRO__
 
@@ -15,6 +15,8 @@
 #define __SRPRGIND_H
 
 #include <time.h>
+#include <atomic>
+#include "srercode.h"
 
 #ifdef __IGOR_PRO__
 #include "srigintr.h"
@@ -26,6 +28,28 @@ extern int (*pgCompProgressIndicFunc)(double CurVal);
 
 //*************************************************************************
 
+struct srTCompJob {//State of a computation run on a worker thread (see srwlJobStart), read and modified by other threads without locks
+	std::atomic<long> CurPoint, TotPoints; //progress, as reported to the outermost srTCompProgressIndicator
+	std::atomic<bool> CancelRequested; //checked by srTYield::Check and srTCompProgressIndicator::UpdateIndicator
+	std::atomic<int> NumIndicators; //number of active indicators of the job (nested computations); only the first one reports progress
+
+	srTCompJob() : CurPoint(0), TotPoints(0), CancelRequested(false), NumIndicators(0) {}
+};
+
+extern thread_local srTCompJob* gpCompJob; //job run by the current thread (0 if none)
+
+inline bool CompJobCancelIsRequested() { return (gpCompJob != 0) && gpCompJob->CancelRequested.load(std::memory_order_relaxed);}
+
+struct srTCompJobOfThread {//Sets the job of the current thread during the life of the object: to be created at the start of parallel regions with the job of the thread
+ //which started the region, so that the worker threads (for which gpCompJob, being thread_local, is 0) can check for cancellation
+	srTCompJob *pPrevJob;
+
+	srTCompJobOfThread(srTCompJob* pJob) { pPrevJob = gpCompJob; gpCompJob = pJob;}
+	~srTCompJobOfThread() { gpCompJob = pPrevJob;}
+};
+
+//*************************************************************************
+
 class srTCompProgressIndicator {
 
 #ifdef __IGOR_PRO__
@@ -33,6 +57,8 @@ class srTCompProgressIndicator {
 #endif
 
 	char ProgressIndicatorIsUsed, CallsAreCountedInside;
+	srTCompJob *m_pJob; //job of the thread that initialized the indicator (counted in its NumIndicators), 0 if none
+	bool m_ReportsToJob; //true for the outermost indicator of the job
 	long TotalAmOfOutPoints, PrevAmOfPoints, PrevAmOfPointsShown, CallsCount;
 	clock_t UpdateTimeInt, PrevUpdateClock, StartCompClock;
 
@@ -43,6 +69,7 @@ public:
 	srTCompProgressIndicator(long InTotalAmOfOutPoints, double UpdateTimeInt_s, char CountCallsInside=0)
 	{
 		ProgressIndicatorIsUsed = 0; ErrorCode = 0;
+		m_pJob = 0; m_ReportsToJob = false;
 		if(InTotalAmOfOutPoints <= 0) return;
 
 		ErrorCode = InitializeIndicator(InTotalAmOfOutPoints, UpdateTimeInt_s, CountCallsInside);
@@ -50,6 +77,7 @@ public:
 	srTCompProgressIndicator()
 	{
 		ProgressIndicatorIsUsed = 0; ErrorCode = 0;
+		m_pJob = 0; m_ReportsToJob = false;
 	}
 	~srTCompProgressIndicator()
 	{
@@ -64,6 +92,14 @@ public:
 		if((!ProgressIndicatorIsUsed) || (ErrorCode != 0)) return 0;
 
 		if(CallsAreCountedInside) CurPoint = CallsCount;
+
+		if(m_ReportsToJob) m_pJob->CurPoint.store(CurPoint, std::memory_order_relaxed); //progress of nested computations is not reported, so that it doesn't go backwards
+		if(CompJobCancelIsRequested()) return SR_COMP_PROC_ABORTED;
+
+#if !defined(__IGOR_PRO__) && !defined(_SRWDLL)
+		if(CallsAreCountedInside) CallsCount++;
+		return 0; //there is no indicator to update, so the clock is not polled
+#endif
 		
 		clock_t CurrentClock = clock();
 		if(CurrentClock < (UpdateTimeInt + PrevUpdateClock)) return 0;
@@ -101,6 +137,11 @@ public:
 	
 	void DestroyIndicator()
 	{
+		if(m_pJob != 0)
+		{
+			m_pJob->NumIndicators.fetch_sub(1, std::memory_order_relaxed);
+			m_pJob = 0; m_ReportsToJob = false;
+		}
 		if(!ProgressIndicatorIsUsed) return;
 
 #ifdef __VC__
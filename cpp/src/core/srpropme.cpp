@@ -12,19 +12,29 @@
  ***************************************************************************/
 
 #include "srpropme.h"
+#include "srradmnp.h"
 #include "srsend.h"
+#include "srprgind.h"
+#include "gmmeth.h"
 
 //*************************************************************************
 
-CGenMathRand srTPropagMultiE::gRandGen;
+thread_local CGenMathRand srTPropagMultiE::gRandGen;
 
 //*************************************************************************
 
 int srTPropagMultiE::PropagateElecFieldStokesAuto(srTEbmDat& ThickEbmDat, srTSRWRadStructAccessData& InWfr, srTGenOptElemHndl OptHndl, double* pPrecPar, srTStokesStructAccessData& OutStokes)
 {
+	//pPrecPar[0]: precision factor for single-electron propagation
+	//pPrecPar[1]: max. number of macro-electrons
+	//pPrecPar[2]: relative error of the "multi-electron" intensity at which the calculation is stopped (0 means that all macro-electrons are processed)
+	//pPrecPar[3]: sampling of electron phase space: 0- pseudo-random, 1- LPtau, 2- LPtau in Gray-code order, scrambled (see CGenMathRand::NextRandStdN)
+	//pPrecPar[4]: seed of the scrambling at pPrecPar[3] = 2 (0 means seed from current time; the same non-zero seed gives the same sequence of macro-electrons)
 	int result = 0;
 	//double RelPrec = 0.001; // corresponding to PrecParMultiE = 1
 	long MaxAmOfMacroPrt = 1000000;
+	const long MinAmOfMacroPrtForRelErr = 32; //to steer: the relative error is not estimated from fewer macro-electrons
+	const long PerCheckRelErr = 16; //to steer: number of macro-electrons between estimations of the relative error
 	//int AmOfSecurityPasses = 1;
 	gRandGen.Initialize();
 
@@ -33,6 +43,15 @@ int srTPropagMultiE::PropagateElecFieldStokesAuto(srTEbmDat& ThickEbmDat, srTSRW
 	//if((PrecParMultiE > 0.) && (PrecParMultiE != 1.)) RelPrec /= PrecParMultiE;
 
 	if(pPrecPar[1] >= 1.) MaxAmOfMacroPrt = (long)pPrecPar[1];
+	double RelErrToStop = pPrecPar[2];
+	char RandMode = (char)pPrecPar[3];
+	if((RandMode < 0) || (RandMode > 2)) RandMode = 1;
+	if(RandMode == 2)
+	{
+		unsigned long Seed = (unsigned long)pPrecPar[4];
+		if(Seed == 0) Seed = (unsigned long)time(NULL) | 1UL;
+		gRandGen.InitScrambledLPTau(Seed);
+	}
 
 	//srTEbmDat ThickEbmDat;
 	//if(result = InWfr.OutElectronBeamStruct(ThickEbmDat)) return result;
@@ -52,13 +71,22 @@ int srTPropagMultiE::PropagateElecFieldStokesAuto(srTEbmDat& ThickEbmDat, srTSRW
 	//srTParPrecWfrPropag ManParPrecWfrPropag(ManMethNo, 0, 0, 1., 0.5);
 
 	srTGenOptElem *pOptElem = (srTGenOptElem*)(OptHndl.rep);
-	if(result = pOptElem->PropagateRadiation(pLocWfr, AutoParPrecWfrPropag, RadResizeVect)) return result;
+	pOptElem->SetDataIsFixed(); //the same elements are applied to the wavefronts of all macro-particles
+	if(result = pOptElem->PropagateRadiation(pLocWfr, AutoParPrecWfrPropag, RadResizeVect)) { delete pLocWfr; return result;}
 
-	if(result = ReallocateStokesAccordingToWfr(*pLocWfr, OutStokes)) return result;
+	if(result = ReallocateStokesAccordingToWfr(*pLocWfr, OutStokes)) { delete pLocWfr; return result;}
 	OutStokes.ZeroStokesData();
 
+	vector<double> vSumS0E2; //running sums of squared intensity per point, for the estimation of the relative error
+	double *arSumS0E2 = 0;
+	if(RelErrToStop > 0.)
+	{
+		vSumS0E2.assign((long)OutStokes.ne*OutStokes.nx*OutStokes.nz, 0.);
+		arSumS0E2 = &vSumS0E2[0];
+	}
+
 	//double CurRelPrec = -1.;
-	if(result = AddWfrToStokesWithInterpXZ(*pLocWfr, OutStokes, 0)) return result;
+	if(result = AddWfrToStokesWithInterpXZ(*pLocWfr, OutStokes, 0, arSumS0E2)) { delete pLocWfr; return result;}
 
 	//srTGenOptElemPtrList ActOptElemsList;
 	//((srTGenOptElem*)(OptHndl.rep))->AddPtrOfActualOptElem(ActOptElemsList);
@@ -75,6 +103,10 @@ int srTPropagMultiE::PropagateElecFieldStokesAuto(srTEbmDat& ThickEbmDat, srTSRW
 //repeat propagation in "automatic" mode
 
 	srTEbmDat CurThinEbmDat = ThickEbmDat;
+
+	srTCompProgressIndicator CompProgressInd;
+	char showProgressInd = (gpCompJob != 0)? 1 : 0; //progress (number of macro-electrons, out of the max. number) is only reported to the job run by this thread (see srwlJobStart)
+	if(showProgressInd) if(result = CompProgressInd.InitializeIndicator(MaxAmOfMacroPrt, 0.5)) return result;
 	//int SecurityPassCount = 0;
 	//bool PrecLevelWasNotReached = true;
 	
@@ -90,7 +122,7 @@ int srTPropagMultiE::PropagateElecFieldStokesAuto(srTEbmDat& ThickEbmDat, srTSRW
 		pLocWfr->DoNotResizeAfter = true;
 		pLocWfr->WfrEdgeCorrShouldBeDone = 0; // ????
 
-		SetupNextThinEbm(ThickEbmDat, SigleElecVars, CurThinEbmDat);
+		SetupNextThinEbm(ThickEbmDat, SigleElecVars, CurThinEbmDat, RandMode);
 
 			//OC debug
 			//CurThinEbmDat.dxds0 = 2.3e-005;
@@ -100,13 +132,20 @@ int srTPropagMultiE::PropagateElecFieldStokesAuto(srTEbmDat& ThickEbmDat, srTSRW
 
 		SimulateWfrFromOffAxisEbm(ThickEbmDat, CurThinEbmDat, SigleElecVars, *pLocWfr);
 
-        if(result = pOptElem->PropagateRadiation(pLocWfr, AutoParPrecWfrPropag, RadResizeVect)) return result;
-		if(result = AddWfrToStokesWithInterpXZ(*pLocWfr, OutStokes, i)) return result;
+        if(result = pOptElem->PropagateRadiation(pLocWfr, AutoParPrecWfrPropag, RadResizeVect)) { delete pLocWfr; return result;}
+		if(result = AddWfrToStokesWithInterpXZ(*pLocWfr, OutStokes, i, arSumS0E2)) { delete pLocWfr; return result;}
 
 		if(pLocWfr != 0) delete pLocWfr;
 
 			StestXc += CurThinEbmDat.z0; StestMxx += (CurThinEbmDat.z0*CurThinEbmDat.z0);
 			StestXpc += CurThinEbmDat.dzds0; StestMxpxp += (CurThinEbmDat.dzds0*CurThinEbmDat.dzds0);
+
+		long AmOfMacroPrt = i + 1;
+		if(showProgressInd) if(result = CompProgressInd.UpdateIndicator(AmOfMacroPrt)) return result;
+		if((arSumS0E2 != 0) && (AmOfMacroPrt >= MinAmOfMacroPrtForRelErr) && ((AmOfMacroPrt % PerCheckRelErr) == 0))
+		{
+			if(EstimRelErrIntens(OutStokes, arSumS0E2, AmOfMacroPrt) <= RelErrToStop) break;
+		}
 	}
 
 		//double testXc = StestXc/MaxAmOfMacroPrt, testMxx = StestMxx/MaxAmOfMacroPrt;
@@ -152,6 +191,7 @@ int srTPropagMultiE::PropagateElecFieldStokes(srTEbmDat& ThickEbmDat, srTSRWRadS
 	srTParPrecWfrPropag ManParPrecWfrPropag(ManMethNo, 0, 0, 1., 0.5);
 
 	//if(result = ((srTGenOptElem*)(OptHndl.rep))->PropagateRadiation(pLocWfr, AutoMethNo, RadResizeVect)) return result;
+	((srTGenOptElem*)(OptHndl.rep))->SetDataIsFixed(); //the same elements are applied to the wavefronts of all macro-particles
 	if(result = ((srTGenOptElem*)(OptHndl.rep))->PropagateRadiation(pLocWfr, AutoParPrecWfrPropag, RadResizeVect)) return result;
 
 	if(result = ReallocateStokesAccordingToWfr(*pLocWfr, OutStokes)) return result;
@@ -274,8 +314,8 @@ int srTPropagMultiE::ReallocateStokesAccordingToWfr(srTSRWRadStructAccessData& L
 
 //*************************************************************************
 
-int srTPropagMultiE::AddWfrToStokesWithInterpXZ(srTSRWRadStructAccessData& Wfr, srTStokesStructAccessData& Stokes, long MacroPartCountZeroBased)
-{
+int srTPropagMultiE::AddWfrToStokesWithInterpXZ(srTSRWRadStructAccessData& Wfr, srTStokesStructAccessData& Stokes, long MacroPartCountZeroBased, double* arSumS0E2)
+{//if arSumS0E2 != 0, squared intensities (S0) of the added wavefront are summed up in it (per point, in the order of the Stokes data)
 	//int result = 0;
 	//if(AllowResize)
 	//{
@@ -306,11 +346,12 @@ int srTPropagMultiE::AddWfrToStokesWithInterpXZ(srTSRWRadStructAccessData& Wfr,
 			{
 				float *pSto = Stokes.pBaseSto + izPerZ + ixPerX +ie*PerE;
 
+				float StoE[] = {0., 0., 0., 0.}; //Stokes parameters of the added wavefront alone
+				Wfr.AddStokesAtPoint(EXZ, StoE);
+				if(arSumS0E2 != 0) *(arSumS0E2++) += ((double)StoE[0])*((double)StoE[0]);
+
 				float *tSto = pSto;
-				for(int k=0; k<4; k++) *(tSto++) *= fMacroPartCountZeroBased; 
-				Wfr.AddStokesAtPoint(EXZ, pSto);
-				tSto = pSto;
-				for(int i=0; i<4; i++) *(tSto++) *= fInvN; 
+				for(int k=0; k<4; k++) { *tSto = (*tSto*fMacroPartCountZeroBased + StoE[k])*fInvN; tSto++;}
 
 				//if(result = srYield.Check()) return result;
 				//if(result = CompProgressInd.UpdateIndicator(PointCount++)) return result;
@@ -366,7 +407,30 @@ int srTPropagMultiE::AddWfrToStokes(srTSRWRadStructAccessData& Wfr, srTStokesStr
 
 //*************************************************************************
 
-void srTPropagMultiE::SetupNextThinEbm(srTEbmDat& EbmDat, srTSigleElecVars& SigleElecVars, srTEbmDat& OutThinEbmDat)
+double srTPropagMultiE::EstimRelErrIntens(srTStokesStructAccessData& Stokes, double* arSumS0E2, long MacroPartCount)
+{//Standard error of the averaged intensity (S0), from the per-point variances of single-electron intensities, relative to the intensity (in the sense of L2 norm over all points).
+ //For quasi-random sampling this is an upper estimate: the actual error decreases faster than 1/sqrt(MacroPartCount).
+	if((arSumS0E2 == 0) || (MacroPartCount <= 1)) return -1.;
+
+	long AmOfPts = Stokes.ne*Stokes.nx*Stokes.nz;
+	double InvN = 1./MacroPartCount;
+	float *tSto = Stokes.pBaseSto;
+	double SumVar = 0., SumS0E2 = 0.;
+	for(long i=0; i<AmOfPts; i++)
+	{
+		double S0 = *tSto;
+		double Var = (*(arSumS0E2++))*InvN - S0*S0;
+		if(Var > 0.) SumVar += Var;
+		SumS0E2 += S0*S0;
+		tSto += 4;
+	}
+	if(SumS0E2 <= 0.) return 0.;
+	return sqrt(SumVar*InvN/SumS0E2);
+}
+
+//*************************************************************************
+
+void srTPropagMultiE::SetupNextThinEbm(srTEbmDat& EbmDat, srTSigleElecVars& SigleElecVars, srTEbmDat& OutThinEbmDat, char RandMode)
 {
 	//Take into account here:
 	// - coupling x - xp
@@ -379,14 +443,14 @@ void srTPropagMultiE::SetupNextThinEbm(srTEbmDat& EbmDat, srTSigleElecVars& Sigl
 	if((!VarX_or_VarXp) && VarZ_or_VarZp)
 	{
 		//gRandGen.NextGaussRand2D(EbmDat.z0, sqrt(EbmDat.Mzz), EbmDat.dzds0, sqrt(EbmDat.Mzpzp), OutThinEbmDat.z0, OutThinEbmDat.dzds0);
-		gRandGen.NextRandGauss2D(EbmDat.z0, sqrt(EbmDat.Mzz), EbmDat.dzds0, sqrt(EbmDat.Mzpzp), OutThinEbmDat.z0, OutThinEbmDat.dzds0);
+		gRandGen.NextRandGauss2D(EbmDat.z0, sqrt(EbmDat.Mzz), EbmDat.dzds0, sqrt(EbmDat.Mzpzp), OutThinEbmDat.z0, OutThinEbmDat.dzds0, RandMode);
 
 		//OutThinEbmDat.z0 = 0.; OutThinEbmDat.dzds0 = 2.e-06;
 	}
 	else if(VarX_or_VarXp && (!VarZ_or_VarZp))
 	{
 		//gRandGen.NextGaussRand2D(EbmDat.x0, sqrt(EbmDat.Mxx), EbmDat.dxds0, sqrt(EbmDat.Mxpxp), OutThinEbmDat.x0, OutThinEbmDat.dxds0);
-		gRandGen.NextRandGauss2D(EbmDat.x0, sqrt(EbmDat.Mxx), EbmDat.dxds0, sqrt(EbmDat.Mxpxp), OutThinEbmDat.x0, OutThinEbmDat.dxds0);
+		gRandGen.NextRandGauss2D(EbmDat.x0, sqrt(EbmDat.Mxx), EbmDat.dxds0, sqrt(EbmDat.Mxpxp), OutThinEbmDat.x0, OutThinEbmDat.dxds0, RandMode);
 	}
 	else if(VarX_or_VarXp && VarZ_or_VarZp)
 	{
@@ -394,7 +458,7 @@ void srTPropagMultiE::SetupNextThinEbm(srTEbmDat& EbmDat, srTSigleElecVars& Sigl
 		double SigmaXArr[] = {sqrt(EbmDat.Mxx), sqrt(EbmDat.Mxpxp), sqrt(EbmDat.Mzz), sqrt(EbmDat.Mzpzp)};
 
 		//gRandGen.NextGaussRand4D(XcArr, SigmaXArr, OutThinEbmDat.x0, OutThinEbmDat.dxds0, OutThinEbmDat.z0, OutThinEbmDat.dzds0);
-		gRandGen.NextRandGauss4D(XcArr, SigmaXArr, OutThinEbmDat.x0, OutThinEbmDat.dxds0, OutThinEbmDat.z0, OutThinEbmDat.dzds0);
+		gRandGen.NextRandGauss4D(XcArr, SigmaXArr, OutThinEbmDat.x0, OutThinEbmDat.dxds0, OutThinEbmDat.z0, OutThinEbmDat.dzds0, RandMode);
 		
 		//int aha = 1;
 		//make sure Multi-D LpTau is implemented
@@ -445,6 +509,7 @@ void srTPropagMultiE::SimulateWfrFromOffAxisEbm(srTEbmDat& OnAxisEbmDat, srTEbmD
 		//double kMult = 5.0676816037856e+06; //(TwoPi/(1.239854e-06))
 		double kMult = 5.067730652e+06; //(TwoPi/(1.239842e-06))
 
+		Wfr.NoteFieldModif();
 		float *pEx0 = Wfr.pBaseRadX;
 		float *pEz0 = Wfr.pBaseRadZ;
 		long PerX = Wfr.ne << 1;
@@ -566,3 +631,564 @@ int srTPropagMultiE::ReallocateStokesAccordingToWfr(srTWfrSmp& WfrSmp, srTStokes
 }
 
 //*************************************************************************
+
+bool srTPropagMultiE::SetupPhaseSpaceQuadr(double Mxx, double Mxxp, double Mxpxp, int nNodes, vector<double>& vPos, vector<double>& vAng, vector<double>& vW)
+{//Nodes and weights of Gauss-Hermite quadrature over 2D Gaussian distribution of position and angle deviations with 2nd order moments Mxx, Mxxp, Mxpxp;
+ //the correlation is treated by Cholesky factorization: x = a11*u1, x' = a21*u1 + a22*u2, with u1, u2 independent standard normal variables
+	vPos.clear(); vAng.clear(); vW.clear();
+
+	double a11 = (Mxx > 0.)? sqrt(Mxx) : 0.;
+	double a21 = (a11 > 0.)? Mxxp/a11 : 0.;
+	double a22E2 = Mxpxp - a21*a21;
+	double a22 = (a22E2 > 0.)? sqrt(a22E2) : 0.;
+
+	if(nNodes < 1) nNodes = 1;
+	int n1 = (a11 > 0.)? nNodes : 1;
+	int n2 = (a22 > 0.)? nNodes : 1;
+
+	vector<double> vU1(n1), vW1(n1), vU2(n2), vW2(n2);
+	if(!CGenMathMeth::GaussHermiteNodesWeights(n1, &vU1[0], &vW1[0])) return false;
+	if(!CGenMathMeth::GaussHermiteNodesWeights(n2, &vU2[0], &vW2[0])) return false;
+
+	for(int i1=0; i1<n1; i1++)
+	{
+		for(int i2=0; i2<n2; i2++)
+		{
+			vPos.push_back(a11*vU1[i1]);
+			vAng.push_back(a21*vU1[i1] + a22*vU2[i2]);
+			vW.push_back(vW1[i1]*vW2[i2]);
+		}
+	}
+	return true;
+}
+
+//*************************************************************************
+
+int srTPropagMultiE::EigDecompSampleGram(float* arA, int nCol, long lenCol, int nVecMax, double relMin, double* arV, double* arLam, int& nVec, double& trG)
+{//Eigenvalues and eigenvectors of the Gram matrix G[i][j] = Sum(A_i* A_j) of complex columns A_i (nCol columns of lenCol floats);
+ //nVec (<= nVecMax) eigenvectors with eigenvalues >= relMin*trG are returned in arV (nVec complex vectors of length nCol), eigenvalues in arLam (in descending order).
+ //The Hermitian G is processed by its real symmetric embedding B = [[Re(G), -Im(G)], [Im(G), Re(G)]]
+	nVec = 0; trG = 0.;
+	if(nCol <= 0) return 0;
+	int nCol2 = nCol << 1;
+	double *arB = new double[(long)nCol2*nCol2];
+	double *arEig = new double[nCol2];
+	if((arB == 0) || (arEig == 0)) { delete[] arB; delete[] arEig; return MEMORY_ALLOCATION_FAILURE;}
+
+	for(int i=0; i<nCol; i++)
+	{
+		float *tAi0 = arA + i*lenCol;
+		for(int j=i; j<nCol; j++)
+		{
+			float *tAi = tAi0, *tAj = arA + j*lenCol;
+			double gRe = 0., gIm = 0.;
+			for(long p=0; p<lenCol; p += 2)
+			{
+				double aRe = tAi[p], aIm = tAi[p + 1], bRe = tAj[p], bIm = tAj[p + 1];
+				gRe += aRe*bRe + aIm*bIm;
+				gIm += aRe*bIm - aIm*bRe;
+			}
+			arB[(long)i*nCol2 + j] = arB[(long)j*nCol2 + i] = arB[(long)(i + nCol)*nCol2 + j + nCol] = arB[(long)(j + nCol)*nCol2 + i + nCol] = gRe;
+			arB[(long)(i + nCol)*nCol2 + j] = gIm; arB[(long)(j + nCol)*nCol2 + i] = -gIm;
+			arB[(long)i*nCol2 + j + nCol] = -gIm; arB[(long)j*nCol2 + i + nCol] = gIm;
+			if(i == j) trG += gRe;
+		}
+	}
+	if(trG <= 0.) { delete[] arB; delete[] arEig; return 0;}
+
+	if(!CGenMathMeth::EigSym(arB, nCol2, arEig)) { delete[] arB; delete[] arEig; return SRWL_INCORRECT_PARAM_FOR_COH_MODES;}
+
+	//Each eigenvalue of G appears twice in B, with eigenvectors (a; b) and (-b; a), both corresponding to the complex eigenvector a + i*b of G;
+	//the complex vectors are therefore orthogonalized to the ones already selected
+	for(int r=0; (r<nCol2) && (nVec<nVecMax); r++)
+	{
+		double lam = arEig[r];
+		if((lam <= 0.) || (lam < relMin*trG)) break;
+		double *tB = arB + (long)r*nCol2;
+		double *tV = arV + (long)nVec*nCol2;
+		for(int j=0; j<nCol; j++) { tV[j << 1] = tB[j]; tV[(j << 1) + 1] = tB[j + nCol];}
+		for(int k=0; k<nVec; k++)
+		{
+			double *tVk = arV + (long)k*nCol2;
+			double cRe = 0., cIm = 0.;
+			for(int j=0; j<nCol2; j += 2)
+			{
+				cRe += tVk[j]*tV[j] + tVk[j + 1]*tV[j + 1];
+				cIm += tVk[j]*tV[j + 1] - tVk[j + 1]*tV[j];
+			}
+			for(int j=0; j<nCol2; j += 2)
+			{
+				tV[j] -= cRe*tVk[j] - cIm*tVk[j + 1];
+				tV[j + 1] -= cRe*tVk[j + 1] + cIm*tVk[j];
+			}
+		}
+		double normE2 = 0.;
+		for(int j=0; j<nCol2; j++) normE2 += tV[j]*tV[j];
+		if(normE2 < 0.5) continue;
+		double invNorm = 1./sqrt(normE2);
+		for(int j=0; j<nCol2; j++) tV[j] *= invNorm;
+		arLam[nVec++] = lam;
+	}
+	delete[] arB; delete[] arEig;
+	return 0;
+}
+
+//*************************************************************************
+
+void srTPropagMultiE::CombineSamples(float* arA, int nCol, long lenCol, double* arV, double* arU, float* arOut)
+{//u = Sum_j A_j*v[j], for complex columns A_j and complex vector v (of length nCol); the result is put to arU and, if arOut != 0, to arOut
+	for(long p=0; p<lenCol; p++) arU[p] = 0.;
+	for(int j=0; j<nCol; j++)
+	{
+		double vRe = arV[j << 1], vIm = arV[(j << 1) + 1];
+		float *tAj = arA + j*lenCol;
+		for(long p=0; p<lenCol; p += 2)
+		{
+			double aRe = tAj[p], aIm = tAj[p + 1];
+			arU[p] += aRe*vRe - aIm*vIm;
+			arU[p + 1] += aRe*vIm + aIm*vRe;
+		}
+	}
+	if(arOut != 0) for(long p=0; p<lenCol; p++) arOut[p] = (float)arU[p];
+}
+
+//*************************************************************************
+
+int srTPropagMultiE::DecomposeCohModes(srTSRWRadStructAccessData& InWfr, srTEbmDat& EbmDat, srTSRWRadStructAccessData** arModes, int& nModes, double* arOcc, double* pPrecPar)
+{//Coherent-mode decomposition of the Cross-Spectral Density (CSD) of radiation from finite-emittance electron beam, at each photon energy of InWfr.
+ //The CSD is represented as W(r1,r2) = Sum_j w_j E_j*(r1) E_j(r2), where E_j are the fields of the average electron (InWfr), shifted and tilted as in SimulateWfrFromOffAxisEbm,
+ //at nodes of Gauss-Hermite quadrature over the electron beam phase space (and over the relative energy spread, if InWfr contains several photon energies:
+ //the field of electron with relative energy deviation dGam is approximated by the field of the average electron at photon energy e/(1 + dGam)^2, interpolated vs photon energy).
+ //The modes are obtained from the eigenvectors of the Gram matrix of the weighted samples ("method of snapshots"), without forming the CSD itself.
+ //The field of each mode is scaled by the square root of its eigenvalue, so that the sum of "single-electron" intensities of the modes is the "multi-electron" intensity.
+ //pPrecPar[0]: number of quadrature nodes per horizontal phase-space variable; [1]: same for vertical; [2]: number of nodes vs relative energy spread;
+ //[3]: minimal occupation (eigenvalue relative to the sum of all eigenvalues) of the modes to keep.
+ //All the weighted samples at one photon energy are kept in memory (they are needed both for the Gram matrix and for the fields of the modes):
+ //this takes 8*nSmp*nPol*nx*nz bytes, nSmp <= pPrecPar[0]^2*pPrecPar[1]^2*pPrecPar[2] being the number of samples (nPol = 1 or 2 polarization components stored);
+ //e.g. 5.4 GB for the default 5, 5, 3 nodes, one polarization component and a 600x600 mesh. If this memory can't be allocated, SRWL_TOO_MANY_SAMPLES_FOR_COH_MODES is returned.
+ //On return, nModes is the maximal number of modes kept at one photon energy; arOcc[ie*nModes_in + k] is the occupation of mode k at photon energy ie.
+	const double kMult = 5.067730652e+06; //(TwoPi/(1.239842e-06))
+
+	int nModesMax = nModes;
+	if((arModes == 0) || (nModesMax <= 0) || (arOcc == 0) || (pPrecPar == 0)) return SRWL_INCORRECT_PARAM_FOR_COH_MODES;
+	if(((InWfr.pBaseRadX == 0) && (InWfr.pBaseRadZ == 0)) || (InWfr.Pres != 0) || (InWfr.PresT != 0)) return SRWL_INCORRECT_PARAM_FOR_COH_MODES;
+	for(int k=0; k<nModesMax; k++)
+	{
+		srTSRWRadStructAccessData *pMode = arModes[k];
+		if((pMode == 0) || (pMode->ne != InWfr.ne) || (pMode->nx != InWfr.nx) || (pMode->nz != InWfr.nz)) return SRWL_INCORRECT_PARAM_FOR_COH_MODES;
+		if(((InWfr.pBaseRadX != 0) && (pMode->pBaseRadX == 0)) || ((InWfr.pBaseRadZ != 0) && (pMode->pBaseRadZ == 0))) return SRWL_INCORRECT_PARAM_FOR_COH_MODES;
+	}
+
+	vector<double> vDx, vDxp, vWx, vDz, vDzp, vWz;
+	if(!SetupPhaseSpaceQuadr(EbmDat.Mxx, EbmDat.Mxxp, EbmDat.Mxpxp, (int)pPrecPar[0], vDx, vDxp, vWx)) return SRWL_INCORRECT_PARAM_FOR_COH_MODES;
+	if(!SetupPhaseSpaceQuadr(EbmDat.Mzz, EbmDat.Mzzp, EbmDat.Mzpzp, (int)pPrecPar[1], vDz, vDzp, vWz)) return SRWL_INCORRECT_PARAM_FOR_COH_MODES;
+
+	int nNodesE = ((InWfr.ne > 1) && (EbmDat.SigmaRelE > 0.) && (pPrecPar[2] > 1.))? (int)pPrecPar[2] : 1;
+	vector<double> vDe(nNodesE), vWe(nNodesE);
+	if(!CGenMathMeth::GaussHermiteNodesWeights(nNodesE, &vDe[0], &vWe[0])) return SRWL_INCORRECT_PARAM_FOR_COH_MODES;
+	for(int i=0; i<nNodesE; i++) vDe[i] *= EbmDat.SigmaRelE;
+	double relOccMin = pPrecPar[3];
+
+	long ne = InWfr.ne, nx = InWfr.nx, nz = InWfr.nz;
+	long PerX = ne << 1;
+	long PerZ = PerX*nx;
+	long nPt = nx*nz;
+	int nPol = ((InWfr.pBaseRadX != 0)? 1 : 0) + ((InWfr.pBaseRadZ != 0)? 1 : 0);
+	long lenCol = (nPol*nPt) << 1;
+	int nSmpX = (int)vWx.size(), nSmpZ = (int)vWz.size();
+	int nSmp = nSmpX*nSmpZ*nNodesE;
+	int nSmp2 = nSmp << 1;
+	int nModesKeep = (nModesMax < nSmp)? nModesMax : nSmp;
+	float *arPolInp[] = {InWfr.pBaseRadX, InWfr.pBaseRadZ};
+
+	float *arA = ((lenCol > 0) && ((size_t)nSmp <= ((size_t)(-1))/(sizeof(float)*lenCol)))? new(nothrow) float[(size_t)nSmp*lenCol] : 0; //weighted samples of the field (the largest array, see the memory estimate above)
+	if(arA == 0) return SRWL_TOO_MANY_SAMPLES_FOR_COH_MODES;
+	float *arS = new(nothrow) float[ne*lenCol]; //smooth part of the field: [ie][pol][iz][ix][re,im]
+	float *arSe = new(nothrow) float[lenCol];
+	double *arV = new(nothrow) double[(long)nModesKeep*nSmp2];
+	double *arLam = new(nothrow) double[nModesKeep];
+	double *arU = new(nothrow) double[lenCol];
+	long *arIx = new(nothrow) long[nSmpX*nx], *arIz = new(nothrow) long[nSmpZ*nz];
+	double *arFx = new(nothrow) double[nSmpX*nx], *arFz = new(nothrow) double[nSmpZ*nz];
+	double *arCx = new(nothrow) double[(nSmpX*nx) << 1], *arCz = new(nothrow) double[(nSmpZ*nz) << 1];
+	if((arS == 0) || (arSe == 0) || (arA == 0) || (arV == 0) || (arLam == 0) || (arU == 0) || (arIx == 0) || (arIz == 0) || (arFx == 0) || (arFz == 0) || (arCx == 0) || (arCz == 0))
+	{
+		delete[] arS; delete[] arSe; delete[] arA;
+		delete[] arV; delete[] arLam; delete[] arU;
+		delete[] arIx; delete[] arIz; delete[] arFx; delete[] arFz; delete[] arCx; delete[] arCz;
+		return MEMORY_ALLOCATION_FAILURE;
+	}
+
+	double invRx = (InWfr.RobsX != 0.)? 1./InWfr.RobsX : 0.;
+	double invRz = (InWfr.RobsZ != 0.)? 1./InWfr.RobsZ : 0.;
+
+	//Removing the quadratic phase term, to make the field suitable for interpolation at shifted positions
+	float *tS = arS;
+	for(long ie=0; ie<ne; ie++)
+	{
+		double k_d_2 = 0.5*kMult*(InWfr.eStart + ie*InWfr.eStep);
+		for(int iPol=0; iPol<2; iPol++)
+		{
+			if(arPolInp[iPol] == 0) continue;
+			for(long iz=0; iz<nz; iz++)
+			{
+				double dz = InWfr.zStart + iz*InWfr.zStep - InWfr.zc;
+				double phZ = k_d_2*dz*dz*invRz;
+				float *tE = arPolInp[iPol] + iz*PerZ + (ie << 1);
+				for(long ix=0; ix<nx; ix++)
+				{
+					double dx = InWfr.xStart + ix*InWfr.xStep - InWfr.xc;
+					double ph = -(phZ + k_d_2*dx*dx*invRx);
+					double cosPh = cos(ph), sinPh = sin(ph);
+					double ERe = *tE, EIm = *(tE + 1);
+					*(tS++) = (float)(ERe*cosPh - EIm*sinPh);
+					*(tS++) = (float)(ERe*sinPh + EIm*cosPh);
+					tE += PerX;
+				}
+			}
+		}
+	}
+
+	long dIx = (nx > 1)? 1 : 0, dIz = (nz > 1)? 2*nx : 0;
+	int nModesOut = 0;
+
+	srTCompProgressIndicator CompProgressInd;
+	char showProgressInd = (gpCompJob != 0)? 1 : 0; //progress (number of photon energies processed) is only reported to the job run by this thread (see srwlJobStart)
+	if(showProgressInd) CompProgressInd.InitializeIndicator(ne, 0.5);
+	for(long ie=0; ie<ne; ie++)
+	{
+		double eSl = InWfr.eStart + ie*InWfr.eStep;
+		double kSl = kMult*eSl;
+		for(long i=0; i<(long)nSmp*lenCol; i++) arA[i] = 0.;
+
+		for(int iSmpE=0; iSmpE<nNodesE; iSmpE++)
+		{
+			double onePlusDe = 1. + vDe[iSmpE];
+			double eSrc = eSl/(onePlusDe*onePlusDe);
+			long ie0 = 0;
+			double fe = 0.;
+			if(ne > 1)
+			{
+				double t = (eSrc - InWfr.eStart)/InWfr.eStep;
+				if((t < -1.e-09) || (t > ne - 1 + 1.e-09)) continue; //the field is assumed to be zero outside the photon energy range
+				ie0 = (long)t;
+				if(ie0 < 0) ie0 = 0; else if(ie0 > ne - 2) ie0 = ne - 2;
+				fe = t - ie0;
+			}
+			float *tS0 = arS + ie0*lenCol, *tS1 = (ne > 1)? (tS0 + lenCol) : tS0;
+			for(long i=0; i<lenCol; i++) arSe[i] = (float)((1. - fe)*tS0[i] + fe*tS1[i]);
+
+			//Positions of the shifted points in the mesh, and phase factors, separately vs x and z
+			double kSrc_d_2 = 0.5*kMult*eSrc;
+			for(int iSmpX=0; iSmpX<nSmpX; iSmpX++)
+			{
+				double dxp = vDxp[iSmpX], dX = vDx[iSmpX] + InWfr.RobsX*dxp;
+				long *tIx = arIx + iSmpX*nx; double *tFx = arFx + iSmpX*nx, *tCx = arCx + ((iSmpX*nx) << 1);
+				for(long ix=0; ix<nx; ix++)
+				{
+					double x = InWfr.xStart + ix*InWfr.xStep, xs = x - dX;
+					tIx[ix] = -1; tFx[ix] = 0.;
+					if(nx > 1)
+					{
+						double t = (xs - InWfr.xStart)/InWfr.xStep;
+						if((t >= 0.) && (t <= nx - 1))
+						{
+							long i0 = (long)t; if(i0 > nx - 2) i0 = nx - 2;
+							tIx[ix] = i0; tFx[ix] = t - i0;
+						}
+					}
+					else { tIx[ix] = 0; xs = x;}
+					double dxs = xs - InWfr.xc;
+					double ph = kSrc_d_2*dxs*dxs*invRx + kSl*dxp*(x - InWfr.RobsX*dxp);
+					tCx[ix << 1] = cos(ph); tCx[(ix << 1) + 1] = sin(ph);
+				}
+			}
+			for(int iSmpZ=0; iSmpZ<nSmpZ; iSmpZ++)
+			{
+				double dzp = vDzp[iSmpZ], dZ = vDz[iSmpZ] + InWfr.RobsZ*dzp;
+				long *tIz = arIz + iSmpZ*nz; double *tFz = arFz + iSmpZ*nz, *tCz = arCz + ((iSmpZ*nz) << 1);
+				for(long iz=0; iz<nz; iz++)
+				{
+					double z = InWfr.zStart + iz*InWfr.zStep, zs = z - dZ;
+					tIz[iz] = -1; tFz[iz] = 0.;
+					if(nz > 1)
+					{
+						double t = (zs - InWfr.zStart)/InWfr.zStep;
+						if((t >= 0.) && (t <= nz - 1))
+						{
+							long i0 = (long)t; if(i0 > nz - 2) i0 = nz - 2;
+							tIz[iz] = i0; tFz[iz] = t - i0;
+						}
+					}
+					else { tIz[iz] = 0; zs = z;}
+					double dzs = zs - InWfr.zc;
+					double ph = kSrc_d_2*dzs*dzs*invRz + kSl*dzp*(z - InWfr.RobsZ*dzp);
+					tCz[iz << 1] = cos(ph); tCz[(iz << 1) + 1] = sin(ph);
+				}
+			}
+
+			for(int iSmpX=0; iSmpX<nSmpX; iSmpX++)
+			{
+				long *tIx = arIx + iSmpX*nx; double *tFx = arFx + iSmpX*nx, *tCx = arCx + ((iSmpX*nx) << 1);
+				for(int iSmpZ=0; iSmpZ<nSmpZ; iSmpZ++)
+				{
+					long *tIz = arIz + iSmpZ*nz; double *tFz = arFz + iSmpZ*nz, *tCz = arCz + ((iSmpZ*nz) << 1);
+					double sqrtW = sqrt(vWe[iSmpE]*vWx[iSmpX]*vWz[iSmpZ]);
+					float *tA = arA + ((long)(iSmpE*nSmpZ + iSmpZ)*nSmpX + iSmpX)*lenCol;
+
+					for(int iPol=0; iPol<nPol; iPol++)
+					{
+						float *tSe = arSe + ((iPol*nPt) << 1);
+						for(long iz=0; iz<nz; iz++)
+						{
+							long iz0 = tIz[iz];
+							if(iz0 < 0) { tA += nx << 1; continue;}
+							double fz = tFz[iz], czRe = sqrtW*tCz[iz << 1], czIm = sqrtW*tCz[(iz << 1) + 1];
+							float *tSe0 = tSe + ((iz0*nx) << 1);
+							for(long ix=0; ix<nx; ix++)
+							{
+								long ix0 = tIx[ix];
+								if(ix0 >= 0)
+								{
+									double fx = tFx[ix];
+									float *p00 = tSe0 + (ix0 << 1), *p10 = p00 + (dIx << 1), *p01 = p00 + dIz, *p11 = p10 + dIz;
+									double w00 = (1. - fx)*(1. - fz), w10 = fx*(1. - fz), w01 = (1. - fx)*fz, w11 = fx*fz;
+									double SRe = w00*p00[0] + w10*p10[0] + w01*p01[0] + w11*p11[0];
+									double SIm = w00*p00[1] + w10*p10[1] + w01*p01[1] + w11*p11[1];
+									double cRe = tCx[ix << 1]*czRe - tCx[(ix << 1) + 1]*czIm;
+									double cIm = tCx[ix << 1]*czIm + tCx[(ix << 1) + 1]*czRe;
+									tA[0] = (float)(SRe*cRe - SIm*cIm);
+									tA[1] = (float)(SRe*cIm + SIm*cRe);
+								}
+								tA += 2;
+							}
+						}
+					}
+				}
+			}
+		}
+
+		int nModesSl = 0;
+		double trG = 0.;
+		int res = EigDecompSampleGram(arA, nSmp, lenCol, nModesKeep, relOccMin, arV, arLam, nModesSl, trG);
+		if(res)
+		{
+			delete[] arS; delete[] arSe; delete[] arA; delete[] arV; delete[] arLam; delete[] arU;
+			delete[] arIx; delete[] arIz; delete[] arFx; delete[] arFz; delete[] arCx; delete[] arCz;
+			return res;
+		}
+		if(nModesOut < nModesSl) nModesOut = nModesSl;
+
+		//Fields of the modes: u_k = Sum_j A_j*v_k[j], with |u_k|^2 = eigenvalue
+		for(int k=0; k<nModesMax; k++)
+		{
+			if(k < nModesSl)
+			{
+				CombineSamples(arA, nSmp, lenCol, arV + (long)k*nSmp2, arU, 0);
+				arOcc[ie*nModesMax + k] = arLam[k]/trG;
+			}
+			else
+			{
+				for(long p=0; p<lenCol; p++) arU[p] = 0.;
+				arOcc[ie*nModesMax + k] = 0.;
+			}
+
+			srTSRWRadStructAccessData &Mode = *(arModes[k]);
+			float *arPolOut[] = {Mode.pBaseRadX, Mode.pBaseRadZ};
+			double *tU = arU;
+			for(int iPol=0; iPol<2; iPol++)
+			{
+				if(arPolOut[iPol] == 0) continue;
+				if(arPolInp[iPol] == 0)
+				{
+					for(long iz=0; iz<nz; iz++)
+					{
+						float *tE = arPolOut[iPol] + iz*PerZ + (ie << 1);
+						for(long ix=0; ix<nx; ix++) { *tE = 0.; *(tE + 1) = 0.; tE += PerX;}
+					}
+					continue;
+				}
+				for(long iz=0; iz<nz; iz++)
+				{
+					float *tE = arPolOut[iPol] + iz*PerZ + (ie << 1);
+					for(long ix=0; ix<nx; ix++) { *tE = (float)(*(tU++)); *(tE + 1) = (float)(*(tU++)); tE += PerX;}
+				}
+			}
+		}
+
+		if(showProgressInd && (res = CompProgressInd.UpdateIndicator(ie + 1)))
+		{
+			delete[] arS; delete[] arSe; delete[] arA; delete[] arV; delete[] arLam; delete[] arU;
+			delete[] arIx; delete[] arIz; delete[] arFx; delete[] arFz; delete[] arCx; delete[] arCz;
+			return res;
+		}
+	}
+
+	for(int k=0; k<nModesMax; k++)
+	{
+		srTSRWRadStructAccessData &Mode = *(arModes[k]);
+		Mode.eStart = InWfr.eStart; Mode.eStep = InWfr.eStep;
+		Mode.xStart = InWfr.xStart; Mode.xStep = InWfr.xStep;
+		Mode.zStart = InWfr.zStart; Mode.zStep = InWfr.zStep;
+		Mode.xc = InWfr.xc; Mode.zc = InWfr.zc;
+		Mode.RobsX = InWfr.RobsX; Mode.RobsZ = InWfr.RobsZ;
+		Mode.RobsXAbsErr = InWfr.RobsXAbsErr; Mode.RobsZAbsErr = InWfr.RobsZAbsErr;
+		Mode.Pres = InWfr.Pres; Mode.PresT = InWfr.PresT;
+	}
+	nModes = nModesOut;
+
+	delete[] arS; delete[] arSe; delete[] arA; delete[] arV; delete[] arLam; delete[] arU;
+	delete[] arIx; delete[] arIz; delete[] arFx; delete[] arFz; delete[] arCx; delete[] arCz;
+	return 0;
+}
+
+//*************************************************************************
+
+void srTPropagMultiE::ExtractIntFromCohModes(srTSRWRadStructAccessData** arModes, int nModes, int pol, int intType, int depType, double e, double x, double y, float* pInt)
+{//Extracts characteristics of partially-coherent radiation represented by coherent modes (e.g. obtained by DecomposeCohModes and propagated):
+ //intType = 0: "multi-electron" intensity, i.e. the sum of "single-electron" intensities of the modes (pol and depType as in srTRadGenManip::ExtractRadiation);
+ //intType = 1: mutual intensity J(r1,r2) = Sum_k u_k*(r1) u_k(r2) of the polarization component pol, vs x1, x2 at (e, y) (depType = 1) or vs y1, y2 at (e, x) (depType = 2);
+ //  pInt[2*(i1 + i2*n)] and pInt[2*(i1 + i2*n) + 1] are the real and imaginary parts of J(r1,r2);
+ //intType = 2: degree of coherence |J(r1,r2)|/sqrt(J(r1,r1)*J(r2,r2)), on the same mesh as for intType = 1.
+ //All the modes should have the same mesh.
+	if((arModes == 0) || (nModes <= 0) || (pInt == 0) || (intType < 0) || (intType > 2)) throw SRWL_INCORRECT_PARAM_FOR_COH_MODES;
+	if((intType > 0) && (depType != 1) && (depType != 2)) throw SRWL_INCORRECT_PARAM_FOR_COH_MODES;
+
+	const double relTol = 1.e-09;
+	srTSRWRadStructAccessData &Mode0 = *(arModes[0]);
+	for(int k=0; k<nModes; k++)
+	{
+		srTSRWRadStructAccessData *pMode = arModes[k];
+		if(pMode == 0) throw SRWL_INCORRECT_PARAM_FOR_COH_MODES;
+		if((pMode->ne != Mode0.ne) || (pMode->nx != Mode0.nx) || (pMode->nz != Mode0.nz) || (pMode->Pres != Mode0.Pres)) throw SRWL_INCORRECT_PARAM_FOR_COH_MODES;
+		if((::fabs(pMode->eStart - Mode0.eStart) > relTol*::fabs(Mode0.eStart) + relTol*::fabs(Mode0.eStep)) || (::fabs(pMode->eStep - Mode0.eStep) > relTol*::fabs(Mode0.eStep)) ||
+		   (::fabs(pMode->xStart - Mode0.xStart) > relTol*::fabs(Mode0.xStep*Mode0.nx)) || (::fabs(pMode->xStep - Mode0.xStep) > relTol*::fabs(Mode0.xStep)) ||
+		   (::fabs(pMode->zStart - Mode0.zStart) > relTol*::fabs(Mode0.zStep*Mode0.nz)) || (::fabs(pMode->zStep - Mode0.zStep) > relTol*::fabs(Mode0.zStep))) throw SRWL_INCORRECT_PARAM_FOR_COH_MODES;
+	}
+
+	if(intType == 0)
+	{
+		long np = 1;
+		if((depType == 0) || (depType >= 4)) np *= Mode0.ne;
+		if((depType == 1) || (depType == 3) || (depType == 4) || (depType == 6)) np *= Mode0.nx;
+		if((depType == 2) || (depType == 3) || (depType == 5) || (depType == 6)) np *= Mode0.nz;
+
+		float *arAux = new float[np];
+		if(arAux == 0) throw MEMORY_ALLOCATION_FAILURE;
+		for(long i=0; i<np; i++) pInt[i] = 0.;
+		for(int k=0; k<nModes; k++)
+		{
+			CHGenObj hMode(arModes[k], true);
+			srTRadGenManip RadGenManip(hMode);
+			try { RadGenManip.ExtractRadiation(pol, 0, depType, arModes[k]->Pres, e, x, y, (char*)arAux);}
+			catch(int erNo) { delete[] arAux; throw erNo;}
+			for(long i=0; i<np; i++) pInt[i] += arAux[i];
+		}
+		delete[] arAux;
+		return;
+	}
+
+	//Linear interpolation vs photon energy and vs the fixed transverse coordinate
+	long ne = Mode0.ne, nx = Mode0.nx, nz = Mode0.nz;
+	long PerX = ne << 1, PerZ = PerX*nx;
+	long ie0 = 0, iFix0 = 0, dIe = 0, dIFix = 0;
+	double fe = 0., fFix = 0.;
+	if(ne > 1)
+	{
+		double t = (e - Mode0.eStart)/Mode0.eStep;
+		if(t < 0.) t = 0.; else if(t > ne - 1) t = (double)(ne - 1);
+		ie0 = (long)t; if(ie0 > ne - 2) ie0 = ne - 2;
+		fe = t - ie0; dIe = 2;
+	}
+	long n = (depType == 1)? nx : nz, nFix = (depType == 1)? nz : nx;
+	double argFixStart = (depType == 1)? Mode0.zStart : Mode0.xStart, argFixStep = (depType == 1)? Mode0.zStep : Mode0.xStep;
+	long PerArg = (depType == 1)? PerX : PerZ, PerFix = (depType == 1)? PerZ : PerX;
+	if(nFix > 1)
+	{
+		double t = (((depType == 1)? y : x) - argFixStart)/argFixStep;
+		if(t < 0.) t = 0.; else if(t > nFix - 1) t = (double)(nFix - 1);
+		iFix0 = (long)t; if(iFix0 > nFix - 2) iFix0 = nFix - 2;
+		fFix = t - iFix0; dIFix = PerFix;
+	}
+	long ofst00 = iFix0*PerFix + (ie0 << 1);
+	double w00 = (1. - fe)*(1. - fFix), w10 = fe*(1. - fFix), w01 = (1. - fe)*fFix, w11 = fe*fFix;
+
+	//Polarization component: aX*Ex + aZ*Ez (as in srTRadGenManip::IntensityComponent); total intensity: sum of the two linear components
+	const double invSqrt2 = 0.70710678118654752;
+	double arCoef[2][4]; //{aXRe, aXIm, aZRe, aZIm} for each "channel"
+	int nChan = 1;
+	switch(pol)
+	{
+		case 0: arCoef[0][0] = 1.; arCoef[0][1] = 0.; arCoef[0][2] = 0.; arCoef[0][3] = 0.; break;
+		case 1: arCoef[0][0] = 0.; arCoef[0][1] = 0.; arCoef[0][2] = 1.; arCoef[0][3] = 0.; break;
+		case 2: arCoef[0][0] = invSqrt2; arCoef[0][1] = 0.; arCoef[0][2] = invSqrt2; arCoef[0][3] = 0.; break;
+		case 3: arCoef[0][0] = invSqrt2; arCoef[0][1] = 0.; arCoef[0][2] = -invSqrt2; arCoef[0][3] = 0.; break;
+		case 4: arCoef[0][0] = invSqrt2; arCoef[0][1] = 0.; arCoef[0][2] = 0.; arCoef[0][3] = invSqrt2; break;
+		case 5: arCoef[0][0] = invSqrt2; arCoef[0][1] = 0.; arCoef[0][2] = 0.; arCoef[0][3] = -invSqrt2; break;
+		default:
+			nChan = 2;
+			arCoef[0][0] = 1.; arCoef[0][1] = 0.; arCoef[0][2] = 0.; arCoef[0][3] = 0.;
+			arCoef[1][0] = 0.; arCoef[1][1] = 0.; arCoef[1][2] = 1.; arCoef[1][3] = 0.;
+	}
+
+	long nE2 = n*n;
+	double *arJ = new double[nE2 << 1];
+	double *arU = new double[n << 1];
+	if((arJ == 0) || (arU == 0)) { delete[] arJ; delete[] arU; throw MEMORY_ALLOCATION_FAILURE;}
+	for(long i=0; i<(nE2 << 1); i++) arJ[i] = 0.;
+
+	for(int k=0; k<nModes; k++)
+	{
+		float *arE[] = {arModes[k]->pBaseRadX, arModes[k]->pBaseRadZ};
+		for(int iChan=0; iChan<nChan; iChan++)
+		{
+			double *c = arCoef[iChan];
+			for(long i=0; i<(n << 1); i++) arU[i] = 0.;
+			for(int iPol=0; iPol<2; iPol++)
+			{
+				double aRe = c[iPol << 1], aIm = c[(iPol << 1) + 1];
+				if((arE[iPol] == 0) || ((aRe == 0.) && (aIm == 0.))) continue;
+				float *tE = arE[iPol] + ofst00;
+				for(long i=0; i<n; i++)
+				{
+					double ERe = w00*tE[0] + w10*tE[dIe] + w01*tE[dIFix] + w11*tE[dIFix + dIe];
+					double EIm = w00*tE[1] + w10*tE[dIe + 1] + w01*tE[dIFix + 1] + w11*tE[dIFix + dIe + 1];
+					arU[i << 1] += aRe*ERe - aIm*EIm;
+					arU[(i << 1) + 1] += aRe*EIm + aIm*ERe;
+					tE += PerArg;
+				}
+			}
+			double *tJ = arJ;
+			for(long i2=0; i2<n; i2++)
+			{
+				double u2Re = arU[i2 << 1], u2Im = arU[(i2 << 1) + 1];
+				for(long i1=0; i1<n; i1++)
+				{
+					double u1Re = arU[i1 << 1], u1Im = arU[(i1 << 1) + 1];
+					*(tJ++) += u1Re*u2Re + u1Im*u2Im;
+					*(tJ++) += u1Re*u2Im - u1Im*u2Re;
+				}
+			}
+		}
+	}
+
+	if(intType == 1)
+	{
+		for(long i=0; i<(nE2 << 1); i++) pInt[i] = (float)arJ[i];
+	}
+	else
+	{
+		for(long i2=0; i2<n; i2++)
+		{
+			double J22 = arJ[(i2*(n + 1)) << 1];
+			for(long i1=0; i1<n; i1++)
+			{
+				double J11 = arJ[(i1*(n + 1)) << 1];
+				double *tJ = arJ + ((i1 + i2*n) << 1);
+				double denom = J11*J22;
+				pInt[i1 + i2*n] = (denom > 0.)? (float)(sqrt((tJ[0]*tJ[0] + tJ[1]*tJ[1])/denom)) : 0.f;
+			}
+		}
+	}
+	delete[] arJ; delete[] arU;
+}
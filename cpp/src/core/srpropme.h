@@ -56,7 +56,7 @@ struct srTSigleElecVars {
 
 class srTPropagMultiE {
 
-	static CGenMathRand gRandGen;
+	static thread_local CGenMathRand gRandGen; //per thread, so that jobs run concurrently (see srwlJobStart) do not share the random sequence
 
 public:
 
@@ -67,11 +67,18 @@ public:
 	static int ReallocateStokesAccordingToWfr(srTSRWRadStructAccessData& LocWfr, srTStokesStructAccessData& OutStokes);
 	
 	static int AddWfrToStokes(srTSRWRadStructAccessData& Wfr, srTStokesStructAccessData& Stokes, long MacroPartCount, double& CurRelPrec);
-	static int AddWfrToStokesWithInterpXZ(srTSRWRadStructAccessData& Wfr, srTStokesStructAccessData& Stokes, long MacroPartCount);
+	static int AddWfrToStokesWithInterpXZ(srTSRWRadStructAccessData& Wfr, srTStokesStructAccessData& Stokes, long MacroPartCount, double* arSumS0E2=0);
+	static double EstimRelErrIntens(srTStokesStructAccessData& Stokes, double* arSumS0E2, long MacroPartCount);
 
-	static void SetupNextThinEbm(srTEbmDat& EbmDat, srTSigleElecVars&, srTEbmDat& OutThinEbmDat);
+	static void SetupNextThinEbm(srTEbmDat& EbmDat, srTSigleElecVars&, srTEbmDat& OutThinEbmDat, char RandMode=1);
 	static void SimulateWfrFromOffAxisEbm(srTEbmDat& OnAxisEbmDat, srTEbmDat& OffAxisEbmDat, srTSigleElecVars&, srTSRWRadStructAccessData& Wfr);
 
+	static int DecomposeCohModes(srTSRWRadStructAccessData& InWfr, srTEbmDat& EbmDat, srTSRWRadStructAccessData** arModes, int& nModes, double* arOcc, double* pPrecPar);
+	static int EigDecompSampleGram(float* arA, int nCol, long lenCol, int nVecMax, double relMin, double* arV, double* arLam, int& nVec, double& trG);
+	static void CombineSamples(float* arA, int nCol, long lenCol, double* arV, double* arU, float* arOut);
+	static bool SetupPhaseSpaceQuadr(double Mxx, double Mxxp, double Mxpxp, int nNodes, vector<double>& vPos, vector<double>& vAng, vector<double>& vW);
+	static void ExtractIntFromCohModes(srTSRWRadStructAccessData** arModes, int nModes, int pol, int intType, int depType, double e, double x, double y, float* pInt);
+
 	static void CalcStokesFromE(float* tEx, float* tEz, float* Stokes)
 	{
 		float &EwX_Re = *tEx, &EwX_Im = *(tEx + 1);
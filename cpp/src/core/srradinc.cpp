@@ -14,6 +14,7 @@
 #include "srradinc.h"
 #include "srprgind.h"
 #include "gmfft.h"
+#include "gmconv.h"
 //#include "srmamet.h"
 #include "gmmeth.h"
 #include "gmfunc.h"
@@ -314,544 +315,41 @@ int srTRadIntConst::ComputeElFieldAtPointLocFrame(srTEFourier& E)
 //*************************************************************************
 
 int srTRadIntConst::TreatFiniteElecBeamEmittance(srTStokesStructAccessData& StokesAccessData, double ElBeamMomFact)
-{
-	int result;
+{//All Stokes components at all photon energies are convolved "in place", by one call of the separable Gaussian convolution
 	if((StokesAccessData.nx == 1) && (StokesAccessData.nz == 1)) return 0;
 
-	long LenFloatArr = (StokesAccessData.nx*StokesAccessData.nz);
-	float *StokesCmpnArr = new float[LenFloatArr];
-	if(StokesCmpnArr == 0) return MEMORY_ALLOCATION_FAILURE;
-
-	for(int ie=0; ie<StokesAccessData.ne; ie++)
-	{
-		for(int is=0; is<4; is++)
-		{
-			ExtractStokesSliceConstE(StokesAccessData, ie, is, StokesCmpnArr);
-
-			if((StokesAccessData.nx == 1) || (StokesAccessData.nz == 1))
-			{
-				if(result = TreatFiniteElecBeamEmittanceOneComp1D(StokesCmpnArr, ElBeamMomFact)) return result;
-			}
-			else
-			{
-				if(result = TreatFiniteElecBeamEmittanceOneComp2D(StokesCmpnArr, ElBeamMomFact)) return result;
-			}
-			if(is == 0) SuppressNegativeValues(StokesCmpnArr);
-
-			UpdateStokesSliceConstE(StokesCmpnArr, ie, is, StokesAccessData);
-		}
-	}
-	delete[] StokesCmpnArr;
-	return 0;
-}
-
-//*************************************************************************
-
-void srTRadIntConst::ExtractStokesSliceConstE(srTStokesStructAccessData& StokesAccessData, long ie, int StokesNo, float* pOutS)
-{
-	float *pS0 = StokesAccessData.pBaseSto + StokesNo;
-	long PerX = StokesAccessData.ne << 2;
-	long PerZ = PerX*StokesAccessData.nx;
-
-	long izPerZ = 0;
-	long iePerE = ie << 2;
-
-	float *tOutS = pOutS;
-	for(int iz=0; iz<StokesAccessData.nz; iz++)
-	{
-		float *pS_StartForX = pS0 + izPerZ;
-		long ixPerX = 0;
-
-		for(int ix=0; ix<StokesAccessData.nx; ix++)
-		{
-			long ixPerX_p_iePerE = ixPerX + iePerE;
-			float *pS = pS_StartForX + ixPerX_p_iePerE;
-			*(tOutS++) = *pS;
-
-			ixPerX += PerX;
-		}
-		izPerZ += PerZ;
-	}
-}
-
-//*************************************************************************
-
-void srTRadIntConst::UpdateStokesSliceConstE(float* StokesCmpnArr, long ie, int StokesNo, srTStokesStructAccessData& StokesAccessData)
-{
-	float *pS0 = StokesAccessData.pBaseSto + StokesNo;
-
-	long PerX = StokesAccessData.ne << 2;
-	long PerZ = PerX*StokesAccessData.nx;
-
-	long izPerZ = 0;
-	long iePerE = ie << 2;
-
-	float *tCmpn = StokesCmpnArr;
-	for(int iz=0; iz<StokesAccessData.nz; iz++)
-	{
-		float *pS_StartForX = pS0 + izPerZ;
-		long ixPerX = 0;
-
-		for(int ix=0; ix<StokesAccessData.nx; ix++)
-		{
-			long ixPerX_p_iePerE = ixPerX + iePerE;
-			float *pS = pS_StartForX + ixPerX_p_iePerE;
-			*pS = *(tCmpn++);
-
-			ixPerX += PerX;
-		}
-		izPerZ += PerZ;
-	}
-}
-
-//*************************************************************************
-
-int srTRadIntConst::TreatFiniteElecBeamEmittanceOneComp1D(float* CmpnArr, double ElBeamMomFact)
-{
-	int result;
-	char VsXorZ = 0;
-	if(DistrInfoDat.nx > 1) VsXorZ = 'x';
-	else if(DistrInfoDat.nz > 1) VsXorZ = 'z';
-	else return 0;
-
-	double M_ElecEff = ElBeamMomFact*((VsXorZ == 'x')? 0.5/Gx : 0.5/Gz);
-	double M_DistrSingleE;
-	DetermineSingleElecDistrEffSizes1D(CmpnArr, VsXorZ, M_DistrSingleE);
-
-	srTRadResize1D Resize;
-	DetermineResizeBeforeConv1D(M_ElecEff, M_DistrSingleE, VsXorZ, Resize);
-
-	long Np = (VsXorZ == 'x')? DistrInfoDat.nx : DistrInfoDat.nz;
-	long NpAux = (long)(Resize.pm*Np);
-
-	CGenMathFFT1D FFT;
-	FFT.NextCorrectNumberForFFT(NpAux);
-	float* AuxConvData = new float[NpAux << 1];
-	if(AuxConvData == 0) return MEMORY_ALLOCATION_FAILURE;
-
-	ConstructDataForConv1D(CmpnArr, AuxConvData, Np, NpAux);
-	if(result = PerformConvolutionWithGaussian1D(AuxConvData, NpAux, M_ElecEff, VsXorZ)) return result;
-
-	ExtractDataAfterConv1D(AuxConvData, NpAux, Np, CmpnArr);
-
-	if(AuxConvData != 0) delete[] AuxConvData;
-	return 0;
-}
-
-//*************************************************************************
-
-void srTRadIntConst::DetermineSingleElecDistrEffSizes1D(float* CmpnArr, char VsXorZ, double& M_Cen)
-{
-	long Np;
-	double Step, Arg;
-	if(VsXorZ == 'x') 
-	{
-		Np = DistrInfoDat.nx;
-		Step = (DistrInfoDat.xEnd - DistrInfoDat.xStart)/(DistrInfoDat.nx - 1);
-		Arg = DistrInfoDat.xStart;
-	}
-	else
-	{
-		Np = DistrInfoDat.nz;
-		Step = (DistrInfoDat.nz > 1)? (DistrInfoDat.zEnd - DistrInfoDat.zStart)/(DistrInfoDat.nz - 1) : 0.;
-		Arg = DistrInfoDat.zStart;
-	}
-	long Np_mi_1 = Np - 1;
-	float Sm0 = 0., Sm1 = 0., Sm2 = 0.;
-	float *tDistr = CmpnArr;
-	//float ArgE2 = (float)(Arg*Arg);
-	float w = 0.5;
-
-	for(int i=0; i<Np; i++)
-	{
-		if(i == Np_mi_1) w = 0.5;
-
-		float Distr = (float)::fabs(w*(*(tDistr++)));
-		Sm0 += Distr;
-		Sm1 += (float)(Arg*Distr);
-		Sm2 += (float)(Arg*Arg*Distr);
-
-		w = 1.;
-		Arg += Step;
-	}
-	float Norm = (float)(1./Sm0);
-	float M1 = Sm1*Norm, M2 = Sm2*Norm;
-	M_Cen = M2 - M1*M1;
-}
-
-//*************************************************************************
-
-void srTRadIntConst::DetermineResizeBeforeConv1D(double M_ElecEff, double M_DistrSingleE, char VsXorZ, srTRadResize1D& Resize)
-{
-	const double DoNotResizeRatio = 3.; // To steer
-	const double AmOfExtraSig = 2.5;
-
-	if(M_DistrSingleE*DoNotResizeRatio > M_ElecEff)
-	{
-		double ExtraRange = 2.*AmOfExtraSig*sqrt(M_ElecEff);
-		double CurrentRange = (VsXorZ == 'x')? (DistrInfoDat.xEnd - DistrInfoDat.xStart) : (DistrInfoDat.zEnd - DistrInfoDat.zStart);
-		Resize.pm = (CurrentRange + ExtraRange)/CurrentRange;
-	}
-}
-
-//*************************************************************************
-
-void srTRadIntConst::ConstructDataForConv1D(float* CmpnArr, float* AuxConvData, long NpOld, long NpNew)
-{
-	long iDat = (NpNew - NpOld) >> 1;
-
-	long i;
-	float V = *CmpnArr;
-	float *tNew = AuxConvData;
-	for(i=0; i<iDat; i++)
-	{
-		*(tNew++) = V; *(tNew++) = 0;
-	}
-	float *tOld = CmpnArr;
-	for(i=iDat; i<(iDat + NpOld); i++)
-	{
-		*(tNew++) = *(tOld++); *(tNew++) = 0;
-	}
-	V = *(CmpnArr + NpOld - 1);
-	for(i=(iDat + NpOld); i<NpNew; i++)
-	{
-		*(tNew++) = V; *(tNew++) = 0;
-	}
-}
-
-//*************************************************************************
-
-int srTRadIntConst::PerformConvolutionWithGaussian1D(float* ConvData, long NewNp, double M_ElecEff, char VsXorZ)
-{
-	int result;
-	const double Pi = 3.14159265358979;
-	const double TwoPi = Pi*2.;
-	const double TwoPiE2 = TwoPi*Pi;
-
-	double Step = (VsXorZ == 'x')? (DistrInfoDat.xEnd - DistrInfoDat.xStart)/(DistrInfoDat.nx - 1) : (DistrInfoDat.zEnd - DistrInfoDat.zStart)/(DistrInfoDat.nz - 1);
-	double StartFict = -Step*(NewNp >> 1);
-
-	long TwoNewNp = NewNp << 1;
-	float* AuxData = new float[TwoNewNp];
-	if(AuxData == 0) return MEMORY_ALLOCATION_FAILURE;
-
-	CGenMathFFT1DInfo FFT1DInfo;
-	FFT1DInfo.pInData = ConvData;
-	FFT1DInfo.pOutData = AuxData;
-	FFT1DInfo.Dir = 1;
-	FFT1DInfo.xStep = Step;
-	FFT1DInfo.xStart = StartFict;
-	FFT1DInfo.Nx = NewNp;
-	FFT1DInfo.HowMany = 1;
-	FFT1DInfo.UseGivenStartTrValue = 0;
-	FFT1DInfo.TreatSharpEdges = 0;
-	CGenMathFFT1D FFT1D;
-	if(result = FFT1D.Make1DFFT(FFT1DInfo)) return result;
-
-	double C2 = TwoPiE2*M_ElecEff;
-	float* tData = AuxData;
-	double q = FFT1DInfo.xStartTr;
-	for(long j=0; j<NewNp; j++)
-	{
-		//double C2qE2 = C2*q*q;
-		double Magn = exp(-C2*q*q);
-		*(tData++) *= (float)Magn; // Re
-		*(tData++) *= (float)Magn; // Im
-
-		q += FFT1DInfo.xStepTr;
-	}
-
-	FFT1DInfo.pInData = AuxData;
-	FFT1DInfo.pOutData = ConvData;
-	FFT1DInfo.Dir = -1;
-	FFT1DInfo.xStep = FFT1DInfo.xStepTr; FFT1DInfo.xStepTr = Step;
-	FFT1DInfo.xStart = FFT1DInfo.xStartTr; FFT1DInfo.xStartTr = StartFict;
-	FFT1DInfo.UseGivenStartTrValue = 1;
-
-	if(result = FFT1D.Make1DFFT(FFT1DInfo)) return result;
-	delete[] AuxData;
-	return 0;
-}
-
-//*************************************************************************
-
-void srTRadIntConst::ExtractDataAfterConv1D(float* AuxConvData, long NpAux, long Np, float* CmpnArr)
-{
-	long iDat = (NpAux - Np) >> 1;
-
-	float *tCmpn = CmpnArr;
-	float *tAux = AuxConvData + (iDat << 1);
-	for(long i=0; i<Np; i++)
-	{
-		*(tCmpn++) = *tAux; tAux += 2;
-	}
-}
-
-//*************************************************************************
-
-int srTRadIntConst::TreatFiniteElecBeamEmittanceOneComp2D(float* CmpnArr, double ElBeamMomFact)
-{
+	CGenMathConvGaussInfo ConvInfo;
+	ConvInfo.pData = StokesAccessData.pBaseSto;
+	ConvInfo.Nx = StokesAccessData.nx;
+	ConvInfo.Ny = StokesAccessData.nz;
+	ConvInfo.PerX = StokesAccessData.ne << 2;
+	ConvInfo.PerY = ConvInfo.PerX*StokesAccessData.nx;
+	ConvInfo.nBatch = StokesAccessData.ne << 2;
+	ConvInfo.PerBatch = 1;
+	ConvInfo.xStep = (DistrInfoDat.nx > 1)? (DistrInfoDat.xEnd - DistrInfoDat.xStart)/(DistrInfoDat.nx - 1) : 0.;
+	ConvInfo.yStep = (DistrInfoDat.nz > 1)? (DistrInfoDat.zEnd - DistrInfoDat.zStart)/(DistrInfoDat.nz - 1) : 0.;
+	ConvInfo.Mxx = ElBeamMomFact*0.5/Gx;
+	ConvInfo.Myy = ElBeamMomFact*0.5/Gz;
+	ConvInfo.PadWithEdgeValues = 1;
+
+	CGenMathConvGauss ConvGauss;
 	int result;
-	double MxxElecEff = ElBeamMomFact*0.5/Gx, MzzElecEff = ElBeamMomFact*0.5/Gz;
-
-	double MxxPowSingleE, MzzPowSingleE;
-	DetermineSingleElecDistrEffSizes2D(CmpnArr, MxxPowSingleE, MzzPowSingleE);
+	if(result = ConvGauss.Convolve(ConvInfo)) return result;
 
-	srTRadResize Resize;
-	DetermineResizeBeforeConv2D(MxxElecEff, MzzElecEff, MxxPowSingleE, MzzPowSingleE, Resize);
-
-	long NxAux = (long)(Resize.pxm*DistrInfoDat.nx);
-	long NzAux = (long)(Resize.pzm*DistrInfoDat.nz);
-	CGenMathFFT2D FFT;
-	FFT.NextCorrectNumberForFFT(NxAux);
-	FFT.NextCorrectNumberForFFT(NzAux);
-	float* AuxConvData = new float[NxAux*NzAux << 1];
-	if(AuxConvData == 0) return MEMORY_ALLOCATION_FAILURE;
-
-	ConstructDataForConv2D(CmpnArr, AuxConvData, NxAux, NzAux);
-	if(result = PerformConvolutionWithGaussian2D(AuxConvData, NxAux, NzAux, MxxElecEff, MzzElecEff)) return result;
-
-	ExtractDataAfterConv2D(AuxConvData, NxAux, NzAux, CmpnArr);
-
-	if(AuxConvData != 0) delete[] AuxConvData;
+	for(int ie=0; ie<StokesAccessData.ne; ie++) SuppressNegativeValues(StokesAccessData.pBaseSto + (ie << 2), ConvInfo.PerX);
 	return 0;
 }
 
 //*************************************************************************
 
-void srTRadIntConst::DetermineSingleElecDistrEffSizes2D(float* CmpnArr, double& MxxCen, double& MzzCen)
-{// Compute central moments
-	float Sm0 = 0., SmX = 0., SmZ = 0., SmXX = 0., SmZZ = 0.;
-	float xStep = (float)((DistrInfoDat.nx > 1)? (DistrInfoDat.xEnd - DistrInfoDat.xStart)/(DistrInfoDat.nx - 1) : 0.);
-	float zStep = (float)((DistrInfoDat.nz > 1)? (DistrInfoDat.zEnd - DistrInfoDat.zStart)/(DistrInfoDat.nz - 1) : 0.);
-	long nz_mi_1 = DistrInfoDat.nz - 1, nx_mi_1 = DistrInfoDat.nx - 1;
-
-	float *tDistr = CmpnArr;
-	float z = (float)DistrInfoDat.zStart;
-	float ze2 = z*z;
-	float wz = 0.5;
-
-	for(int iz=0; iz<DistrInfoDat.nz; iz++)
-	{
-		if(iz == nz_mi_1) wz = 0.5;
-		
-		float x = (float)DistrInfoDat.xStart;
-		float xe2 = x*x;
-		for(int ix=0; ix<DistrInfoDat.nx; ix++)
-		{
-			float Distr = (float)::fabs(wz*(*(tDistr++)));
-			if((ix == nx_mi_1) || (iz == nz_mi_1)) Distr *= 0.5;
-
-			Sm0 += Distr;
-			SmX += x*Distr;
-			SmXX += xe2*Distr;
-			SmZ += z*Distr;
-			SmZZ += ze2*Distr;
-
-			x += xStep;
-			xe2 = x*x;
-		}
-		wz = 1.;
-		z += zStep;
-		ze2 = z*z;
-	}
-	float Norm = (float)(1./Sm0);
-	float Mx = SmX*Norm, Mxx = SmXX*Norm;
-	float Mz = SmZ*Norm, Mzz = SmZZ*Norm;
-
-	MxxCen = Mxx - Mx*Mx;
-	MzzCen = Mzz - Mz*Mz;
-}
-
-//*************************************************************************
-
-void srTRadIntConst::DetermineResizeBeforeConv2D(double MxxElecEff, double MzzElecEff, double MxxPowSingleE, double MzzPowSingleE, srTRadResize& Resize)
-{
-	const double DoNotResizeRatio = 3.; // To steer
-	const double AmOfExtraSig = 2.5;
-
-	if(MxxPowSingleE*DoNotResizeRatio > MxxElecEff)
-	{
-		double ExtraRange = 2.*AmOfExtraSig*sqrt(MxxElecEff);
-		double CurrentRange = DistrInfoDat.xEnd - DistrInfoDat.xStart;
-		Resize.pxm = (CurrentRange + ExtraRange)/CurrentRange;
-	}
-	if(MzzPowSingleE*DoNotResizeRatio > MzzElecEff)
-	{
-		double ExtraRange = 2.*AmOfExtraSig*sqrt(MzzElecEff);
-		double CurrentRange = DistrInfoDat.zEnd - DistrInfoDat.zStart;
-		Resize.pzm = (CurrentRange + ExtraRange)/CurrentRange;
-	}
-}
-
-//*************************************************************************
-
-void srTRadIntConst::ConstructDataForConv2D(float* CmpnArr, float* NewData, long NewNx, long NewNz)
-{
-	long ixDat = (NewNx - DistrInfoDat.nx) >> 1;
-	long izDat = (NewNz - DistrInfoDat.nz) >> 1;
-	long OffsetXp = ixDat + DistrInfoDat.nx;
-	long OffsetZp = izDat + DistrInfoDat.nz;
-
-	long NewPerZ = NewNx << 1;
-	long ix, iz;
-	float V = *CmpnArr;
-	for(iz=0; iz<izDat; iz++)
-	{
-		float *tNew = NewData + iz*NewPerZ;
-		for(ix=0; ix<ixDat; ix++) { *(tNew++) = V; *(tNew++) = 0;}
-	}
-	V = *(CmpnArr + DistrInfoDat.nx - 1);
-	for(iz=0; iz<izDat; iz++)
-	{
-		float *tNew = NewData + iz*NewPerZ + (OffsetXp << 1);
-		for(ix=OffsetXp; ix<NewNx; ix++) { *(tNew++) = V; *(tNew++) = 0;}
-	}
-	V = *(CmpnArr + (DistrInfoDat.nz - 1)*DistrInfoDat.nx);
-	for(iz=OffsetZp; iz<NewNz; iz++)
-	{
-		float *tNew = NewData + iz*NewPerZ;
-		for(ix=0; ix<ixDat; ix++) { *(tNew++) = V; *(tNew++) = 0;}
-	}
-	V = *(CmpnArr + DistrInfoDat.nz*DistrInfoDat.nx - 1);
-	for(iz=OffsetZp; iz<NewNz; iz++)
-	{
-		float *tNew = NewData + iz*NewPerZ + (OffsetXp << 1);
-		for(ix=OffsetXp; ix<NewNx; ix++) { *(tNew++) = V; *(tNew++) = 0;}
-	}
-
-	float *tOldL = CmpnArr;
-	float *tOldR = CmpnArr + DistrInfoDat.nx - 1;
-	for(iz=izDat; iz<(izDat + DistrInfoDat.nz); iz++)
-	{
-		V = *tOldL;
-		long izNewPerZ = iz*NewPerZ;
-		float *tNew = NewData + izNewPerZ;
-		for(ix=0; ix<ixDat; ix++) { *(tNew++) = V; *(tNew++) = 0;}
-		tOldL += DistrInfoDat.nx;
-
-		V = *tOldR;
-		tNew = NewData + izNewPerZ + (OffsetXp << 1);
-		for(ix=OffsetXp; ix<NewNx; ix++) { *(tNew++) = V; *(tNew++) = 0;}
-		tOldR += DistrInfoDat.nx;
-	}
-
-	float *tOldD = CmpnArr;
-	float *tOldU = CmpnArr + (DistrInfoDat.nz - 1)*DistrInfoDat.nx;
-	for(ix=ixDat; ix<(ixDat + DistrInfoDat.nx); ix++)
-	{
-		V = *(tOldD++);
-		float *tNew = NewData + (ix << 1);
-		for(iz=0; iz<izDat; iz++) { *tNew = V; *(tNew+1) = 0; tNew += NewPerZ;}
-
-		V = *(tOldU++);
-		tNew = NewData + OffsetZp*NewPerZ + (ix << 1);
-		for(iz=OffsetZp; iz<NewNz; iz++) { *tNew = V; *(tNew+1) = 0; tNew += NewPerZ;}
-	}
-
-	float *tOld = CmpnArr;
-	for(iz=izDat; iz<(izDat + DistrInfoDat.nz); iz++)
-	{
-		float *tNew = NewData + iz*NewPerZ + (ixDat << 1);
-		for(ix=ixDat; ix<(ixDat + DistrInfoDat.nx); ix++)
-		{
-			*(tNew++) = *(tOld++); *(tNew++) = 0.;
-		}
-	}
-}
-
-//*************************************************************************
-
-int srTRadIntConst::PerformConvolutionWithGaussian2D(float* ConvData, long NewNx, long NewNz, double MxxElecEff, double MzzElecEff)
-{
-	int result;
-	double xStep = (DistrInfoDat.nx > 1)? (DistrInfoDat.xEnd - DistrInfoDat.xStart)/(DistrInfoDat.nx - 1) : 0.;
-	double zStep = (DistrInfoDat.nz > 1)? (DistrInfoDat.zEnd - DistrInfoDat.zStart)/(DistrInfoDat.nz - 1) : 0.;
-
-	double xStartFict = -xStep*(NewNx >> 1);
-	double zStartFict = -zStep*(NewNz >> 1);
-
-	CGenMathFFT2DInfo FFT2DInfo;
-	FFT2DInfo.pData = ConvData;
-	FFT2DInfo.Dir = 1;
-	FFT2DInfo.xStep = xStep;
-	FFT2DInfo.yStep = zStep;
-	FFT2DInfo.xStart = xStartFict;
-	FFT2DInfo.yStart = zStartFict;
-	FFT2DInfo.Nx = NewNx;
-	FFT2DInfo.Ny = NewNz;
-	FFT2DInfo.UseGivenStartTrValues = 0;
-
-	CGenMathFFT2D FFT2D;
-	if(result = FFT2D.Make2DFFT(FFT2DInfo)) return result;
-
-	const double Pi = 3.14159265358979;
-	const double TwoPi = Pi*2.;
-	const double TwoPiE2 = TwoPi*Pi;
-
-	double C2x = TwoPiE2*MxxElecEff;
-	double C2z = TwoPiE2*MzzElecEff;
-
-	float* tData = ConvData;
-	double qz = FFT2DInfo.yStartTr;
-	for(long iz=0; iz<NewNz; iz++)
-	{
-		double C2zqzE2 = C2z*qz*qz;
-		double qx = FFT2DInfo.xStartTr;
-
-		for(long ix=0; ix<NewNx; ix++)
-		{
-			double Magn = exp(-C2x*qx*qx - C2zqzE2);
-			*(tData++) *= (float)Magn; // Re
-			*(tData++) *= (float)Magn; // Im
-
-			qx += FFT2DInfo.xStepTr;
-		}
-		qz += FFT2DInfo.yStepTr;
-	}
-
-	FFT2DInfo.pData = ConvData;
-	FFT2DInfo.Dir = -1;
-	FFT2DInfo.xStep = FFT2DInfo.xStepTr; FFT2DInfo.xStepTr = xStep;
-	FFT2DInfo.yStep = FFT2DInfo.yStepTr; FFT2DInfo.yStepTr = zStep;
-	FFT2DInfo.xStart = FFT2DInfo.xStartTr; FFT2DInfo.xStartTr = xStartFict;
-	FFT2DInfo.yStart = FFT2DInfo.yStartTr; FFT2DInfo.yStartTr = zStartFict;
-	FFT2DInfo.UseGivenStartTrValues = 1;
-
-	return FFT2D.Make2DFFT(FFT2DInfo);
-	return 0;
-}
-
-//*************************************************************************
-
-void srTRadIntConst::ExtractDataAfterConv2D(float* AuxConvData, long NxAux, long NzAux, float* CmpnArr)
-{
-	long ixDat = (NxAux - DistrInfoDat.nx) >> 1;
-	long izDat = (NzAux - DistrInfoDat.nz) >> 1;
-	long Two_ixDat = ixDat << 1;
-	long AuxPerZ = NxAux << 1;
-
-	float *tCmpn = CmpnArr;
-	for(long iz=0; iz<DistrInfoDat.nz; iz++)
-	{
-		float *tAux = AuxConvData + (izDat + iz)*AuxPerZ + Two_ixDat;
-		for(long ix=0; ix<DistrInfoDat.nx; ix++)
-		{
-			*(tCmpn++) = *tAux; tAux += 2;
-		}
-	}
-}
-
-//*************************************************************************
-
-void srTRadIntConst::SuppressNegativeValues(float* StokesCmpnArr)
+void srTRadIntConst::SuppressNegativeValues(float* pS0, long PerX)
 {
-	float *t = StokesCmpnArr;
+	float *t = pS0;
 	for(int iz=0; iz<DistrInfoDat.nz; iz++)
 		for(int ix=0; ix<DistrInfoDat.nx; ix++)
 		{
 			if(*t < 0.) *t = 0.;
-			t++;
+			t += PerX;
 		}
 }
 
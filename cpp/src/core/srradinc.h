@@ -22,7 +22,7 @@
 //*************************************************************************
 
 extern srTYield srYield;
-extern srTIntVect gVectWarnNos;
+extern thread_local srTIntVect gVectWarnNos;
 
 //*************************************************************************
 
@@ -77,21 +77,7 @@ public:
 	void SetupNativeRotation();
 
 	int TreatFiniteElecBeamEmittance(srTStokesStructAccessData&, double ElBeamMomFact);
-	void ExtractStokesSliceConstE(srTStokesStructAccessData& StokesAccessData, long ie, int StokesNo, float* pOutS);
-	void UpdateStokesSliceConstE(float* StokesCmpnArr, long ie, int is, srTStokesStructAccessData& StokesAccessData);
-	int TreatFiniteElecBeamEmittanceOneComp1D(float* CmpnArr, double ElBeamMomFact);
-	int TreatFiniteElecBeamEmittanceOneComp2D(float* CmpnArr, double ElBeamMomFact);
-	void DetermineSingleElecDistrEffSizes2D(float* CmpnArr, double& Mxx, double& Mzz);
-	void DetermineSingleElecDistrEffSizes1D(float* CmpnArr, char VsXorZ, double& M_Cen);
-	void DetermineResizeBeforeConv2D(double MxxElecEff, double MzzElecEff, double MxxPowSingleE, double MzzPowSingleE, srTRadResize& Resize);
-	void DetermineResizeBeforeConv1D(double M_ElecEff, double M_DistrSingleE, char VsXorZ, srTRadResize1D& Resize);
-	void ConstructDataForConv2D(float* CmpnArr, float* NewData, long NewNx, long NewNz);
-	void ConstructDataForConv1D(float* CmpnArr, float* AuxConvData, long NpOld, long NpNew);
-	int PerformConvolutionWithGaussian2D(float* ConvData, long NewNx, long NewNz, double MxxElecEff, double MzzElecEff);
-	int PerformConvolutionWithGaussian1D(float* AuxConvData, long NpAux, double M_ElecEff, char VsXorZ);
-	void ExtractDataAfterConv2D(float* AuxConvData, long NxAux, long NzAux, float* CmpnArr);
-	void ExtractDataAfterConv1D(float* AuxConvData, long NpAux, long Np, float* CmpnArr);
-	void SuppressNegativeValues(float* StokesCmpnArr);
+	void SuppressNegativeValues(float* pS0, long PerX);
 
 	void AnalyzeFinalResultsSymmetry(char& FinalResAreSymOverX, char& FinalResAreSymOverZ);
 	void FillInSymPartsOfResults(char FinalResAreSymOverX, char FinalResAreSymOverZ, srTStokesStructAccessData& StokesAccessData);
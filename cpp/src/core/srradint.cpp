@@ -22,11 +22,13 @@
 #include "sroptelm.h"
 #include "srerror.h"
 
+#include <algorithm>
+
 //*************************************************************************
 
 extern srTYield srYield;
 
-extern srTIntVect gVectWarnNos;
+extern thread_local srTIntVect gVectWarnNos;
 extern char* srWarningDynamic;
 
 //*************************************************************************
@@ -85,6 +87,7 @@ void srTRadInt::Initialize()
 	DistrInfoDat.CoordUnits = 1; // To ensure mm for coord.
 
 	m_CalcResidTerminTerms = 1; // Do calculate residual terminating terms by default
+	m_RelPrecMeshAdapt = 0.; // Compute at all points of observation mesh by default
 }
 
 //*************************************************************************
@@ -307,9 +310,6 @@ int srTRadInt::ComputeTotalRadDistrDirectOut(srTSRWRadStructAccessData& SRWRadSt
 	float *pEx0 = SRWRadStructAccessData.pBaseRadX;
 	float *pEz0 = SRWRadStructAccessData.pBaseRadZ;
 
-	complex<double> RadIntegValues[2];
-	srTEFourier EwNormDer;
-
 	char FinalResAreSymOverX = 0, FinalResAreSymOverZ = 0;
 	AnalizeFinalResultsSymmetry(FinalResAreSymOverX, FinalResAreSymOverZ);
 
@@ -327,46 +327,46 @@ int srTRadInt::ComputeTotalRadDistrDirectOut(srTSRWRadStructAccessData& SRWRadSt
 
 	if(!showProgressInd) TotalAmOfOutPointsForInd = 0;
 	srTCompProgressIndicator compProgressInd(TotalAmOfOutPointsForInd, UpdateTimeInt_s);
+	srTCompProgressIndicator *pCompProgressInd = showProgressInd? &compProgressInd : 0;
 
-	//long AbsPtCount = 0;
-	ObsCoor.y = DistrInfoDat.yStart;
-	ObsCoor.z = DistrInfoDat.zStart;
-	for(int iz=0; iz<DistrInfoDat.nz; iz++)
+	if(m_RelPrecMeshAdapt > 0.)
 	{
-		if(FinalResAreSymOverZ) { if((ObsCoor.z - zc) > zTol) break;}
-
-		long izPerZ = iz*PerZ;
-		ObsCoor.x = DistrInfoDat.xStart;
-		for(int ix=0; ix<DistrInfoDat.nx; ix++)
+		long nxCalc = DistrInfoDat.nx, nzCalc = DistrInfoDat.nz;
+		if(FinalResAreSymOverX)
+		{
+			nxCalc = 0; 
+			while((nxCalc < DistrInfoDat.nx) && ((DistrInfoDat.xStart + nxCalc*StepX - xc) <= xTol)) nxCalc++;
+		}
+		if(FinalResAreSymOverZ)
+		{
+			nzCalc = 0; 
+			while((nzCalc < DistrInfoDat.nz) && ((DistrInfoDat.zStart + nzCalc*StepZ - zc) <= zTol)) nzCalc++;
+		}
+		ObsCoor.y = DistrInfoDat.yStart;
+		if(result = ComputeTotalRadDistrDirectOutAdapt(SRWRadStructAccessData, nxCalc, nzCalc, StepX, StepZ, StepLambda, pCompProgressInd, PointCount)) return result;
+	}
+	else
+	{
+		//long AbsPtCount = 0;
+		ObsCoor.y = DistrInfoDat.yStart;
+		ObsCoor.z = DistrInfoDat.zStart;
+		for(int iz=0; iz<DistrInfoDat.nz; iz++)
 		{
-			if(FinalResAreSymOverX) { if((ObsCoor.x - xc) > xTol) break;}
+			if(FinalResAreSymOverZ) { if((ObsCoor.z - zc) > zTol) break;}
 
-			long ixPerX = ix*PerX;
-			ObsCoor.Lamb = DistrInfoDat.LambStart;
-			for(int iLamb=0; iLamb<DistrInfoDat.nLamb; iLamb++)
+			long izPerZ = iz*PerZ;
+			ObsCoor.x = DistrInfoDat.xStart;
+			for(int ix=0; ix<DistrInfoDat.nx; ix++)
 			{
-				if(result = GenRadIntegration(RadIntegValues, &EwNormDer)) return result;
-
-				long Offset = izPerZ + ixPerX + (iLamb << 1);
-				float *pEx = pEx0 + Offset, *pEz = pEz0 + Offset;
+				if(FinalResAreSymOverX) { if((ObsCoor.x - xc) > xTol) break;}
 
-				*pEx = float(RadIntegValues->real());
-				*(pEx+1) = float(RadIntegValues->imag());
-				*pEz = float(RadIntegValues[1].real());
-				*(pEz+1) = float(RadIntegValues[1].imag());
-
-				if(showProgressInd) 
-				{
-                    //if(result = pCompProgressInd->UpdateIndicator(PointCount++)) return result;
-                    if(result = compProgressInd.UpdateIndicator(PointCount++)) return result;
-				}
-				if(result = srYield.Check()) return result;
+				long Offset = izPerZ + ix*PerX;
+				if(result = ComputeRadDistrAtOnePointXZ(pEx0 + Offset, pEz0 + Offset, StepLambda, pCompProgressInd, PointCount)) return result;
 
-				ObsCoor.Lamb += StepLambda;
+				ObsCoor.x += StepX;
 			}
-			ObsCoor.x += StepX;
+			ObsCoor.z += StepZ;
 		}
-		ObsCoor.z += StepZ;
 	}
 
 	if(FinalResAreSymOverZ || FinalResAreSymOverX) 
@@ -384,6 +384,312 @@ int srTRadInt::ComputeTotalRadDistrDirectOut(srTSRWRadStructAccessData& SRWRadSt
 
 //*************************************************************************
 
+int srTRadInt::ComputeRadDistrAtOnePointXZ(float* pEx, float* pEz, double StepLambda, srTCompProgressIndicator* pCompProgressInd, long& PointCount)
+{//Computes the field at (ObsCoor.x, ObsCoor.z) for all photon energies (wavelengths)
+	int result = 0;
+	complex<double> RadIntegValues[2];
+	srTEFourier EwNormDer;
+
+	ObsCoor.Lamb = DistrInfoDat.LambStart;
+	for(int iLamb=0; iLamb<DistrInfoDat.nLamb; iLamb++)
+	{
+		if(result = GenRadIntegration(RadIntegValues, &EwNormDer)) return result;
+
+		*(pEx++) = float(RadIntegValues->real());
+		*(pEx++) = float(RadIntegValues->imag());
+		*(pEz++) = float(RadIntegValues[1].real());
+		*(pEz++) = float(RadIntegValues[1].imag());
+
+		if(pCompProgressInd != 0)
+		{
+			if(result = pCompProgressInd->UpdateIndicator(PointCount++)) return result;
+		}
+		if(result = srYield.Check()) return result;
+
+		ObsCoor.Lamb += StepLambda;
+	}
+	return result;
+}
+
+//*************************************************************************
+
+int srTRadInt::ComputeTotalRadDistrDirectOutAdapt(srTSRWRadStructAccessData& Rad, long nxCalc, long nzCalc, double StepX, double StepZ, double StepLambda, srTCompProgressIndicator* pCompProgressInd, long& PointCount)
+{//Adaptive refinement of the observation mesh: the field is computed on a coarse mesh (vs x and z), 
+ //then the mesh cells are bisected level by level; a cell is refined further only if the field computed at its center 
+ //differs from the one interpolated from the nodes of the current level by more than m_RelPrecMeshAdapt*max|E|
+ //(for any photon energy), or if one of the adjacent cells requires the refinement.
+ //All other points of the output mesh are filled by 4-point Lagrange interpolation vs x and z.
+	const long MaxAmOfIntervCoarse = 8; //to steer: max. number of intervals of the initial coarse mesh vs x and z
+
+	int result = 0;
+	if((nxCalc <= 0) || (nzCalc <= 0)) return 0;
+
+	long PerX = DistrInfoDat.nLamb << 1;
+	long PerZ = DistrInfoDat.nx*PerX;
+	float *pEx0 = Rad.pBaseRadX, *pEz0 = Rad.pBaseRadZ;
+
+	float *AuxEx = new float[PerX << 1];
+	if(AuxEx == 0) return MEMORY_ALLOCATION_FAILURE;
+	float *AuxEz = AuxEx + PerX;
+
+	vector<char> vPtIsComputed(nxCalc*nzCalc, 0);
+
+	//initial coarse mesh
+	vector<long> vIx, vIz;
+	long AmOfIntervX = (nxCalc - 1 < MaxAmOfIntervCoarse)? nxCalc - 1 : MaxAmOfIntervCoarse;
+	long AmOfIntervZ = (nzCalc - 1 < MaxAmOfIntervCoarse)? nzCalc - 1 : MaxAmOfIntervCoarse;
+	vIx.push_back(0);
+	for(long k=1; k<=AmOfIntervX; k++) vIx.push_back((k*(nxCalc - 1) + (AmOfIntervX >> 1))/AmOfIntervX);
+	vIz.push_back(0);
+	for(long k=1; k<=AmOfIntervZ; k++) vIz.push_back((k*(nzCalc - 1) + (AmOfIntervZ >> 1))/AmOfIntervZ);
+
+	double MaxAbsE = 0.;
+	for(long jz=0; jz<(long)vIz.size(); jz++)
+	{
+		long iz = vIz[jz];
+		ObsCoor.z = DistrInfoDat.zStart + iz*StepZ;
+		for(long jx=0; jx<(long)vIx.size(); jx++)
+		{
+			long ix = vIx[jx];
+			ObsCoor.x = DistrInfoDat.xStart + ix*StepX;
+			long Offset = iz*PerZ + ix*PerX;
+			if(result = ComputeRadDistrAtOnePointXZ(pEx0 + Offset, pEz0 + Offset, StepLambda, pCompProgressInd, PointCount)) { delete[] AuxEx; return result;}
+			vPtIsComputed[iz*nxCalc + ix] = 1;
+
+			float *tEx = pEx0 + Offset, *tEz = pEz0 + Offset;
+			for(long i=0; i<PerX; i++)
+			{
+				double AbsEx = ::fabs(*(tEx++)), AbsEz = ::fabs(*(tEz++));
+				if(MaxAbsE < AbsEx) MaxAbsE = AbsEx;
+				if(MaxAbsE < AbsEz) MaxAbsE = AbsEz;
+			}
+		}
+	}
+
+	//cell flags: 0- converged (to be filled by interpolation), 1- to be refined, 2- failed test at current level
+	long nCellsX = (vIx.size() > 1)? (long)vIx.size() - 1 : 1;
+	long nCellsZ = (vIz.size() > 1)? (long)vIz.size() - 1 : 1;
+	vector<char> vCellFlag(nCellsX*nCellsZ, 1);
+
+	vector<long> vIxNew, vIzNew, vIntervParX, vIntervParZ, vNodeCellMinX, vNodeCellMaxX, vNodeCellMinZ, vNodeCellMaxZ;
+	for(;;)
+	{
+		BisectAdaptMeshIntervals(vIx, vIxNew, vIntervParX, vNodeCellMinX, vNodeCellMaxX);
+		BisectAdaptMeshIntervals(vIz, vIzNew, vIntervParZ, vNodeCellMinZ, vNodeCellMaxZ);
+		if((vIxNew.size() == vIx.size()) && (vIzNew.size() == vIz.size())) break;
+
+		//testing the cells which are still to be refined: the field is computed at the cell center and compared with the interpolated one
+		for(long kz=0; kz<nCellsZ; kz++)
+		{
+			long iza = vIz[kz], izb = (kz + 1 < (long)vIz.size())? vIz[kz + 1] : iza;
+			for(long kx=0; kx<nCellsX; kx++)
+			{
+				char &CellFlag = vCellFlag[kz*nCellsX + kx];
+				if(CellFlag == 0) continue;
+
+				long ixa = vIx[kx], ixb = (kx + 1 < (long)vIx.size())? vIx[kx + 1] : ixa;
+				long ixT = ((ixb - ixa) > 1)? ((ixa + ixb) >> 1) : ixa;
+				long izT = ((izb - iza) > 1)? ((iza + izb) >> 1) : iza;
+				if((ixT == ixa) && (izT == iza)) continue; //no new points in this cell
+
+				InterpolRadDistrOnePointXZ(vIx, vIz, ixT, izT, pEx0, pEz0, PerX, PerZ, AuxEx, AuxEz);
+
+				long Offset = izT*PerZ + ixT*PerX;
+				if(!vPtIsComputed[izT*nxCalc + ixT])
+				{
+					ObsCoor.x = DistrInfoDat.xStart + ixT*StepX;
+					ObsCoor.z = DistrInfoDat.zStart + izT*StepZ;
+					if(result = ComputeRadDistrAtOnePointXZ(pEx0 + Offset, pEz0 + Offset, StepLambda, pCompProgressInd, PointCount)) { delete[] AuxEx; return result;}
+					vPtIsComputed[izT*nxCalc + ixT] = 1;
+				}
+
+				double MaxAbsDif = 0.;
+				float *tEx = pEx0 + Offset, *tEz = pEz0 + Offset, *tAuxEx = AuxEx, *tAuxEz = AuxEz;
+				for(long i=0; i<PerX; i++)
+				{
+					double AbsEx = ::fabs(*tEx), AbsEz = ::fabs(*tEz);
+					if(MaxAbsE < AbsEx) MaxAbsE = AbsEx;
+					if(MaxAbsE < AbsEz) MaxAbsE = AbsEz;
+
+					double AbsDifEx = ::fabs(*(tEx++) - *(tAuxEx++)), AbsDifEz = ::fabs(*(tEz++) - *(tAuxEz++));
+					if(MaxAbsDif < AbsDifEx) MaxAbsDif = AbsDifEx;
+					if(MaxAbsDif < AbsDifEz) MaxAbsDif = AbsDifEz;
+				}
+				CellFlag = (MaxAbsDif > m_RelPrecMeshAdapt*MaxAbsE)? 2 : 0;
+			}
+		}
+
+		//the cells adjacent to those which failed the test are refined as well
+		for(long kz=0; kz<nCellsZ; kz++)
+		{
+			for(long kx=0; kx<nCellsX; kx++)
+			{
+				if(vCellFlag[kz*nCellsX + kx] != 2) continue;
+				long kzSt = (kz > 0)? kz - 1 : 0, kzFi = (kz + 1 < nCellsZ)? kz + 1 : kz;
+				long kxSt = (kx > 0)? kx - 1 : 0, kxFi = (kx + 1 < nCellsX)? kx + 1 : kx;
+				for(long kzz=kzSt; kzz<=kzFi; kzz++)
+				{
+					for(long kxx=kxSt; kxx<=kxFi; kxx++)
+					{
+						char &NeibFlag = vCellFlag[kzz*nCellsX + kxx];
+						if(NeibFlag == 0) NeibFlag = 1;
+					}
+				}
+			}
+		}
+
+		//filling-in the nodes of the next level: computation in the cells to be refined, interpolation in the others
+		for(long jz=0; jz<(long)vIzNew.size(); jz++)
+		{
+			long iz = vIzNew[jz];
+			long izPerZ = iz*PerZ;
+			for(long jx=0; jx<(long)vIxNew.size(); jx++)
+			{
+				long ix = vIxNew[jx];
+				if(vPtIsComputed[iz*nxCalc + ix]) continue;
+				if((vNodeCellMinX[jx] < 0) && (vNodeCellMinZ[jz] < 0)) continue; //node of the current level
+
+				char NeedsComp = 0;
+				long kxSt = (vNodeCellMinX[jx] < 0)? -vNodeCellMinX[jx] - 1 : vNodeCellMinX[jx];
+				long kzSt = (vNodeCellMinZ[jz] < 0)? -vNodeCellMinZ[jz] - 1 : vNodeCellMinZ[jz];
+				for(long kz=kzSt; kz<=vNodeCellMaxZ[jz]; kz++)
+				{
+					for(long kx=kxSt; kx<=vNodeCellMaxX[jx]; kx++)
+					{
+						if(vCellFlag[kz*nCellsX + kx] != 0) { NeedsComp = 1; break;}
+					}
+					if(NeedsComp) break;
+				}
+
+				long Offset = izPerZ + ix*PerX;
+				if(NeedsComp)
+				{
+					ObsCoor.x = DistrInfoDat.xStart + ix*StepX;
+					ObsCoor.z = DistrInfoDat.zStart + iz*StepZ;
+					if(result = ComputeRadDistrAtOnePointXZ(pEx0 + Offset, pEz0 + Offset, StepLambda, pCompProgressInd, PointCount)) { delete[] AuxEx; return result;}
+					vPtIsComputed[iz*nxCalc + ix] = 1;
+				}
+				else InterpolRadDistrOnePointXZ(vIx, vIz, ix, iz, pEx0, pEz0, PerX, PerZ, pEx0 + Offset, pEz0 + Offset);
+			}
+		}
+
+		//flags of the cells of the next level are inherited from the parent cells
+		long nCellsXNew = (vIxNew.size() > 1)? (long)vIxNew.size() - 1 : 1;
+		long nCellsZNew = (vIzNew.size() > 1)? (long)vIzNew.size() - 1 : 1;
+		vector<char> vCellFlagNew(nCellsXNew*nCellsZNew);
+		for(long kz=0; kz<nCellsZNew; kz++)
+		{
+			long kzPar = vIntervParZ[kz];
+			for(long kx=0; kx<nCellsXNew; kx++)
+			{
+				vCellFlagNew[kz*nCellsXNew + kx] = (vCellFlag[kzPar*nCellsX + vIntervParX[kx]] != 0)? 1 : 0;
+			}
+		}
+
+		vIx.swap(vIxNew); vIz.swap(vIzNew);
+		vCellFlag.swap(vCellFlagNew);
+		nCellsX = nCellsXNew; nCellsZ = nCellsZNew;
+	}
+
+	delete[] AuxEx;
+	return result;
+}
+
+//*************************************************************************
+
+void srTRadInt::BisectAdaptMeshIntervals(vector<long>& vI, vector<long>& vINew, vector<long>& vIntervPar, vector<long>& vNodeCellMin, vector<long>& vNodeCellMax)
+{//Bisects all intervals of the (index) mesh vI which contain more than one step.
+ //vIntervPar: index of the parent interval for each interval of vINew;
+ //vNodeCellMin, vNodeCellMax: range of intervals of vI to which each node of vINew belongs;
+ //for nodes already present in vI, vNodeCellMin is coded as -(IndFirstInterv + 1).
+	vINew.erase(vINew.begin(), vINew.end());
+	vIntervPar.erase(vIntervPar.begin(), vIntervPar.end());
+	vNodeCellMin.erase(vNodeCellMin.begin(), vNodeCellMin.end());
+	vNodeCellMax.erase(vNodeCellMax.begin(), vNodeCellMax.end());
+
+	long nNodes = (long)vI.size();
+	long nInterv = nNodes - 1;
+	for(long k=0; k<nNodes; k++)
+	{
+		long kPrev = (k > 0)? k - 1 : 0, kNext = (k < nInterv)? k : nInterv - 1;
+		if(kNext < kPrev) kNext = kPrev; //single node
+		vINew.push_back(vI[k]);
+		vNodeCellMin.push_back(-kPrev - 1);
+		vNodeCellMax.push_back(kNext);
+		if(k < nInterv) vIntervPar.push_back(k);
+
+		if((k < nInterv) && ((vI[k + 1] - vI[k]) > 1))
+		{
+			vINew.push_back((vI[k] + vI[k + 1]) >> 1);
+			vNodeCellMin.push_back(k);
+			vNodeCellMax.push_back(k);
+			vIntervPar.push_back(k);
+		}
+	}
+	if(nInterv <= 0) vIntervPar.push_back(0);
+}
+
+//*************************************************************************
+
+void srTRadInt::InterpolRadDistrOnePointXZ(vector<long>& vIx, vector<long>& vIz, long ix, long iz, float* pEx0, float* pEz0, long PerX, long PerZ, float* pResEx, float* pResEz)
+{//4-point Lagrange interpolation vs x and z over (generally non-equidistant) nodes vIx, vIz of the mesh of observation points
+	long nNodesX = (long)vIx.size(), nNodesZ = (long)vIz.size();
+	long npX = (nNodesX < 4)? nNodesX : 4, npZ = (nNodesZ < 4)? nNodesZ : 4;
+
+	long kx = (long)(upper_bound(vIx.begin(), vIx.end(), ix) - vIx.begin()) - 1;
+	long kxSt = kx - 1;
+	if(kxSt > nNodesX - npX) kxSt = nNodesX - npX;
+	if(kxSt < 0) kxSt = 0;
+	long kz = (long)(upper_bound(vIz.begin(), vIz.end(), iz) - vIz.begin()) - 1;
+	long kzSt = kz - 1;
+	if(kzSt > nNodesZ - npZ) kzSt = nNodesZ - npZ;
+	if(kzSt < 0) kzSt = 0;
+
+	double wx[4], wz[4];
+	for(long a=0; a<npX; a++)
+	{
+		double w = 1.;
+		long ixa = vIx[kxSt + a];
+		for(long b=0; b<npX; b++) 
+		{
+			if(b != a) { long ixb = vIx[kxSt + b]; w *= double(ix - ixb)/double(ixa - ixb);}
+		}
+		wx[a] = w;
+	}
+	for(long a=0; a<npZ; a++)
+	{
+		double w = 1.;
+		long iza = vIz[kzSt + a];
+		for(long b=0; b<npZ; b++) 
+		{
+			if(b != a) { long izb = vIz[kzSt + b]; w *= double(iz - izb)/double(iza - izb);}
+		}
+		wz[a] = w;
+	}
+
+	for(long i=0; i<PerX; i++)
+	{
+		double SumEx = 0., SumEz = 0.;
+		for(long b=0; b<npZ; b++)
+		{
+			long izPerZ = vIz[kzSt + b]*PerZ + i;
+			double SumExZ = 0., SumEzZ = 0.;
+			for(long a=0; a<npX; a++)
+			{
+				long Offset = izPerZ + vIx[kxSt + a]*PerX;
+				SumExZ += wx[a]*pEx0[Offset];
+				SumEzZ += wx[a]*pEz0[Offset];
+			}
+			SumEx += wz[b]*SumExZ;
+			SumEz += wz[b]*SumEzZ;
+		}
+		pResEx[i] = float(SumEx);
+		pResEz[i] = float(SumEz);
+	}
+}
+
+//*************************************************************************
+
 int srTRadInt::ComputeNormalResidual(double s, int NumberOfTerms, complex<double>* ResidValues, srTEFourier* pEwNormDerResid)
 {
 // Steerable parameters
@@ -2393,18 +2699,139 @@ int srTRadInt::RadIntegrationAuto2(double& OutIntXRe, double& OutIntXIm, double&
 		}
 	}
 
+	if(!(*PointIsGoodForAnAuto)) *(PointIsGoodForAnAuto+1) = 0;
+	if(!PointIsGoodForAnAuto[TotAmOfInitPo-1]) PointIsGoodForAnAuto[TotAmOfInitPo-2] = 0;
+
+	int AmOfAnArrays = 0, AmOfNumArrays = 0;
+	SetupRadIntervalsAuto2(TotAmOfInitPo, AmOfAnArrays, AmOfNumArrays);
+	srTRadIntervVal *pAnRadInt = ComputedRadIntervAuto, *pNumRadInt = NumRadIntervAuto;
+
+	double BufIntXRe, BufIntXIm, BufIntZRe, BufIntZIm;
+	double FunArr[513*4], EdgeDerArr[8];
+	if(AmOfAnArrays == 0)
+	{
+		double *t = FunArr, *td = EdgeDerArr;
+		pPh = PhArrAuto; pdPhds = dPhdsArrAuto; pAx = AxArrAuto; pdAxds = dAxdsArrAuto; pAz = AzArrAuto; pdAzds = dAzdsArrAuto;
+		double InitPh = *pPh;
+		for(int i=0; i<TotNp; i++)
+		{
+			CosAndSin(*pPh, CosPh, SinPh);
+			if((i==0) || (i==(TotNp-1)))
+			{
+				double dPhdsSinPh = (*pdPhds)*SinPh, dPhdsCosPh = (*pdPhds)*CosPh;
+				*(td++) = (*pdAxds)*CosPh - (*pAx)*dPhdsSinPh;
+				*(td++) = (*pdAxds)*SinPh + (*pAx)*dPhdsCosPh;
+				*(td++) = (*pdAzds)*CosPh - (*pAz)*dPhdsSinPh;
+				*(td++) = (*pdAzds)*SinPh + (*pAz)*dPhdsCosPh;
+			}
+			*(t++) = (*pAx)*CosPh; *(t++) = (*pAx)*SinPh;
+			*(t++) = (*pAz)*CosPh; *(t++) = (*pAz)*SinPh;
+
+			pPh++; pdPhds++; pAx++; pdAxds++; pAz++; pdAzds++;
+		}
+		*t = InitPh;
+		if(result = RadIntegrationAuto1M(sIntegStart, sIntegFin, FunArr, EdgeDerArr, TotNp, LevelNo, BufIntXRe, BufIntXIm, BufIntZRe, BufIntZIm)) return result;
+		OutIntXRe += BufIntXRe; OutIntXIm += BufIntXIm; OutIntZRe += BufIntZRe; OutIntZIm += BufIntZIm;
+		return 0;
+	}
+
+	pAnRadInt = ComputedRadIntervAuto;
+
+	for(int kAn=0; kAn<AmOfAnArrays; kAn++)
+	{
+		int IndSt = pAnRadInt->InitLevelNo;
+		int IndFi = pAnRadInt->SecondInt;
+
+		double CosPh, SinPh;
+		double Ph = PhArrAuto[IndFi], dPhds = dPhdsArrAuto[IndFi], d2Phds2 = d2Phds2ArrAuto[IndFi];
+		double Ax = AxArrAuto[IndFi], dAxds = dAxdsArrAuto[IndFi], Az = AzArrAuto[IndFi], dAzds = dAzdsArrAuto[IndFi];
+		double One_d_dPhds = 1./dPhds;
+		double One_d_dPhdsE2 = One_d_dPhds*One_d_dPhds;
+		double dAxdsddPhds = dAxds*One_d_dPhds;
+		double dAzdsddPhds = dAzds*One_d_dPhds;
+		double d2Phds2ddPhdsE2 = d2Phds2*One_d_dPhdsE2;
+		double t1x = dAxdsddPhds - Ax*d2Phds2ddPhdsE2;
+		double t1z = dAzdsddPhds - Az*d2Phds2ddPhdsE2;
+		CosAndSin(Ph, CosPh, SinPh);
+		double IntXRe = One_d_dPhds*(t1x*CosPh + Ax*SinPh);
+		double IntXIm = One_d_dPhds*(t1x*SinPh - Ax*CosPh);
+		double IntZRe = One_d_dPhds*(t1z*CosPh + Az*SinPh);
+		double IntZIm = One_d_dPhds*(t1z*SinPh - Az*CosPh);
+
+		Ph = PhArrAuto[IndSt]; dPhds = dPhdsArrAuto[IndSt]; d2Phds2 = d2Phds2ArrAuto[IndSt];
+		Ax = AxArrAuto[IndSt]; dAxds = dAxdsArrAuto[IndSt]; Az = AzArrAuto[IndSt]; dAzds = dAzdsArrAuto[IndSt];
+		One_d_dPhds = 1./dPhds;
+		One_d_dPhdsE2 = One_d_dPhds*One_d_dPhds;
+		dAxdsddPhds = dAxds*One_d_dPhds;
+		dAzdsddPhds = dAzds*One_d_dPhds;
+		d2Phds2ddPhdsE2 = d2Phds2*One_d_dPhdsE2;
+		t1x = dAxdsddPhds - Ax*d2Phds2ddPhdsE2;
+		t1z = dAzdsddPhds - Az*d2Phds2ddPhdsE2;
+		CosAndSin(Ph, CosPh, SinPh);
+		IntXRe -= One_d_dPhds*(t1x*CosPh + Ax*SinPh);
+		IntXIm -= One_d_dPhds*(t1x*SinPh - Ax*CosPh);
+		IntZRe -= One_d_dPhds*(t1z*CosPh + Az*SinPh);
+		IntZIm -= One_d_dPhds*(t1z*SinPh - Az*CosPh);
+
+		SumIntXRe += IntXRe; SumIntXIm += IntXIm; SumIntZRe += IntZRe; SumIntZIm += IntZIm;
+		pAnRadInt++;
+	}
+	SumIntXRe *= ActNormConst; SumIntXIm *= ActNormConst; 
+	SumIntZRe *= ActNormConst; SumIntZIm *= ActNormConst;
+
+	pNumRadInt = NumRadIntervAuto;
+	for(int n=0; n<AmOfNumArrays; n++)
+	{
+		int TotAmOfPo = pNumRadInt->SecondInt - pNumRadInt->InitLevelNo + 1;
+
+		double *t = FunArr, *td = EdgeDerArr;
+		int StNo = pNumRadInt->InitLevelNo, FiNo = pNumRadInt->SecondInt;
+		//int FiNo_mi_1 = FiNo - 1;
+
+		pPh = PhArrAuto+StNo; pdPhds = dPhdsArrAuto+StNo; 
+		pAx = AxArrAuto+StNo; pdAxds = dAxdsArrAuto+StNo; 
+		pAz = AzArrAuto+StNo; pdAzds = dAzdsArrAuto+StNo;
+		double InitPh = *pPh;
+
+		for(int jj=StNo; jj<=FiNo; jj++)
+		{
+			CosAndSin(*pPh, CosPh, SinPh);
+			if((jj==StNo) || (jj==FiNo))
+			{
+				double dPhdsSinPh = (*pdPhds)*SinPh, dPhdsCosPh = (*pdPhds)*CosPh;
+				*(td++) = (*pdAxds)*CosPh - (*pAx)*dPhdsSinPh;
+				*(td++) = (*pdAxds)*SinPh + (*pAx)*dPhdsCosPh;
+				*(td++) = (*pdAzds)*CosPh - (*pAz)*dPhdsSinPh;
+				*(td++) = (*pdAzds)*SinPh + (*pAz)*dPhdsCosPh;
+			}
+			*(t++) = (*pAx)*CosPh; *(t++) = (*pAx)*SinPh;
+			*(t++) = (*pAz)*CosPh; *(t++) = (*pAz)*SinPh;
+
+			pPh++; pdPhds++; pAx++; pdAxds++; pAz++; pdAzds++;
+		}
+		*t = InitPh;
+		if(result = RadIntegrationAuto1M(pNumRadInt->sStart, pNumRadInt->sEnd, FunArr, EdgeDerArr, TotAmOfPo, LevelNo, BufIntXRe, BufIntXIm, BufIntZRe, BufIntZIm)) return result;
+		SumIntXRe += BufIntXRe; SumIntXIm += BufIntXIm; SumIntZRe += BufIntZRe; SumIntZIm += BufIntZIm;
+		pNumRadInt++;
+	}
+	OutIntXRe += SumIntXRe; OutIntXIm += SumIntXIm; OutIntZRe += SumIntZRe; OutIntZIm += SumIntZIm;
+	return 0;
+}
+
+//*************************************************************************
+
+void srTRadInt::SetupRadIntervalsAuto2(int TotAmOfInitPo, int& AmOfAnArrays, int& AmOfNumArrays)
+{//Subdivides the integration range of RadIntegrationAuto2 into intervals to be integrated "analytically" (ComputedRadIntervAuto)
+ //and numerically (NumRadIntervAuto), based on the flags PointIsGoodForAnAuto of the initial points
 	double Stp = (sIntegFin - sIntegStart)/(TotAmOfInitPo - 1);
 
 	int jCurrentStartAn = 0, jCurrentStartNum = 0;
 
-	if(!(*PointIsGoodForAnAuto)) *(PointIsGoodForAnAuto+1) = 0;
-	if(!PointIsGoodForAnAuto[TotAmOfInitPo-1]) PointIsGoodForAnAuto[TotAmOfInitPo-2] = 0;
-
-	pd2Phds2 = d2Phds2ArrAuto + 1;
-	pPointIsGoodForAnAuto = PointIsGoodForAnAuto + 1;
+	double *pd2Phds2 = d2Phds2ArrAuto + 1;
+	char *pPointIsGoodForAnAuto = PointIsGoodForAnAuto + 1;
 
 	srTRadIntervVal *pAnRadInt = ComputedRadIntervAuto, *pNumRadInt = NumRadIntervAuto;
-	int AmOfNumArrays = 0, AmOfAnArrays = 0;
+	AmOfNumArrays = 0; AmOfAnArrays = 0;
 	int TotAmOfInitPo_mi_1 = TotAmOfInitPo - 1, TotAmOfInitPo_mi_2 = TotAmOfInitPo - 2;
 
 	char AllPointsAreGoodForAn = 1;
@@ -2547,7 +2974,7 @@ int srTRadInt::RadIntegrationAuto2(double& OutIntXRe, double& OutIntXIm, double&
 
 	if(AllPointsAreGoodForAn)
 	{
-		pd2Phds2ddPhdsE2 = d2Phds2ddPhdsE2ArrAuto;
+		double *pd2Phds2ddPhdsE2 = d2Phds2ddPhdsE2ArrAuto;
 		double Max = 0.;
 		int kMax = -1;
 		for(int k=0; k<TotAmOfInitPo; k++)
@@ -2604,116 +3031,6 @@ int srTRadInt::RadIntegrationAuto2(double& OutIntXRe, double& OutIntXIm, double&
 		AmOfNumArrays = 1;
 	}
 
-	double BufIntXRe, BufIntXIm, BufIntZRe, BufIntZIm;
-	double FunArr[513*4], EdgeDerArr[8];
-	if(AmOfAnArrays == 0)
-	{
-		double *t = FunArr, *td = EdgeDerArr;
-		pPh = PhArrAuto; pdPhds = dPhdsArrAuto; pAx = AxArrAuto; pdAxds = dAxdsArrAuto; pAz = AzArrAuto; pdAzds = dAzdsArrAuto;
-		double InitPh = *pPh;
-		for(int i=0; i<TotNp; i++)
-		{
-			CosAndSin(*pPh, CosPh, SinPh);
-			if((i==0) || (i==(TotNp-1)))
-			{
-				double dPhdsSinPh = (*pdPhds)*SinPh, dPhdsCosPh = (*pdPhds)*CosPh;
-				*(td++) = (*pdAxds)*CosPh - (*pAx)*dPhdsSinPh;
-				*(td++) = (*pdAxds)*SinPh + (*pAx)*dPhdsCosPh;
-				*(td++) = (*pdAzds)*CosPh - (*pAz)*dPhdsSinPh;
-				*(td++) = (*pdAzds)*SinPh + (*pAz)*dPhdsCosPh;
-			}
-			*(t++) = (*pAx)*CosPh; *(t++) = (*pAx)*SinPh;
-			*(t++) = (*pAz)*CosPh; *(t++) = (*pAz)*SinPh;
-
-			pPh++; pdPhds++; pAx++; pdAxds++; pAz++; pdAzds++;
-		}
-		*t = InitPh;
-		if(result = RadIntegrationAuto1M(sIntegStart, sIntegFin, FunArr, EdgeDerArr, TotNp, LevelNo, BufIntXRe, BufIntXIm, BufIntZRe, BufIntZIm)) return result;
-		OutIntXRe += BufIntXRe; OutIntXIm += BufIntXIm; OutIntZRe += BufIntZRe; OutIntZIm += BufIntZIm;
-		return 0;
-	}
-
-	pAnRadInt = ComputedRadIntervAuto;
-
-	for(int kAn=0; kAn<AmOfAnArrays; kAn++)
-	{
-		int IndSt = pAnRadInt->InitLevelNo;
-		int IndFi = pAnRadInt->SecondInt;
-
-		double CosPh, SinPh;
-		double Ph = PhArrAuto[IndFi], dPhds = dPhdsArrAuto[IndFi], d2Phds2 = d2Phds2ArrAuto[IndFi];
-		double Ax = AxArrAuto[IndFi], dAxds = dAxdsArrAuto[IndFi], Az = AzArrAuto[IndFi], dAzds = dAzdsArrAuto[IndFi];
-		double One_d_dPhds = 1./dPhds;
-		double One_d_dPhdsE2 = One_d_dPhds*One_d_dPhds;
-		double dAxdsddPhds = dAxds*One_d_dPhds;
-		double dAzdsddPhds = dAzds*One_d_dPhds;
-		double d2Phds2ddPhdsE2 = d2Phds2*One_d_dPhdsE2;
-		double t1x = dAxdsddPhds - Ax*d2Phds2ddPhdsE2;
-		double t1z = dAzdsddPhds - Az*d2Phds2ddPhdsE2;
-		CosAndSin(Ph, CosPh, SinPh);
-		double IntXRe = One_d_dPhds*(t1x*CosPh + Ax*SinPh);
-		double IntXIm = One_d_dPhds*(t1x*SinPh - Ax*CosPh);
-		double IntZRe = One_d_dPhds*(t1z*CosPh + Az*SinPh);
-		double IntZIm = One_d_dPhds*(t1z*SinPh - Az*CosPh);
-
-		Ph = PhArrAuto[IndSt]; dPhds = dPhdsArrAuto[IndSt]; d2Phds2 = d2Phds2ArrAuto[IndSt];
-		Ax = AxArrAuto[IndSt]; dAxds = dAxdsArrAuto[IndSt]; Az = AzArrAuto[IndSt]; dAzds = dAzdsArrAuto[IndSt];
-		One_d_dPhds = 1./dPhds;
-		One_d_dPhdsE2 = One_d_dPhds*One_d_dPhds;
-		dAxdsddPhds = dAxds*One_d_dPhds;
-		dAzdsddPhds = dAzds*One_d_dPhds;
-		d2Phds2ddPhdsE2 = d2Phds2*One_d_dPhdsE2;
-		t1x = dAxdsddPhds - Ax*d2Phds2ddPhdsE2;
-		t1z = dAzdsddPhds - Az*d2Phds2ddPhdsE2;
-		CosAndSin(Ph, CosPh, SinPh);
-		IntXRe -= One_d_dPhds*(t1x*CosPh + Ax*SinPh);
-		IntXIm -= One_d_dPhds*(t1x*SinPh - Ax*CosPh);
-		IntZRe -= One_d_dPhds*(t1z*CosPh + Az*SinPh);
-		IntZIm -= One_d_dPhds*(t1z*SinPh - Az*CosPh);
-
-		SumIntXRe += IntXRe; SumIntXIm += IntXIm; SumIntZRe += IntZRe; SumIntZIm += IntZIm;
-		pAnRadInt++;
-	}
-	SumIntXRe *= ActNormConst; SumIntXIm *= ActNormConst; 
-	SumIntZRe *= ActNormConst; SumIntZIm *= ActNormConst;
-
-	pNumRadInt = NumRadIntervAuto;
-	for(int n=0; n<AmOfNumArrays; n++)
-	{
-		int TotAmOfPo = pNumRadInt->SecondInt - pNumRadInt->InitLevelNo + 1;
-
-		double *t = FunArr, *td = EdgeDerArr;
-		int StNo = pNumRadInt->InitLevelNo, FiNo = pNumRadInt->SecondInt;
-		//int FiNo_mi_1 = FiNo - 1;
-
-		pPh = PhArrAuto+StNo; pdPhds = dPhdsArrAuto+StNo; 
-		pAx = AxArrAuto+StNo; pdAxds = dAxdsArrAuto+StNo; 
-		pAz = AzArrAuto+StNo; pdAzds = dAzdsArrAuto+StNo;
-		double InitPh = *pPh;
-
-		for(int jj=StNo; jj<=FiNo; jj++)
-		{
-			CosAndSin(*pPh, CosPh, SinPh);
-			if((jj==StNo) || (jj==FiNo))
-			{
-				double dPhdsSinPh = (*pdPhds)*SinPh, dPhdsCosPh = (*pdPhds)*CosPh;
-				*(td++) = (*pdAxds)*CosPh - (*pAx)*dPhdsSinPh;
-				*(td++) = (*pdAxds)*SinPh + (*pAx)*dPhdsCosPh;
-				*(td++) = (*pdAzds)*CosPh - (*pAz)*dPhdsSinPh;
-				*(td++) = (*pdAzds)*SinPh + (*pAz)*dPhdsCosPh;
-			}
-			*(t++) = (*pAx)*CosPh; *(t++) = (*pAx)*SinPh;
-			*(t++) = (*pAz)*CosPh; *(t++) = (*pAz)*SinPh;
-
-			pPh++; pdPhds++; pAx++; pdAxds++; pAz++; pdAzds++;
-		}
-		*t = InitPh;
-		if(result = RadIntegrationAuto1M(pNumRadInt->sStart, pNumRadInt->sEnd, FunArr, EdgeDerArr, TotAmOfPo, LevelNo, BufIntXRe, BufIntXIm, BufIntZRe, BufIntZIm)) return result;
-		SumIntXRe += BufIntXRe; SumIntXIm += BufIntXIm; SumIntZRe += BufIntZRe; SumIntZIm += BufIntZIm;
-		pNumRadInt++;
-	}
-	OutIntXRe += SumIntXRe; OutIntXIm += SumIntXIm; OutIntZRe += SumIntZRe; OutIntZIm += SumIntZIm;
-	return 0;
 }
 
 //*************************************************************************
@@ -3452,6 +3769,7 @@ void srTRadInt::ComputeElectricFieldFreqDomain(srTTrjDat* pTrjDat, srTWfrSmp* pW
 	if(res = ComputeTotalRadDistrDirectOut(*pWfr, showProgressInd)) throw res;
 
 	srTGenOptElem GenOptElem;
+	pWfr->NoteFieldModif(); //the field was computed above
 	if(res = GenOptElem.ComputeRadMoments(pWfr)) throw res;
 
 	//setting the average photon energy:
@@ -3460,6 +3778,180 @@ void srTRadInt::ComputeElectricFieldFreqDomain(srTTrjDat* pTrjDat, srTWfrSmp* pW
 
 //*************************************************************************
 
+void srTRadInt::ComputeElectricFieldFreqDomainPerFold(srTTrjDat* pTrjDat, srTWfrSmp* pWfrSmp, srTParPrecElecFld* pPrecElecFld, srTSRWRadStructAccessData* pWfr, double perLen, double sPerStart, int nPer, char showProgressInd)
+{//Electric field from a trajectory which is periodic (with period perLen) over [sPerStart, sPerStart + nPer*perLen], e.g. in the central part of a long undulator.
+ //Only the entrance part, the exit part and three periods (first, middle, last) are integrated numerically. For each observation point, the period integrals
+ //are "de-phased" by the phase of the integrand at the period start, which leaves a function slowly varying vs period number (constant in the far field);
+ //it is interpolated quadratically over all periods, and the sum over periods is done with the exact phases at the period starts.
+ //The result is approximate: the interpolation error grows with the variation of the de-phased period integral along the undulator (near field, large angles).
+	if((pTrjDat == 0) || (pWfrSmp == 0) || (pPrecElecFld == 0) || (pWfr == 0)) throw INCORRECT_PARAMS_SR_COMP;
+
+	double sIntSt = pTrjDat->sStart;
+	double sIntFi = pTrjDat->sStart + pTrjDat->sStep*(pTrjDat->LenFieldData - 1);
+	double sStartIntPrec = pPrecElecFld->sStartInt, sEndIntPrec = pPrecElecFld->sEndInt; //same as in SetPrecParams
+	bool SpecLimitsMayBeDefined = (sStartIntPrec < sEndIntPrec);
+	if(SpecLimitsMayBeDefined && (sStartIntPrec > sIntSt) && (sStartIntPrec < sIntFi)) sIntSt = sStartIntPrec;
+	if(SpecLimitsMayBeDefined && (sEndIntPrec > sIntSt) && (sEndIntPrec < sIntFi)) sIntFi = sEndIntPrec;
+
+	const int nPerMin = 5; //below this, folding doesn't save anything
+	double sPerFin = sPerStart + nPer*perLen;
+	if((perLen <= 0.) || (nPer < nPerMin) || (sPerStart <= sIntSt) || (sPerFin >= sIntFi))
+	{
+		ComputeElectricFieldFreqDomain(pTrjDat, pWfrSmp, pPrecElecFld, pWfr, showProgressInd);
+		return;
+	}
+
+	const int nPerSmp = 3;
+	int arPerSmp[] = {0, nPer >> 1, nPer - 1}; //periods integrated numerically
+
+	char CalcTerm = pPrecElecFld->CalcTerminTerms;
+	srTParPrecElecFld PrecEntr(*pPrecElecFld), PrecExit(*pPrecElecFld), PrecPer(*pPrecElecFld);
+	PrecEntr.sStartInt = sIntSt; PrecEntr.sEndInt = sPerStart;
+	PrecEntr.CalcTerminTerms = ((CalcTerm == 1) || (CalcTerm == 2))? 2 : 0;
+	PrecExit.sStartInt = sPerFin; PrecExit.sEndInt = sIntFi;
+	PrecExit.CalcTerminTerms = ((CalcTerm == 1) || (CalcTerm == 3))? 3 : 0;
+	PrecPer.CalcTerminTerms = 0;
+
+	//entrance part goes directly to the resulting wavefront, the rest to auxiliary arrays
+	ComputeElectricFieldFreqDomain(pTrjDat, pWfrSmp, &PrecEntr, pWfr, showProgressInd);
+
+	long nLamb = DistrInfoDat.nLamb, nx = DistrInfoDat.nx, nz = DistrInfoDat.nz;
+	long nTot = (nLamb << 1)*nx*nz;
+	float *pEx0 = pWfr->pBaseRadX, *pEz0 = pWfr->pBaseRadZ;
+	float *arAuxE = new float[2*(nPerSmp + 1)*nTot];
+	if(arAuxE == 0) throw MEMORY_ALLOCATION_FAILURE;
+	float *arExPer[nPerSmp], *arEzPer[nPerSmp];
+	for(int j=0; j<nPerSmp; j++) { arExPer[j] = arAuxE + 2*j*nTot; arEzPer[j] = arExPer[j] + nTot;}
+	float *pExExit = arAuxE + 2*nPerSmp*nTot, *pEzExit = pExExit + nTot;
+
+	srTRadInt *pRadIntAux = 0;
+	try
+	{
+		for(int j=0; j<=nPerSmp; j++)
+		{
+			srTParPrecElecFld *pPrec = &PrecExit;
+			if(j < nPerSmp)
+			{
+				PrecPer.sStartInt = sPerStart + arPerSmp[j]*perLen; PrecPer.sEndInt = PrecPer.sStartInt + perLen;
+				pPrec = &PrecPer;
+				pWfr->pBaseRadX = arExPer[j]; pWfr->pBaseRadZ = arEzPer[j];
+			}
+			else { pWfr->pBaseRadX = pExExit; pWfr->pBaseRadZ = pEzExit;}
+
+			pRadIntAux = new srTRadInt();
+			if(pRadIntAux == 0) throw MEMORY_ALLOCATION_FAILURE;
+			pRadIntAux->ComputeElectricFieldFreqDomain(pTrjDat, pWfrSmp, pPrec, pWfr, 0);
+			delete pRadIntAux; pRadIntAux = 0;
+		}
+	}
+	catch(int erNo)
+	{
+		pWfr->pBaseRadX = pEx0; pWfr->pBaseRadZ = pEz0;
+		if(pRadIntAux != 0) delete pRadIntAux;
+		delete[] arAuxE;
+		throw erNo;
+	}
+	pWfr->pBaseRadX = pEx0; pWfr->pBaseRadZ = pEz0;
+
+	//trajectory data at the period starts and quadratic interpolation weights (independent of observation point)
+	const int nTrjPar = 7;
+	double *arTrjPer = new double[nPer*nTrjPar];
+	if(arTrjPer == 0) { delete[] arAuxE; throw MEMORY_ALLOCATION_FAILURE;}
+	double k0 = arPerSmp[0], k1 = arPerSmp[1], k2 = arPerSmp[2];
+	double *t_arTrjPer = arTrjPer;
+	for(int k=0; k<nPer; k++)
+	{
+		double sk = sPerStart + k*perLen;
+		double Btx=0., Btz=0., Crdx=0., Crdz=0., IntBtE2x=0., IntBtE2z=0.;
+		pTrjDat->CompTrjDataDerivedAtPoint(sk, Btx, Crdx, IntBtE2x, Btz, Crdz, IntBtE2z);
+		*(t_arTrjPer++) = sk;
+		*(t_arTrjPer++) = Crdx;
+		*(t_arTrjPer++) = Crdz;
+		*(t_arTrjPer++) = IntBtE2x + IntBtE2z;
+		*(t_arTrjPer++) = (k - k1)*(k - k2)/((k0 - k1)*(k0 - k2));
+		*(t_arTrjPer++) = (k - k0)*(k - k2)/((k1 - k0)*(k1 - k2));
+		*(t_arTrjPer++) = (k - k0)*(k - k1)/((k2 - k0)*(k2 - k1));
+	}
+
+	char NearField = (DistrInfoDat.CoordOrAngPresentation == CoordPres);
+	double GamEm2 = pTrjDat->EbmDat.GammaEm2;
+	double yObs = DistrInfoDat.yStart;
+	double StepLambda = (nLamb > 1)? (DistrInfoDat.LambEnd - DistrInfoDat.LambStart)/(nLamb - 1) : 0.;
+	double StepX = (nx > 1)? (DistrInfoDat.xEnd - DistrInfoDat.xStart)/(nx - 1) : 0.;
+	double StepZ = (nz > 1)? (DistrInfoDat.zEnd - DistrInfoDat.zStart)/(nz - 1) : 0.;
+
+	long ofst = 0;
+	double zObs = DistrInfoDat.zStart;
+	for(long iz=0; iz<nz; iz++)
+	{
+		double xObs = DistrInfoDat.xStart;
+		for(long ix=0; ix<nx; ix++)
+		{
+			double Lamb = DistrInfoDat.LambStart;
+			for(long iLamb=0; iLamb<nLamb; iLamb++)
+			{
+				double PIm10e9_d_Lamb = (DistrInfoDat.TreatLambdaAsEnergyIn_eV)? PIm10e6dEnCon*Lamb : PIm10e6*1000./Lamb;
+
+				//weighted sums of the phase factors of all periods (relative to the first one)
+				double arSumRe[] = {0.,0.,0.}, arSumIm[] = {0.,0.,0.};
+				double arCosSmp[] = {1.,1.,1.}, arSinSmp[] = {0.,0.,0.};
+				double Ph0 = 0.;
+				int jSmp = 0;
+				t_arTrjPer = arTrjPer;
+				for(int k=0; k<nPer; k++)
+				{
+					double sk = t_arTrjPer[0], xk = t_arTrjPer[1], zk = t_arTrjPer[2], IntBtE2k = t_arTrjPer[3];
+					double Ph = 0.;
+					if(NearField)
+					{
+						double xObs_mi_x = xObs - xk, zObs_mi_z = zObs - zk;
+						Ph = PIm10e9_d_Lamb*(sk*GamEm2 + IntBtE2k + (xObs_mi_x*xObs_mi_x + zObs_mi_z*zObs_mi_z)/(yObs - sk));
+					}
+					else Ph = PIm10e9_d_Lamb*(sk*(GamEm2 + xObs*xObs + zObs*zObs) + IntBtE2k - 2.*(xObs*xk + zObs*zk));
+					if(k == 0) Ph0 = Ph;
+
+					double CosPh, SinPh;
+					CosAndSin(Ph - Ph0, CosPh, SinPh);
+					if((jSmp < nPerSmp) && (k == arPerSmp[jSmp])) { arCosSmp[jSmp] = CosPh; arSinSmp[jSmp] = SinPh; jSmp++;}
+					for(int j=0; j<nPerSmp; j++)
+					{
+						double w = t_arTrjPer[4 + j];
+						arSumRe[j] += w*CosPh; arSumIm[j] += w*SinPh;
+					}
+					t_arTrjPer += nTrjPar;
+				}
+
+				long ofstIm = ofst + 1;
+				double ExRe = pExExit[ofst], ExIm = pExExit[ofstIm], EzRe = pEzExit[ofst], EzIm = pEzExit[ofstIm];
+				for(int j=0; j<nPerSmp; j++)
+				{//de-phased period integral times the weighted sum of phase factors
+					double MultRe = arSumRe[j]*arCosSmp[j] + arSumIm[j]*arSinSmp[j];
+					double MultIm = arSumIm[j]*arCosSmp[j] - arSumRe[j]*arSinSmp[j];
+					double ExPerRe = arExPer[j][ofst], ExPerIm = arExPer[j][ofstIm], EzPerRe = arEzPer[j][ofst], EzPerIm = arEzPer[j][ofstIm];
+					ExRe += ExPerRe*MultRe - ExPerIm*MultIm; ExIm += ExPerRe*MultIm + ExPerIm*MultRe;
+					EzRe += EzPerRe*MultRe - EzPerIm*MultIm; EzIm += EzPerRe*MultIm + EzPerIm*MultRe;
+				}
+				pEx0[ofst] += (float)ExRe; pEx0[ofstIm] += (float)ExIm;
+				pEz0[ofst] += (float)EzRe; pEz0[ofstIm] += (float)EzIm;
+				ofst += 2;
+
+				Lamb += StepLambda;
+			}
+			xObs += StepX;
+		}
+		zObs += StepZ;
+	}
+	delete[] arTrjPer;
+	delete[] arAuxE;
+
+	srTGenOptElem GenOptElem;
+	int res = 0;
+	pWfr->NoteFieldModif(); //the field was computed above
+	if(res = GenOptElem.ComputeRadMoments(pWfr)) throw res;
+}
+
+//*************************************************************************
+
 void srTRadInt::SetPrecParams(srTParPrecElecFld* pPrecElecFld)
 {
 	if(pPrecElecFld == 0) return;
@@ -3495,6 +3987,7 @@ void srTRadInt::SetPrecParams(srTParPrecElecFld* pPrecElecFld)
 	TryToApplyNearFieldResidual_AtRight = 0; // because it's buggy
 
 	m_CalcResidTerminTerms = pPrecElecFld->CalcTerminTerms;
+	m_RelPrecMeshAdapt = pPrecElecFld->RelPrecMeshAdapt;
 }
 
 //*************************************************************************
@@ -38,6 +38,7 @@ typedef vector<srTPartAutoRadIntHndl, allocator<srTPartAutoRadIntHndl> > srTPart
 #endif
 
 struct srTParPrecElecFld;
+class srTCompProgressIndicator;
 
 //*************************************************************************
 
@@ -87,6 +88,7 @@ class srTRadInt {
 
 	double EstimatedAbsoluteTolerance;
 	char m_CalcResidTerminTerms;
+	double m_RelPrecMeshAdapt; //relative precision for adaptive refinement of observation mesh (active if > 0)
 
 public:
 
@@ -142,6 +144,10 @@ public:
 	inline int ComputeTotalRadDistr();
 	int ComputeTotalRadDistrLoops();
 	int ComputeTotalRadDistrDirectOut(srTSRWRadStructAccessData&, char showProgressInd = 1);
+	int ComputeTotalRadDistrDirectOutAdapt(srTSRWRadStructAccessData&, long nxCalc, long nzCalc, double StepX, double StepZ, double StepLambda, srTCompProgressIndicator*, long& PointCount);
+	int ComputeRadDistrAtOnePointXZ(float* pEx, float* pEz, double StepLambda, srTCompProgressIndicator*, long& PointCount);
+	void InterpolRadDistrOnePointXZ(vector<long>& vIx, vector<long>& vIz, long ix, long iz, float* pEx0, float* pEz0, long PerX, long PerZ, float* pResEx, float* pResEz);
+	void BisectAdaptMeshIntervals(vector<long>& vI, vector<long>& vINew, vector<long>& vIntervPar, vector<long>& vNodeCellMin, vector<long>& vNodeCellMax);
 	inline int GenRadIntegration(complex<double>*, srTEFourier*);
 	inline int RadIntegrationAutoByPieces(complex<double>*);
 	inline int RadIntegrationResiduals(complex<double>*, srTEFourier*);
@@ -174,6 +180,7 @@ public:
 	int RadIntegrationAuto1(double&, double&, double&, double&, srTEFourier*);
 	int RadIntegrationAuto1M(double sStart, double sEnd, double* FunArr, double* EdgeDerArr, int AmOfInitPo, int NextLevNo, double& OutIntXRe, double& OutIntXIm, double& OutIntZRe, double& OutIntZIm);
 	int RadIntegrationAuto2(double&, double&, double&, double&, srTEFourier*);
+	void SetupRadIntervalsAuto2(int TotAmOfInitPo, int& AmOfAnArrays, int& AmOfNumArrays);
 
 	inline void CosAndSin(double x, double& Cos, double& Sin);
 
@@ -214,6 +221,7 @@ public:
 
     void SetPrecParams(srTParPrecElecFld*);
     void ComputeElectricFieldFreqDomain(srTTrjDat* pTrjDat, srTWfrSmp* pWfrSmp, srTParPrecElecFld* pPrecElecFld, srTSRWRadStructAccessData* pWfr, char showProgressInd = 1);
+    void ComputeElectricFieldFreqDomainPerFold(srTTrjDat* pTrjDat, srTWfrSmp* pWfrSmp, srTParPrecElecFld* pPrecElecFld, srTSRWRadStructAccessData* pWfr, double perLen, double sPerStart, int nPer, char showProgressInd = 1);
 };
 
 //*************************************************************************
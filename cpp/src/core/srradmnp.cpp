@@ -13,6 +13,7 @@
 
 #include "srradmnp.h"
 #include "gmfft.h"
+#include "gmconv.h"
 #include "gmmeth.h"
 #include "srerror.h"
 
@@ -124,7 +125,9 @@ int srTRadGenManip::ExtractSingleElecFlux1DvsE(srTRadExtract& RadExtract)
 //*************************************************************************
 
 int srTRadGenManip::ExtractMultiElecFlux1DvsE(srTRadExtract& RadExtract)
-{
+{//Multi-electron flux through the wavefront mesh vs photon energy: the multi-electron intensity (see ConvoluteWithElecBeamOverTransvCoord) integrated over the mesh.
+ //The part of the intensity which the convolution spreads beyond the mesh edges is not counted, so the result is the flux through the mesh (seen as an aperture)
+ //and may be smaller than the single-electron flux through it; earlier versions, by the wrap-around of the circular FFT convolution, kept the total single-electron flux.
 	int result;
 	srTSRWRadStructAccessData& RadAccessData = *((srTSRWRadStructAccessData*)(hRadAccessData.ptr()));
 
@@ -215,6 +218,7 @@ int srTRadGenManip::ExtractSingleElecIntensity1DvsE(srTRadExtract& RadExtract)
 	double InvStepRelArg1, InvStepRelArg2;
 	SetupIntCoord('x', RadExtract.x, ix0, ix1, InvStepRelArg1);
 	SetupIntCoord('z', RadExtract.z, iz0, iz1, InvStepRelArg2);
+	if(!RowIsLastToProc(iz1)) return 0;
 
 	long iz0PerZ = iz0*PerZ, iz1PerZ = iz1*PerZ;
 	float *pEx_StartForX_iz0 = pEx0 + iz0PerZ, *pEx_StartForX_iz1 = pEx0 + iz1PerZ;
@@ -268,12 +272,15 @@ int srTRadGenManip::ExtractSingleElecIntensity1DvsX(srTRadExtract& RadExtract)
 	double InvStepRelArg1, InvStepRelArg2;
 	//SetupIntCoord('e', RadExtract.ePh, ie0, ie1, InvStepRelArg1); //OC140813
 	SetupIntCoord('z', RadExtract.z, iz0, iz1, InvStepRelArg2);
+	if(!RowIsLastToProc(iz1)) return 0;
 
 	bool intOverEnIsRequired = (RadExtract.Int_or_Phase == 7) && (RadAccessData.ne > 1); //OC140813
-	double *arAuxInt = 0, resInt;
+	double *arIntegW = 0, resInt;
 	if(intOverEnIsRequired)
-	{
-		arAuxInt = new double[RadAccessData.ne];
+	{//weights for integration over photon energy / time "on the fly"
+		arIntegW = new double[RadAccessData.ne];
+		if(arIntegW == 0) return MEMORY_ALLOCATION_FAILURE;
+		CGenMathMeth::Integ1D_SetupWeightsFuncDefByArray(arIntegW, RadAccessData.ne, RadAccessData.eStep);
 	}
 	else SetupIntCoord('e', RadExtract.ePh, ie0, ie1, InvStepRelArg1); //OC140813
 
@@ -302,20 +309,10 @@ int srTRadGenManip::ExtractSingleElecIntensity1DvsX(srTRadExtract& RadExtract)
 		//if(pId != 0) *(pId++) = IntensityComponentSimpleInterpol2D(ExPtrs, EzPtrs, InvStepRelArg1, InvStepRelArg2, PolCom, Int_or_ReE);
 
 		if(intOverEnIsRequired) //OC150813
-		{//integrate over photon energy / time
-			double *tInt = arAuxInt; 
-			float *pEx_StAux = pEx_StartForE_iz0;
-			float *pEx_FiAux = pEx_StartForE_iz1;
-			float *pEz_StAux = pEz_StartForE_iz0;
-			float *pEz_FiAux = pEz_StartForE_iz1;
-
-			for(int ie=0; ie<RadAccessData.ne; ie++)
-			{
-				*(tInt++) = IntensityComponentSimpleInterpol(pEx_StAux, pEx_FiAux, pEz_StAux, pEz_FiAux, InvStepRelArg2, PolCom, Int_or_ReE);
-				pEx_StAux += 2; pEx_FiAux += 2;
-				pEz_StAux += 2; pEz_FiAux += 2;
-			}
-			resInt = ConstPhotEnInteg*CGenMathMeth::Integ1D_FuncDefByArray(arAuxInt, RadAccessData.ne, RadAccessData.eStep);
+		{//integrate over photon energy / time (the interpolation vs z is linear, so it is done after the integration)
+			double resInt_St = IntensityComponentWeightedSum(pEx_StartForE_iz0, pEz_StartForE_iz0, 2, RadAccessData.ne, PolCom, Int_or_ReE, arIntegW);
+			double resInt_Fi = (iz1 != iz0)? IntensityComponentWeightedSum(pEx_StartForE_iz1, pEz_StartForE_iz1, 2, RadAccessData.ne, PolCom, Int_or_ReE, arIntegW) : resInt_St;
+			resInt = ConstPhotEnInteg*((resInt_Fi - resInt_St)*InvStepRelArg2 + resInt_St);
 		}
 		else resInt = IntensityComponentSimpleInterpol2D(ExPtrs, EzPtrs, InvStepRelArg1, InvStepRelArg2, PolCom, Int_or_ReE);
 		//OC150813
@@ -324,7 +321,7 @@ int srTRadGenManip::ExtractSingleElecIntensity1DvsX(srTRadExtract& RadExtract)
 
 		ixPerX += PerX;
 	}
-	if(arAuxInt != 0) delete[] arAuxInt; //OC150813
+	if(arIntegW != 0) delete[] arIntegW; //OC150813
 	return 0;
 }
 
@@ -356,10 +353,12 @@ int srTRadGenManip::ExtractSingleElecIntensity1DvsZ(srTRadExtract& RadExtract)
 	SetupIntCoord('x', RadExtract.x, ix0, ix1, InvStepRelArg2);
 
 	bool intOverEnIsRequired = (RadExtract.Int_or_Phase == 7) && (RadAccessData.ne > 1); //OC150813
-	double *arAuxInt = 0, resInt;
+	double *arIntegW = 0, resInt;
 	if(intOverEnIsRequired)
-	{
-		arAuxInt = new double[RadAccessData.ne];
+	{//weights for integration over photon energy / time "on the fly"
+		arIntegW = new double[RadAccessData.ne];
+		if(arIntegW == 0) return MEMORY_ALLOCATION_FAILURE;
+		CGenMathMeth::Integ1D_SetupWeightsFuncDefByArray(arIntegW, RadAccessData.ne, RadAccessData.eStep);
 	}
 	else SetupIntCoord('e', RadExtract.ePh, ie0, ie1, InvStepRelArg1); //OC150813
 
@@ -369,9 +368,14 @@ int srTRadGenManip::ExtractSingleElecIntensity1DvsZ(srTRadExtract& RadExtract)
 
 	long Two_ie0 = ie0 << 1, Two_ie1 = ie1 << 1;
 	long ix0PerX = ix0*PerX, ix1PerX = ix1*PerX;
-	long izPerZ = 0;
 
-	for(long iz=0; iz<RadAccessData.nz; iz++)
+	long izSt, izEn;
+	FindRowRangeToProc(RadAccessData.nz, izSt, izEn);
+	long izPerZ = izSt*PerZ;
+	if(pI != 0) pI += izSt;
+	if(pId != 0) pId += izSt;
+
+	for(long iz=izSt; iz<=izEn; iz++)
 	{
 		float *pEx_StartForX = pEx0 + izPerZ;
 		float *pEz_StartForX = pEz0 + izPerZ;
@@ -387,20 +391,10 @@ int srTRadGenManip::ExtractSingleElecIntensity1DvsZ(srTRadExtract& RadExtract)
 		//if(pId != 0) *(pId++) = IntensityComponentSimpleInterpol2D(ExPtrs, EzPtrs, InvStepRelArg1, InvStepRelArg2, PolCom, Int_or_ReE);
 
 		if(intOverEnIsRequired) //OC150813
-		{//integrate over photon energy / time
-			double *tInt = arAuxInt; 
-			float *pEx_StAux = pEx_StartForE_ix0;
-			float *pEx_FiAux = pEx_StartForE_ix1;
-			float *pEz_StAux = pEz_StartForE_ix0;
-			float *pEz_FiAux = pEz_StartForE_ix1;
-
-			for(int ie=0; ie<RadAccessData.ne; ie++)
-			{
-				*(tInt++) = IntensityComponentSimpleInterpol(pEx_StAux, pEx_FiAux, pEz_StAux, pEz_FiAux, InvStepRelArg2, PolCom, Int_or_ReE);
-				pEx_StAux += 2; pEx_FiAux += 2;
-				pEz_StAux += 2; pEz_FiAux += 2;
-			}
-			resInt = ConstPhotEnInteg*CGenMathMeth::Integ1D_FuncDefByArray(arAuxInt, RadAccessData.ne, RadAccessData.eStep);
+		{//integrate over photon energy / time (the interpolation vs x is linear, so it is done after the integration)
+			double resInt_St = IntensityComponentWeightedSum(pEx_StartForE_ix0, pEz_StartForE_ix0, 2, RadAccessData.ne, PolCom, Int_or_ReE, arIntegW);
+			double resInt_Fi = (ix1 != ix0)? IntensityComponentWeightedSum(pEx_StartForE_ix1, pEz_StartForE_ix1, 2, RadAccessData.ne, PolCom, Int_or_ReE, arIntegW) : resInt_St;
+			resInt = ConstPhotEnInteg*((resInt_Fi - resInt_St)*InvStepRelArg2 + resInt_St);
 		}
 		else resInt = IntensityComponentSimpleInterpol2D(ExPtrs, EzPtrs, InvStepRelArg1, InvStepRelArg2, PolCom, Int_or_ReE);
 		//OC150813
@@ -409,7 +403,7 @@ int srTRadGenManip::ExtractSingleElecIntensity1DvsZ(srTRadExtract& RadExtract)
 
 		izPerZ += PerZ;
 	}
-	if(arAuxInt != 0) delete[] arAuxInt; //OC150813
+	if(arIntegW != 0) delete[] arIntegW; //OC150813
 	return 0;
 }
 
@@ -432,17 +426,20 @@ int srTRadGenManip::ExtractSingleElecIntensity2DvsXZ(srTRadExtract& RadExtract)
 	float *pEx0 = RadAccessData.pBaseRadX;
 	float *pEz0 = RadAccessData.pBaseRadZ;
 
-	long PerX = RadAccessData.ne << 1;
-	long PerZ = PerX*RadAccessData.nx;
+	long nx = RadAccessData.nx, nz = RadAccessData.nz, ne = RadAccessData.ne;
+	long PerX = ne << 1;
+	long PerZ = PerX*nx;
 
 	long ie0=0, ie1=0;
 	double InvStepRelArg=0;
 	//SetupIntCoord('e', RadExtract.ePh, ie0, ie1, InvStepRelArg); //OC140813
-	bool intOverEnIsRequired = (RadExtract.Int_or_Phase == 7) && (RadAccessData.ne > 1); //OC140813
-	double *arAuxInt = 0, resInt;
+	bool intOverEnIsRequired = (RadExtract.Int_or_Phase == 7) && (ne > 1); //OC140813
+	double *arIntegW = 0;
 	if(intOverEnIsRequired)
-	{
-		arAuxInt = new double[RadAccessData.ne];
+	{//weights for integration over photon energy / time "on the fly"
+		arIntegW = new double[ne];
+		if(arIntegW == 0) return MEMORY_ALLOCATION_FAILURE;
+		CGenMathMeth::Integ1D_SetupWeightsFuncDefByArray(arIntegW, ne, RadAccessData.eStep);
 	}
 	else SetupIntCoord('e', RadExtract.ePh, ie0, ie1, InvStepRelArg); //OC140813
 
@@ -451,64 +448,65 @@ int srTRadGenManip::ExtractSingleElecIntensity2DvsXZ(srTRadExtract& RadExtract)
 	double ConstPhotEnInteg = 1.; //1 Phot/s/.1%bw correspond(s) to : 1.60219e-16 W/eV
 
 	long Two_ie0 = ie0 << 1, Two_ie1 = ie1 << 1;
-	long izPerZ = 0;
-
-	for(long iz=0; iz<RadAccessData.nz; iz++)
-	{
-		float *pEx_StartForX = pEx0 + izPerZ;
-		float *pEz_StartForX = pEz0 + izPerZ;
-		//long ixPerX = 0;
-
-		float *pEx_St = pEx_StartForX + Two_ie0;
-		float *pEz_St = pEz_StartForX + Two_ie0;
-		float *pEx_Fi = pEx_StartForX + Two_ie1;
-		float *pEz_Fi = pEz_StartForX + Two_ie1;
-
-		for(long ix=0; ix<RadAccessData.nx; ix++)
+	bool interpIsRequired = (!intOverEnIsRequired) && (ie1 != ie0) && (Int_or_ReE != 2);
+
+	long izSt, izEn;
+	FindRowRangeToProc(nz, izSt, izEn);
+
+	bool memAllocFailed = false;
+#ifdef _OPENMP
+	#pragma omp parallel
+#endif
+	{//rows (vs x) are processed independently
+		float *arAuxI = new(nothrow) float[nx << 1]; //exceptions must not leave the parallel region
+		if(arAuxI == 0) memAllocFailed = true;
+		else
 		{
-			//float *pEx_StartForE = pEx_StartForX + ixPerX;
-			//float *pEz_StartForE = pEz_StartForX + ixPerX;
-			//float *pEx_St = pEx_StartForE + Two_ie0, *pEx_Fi = pEx_StartForE + Two_ie1;
-			//float *pEz_St = pEz_StartForE + Two_ie0, *pEz_Fi = pEz_StartForE + Two_ie1;
-
-			//OC140813
-			//if(pI != 0) *(pI++) = IntensityComponentSimpleInterpol(pEx_St, pEx_Fi, pEz_St, pEz_Fi, InvStepRelArg, PolCom, Int_or_ReE);
-			//if(pId != 0) *(pId++) = IntensityComponentSimpleInterpol(pEx_St, pEx_Fi, pEz_St, pEz_Fi, InvStepRelArg, PolCom, Int_or_ReE);
-
-			if(intOverEnIsRequired) //OC140813
-			{//integrate over photon energy / time
-				double *tInt = arAuxInt; 
-				float *pEx_StAux = pEx_St;
-				float *pEz_StAux = pEz_St;
-				for(int ie=0; ie<RadAccessData.ne; ie++)
+			float *arI_St = arAuxI, *arI_Fi = arAuxI + nx;
+#ifdef _OPENMP
+			#pragma omp for schedule(static)
+#endif
+			for(long iz=izSt; iz<=izEn; iz++)
+			{
+				long izPerZ = iz*PerZ;
+				float *pEx_StartForX = pEx0 + izPerZ;
+				float *pEz_StartForX = pEz0 + izPerZ;
+
+				if(intOverEnIsRequired) //OC140813
+				{//integrate over photon energy / time
+					float *pEx_St = pEx_StartForX, *pEz_St = pEz_StartForX;
+					for(long ix=0; ix<nx; ix++)
+					{
+						arI_St[ix] = (float)(ConstPhotEnInteg*IntensityComponentWeightedSum(pEx_St, pEz_St, 2, ne, PolCom, Int_or_ReE, arIntegW));
+						pEx_St += PerX; pEz_St += PerX;
+					}
+				}
+				else
 				{
-					*(tInt++) = IntensityComponent(pEx_StAux, pEz_StAux, PolCom, Int_or_ReE);
-					pEx_StAux += 2;
-					pEz_StAux += 2;
+					IntensityComponentArr(pEx_StartForX + Two_ie0, pEz_StartForX + Two_ie0, PerX, nx, PolCom, Int_or_ReE, arI_St);
+					if(interpIsRequired)
+					{
+						IntensityComponentArr(pEx_StartForX + Two_ie1, pEz_StartForX + Two_ie1, PerX, nx, PolCom, Int_or_ReE, arI_Fi);
+						for(long ix=0; ix<nx; ix++) arI_St[ix] = (float)((arI_Fi[ix] - arI_St[ix])*InvStepRelArg + arI_St[ix]);
+					}
 				}
-				resInt = ConstPhotEnInteg*CGenMathMeth::Integ1D_FuncDefByArray(arAuxInt, RadAccessData.ne, RadAccessData.eStep);
+
+				long izNx = iz*nx;
+				if(pI != 0) { float *tI = pI + izNx; for(long ix=0; ix<nx; ix++) tI[ix] = arI_St[ix];}
+				if(pId != 0) { DOUBLE *tId = pId + izNx; for(long ix=0; ix<nx; ix++) tId[ix] = (DOUBLE)arI_St[ix];}
 			}
-			else resInt = IntensityComponentSimpleInterpol(pEx_St, pEx_Fi, pEz_St, pEz_Fi, InvStepRelArg, PolCom, Int_or_ReE);
-			//OC140813
-			if(pI != 0) *(pI++) = (float)resInt;
-			if(pId != 0) *(pId++) = (double)resInt;
-
-			//ixPerX += PerX;
-			pEx_St += PerX;
-			pEz_St += PerX;
-			pEx_Fi += PerX;
-			pEz_Fi += PerX;
+			delete[] arAuxI;
 		}
-		izPerZ += PerZ;
 	}
-	if(arAuxInt != 0) delete[] arAuxInt; //OC150813
+	if(arIntegW != 0) delete[] arIntegW; //OC150813
+	if(memAllocFailed) return MEMORY_ALLOCATION_FAILURE;
 	return 0;
 }
 
 //*************************************************************************
 
 int srTRadGenManip::ExtractSingleElecIntensity2DvsEX(srTRadExtract& RadExtract)
-{
+{//for given z, the data vs (e, x) is contiguous in memory
 	int PolCom = RadExtract.PolarizCompon;
 	int Int_or_ReE = RadExtract.Int_or_Phase;
 
@@ -520,34 +518,22 @@ int srTRadGenManip::ExtractSingleElecIntensity2DvsEX(srTRadExtract& RadExtract)
 
 	long PerX = RadAccessData.ne << 1;
 	long PerZ = PerX*RadAccessData.nx;
+	long NpEX = RadAccessData.ne*RadAccessData.nx;
 
 	long iz0=0, iz1=0;
 	double InvStepRelArg;
 	SetupIntCoord('z', RadExtract.z, iz0, iz1, InvStepRelArg);
+	if(!RowIsLastToProc(iz1)) return 0;
 
 	long iz0PerZ = iz0*PerZ, iz1PerZ = iz1*PerZ;
-	float *pEx_StartForX_iz0 = pEx0 + iz0PerZ, *pEx_StartForX_iz1 = pEx0 + iz1PerZ;
-	float *pEz_StartForX_iz0 = pEz0 + iz0PerZ, *pEz_StartForX_iz1 = pEz0 + iz1PerZ;
-
-	long ixPerX = 0;
-
-	for(long ix=0; ix<RadAccessData.nx; ix++)
-	{
-		float *pEx_StartForE_iz0 = pEx_StartForX_iz0 + ixPerX, *pEx_StartForE_iz1 = pEx_StartForX_iz1 + ixPerX;
-		float *pEz_StartForE_iz0 = pEz_StartForX_iz0 + ixPerX, *pEz_StartForE_iz1 = pEz_StartForX_iz1 + ixPerX;
-		long iePerE = 0;
-
-		for(long ie=0; ie<RadAccessData.ne; ie++)
-		{
-			float *pEx_St = pEx_StartForE_iz0 + iePerE, *pEx_Fi = pEx_StartForE_iz1 + iePerE;
-			float *pEz_St = pEz_StartForE_iz0 + iePerE, *pEz_Fi = pEz_StartForE_iz1 + iePerE;
-
-			*(pI++) = IntensityComponentSimpleInterpol(pEx_St, pEx_Fi, pEz_St, pEz_Fi, InvStepRelArg, PolCom, Int_or_ReE);
-
-			iePerE += 2;
-		}
-		ixPerX += PerX;
-	}
+	IntensityComponentArr(pEx0 + iz0PerZ, pEz0 + iz0PerZ, 2, NpEX, PolCom, Int_or_ReE, pI);
+	if((iz1 == iz0) || (Int_or_ReE == 2)) return 0;
+
+	float *arI_Fi = new float[NpEX];
+	if(arI_Fi == 0) return MEMORY_ALLOCATION_FAILURE;
+	IntensityComponentArr(pEx0 + iz1PerZ, pEz0 + iz1PerZ, 2, NpEX, PolCom, Int_or_ReE, arI_Fi);
+	for(long i=0; i<NpEX; i++) pI[i] = (float)((arI_Fi[i] - pI[i])*InvStepRelArg + pI[i]);
+	delete[] arI_Fi;
 	return 0;
 }
 
@@ -564,42 +550,51 @@ int srTRadGenManip::ExtractSingleElecIntensity2DvsEZ(srTRadExtract& RadExtract)
 	float *pEx0 = RadAccessData.pBaseRadX;
 	float *pEz0 = RadAccessData.pBaseRadZ;
 
-	long PerX = RadAccessData.ne << 1;
+	long ne = RadAccessData.ne;
+	long PerX = ne << 1;
 	long PerZ = PerX*RadAccessData.nx;
 
 	long ix0=0, ix1=0;
 	double InvStepRelArg;
 	SetupIntCoord('x', RadExtract.x, ix0, ix1, InvStepRelArg);
+	bool interpIsRequired = (ix1 != ix0) && (Int_or_ReE != 2);
+
+	float *arI_Fi = 0;
+	if(interpIsRequired)
+	{
+		arI_Fi = new float[ne];
+		if(arI_Fi == 0) return MEMORY_ALLOCATION_FAILURE;
+	}
 
 	long ix0PerX = ix0*PerX, ix1PerX = ix1*PerX;
-	long izPerZ = 0;
 
-	for(long iz=0; iz<RadAccessData.nz; iz++)
+	long izSt, izEn;
+	FindRowRangeToProc(RadAccessData.nz, izSt, izEn);
+	long izPerZ = izSt*PerZ;
+	pI += izSt*ne;
+
+	for(long iz=izSt; iz<=izEn; iz++)
 	{
 		float *pEx_StartForX = pEx0 + izPerZ;
 		float *pEz_StartForX = pEz0 + izPerZ;
 
-		float *pEx_StartForE_ix0 = pEx_StartForX + ix0PerX, *pEx_StartForE_ix1 = pEx_StartForX + ix1PerX;
-		float *pEz_StartForE_ix0 = pEz_StartForX + ix0PerX, *pEz_StartForE_ix1 = pEz_StartForX + ix1PerX;
-		long iePerE = 0;
-
-		for(long ie=0; ie<RadAccessData.ne; ie++)
+		IntensityComponentArr(pEx_StartForX + ix0PerX, pEz_StartForX + ix0PerX, 2, ne, PolCom, Int_or_ReE, pI);
+		if(interpIsRequired)
 		{
-			float *pEx_St = pEx_StartForE_ix0 + iePerE, *pEx_Fi = pEx_StartForE_ix1 + iePerE;
-			float *pEz_St = pEz_StartForE_ix0 + iePerE, *pEz_Fi = pEz_StartForE_ix1 + iePerE;
-
-			*(pI++) = IntensityComponentSimpleInterpol(pEx_St, pEx_Fi, pEz_St, pEz_Fi, InvStepRelArg, PolCom, Int_or_ReE);
-			iePerE += 2;
+			IntensityComponentArr(pEx_StartForX + ix1PerX, pEz_StartForX + ix1PerX, 2, ne, PolCom, Int_or_ReE, arI_Fi);
+			for(long ie=0; ie<ne; ie++) pI[ie] = (float)((arI_Fi[ie] - pI[ie])*InvStepRelArg + pI[ie]);
 		}
+		pI += ne;
 		izPerZ += PerZ;
 	}
+	if(arI_Fi != 0) delete[] arI_Fi;
 	return 0;
 }
 
 //*************************************************************************
 
 int srTRadGenManip::ExtractSingleElecIntensity3D(srTRadExtract& RadExtract)
-{
+{//the extracted data has the same order as the electric field: e is the fastest index, then x, then z
 	int PolCom = RadExtract.PolarizCompon;
 	int Int_or_ReE = RadExtract.Int_or_Phase;
 
@@ -609,34 +604,18 @@ int srTRadGenManip::ExtractSingleElecIntensity3D(srTRadExtract& RadExtract)
 	float *pEx0 = RadAccessData.pBaseRadX;
 	float *pEz0 = RadAccessData.pBaseRadZ;
 
-	long PerX = RadAccessData.ne << 1;
-	long PerZ = PerX*RadAccessData.nx;
-	long izPerZ = 0;
+	long NpEX = RadAccessData.ne*RadAccessData.nx;
+	long PerZ = NpEX << 1;
+	long izSt, izEn;
+	FindRowRangeToProc(RadAccessData.nz, izSt, izEn);
 
-	for(long iz=0; iz<RadAccessData.nz; iz++)
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(static)
+#endif
+	for(long iz=izSt; iz<=izEn; iz++)
 	{
-		float *pEx_StartForX = pEx0 + izPerZ;
-		float *pEz_StartForX = pEz0 + izPerZ;
-		long ixPerX = 0;
-
-		for(long ix=0; ix<RadAccessData.nx; ix++)
-		{
-			float *pEx_StartForE = pEx_StartForX + ixPerX;
-			float *pEz_StartForE = pEz_StartForX + ixPerX;
-			long iePerE = 0;
-
-			for(long ie=0; ie<RadAccessData.ne; ie++)
-			{
-				float* pEx = pEx_StartForE + iePerE;
-				float* pEz = pEz_StartForE + iePerE;
-
-				*(pI++) = IntensityComponent(pEx, pEz, PolCom, Int_or_ReE);
-
-				iePerE += 2; 
-			}
-			ixPerX += PerX; 
-		}
-		izPerZ += PerZ; 
+		long izPerZ = iz*PerZ;
+		IntensityComponentArr(pEx0 + izPerZ, pEz0 + izPerZ, 2, NpEX, PolCom, Int_or_ReE, pI + iz*NpEX);
 	}
 	return 0;
 }
@@ -702,78 +681,40 @@ int srTRadGenManip::ComputeConvolutedIntensity(srTRadExtract& RadExtract)
 //*************************************************************************
 
 int srTRadGenManip::ConvoluteWithElecBeamOverTransvCoord(float* DataToConv, long Nx, long Nz)
-{
-	PadImZerosToRealData(DataToConv, Nx, Nz);
-
-			//srTFFT2D testFFT;
-			//testFFT.AuxDebug_TestFFT_Plans();
-
+{//Convolves real intensity (RadAccessData.nx x RadAccessData.nz points at the beginning of DataToConv),
+ //and then places the result to (Nx x Nz) complex array with zero imaginary parts, as expected by the calling functions.
+ //The intensity is assumed to be zero outside the mesh, and the result is exact at the mesh points (no wrap-around);
+ //the part of the convolved distribution spilled outside the mesh is not kept, since the result is given on the same mesh.
 	srTSRWRadStructAccessData& RadAccessData = *((srTSRWRadStructAccessData*)(hRadAccessData.ptr()));
 
 	if(RadAccessData.pElecBeam == 0) 
 	{
 		//srTSend Send; Send.AddWarningMessage(&gVectWarnNos, SINGLE_E_EXTRACTED_INSTEAD_OF_MULTI);
 		CErrWarn::AddWarningMessage(&gVectWarnNos, SINGLE_E_EXTRACTED_INSTEAD_OF_MULTI);
+		PadImZerosToRealData(DataToConv, Nx, Nz);
 		return 0;
 	}
 
-	CGenMathFFT2DInfo FFT2DInfo;
-	FFT2DInfo.pData = DataToConv;
-	FFT2DInfo.Dir = 1;
-	FFT2DInfo.xStep = RadAccessData.xStep;
-	FFT2DInfo.yStep = RadAccessData.zStep;
-	FFT2DInfo.xStart = -(Nx >> 1)*RadAccessData.xStep;
-	FFT2DInfo.yStart = -(Nz >> 1)*RadAccessData.zStep;
-	FFT2DInfo.Nx = Nx;
-	FFT2DInfo.Ny = Nz;
-	FFT2DInfo.UseGivenStartTrValues = 0;
-
-	CGenMathFFT2D FFT2D;
-	FFT2D.Make2DFFT(FFT2DInfo);
-
 	srTElecBeamMoments ElecBeamMom(RadAccessData.pElecBeam);
 	PropagateElecBeamMoments(ElecBeamMom);
 
-	const double Pi = 3.14159265358979;
-	const double TwoPi = Pi*2.;
-	const double TwoPiE2 = TwoPi*Pi;
-
-	double C2x = TwoPiE2*(ElecBeamMom.Mxx);
-	double C2z = TwoPiE2*(ElecBeamMom.Mzz);
-	//double C1x = TwoPi*(ElecBeamMom.Mx);
-	//double C1z = TwoPi*(ElecBeamMom.Mz);
-
-	float* tData = DataToConv;
-	double qz = FFT2DInfo.yStartTr;
-
-	for(long iz=0; iz<Nz; iz++)
-	{
-		double C2zqzE2 = C2z*qz*qz;
-		double qx = FFT2DInfo.xStartTr;
-
-		for(long ix=0; ix<Nx; ix++)
-		{
-			double Magn = exp(-C2x*qx*qx - C2zqzE2);
-
-			*(tData++) *= (float)Magn; // Re
-			*(tData++) *= (float)Magn; // Im
-
-			qx += FFT2DInfo.xStepTr;
-		}
-		qz += FFT2DInfo.yStepTr;
-	}
-
-	FFT2DInfo.pData = DataToConv;
-	FFT2DInfo.Dir = -1;
-
-	FFT2DInfo.xStep = FFT2DInfo.xStepTr; FFT2DInfo.xStepTr = RadAccessData.xStep;
-	FFT2DInfo.yStep = FFT2DInfo.yStepTr; FFT2DInfo.yStepTr = RadAccessData.zStep;
-	FFT2DInfo.xStart = FFT2DInfo.xStartTr; //FFT2DInfo.xStartTr = RadAccessData.xStart;
-	FFT2DInfo.yStart = FFT2DInfo.yStartTr; //FFT2DInfo.yStartTr = RadAccessData.zStart;
-	FFT2DInfo.UseGivenStartTrValues = 0;
-
-	FFT2D.Make2DFFT(FFT2DInfo);
+	CGenMathConvGaussInfo ConvInfo;
+	ConvInfo.pData = DataToConv;
+	ConvInfo.Nx = RadAccessData.nx;
+	ConvInfo.Ny = RadAccessData.nz;
+	ConvInfo.PerX = 1;
+	ConvInfo.PerY = RadAccessData.nx;
+	ConvInfo.xStep = RadAccessData.xStep;
+	ConvInfo.yStep = RadAccessData.zStep;
+	ConvInfo.Mxx = ElecBeamMom.Mxx;
+	ConvInfo.Myy = ElecBeamMom.Mzz;
+	ConvInfo.PadWithEdgeValues = 0;
+
+	CGenMathConvGauss ConvGauss;
+	int result;
+	if(result = ConvGauss.Convolve(ConvInfo)) return result;
 
+	PadImZerosToRealData(DataToConv, Nx, Nz);
 	return 0;
 }
 
@@ -1354,6 +1295,62 @@ void srTRadGenManip::ExtractRadiation(int PolarizCompon, int Int_or_Phase, int S
 
 //*************************************************************************
 
+void srTRadGenManip::ExtractRadiationMult(srTRadExtract* arRadExtract, int nExtract)
+{//Extracts several characteristics from the same Electric Field.
+ //The single-electron characteristics are extracted in one pass over the Electric Field data:
+ //the data is processed by blocks of rows (vs z), for all the characteristics, while a block is in cache.
+	if((arRadExtract == 0) || (nExtract <= 0)) throw INCORRECT_PARAMS_WFR_COMPON_EXTRACT;
+
+	const long MaxBlockSizeBytes = 1 << 20; //to steer
+
+	srTSRWRadStructAccessData& RadAccessData = *((srTSRWRadStructAccessData*)(hRadAccessData.ptr()));
+	int TransvPres = arRadExtract->TransvPres;
+	for(int i=0; i<nExtract; i++)
+	{
+		srTRadExtract &RadExtract = arRadExtract[i];
+		if((RadExtract.pExtractedData == 0) && (RadExtract.pExtractedDataD == 0)) throw INCORRECT_PARAMS_WFR_COMPON_EXTRACT;
+		if(RadExtract.TransvPres != TransvPres) throw INCORRECT_PARAMS_WFR_COMPON_EXTRACT;
+	}
+
+	int res;
+	if(TransvPres != RadAccessData.Pres)
+	{
+		srTGenOptElem GenOptElem;
+		if(res = GenOptElem.SetRadRepres(&RadAccessData, char(TransvPres))) throw res;
+	}
+
+	long nz = RadAccessData.nz;
+	long RowSizeBytes = RadAccessData.ne*RadAccessData.nx*2*sizeof(float);
+	if(EhOK && EvOK) RowSizeBytes <<= 1;
+	long nRowsPerBlock = MaxBlockSizeBytes/RowSizeBytes;
+	if(nRowsPerBlock < 1) nRowsPerBlock = 1;
+
+	for(long iz=0; iz<nz; iz+=nRowsPerBlock)
+	{
+		izProcSt = iz; izProcEn = iz + nRowsPerBlock - 1;
+		if(izProcEn >= nz) izProcEn = nz - 1;
+
+		for(int i=0; i<nExtract; i++)
+		{
+			int Int_or_Phase = arRadExtract[i].Int_or_Phase;
+			if((Int_or_Phase == 1) || (Int_or_Phase == 4) || (Int_or_Phase == 5)) continue;
+			if(res = ExtractSingleElecIntensity(arRadExtract[i])) { izProcSt = 0; izProcEn = -1; throw res;}
+		}
+	}
+	izProcSt = 0; izProcEn = -1;
+
+	for(int i=0; i<nExtract; i++)
+	{//flux and multi-electron intensity require entire data
+		srTRadExtract &RadExtract = arRadExtract[i];
+		int Int_or_Phase = RadExtract.Int_or_Phase;
+		if(!((Int_or_Phase == 1) || (Int_or_Phase == 4) || (Int_or_Phase == 5))) continue;
+		char *pData = (RadExtract.pExtractedData != 0)? (char*)(RadExtract.pExtractedData) : (char*)(RadExtract.pExtractedDataD);
+		ExtractRadiation(RadExtract.PolarizCompon, Int_or_Phase, RadExtract.PlotType, TransvPres, RadExtract.ePh, RadExtract.x, RadExtract.z, pData);
+	}
+}
+
+//*************************************************************************
+
 void srTRadGenManip::ComponInteg(srTDataMD* pIntensOrigData, srTDataMD* pIntegParData, srTDataMD* pIntegResData)
 {
 	if((pIntensOrigData == 0) || (pIntegParData == 0) || (pIntegResData == 0)) throw INCORRECT_PARAMS_WFR_COMPON_INTEG;
@@ -22,13 +22,14 @@
 
 //*************************************************************************
 
-extern srTIntVect gVectWarnNos;
+extern thread_local srTIntVect gVectWarnNos;
 
 //*************************************************************************
 
 class srTRadGenManip {
 // Various manipulations with computed Radiation
 	bool EhOK, EvOK; //OC111111
+	long izProcSt, izProcEn; //range of rows (vs z) processed by the single-electron extraction functions (izProcEn < 0 means up to the last row); see ExtractRadiationMult
 
 public:
 	//srTSRWRadStructAccessData RadAccessData;
@@ -44,6 +45,7 @@ public:
 		hRadAccessData = In_hRadAccessData;
 
 		EhOK = EvOK = false; //OC111111
+		izProcSt = 0; izProcEn = -1;
 		srTSRWRadStructAccessData& RadAccessData = *((srTSRWRadStructAccessData*)(hRadAccessData.ptr()));
 		EhOK = (RadAccessData.pBaseRadX != 0);
 		EvOK = (RadAccessData.pBaseRadZ != 0);
@@ -51,9 +53,11 @@ public:
 	srTRadGenManip() 
 	{
 		EhOK = EvOK = false; //OC111111
+		izProcSt = 0; izProcEn = -1;
 	}
 
 	void ExtractRadiation(int PolarizCompon, int Int_or_Phase, int SectID, int TransvPres, double e, double x, double z, char* pData);
+	void ExtractRadiationMult(srTRadExtract* arRadExtract, int nExtract);
 	int ExtractRadiation(srTRadExtract& RadExtract, srTWaveAccessData& ExtractedWaveData)
 	{
 		int result;
@@ -102,6 +106,15 @@ public:
 	int SetupExtractedWaveData(srTRadExtract&, srTWaveAccessData&);
 	void SetupIntCoord(char, double, long&, long&, double&);
 
+	bool RowIsLastToProc(long iz)
+	{//for extractions requiring given row(s) only: true if the (last) row required is in the range being processed
+		return (iz >= izProcSt) && ((izProcEn < 0) || (iz <= izProcEn));
+	}
+	void FindRowRangeToProc(long nz, long& izSt, long& izEn)
+	{
+		izSt = izProcSt; izEn = ((izProcEn < 0) || (izProcEn >= nz))? (nz - 1) : izProcEn;
+	}
+
 	int ExtractFluxFromWfr(srTRadExtract& RadExtract, char s_or_m)
 	{
 		if(RadExtract.PlotType != 0) 
@@ -256,6 +269,103 @@ public:
 		}
 	}
 
+	template<int PolCom> static float IntensityComponentT(float ExRe, float ExIm, float EzRe, float EzIm)
+	{//The same as IntensityComponent for Int_or_ReE = 0 or 1; PolCom is resolved at compile time
+		switch(PolCom)
+		{
+			case 0: return (float)(ExRe*ExRe + ExIm*ExIm); // Lin. Hor.
+			case 1: return (float)(EzRe*EzRe + EzIm*EzIm); // Lin. Vert.
+			case 2: { float ExRe_p_EzRe = ExRe + EzRe, ExIm_p_EzIm = ExIm + EzIm; return (float)(0.5*(ExRe_p_EzRe*ExRe_p_EzRe + ExIm_p_EzIm*ExIm_p_EzIm));} // Linear 45 deg.
+			case 3: { float ExRe_mi_EzRe = ExRe - EzRe, ExIm_mi_EzIm = ExIm - EzIm; return (float)(0.5*(ExRe_mi_EzRe*ExRe_mi_EzRe + ExIm_mi_EzIm*ExIm_mi_EzIm));} // Linear 135 deg.
+			case 4: { float ExRe_mi_EzIm = ExRe - EzIm, ExIm_p_EzRe = ExIm + EzRe; return (float)(0.5*(ExRe_mi_EzIm*ExRe_mi_EzIm + ExIm_p_EzRe*ExIm_p_EzRe));} // Circ. Right
+			case 5: { float ExRe_p_EzIm = ExRe + EzIm, ExIm_mi_EzRe = ExIm - EzRe; return (float)(0.5*(ExRe_p_EzIm*ExRe_p_EzIm + ExIm_mi_EzRe*ExIm_mi_EzRe));} // Circ. Left
+			case -2: return (float)(ExRe*ExRe + ExIm*ExIm - (EzRe*EzRe + EzIm*EzIm)); // s1
+			case -3: return (float)(-2.*(ExRe*EzRe + ExIm*EzIm)); // s2
+			case -4: return (float)(2.*(-ExRe*EzIm + ExIm*EzRe)); // s3
+			default: return (float)(ExRe*ExRe + ExIm*ExIm + EzRe*EzRe + EzIm*EzIm); // s0, total
+		}
+	}
+	template<int PolCom> static void IntensityComponentArrT(float* pEx, float* pEz, long PerEx, long PerEz, long Np, float* pI)
+	{//Np values at points separated by PerEx, PerEz (in floats); no branches in the loop, to allow vectorization
+		for(long i=0; i<Np; i++)
+		{
+			pI[i] = IntensityComponentT<PolCom>(*pEx, *(pEx + 1), *pEz, *(pEz + 1));
+			pEx += PerEx; pEz += PerEz;
+		}
+	}
+	template<int PolCom> static double IntensityComponentWeightedSumT(float* pEx, float* pEz, long PerEx, long PerEz, long Np, double* arW)
+	{//4 independent partial sums, to avoid the dependence of each addition on the previous one
+		double Sum0 = 0., Sum1 = 0., Sum2 = 0., Sum3 = 0.;
+		long i = 0;
+		for(; i<(Np - 3); i += 4)
+		{
+			Sum0 += arW[i]*IntensityComponentT<PolCom>(*pEx, *(pEx + 1), *pEz, *(pEz + 1)); pEx += PerEx; pEz += PerEz;
+			Sum1 += arW[i + 1]*IntensityComponentT<PolCom>(*pEx, *(pEx + 1), *pEz, *(pEz + 1)); pEx += PerEx; pEz += PerEz;
+			Sum2 += arW[i + 2]*IntensityComponentT<PolCom>(*pEx, *(pEx + 1), *pEz, *(pEz + 1)); pEx += PerEx; pEz += PerEz;
+			Sum3 += arW[i + 3]*IntensityComponentT<PolCom>(*pEx, *(pEx + 1), *pEz, *(pEz + 1)); pEx += PerEx; pEz += PerEz;
+		}
+		for(; i<Np; i++)
+		{
+			Sum0 += arW[i]*IntensityComponentT<PolCom>(*pEx, *(pEx + 1), *pEz, *(pEz + 1));
+			pEx += PerEx; pEz += PerEz;
+		}
+		return (Sum0 + Sum1) + (Sum2 + Sum3);
+	}
+
+	void IntensityComponentArr(float* pEx, float* pEz, long Per, long Np, int PolCom, int Int_or_ReE, float* pI)
+	{//Values of IntensityComponent at Np points separated by Per (in floats)
+		float Zero[] = {0., 0.};
+		long PerEx = Per, PerEz = Per;
+		if(!EhOK) { pEx = Zero; PerEx = 0;}
+		if(!EvOK) { pEz = Zero; PerEz = 0;}
+
+		if((Int_or_ReE != 0) && (Int_or_ReE != 1))
+		{
+			for(long i=0; i<Np; i++) { pI[i] = IntensityComponent(pEx, pEz, PolCom, Int_or_ReE); pEx += PerEx; pEz += PerEz;}
+			return;
+		}
+		switch(PolCom)
+		{
+			case 0: IntensityComponentArrT<0>(pEx, pEz, PerEx, PerEz, Np, pI); break;
+			case 1: IntensityComponentArrT<1>(pEx, pEz, PerEx, PerEz, Np, pI); break;
+			case 2: IntensityComponentArrT<2>(pEx, pEz, PerEx, PerEz, Np, pI); break;
+			case 3: IntensityComponentArrT<3>(pEx, pEz, PerEx, PerEz, Np, pI); break;
+			case 4: IntensityComponentArrT<4>(pEx, pEz, PerEx, PerEz, Np, pI); break;
+			case 5: IntensityComponentArrT<5>(pEx, pEz, PerEx, PerEz, Np, pI); break;
+			case -2: IntensityComponentArrT<-2>(pEx, pEz, PerEx, PerEz, Np, pI); break;
+			case -3: IntensityComponentArrT<-3>(pEx, pEz, PerEx, PerEz, Np, pI); break;
+			case -4: IntensityComponentArrT<-4>(pEx, pEz, PerEx, PerEz, Np, pI); break;
+			default: IntensityComponentArrT<-1>(pEx, pEz, PerEx, PerEz, Np, pI);
+		}
+	}
+	double IntensityComponentWeightedSum(float* pEx, float* pEz, long Per, long Np, int PolCom, int Int_or_ReE, double* arW)
+	{//Sum of arW[i]*IntensityComponent over Np points separated by Per (in floats), e.g. for integration over photon energy "on the fly"
+		float Zero[] = {0., 0.};
+		long PerEx = Per, PerEz = Per;
+		if(!EhOK) { pEx = Zero; PerEx = 0;}
+		if(!EvOK) { pEz = Zero; PerEz = 0;}
+
+		if((Int_or_ReE != 0) && (Int_or_ReE != 1))
+		{
+			double Sum = 0.;
+			for(long i=0; i<Np; i++) { Sum += arW[i]*IntensityComponent(pEx, pEz, PolCom, Int_or_ReE); pEx += PerEx; pEz += PerEz;}
+			return Sum;
+		}
+		switch(PolCom)
+		{
+			case 0: return IntensityComponentWeightedSumT<0>(pEx, pEz, PerEx, PerEz, Np, arW);
+			case 1: return IntensityComponentWeightedSumT<1>(pEx, pEz, PerEx, PerEz, Np, arW);
+			case 2: return IntensityComponentWeightedSumT<2>(pEx, pEz, PerEx, PerEz, Np, arW);
+			case 3: return IntensityComponentWeightedSumT<3>(pEx, pEz, PerEx, PerEz, Np, arW);
+			case 4: return IntensityComponentWeightedSumT<4>(pEx, pEz, PerEx, PerEz, Np, arW);
+			case 5: return IntensityComponentWeightedSumT<5>(pEx, pEz, PerEx, PerEz, Np, arW);
+			case -2: return IntensityComponentWeightedSumT<-2>(pEx, pEz, PerEx, PerEz, Np, arW);
+			case -3: return IntensityComponentWeightedSumT<-3>(pEx, pEz, PerEx, PerEz, Np, arW);
+			case -4: return IntensityComponentWeightedSumT<-4>(pEx, pEz, PerEx, PerEz, Np, arW);
+			default: return IntensityComponentWeightedSumT<-1>(pEx, pEz, PerEx, PerEz, Np, arW);
+		}
+	}
+
 	static void ComponInteg(srTDataMD* pIntensOrigData, srTDataMD* pIntegParData, srTDataMD* pIntegResData);
 	static void ComponIntegVsPhotEn(srTDataMD* pIntensOrigData, double eMin, double eMax, srTDataMD* pIntegResData);
 	static void ComponIntegVsHorOrVertPos(srTDataMD* pIntensOrigData, char x_or_z, double xMin, double xMax, srTDataMD* pIntegResData);
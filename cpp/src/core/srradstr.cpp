@@ -411,6 +411,7 @@ srTSRWRadStructAccessData::srTSRWRadStructAccessData(srTSRWRadInData* pRadInData
 
 void srTSRWRadStructAccessData::InSRWRadPtrs(srTSRWRadInData* p, bool DataShouldBeCopied)
 {
+	NoteFieldModif();
 	if(p == 0) throw INCORRECT_PARAMS_SR_COMP;
 
 	pBaseRadX = p->pBaseRadX; pBaseRadZ = p->pBaseRadZ;
@@ -471,6 +472,7 @@ void srTSRWRadStructAccessData::InSRWRadPtrs(srTSRWRadInData* p, bool DataShould
 
 void srTSRWRadStructAccessData::InSRWRadPtrs(SRWLWfr& srwlWfr)
 {
+	NoteFieldModif();
 	pBaseRadX = (float*)srwlWfr.arEx; pBaseRadZ = (float*)srwlWfr.arEy;
 	wRad = 0; wRadX = 0; wRadZ = 0;
 	hStateRadX = 0; hStateRadZ = 0;
@@ -1055,6 +1057,7 @@ void srTSRWRadStructAccessData::EstimateOversamplingFactors(double& estimOverSam
 
 void srTSRWRadStructAccessData::CopyBaseRadData(float* pInBaseRadX, float* pInBaseRadZ)
 {
+	NoteFieldModif();
 	long LenRadData = (ne << 1)*nx*nz;
 	bool NeedRadX = (LenRadData > 0) && (pInBaseRadX != 0) && (pBaseRadX != 0);
 	bool NeedRadZ = (LenRadData > 0) && (pInBaseRadZ != 0) && (pBaseRadZ != 0);
@@ -1202,6 +1205,10 @@ srTSRWRadStructAccessData::srTSRWRadStructAccessData(srTSRWRadStructAccessData*
 	}
 
 	Pres = InRadStruct.Pres;
+	MirrorSymX = InRadStruct.MirrorSymX; MirrorSymZ = InRadStruct.MirrorSymZ;
+	CoordStartIsPend = InRadStruct.CoordStartIsPend;
+	xStartCoordPend = InRadStruct.xStartCoordPend;
+	zStartCoordPend = InRadStruct.zStartCoordPend;
 	PresT = InRadStruct.PresT;
 	LengthUnit = InRadStruct.LengthUnit;
 	PhotEnergyUnit = InRadStruct.PhotEnergyUnit;
@@ -1351,6 +1358,9 @@ void srTSRWRadStructAccessData::Initialize()
 	BaseRadWasEmulated = false;
 	
 	UseStartTrToShiftAtChangingRepresToCoord = false;
+	PresAngMayBeKept = 0;
+	MirrorSymX = MirrorSymZ = 0;
+	CoordStartIsPend = 0;
 	
 	DoNotResizeAfter = false;
 	ResAfterWasEmulated = false;
@@ -1366,6 +1376,8 @@ void srTSRWRadStructAccessData::Initialize()
 	wMomX = wMomZ = NIL;
 	MomWereEmulated = false;
 	MomWereCalcNum = false;
+	FldModifCount = MomFldModifCount = 0;
+	MomHashPar = MomHashMom = 0;
 	
 	pWfrAuxData = 0; wWfrAuxData = NIL;
 	WfrAuxDataWasEmulated = false;
@@ -1517,6 +1529,27 @@ void srTSRWRadStructAccessData::FindMinMaxReE(srTMinMaxEParam& a)
 
 //*************************************************************************
 
+void srTSRWRadStructAccessData::FindMirrorSym()
+{//Sets MirrorSymX (MirrorSymZ) to 1 if both Ex and Ez are mirror-symmetric (even or odd, for all photon energies) vs x = 0 (z = 0) of the current mesh
+	MirrorSymX = MirrorSymZ = 0;
+	if((pBaseRadX == 0) || (pBaseRadZ == 0) || (nx <= 1) || (nz <= 1)) return;
+
+	long iCenX = CGenMathFFT2D::FindMirrorCenInd(xStart, xStep, nx);
+	if(iCenX >= 0)
+	{
+		MirrorSymX = (CGenMathFFT2D::FindMirrorSym((FFTW_COMPLEX*)pBaseRadX, nx, nz, ne, 'x', iCenX) != 0) &&
+					 (CGenMathFFT2D::FindMirrorSym((FFTW_COMPLEX*)pBaseRadZ, nx, nz, ne, 'x', iCenX) != 0);
+	}
+	long iCenZ = CGenMathFFT2D::FindMirrorCenInd(zStart, zStep, nz);
+	if(iCenZ >= 0)
+	{
+		MirrorSymZ = (CGenMathFFT2D::FindMirrorSym((FFTW_COMPLEX*)pBaseRadX, nx, nz, ne, 'y', iCenZ) != 0) &&
+					 (CGenMathFFT2D::FindMirrorSym((FFTW_COMPLEX*)pBaseRadZ, nx, nz, ne, 'y', iCenZ) != 0);
+	}
+}
+
+//*************************************************************************
+
 void srTSRWRadStructAccessData::AllocElectronBeam()
 {
 	int MaxLenElecBeam = 50;
@@ -1761,6 +1794,7 @@ void srTSRWRadStructAccessData::ZeroPtrs()
 
 int srTSRWRadStructAccessData::ReAllocBaseRadAccordingToNeNxNz(char PolarizComp)
 {
+	NoteFieldModif();
 	long LenRadData = (ne << 1)*nx*nz;
 	bool TreatPolCompX = ((PolarizComp == 0) || (PolarizComp == 'x')) && (LenRadData > 0);
 	bool TreatPolCompZ = ((PolarizComp == 0) || (PolarizComp == 'z')) && (LenRadData > 0);
@@ -1786,6 +1820,7 @@ int srTSRWRadStructAccessData::ReAllocBaseRadAccordingToNeNxNz(char PolarizComp)
 
 int srTSRWRadStructAccessData::AllocBaseRadAccordingToNeNxNz(char PolarizComp)
 {
+	NoteFieldModif();
 	long LenRadData = (ne << 1)*nx*nz;
 	bool TreatPolCompX = ((PolarizComp == 0) || (PolarizComp == 'x')) && (LenRadData > 0);
 	bool TreatPolCompZ = ((PolarizComp == 0) || (PolarizComp == 'z')) && (LenRadData > 0);
@@ -2498,6 +2533,7 @@ void srTSRWRadStructAccessData::CheckAndResetPhaseTermsLin()
 
 void srTSRWRadStructAccessData::MirrorFieldData(int sx, int sz)
 {// sx < 0 means mirroring should be done vs x 
+	NoteFieldModif();
  // sz < 0 means mirroring should be done vs z 
 	long PerX = ne << 1;
 	long PerZ = PerX*nx;
@@ -2698,6 +2734,7 @@ int srTSRWRadStructAccessData::ExtractSliceConstEorT(long ie, float*& pOutEx, fl
 
 int srTSRWRadStructAccessData::SetupSliceConstEorT(long ie, float* pInEx, float* pInEz)
 {
+	NoteFieldModif();
 	float *pEx0 = pBaseRadX;
 	float *pEz0 = pBaseRadZ;
 	long PerX = ne << 1;
@@ -3064,6 +3101,7 @@ void srTSRWRadStructAccessData::MakeWfrEdgeCorrection(float* pDataEx, float* pDa
 
 int srTSRWRadStructAccessData::ShiftWfrByInterpolVsXZ(double shiftX, double shiftZ)
 {//Shift the wavefront E-field data by interpolation, in whatever representation (coord. of ang.), keeping same mesh
+	NoteFieldModif();
  //Note: it also modifies xc, zc (requires for best treatment of quadratic phase term) !
 
 	long nTot = (ne << 1)*nx*nz;
@@ -3260,6 +3298,7 @@ int srTSRWRadStructAccessData::ShiftWfrByInterpolVsXZ(double shiftX, double shif
 
 void srTSRWRadStructAccessData::FlipFieldData(bool flipOverX, bool flipOverZ)
 {
+	NoteFieldModif();
 	long PerX = ne << 1;
 	long PerZ = PerX*nx;
 
@@ -3330,6 +3369,7 @@ void srTSRWRadStructAccessData::FlipFieldData(bool flipOverX, bool flipOverZ)
 
 int srTSRWRadStructAccessData::SetRepresCA(char CoordOrAng)
 {//Copied from srTGenOptElem::SetRadRepres(srTSRWRadStructAccessData*, char);
+	NoteFieldModif();
 // 'c' or 'C' or 0- to coord.; 'a' or 'A' or 1- to ang.
 // 0- to coord.; 1- to ang.
 	int result=0;
@@ -3351,6 +3391,8 @@ int srTSRWRadStructAccessData::SetRepresCA(char CoordOrAng)
 	FFT2DInfo.Ny = nz;
 	FFT2DInfo.Dir = DirFFT;
 	FFT2DInfo.UseGivenStartTrValues = 0;
+	FFT2DInfo.SymX = MirrorSymX;
+	FFT2DInfo.SymY = MirrorSymZ;
 
 //New
 	if((AuxLong4 == 7777777) || ((CoordOrAng == 0) && UseStartTrToShiftAtChangingRepresToCoord))
@@ -3391,8 +3433,16 @@ int srTSRWRadStructAccessData::SetRepresCA(char CoordOrAng)
 			}
 		}
 	}
+	else if(!(WfrEdgeCorrShouldBeDone && (CoordOrAng == 1)))
+	{//all photon energy slices are transformed at once, directly in the wavefront arrays
+		FFT2DInfo.HowMany = ne;
+		FFT2DInfo.pData = pBaseRadX;
+		if(result = FFT2D.Make2DFFT(FFT2DInfo)) return result;
+		FFT2DInfo.pData = pBaseRadZ;
+		if(result = FFT2D.Make2DFFT(FFT2DInfo)) return result;
+	}
 	else
-	{
+	{//edge correction data is set up per slice
 		long TwoNxNz = (nx*nz) << 1;
 		float* AuxEx = new float[TwoNxNz];
 		if(AuxEx == 0) return MEMORY_ALLOCATION_FAILURE;
@@ -3441,6 +3491,11 @@ int srTSRWRadStructAccessData::SetRepresCA(char CoordOrAng)
 	xStart = FFT2DInfo.xStartTr;
 	zStart = FFT2DInfo.yStartTr;
 	Pres = CoordOrAng;
+	if((CoordOrAng == 0) && CoordStartIsPend)
+	{
+		xStart = xStartCoordPend; zStart = zStartCoordPend;
+		CoordStartIsPend = 0;
+	}
 
 	SetNonZeroWavefrontLimitsToFullRange();
 	return result;
@@ -3450,6 +3505,7 @@ int srTSRWRadStructAccessData::SetRepresCA(char CoordOrAng)
 
 int srTSRWRadStructAccessData::SetRepresFT(char FreqOrTime) 
 {//set Frequency or Time representation
+	NoteFieldModif();
 // 'f' or 'F' or 0- to freq.; 't' or 'T' or 1- to time
 //Conversions are done assuming intensity units to be:
 //	- in Time domain: [W/mm^2]
@@ -90,6 +90,10 @@ public:
 	srTRadResize* pResAfter;
 
 	char Pres; // 0- Coord, 1- Ang.
+	char PresAngMayBeKept; // 1- optical element working in Ang. repres. may leave the wavefront in it (set by srTCompositeOptElem::PropagateRadiationGuided)
+	char MirrorSymX, MirrorSymZ; // 1- electric field may be mirror-symmetric (even or odd) vs x = 0 / z = 0; then the symmetry is checked at changing representation, and if it is confirmed, only a half of the FFTs is done (set by srTCompositeOptElem::PropagateRadiationGuided, reset before elements breaking the symmetry)
+	char CoordStartIsPend; // 1- Ang. repres. corresponds to centered Coord. mesh, the actual start values of which (xStartCoordPend, zStartCoordPend) are set at change to Coord. repres.
+	double xStartCoordPend, zStartCoordPend;
 	char PresT; // 0- Frequency (Photon Energy), 1- Time Domain (i.e. ne, eStep, eStart contain time parameters)
 	char LengthUnit; // 0- m; 1- mm; 
 	char PhotEnergyUnit; // 0- eV; 1- keV; 
@@ -117,6 +121,8 @@ public:
 	waveHndl wMomX, wMomZ;
 	int hStateMomX, hStateMomZ;
 	bool MomWereCalcNum;
+	unsigned long long FldModifCount; //incremented by the code modifying the field data (see NoteFieldModif)
+	unsigned long long MomFldModifCount, MomHashPar, MomHashMom; //field modification count, hashes of the mesh parameters and of the moments at the last numerical computation of the moments (see srTGenOptElem::ComputeRadMoments)
 
 	bool WfrAuxDataWasEmulated;
 	DOUBLE *pWfrAuxData;
@@ -165,6 +171,7 @@ public:
 	void DisposeEmulatedStructs();
 	void PreserveLogicsOfWfrLimitsAtRangeResizing(srTSRWRadStructAccessData* pOldRadData, char x_or_z);
 	void FindMinMaxReE(srTMinMaxEParam& a);
+	void FindMirrorSym();
 	int EmulateElectronBeamStruct(srTEbmDat& EbmDat);
 	int EmulateElectronBeamStruct(const SRWLPartBeam& srwlPartBeam);
 	int EmulateElectronBeamStruct(srTGsnBeam& GsnBeam);
@@ -288,6 +295,10 @@ public:
 		zWfrMin = zStart;
 		zWfrMax = zStart + zStep*(nz - 1);
 	}
+	void NoteFieldModif()
+	{// Is called by the code modifying pBaseRadX, pBaseRadZ (makes moments computed before be recomputed by srTGenOptElem::ComputeRadMoments)
+		FldModifCount++;
+	}
 	void SetNonZeroWavefrontLimitsToFullRange()
 	{// This switches off the sharp Wfr edges treatment
 		xWfrMin = xStart;
@@ -30,7 +30,7 @@
 
 //*************************************************************************
 
-extern srTIntVect gVectWarnNos;
+extern thread_local srTIntVect gVectWarnNos;
 
 //*************************************************************************
 
@@ -302,7 +302,7 @@ extern "C" {
 //#define cartcom_1 cartcom_
 
 extern srTYield srYield;
-extern srTIntVect gVectWarnNos;
+extern thread_local srTIntVect gVectWarnNos;
 
 //*************************************************************************
 
@@ -3856,6 +3856,7 @@ int srTSASE::InitAuxWfrParams(srTSRWRadStructAccessData *arSRWRadAccessData, int
 		t_arSRWRadAccessData->RobsX = t_arSRWRadAccessData->RobsZ = Rinit;
 		t_arSRWRadAccessData->RobsXAbsErr = t_arSRWRadAccessData->RobsZAbsErr = RinitErr; // To steer
 
+		t_arSRWRadAccessData->NoteFieldModif(); //the field was computed above
 		t_arSRWRadAccessData->ComputeRadMoments();
 		t_arSRWRadAccessData->SetupRadMomentsPtrs(MomPtrsX, MomPtrsZ);
 		t_arSRWRadAccessData->xc = *(MomPtrsX.pX);
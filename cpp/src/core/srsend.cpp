@@ -2989,8 +2989,8 @@ int srTSend::GetTotalRadIntegrationParamDataFormat1(srTRadInt& RadInt)
 
 //*************************************************************************
 
-int srTSend::GetPropagRadStokesMultiElecDataFormat1(double* pPrecPar)
-{
+int srTSend::GetPropagRadStokesMultiElecDataFormat1(double* pPrecPar, int nPrecPar)
+{//The first two values are required; values after them (up to nPrecPar) are read if the wave has them, otherwise pPrecPar keeps the defaults
 #if defined(__IGOR_PRO__)
 
 	waveHndl wavH;
@@ -3000,6 +3000,11 @@ int srTSend::GetPropagRadStokesMultiElecDataFormat1(double* pPrecPar)
 	if(waveType != NT_FP64) return NT_FP64_WAVE_REQUIRED;
 
 	int result;
+	long numDimensions;
+	long dimensionSizes[MAX_DIMENSIONS+1];
+	if(result = MDGetWaveDimensions(wavH, &numDimensions, dimensionSizes)) return result;
+	long numRows = dimensionSizes[0];
+
 	long dataOffset;
 	if(result = MDAccessNumericWaveData(wavH, kMDWaveAccessMode0, &dataOffset)) return result;
 	int hState = MoveLockHandle(wavH);
@@ -3009,6 +3014,11 @@ int srTSend::GetPropagRadStokesMultiElecDataFormat1(double* pPrecPar)
 
 	pPrecPar[0] = *(dp++);
 	pPrecPar[1] = *(dp++);
+	for(int i=2; i<nPrecPar; i++)
+	{
+		if(i >= numRows) break;
+		pPrecPar[i] = *(dp++);
+	}
 
 	HSetState((Handle)wavH, hState);
 	return 0;
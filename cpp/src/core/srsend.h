@@ -192,7 +192,7 @@ public:
 	int SetupControlStruct1D(waveHndl wText, long* Indices, long NewNp, DOUBLE NewStart, DOUBLE NewStep, waveHndl& wHndl, char*& pBase, int& hState);
 	int SetupControlStructMD(waveHndl wText, long* Indices, long* NewNpAr, DOUBLE* NewStartAr, DOUBLE* NewStepAr, int numDim, waveHndl& wHndl, char*& pBase, int& hState);
 
-	int GetPropagRadStokesMultiElecDataFormat1(double* pPrecPar);
+	int GetPropagRadStokesMultiElecDataFormat1(double* pPrecPar, int nPrecPar = 2);
 	int GetWfrEmitPropagPrec(double* pPrecPar);
 
 	int FinishWorkingWithControlSASEStruct(srTControlAccessSASE& ControlAccessSASE);
@@ -21,7 +21,7 @@
 //*************************************************************************
 
 extern srTYield srYield;
-extern srTIntVect gVectWarnNos;
+extern thread_local srTIntVect gVectWarnNos;
 
 //*************************************************************************
 
@@ -177,21 +177,7 @@ public:
 	int ComputeCrossTermsAtPointArb(int AmOfInterv, srTStokes& Stokes);
 	int ComputeCrossTermsAtPointPer(int StartIntervNo, int FinIntervNo, srTStokes& Stokes);
 	int TreatFiniteElecBeamEmittance(srTStokesStructAccessData&, char MainOrCrossTerms, double ElBeamMomFact);
-	void ExtractStokesSliceConstE(srTStokesStructAccessData& StokesAccessData, long ie, int StokesNo, char MainOrCrossTerms, float* pOutS);
-	void UpdateStokesSliceConstE(float* StokesCmpnArr, long ie, int is, char MainOrCrossTerms, srTStokesStructAccessData& StokesAccessData);
-	int TreatFiniteElecBeamEmittanceOneComp1D(float* CmpnArr, double ElBeamMomFact);
-	int TreatFiniteElecBeamEmittanceOneComp2D(float* CmpnArr, double ElBeamMomFact);
-	void DetermineSingleElecDistrEffSizes2D(float* CmpnArr, double& Mxx, double& Mzz);
-	void DetermineSingleElecDistrEffSizes1D(float* CmpnArr, char VsXorZ, double& M_Cen);
-	void DetermineResizeBeforeConv2D(double MxxElecEff, double MzzElecEff, double MxxPowSingleE, double MzzPowSingleE, srTRadResize& Resize);
-	void DetermineResizeBeforeConv1D(double M_ElecEff, double M_DistrSingleE, char VsXorZ, srTRadResize1D& Resize);
-	void ConstructDataForConv2D(float* CmpnArr, float* NewData, long NewNx, long NewNz);
-	void ConstructDataForConv1D(float* CmpnArr, float* AuxConvData, long NpOld, long NpNew);
-	int PerformConvolutionWithGaussian2D(float* ConvData, long NewNx, long NewNz, double MxxElecEff, double MzzElecEff);
-	int PerformConvolutionWithGaussian1D(float* AuxConvData, long NpAux, double M_ElecEff, char VsXorZ);
-	void ExtractDataAfterConv2D(float* AuxConvData, long NxAux, long NzAux, float* CmpnArr);
-	void ExtractDataAfterConv1D(float* AuxConvData, long NpAux, long Np, float* CmpnArr);
-	void SuppressNegativeValues(float* StokesCmpnArr);
+	void SuppressNegativeValues(float* pS0, long PerX);
 	
 	int CheckInputConsistency();
 	void CheckPossibilityOfFarFieldPeriodicComp(srTGenTrjHndl& TrjHndl, char& LongIntType);
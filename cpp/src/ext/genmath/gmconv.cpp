@@ -0,0 +1,221 @@
+/************************************************************************//**
+ * File: gmconv.cpp
+ * Description: Separable convolution of real data with Gaussian kernel
+ * Project: Synchrotron Radiation Workshop
+ * First release: 2016
+ *
+ * Copyright (C) Brookhaven National Laboratory, Upton, NY, USA
+ * All Rights Reserved
+ *
+ * @author O.Chubar
+ * @version 1.0
+ ***************************************************************************/
+
+#include "gmconv.h"
+
+//*************************************************************************
+
+int CGenMathConvGauss::Convolve(CGenMathConvGaussInfo& Info)
+{//The 2D Gaussian is separable, so the convolution is done vs x, then vs y.
+ //Lines of different planes (e.g. Stokes components / photon energies) are processed within the same loop,
+ //adjacent planes being the fastest-changing index, to use cache efficiently when the planes are interleaved.
+	if(Info.pData == 0) return 0;
+	int result;
+	if((result = ConvolveAlongOneAxis(Info.pData, Info.Nx, Info.PerX, Info.Ny, Info.PerY, Info.nBatch, Info.PerBatch, Info.xStep, Info.Mxx, Info.PadWithEdgeValues, Info.Method))) return result;
+	if((result = ConvolveAlongOneAxis(Info.pData, Info.Ny, Info.PerY, Info.Nx, Info.PerX, Info.nBatch, Info.PerBatch, Info.yStep, Info.Myy, Info.PadWithEdgeValues, Info.Method))) return result;
+	return 0;
+}
+
+//*************************************************************************
+
+int CGenMathConvGauss::ConvolveAlongOneAxis(float* pData, long Np, long PerP, long nLines1, long PerLines1, long nLines2, long PerLines2, double Step, double M, char PadWithEdgeValues, char Method)
+{
+	const double AmOfExtraSig = 6.; //to steer: extra range (on each side, in units of RMS size) for zero-padding before FFT
+	const double MinSigmaInStepsRec = 0.5; //lower limit of applicability of the recursive filter coefficients
+	const long MinNpRec = 4;
+
+	if((Np <= 1) || (M <= 0.) || (Step == 0.) || (nLines1 <= 0) || (nLines2 <= 0)) return 0;
+
+	double SigmaInSteps = sqrt(M)/::fabs(Step);
+	char UseRec = (Method == 2);
+	if(Method == 0)
+	{//FFT is preferred while the padding does not dominate the transform length
+		double NpPadEstim = Np + 2.*AmOfExtraSig*SigmaInSteps;
+		UseRec = (NpPadEstim > 4.*Np);
+	}
+	if(UseRec && (SigmaInSteps >= MinSigmaInStepsRec) && (Np >= MinNpRec))
+	{
+		return ConvolveLinesRecursive(pData, Np, PerP, nLines1, PerLines1, nLines2, PerLines2, SigmaInSteps, PadWithEdgeValues);
+	}
+	return ConvolveLinesFFT(pData, Np, PerP, nLines1, PerLines1, nLines2, PerLines2, Step, M, PadWithEdgeValues);
+}
+
+//*************************************************************************
+
+int CGenMathConvGauss::ConvolveLinesFFT(float* pData, long Np, long PerP, long nLines1, long PerLines1, long nLines2, long PerLines2, double Step, double M, char PadWithEdgeValues)
+{//Two real lines are transformed at once, as real and imaginary parts of one complex line:
+ //the spectrum of the kernel is real and even, so the two convolved lines are recovered from Re and Im after the backward FFT.
+	const double AmOfExtraSig = 6.;
+	const double TwoPiE2 = 19.739208802178717;
+
+	double SigmaInSteps = sqrt(M)/::fabs(Step);
+	long NpExtra = (long)(AmOfExtraSig*SigmaInSteps) + 1;
+	long NpPad = Np + (NpExtra << 1);
+	NextCorrectNumberForFFT(NpPad);
+	long HalfNpPad = NpPad >> 1;
+	long ipSt = (NpPad - Np) >> 1;
+	long ipFi = ipSt + Np;
+
+	FFTW_COMPLEX *pBuf = new FFTW_COMPLEX[NpPad];
+	if(pBuf == 0) return MEMORY_ALLOCATION_FAILURE;
+	float *arKer = new float[NpPad];
+	if(arKer == 0) { delete[] pBuf; return MEMORY_ALLOCATION_FAILURE;}
+
+	//Spectrum of the kernel, in the order of harmonics used by FFTW, including the normalization of the backward FFT
+	double qStep = 1./(NpPad*Step), InvNpPad = 1./NpPad;
+	float *tKer = arKer;
+	for(long k=0; k<NpPad; k++)
+	{
+		long kk = (k <= HalfNpPad)? k : (k - NpPad);
+		double q = kk*qStep;
+		*(tKer++) = (float)(InvNpPad*exp(-TwoPiE2*M*q*q));
+	}
+
+	fftw_plan PlanForw = fftw_create_plan(NpPad, FFTW_FORWARD, FFTW_ESTIMATE | FFTW_IN_PLACE);
+	fftw_plan PlanBack = fftw_create_plan(NpPad, FFTW_BACKWARD, FFTW_ESTIMATE | FFTW_IN_PLACE);
+	if((PlanForw == 0) || (PlanBack == 0))
+	{
+		if(PlanForw != 0) fftw_destroy_plan(PlanForw);
+		if(PlanBack != 0) fftw_destroy_plan(PlanBack);
+		delete[] pBuf; delete[] arKer;
+		return ERROR_IN_FFT;
+	}
+
+	long OffsetFi = (Np - 1)*PerP;
+	long nLines = nLines1*nLines2;
+	for(long iLine=0; iLine<nLines; iLine += 2)
+	{
+		float *pL1 = pData + (iLine/nLines2)*PerLines1 + (iLine%nLines2)*PerLines2;
+		float *pL2 = 0;
+		long iLine2 = iLine + 1;
+		if(iLine2 < nLines) pL2 = pData + (iLine2/nLines2)*PerLines1 + (iLine2%nLines2)*PerLines2;
+
+		float V1St = 0., V1Fi = 0., V2St = 0., V2Fi = 0.;
+		if(PadWithEdgeValues)
+		{
+			V1St = *pL1; V1Fi = *(pL1 + OffsetFi);
+			if(pL2 != 0) { V2St = *pL2; V2Fi = *(pL2 + OffsetFi);}
+		}
+
+		FFTW_COMPLEX *t = pBuf;
+		long ip;
+		for(ip=0; ip<ipSt; ip++) { t->re = V1St; (t++)->im = V2St;}
+		float *t1 = pL1, *t2 = pL2;
+		if(pL2 != 0)
+		{
+			for(ip=ipSt; ip<ipFi; ip++) { t->re = *t1; (t++)->im = *t2; t1 += PerP; t2 += PerP;}
+		}
+		else
+		{
+			for(ip=ipSt; ip<ipFi; ip++) { t->re = *t1; (t++)->im = 0.; t1 += PerP;}
+		}
+		for(ip=ipFi; ip<NpPad; ip++) { t->re = V1Fi; (t++)->im = V2Fi;}
+
+		fftw_one(PlanForw, pBuf, 0);
+		t = pBuf; tKer = arKer;
+		for(ip=0; ip<NpPad; ip++) { t->re *= *tKer; (t++)->im *= *(tKer++);}
+		fftw_one(PlanBack, pBuf, 0);
+
+		t = pBuf + ipSt; t1 = pL1; t2 = pL2;
+		if(pL2 != 0)
+		{
+			for(ip=0; ip<Np; ip++) { *t1 = t->re; *t2 = (t++)->im; t1 += PerP; t2 += PerP;}
+		}
+		else
+		{
+			for(ip=0; ip<Np; ip++) { *t1 = (t++)->re; t1 += PerP;}
+		}
+	}
+
+	fftw_destroy_plan(PlanForw);
+	fftw_destroy_plan(PlanBack);
+	delete[] pBuf;
+	delete[] arKer;
+	return 0;
+}
+
+//*************************************************************************
+
+int CGenMathConvGauss::ConvolveLinesRecursive(float* pData, long Np, long PerP, long nLines1, long PerLines1, long nLines2, long PerLines2, double SigmaInSteps, char PadWithEdgeValues)
+{//Third-order recursive Gaussian filter: I.T. Young, L.J. van Vliet, Signal Processing 44 (1995) 139;
+ //boundary conditions at the end of the causal pass: B. Triggs, M. Sdika, IEEE Trans. Signal Processing 54 (2006) 2365.
+ //The cost per point does not depend on the kernel width, and no padding is required.
+	double s = SigmaInSteps;
+	double q = (s >= 2.5)? (0.98711*s - 0.96330) : (3.97156 - 4.14554*sqrt(1. - 0.26891*s));
+	double qE2 = q*q, qE3 = qE2*q;
+	double b0 = 1.57825 + 2.44413*q + 1.4281*qE2 + 0.422205*qE3;
+	double a1 = (2.44413*q + 2.85619*qE2 + 1.26661*qE3)/b0;
+	double a2 = -(1.4281*qE2 + 1.26661*qE3)/b0;
+	double a3 = 0.422205*qE3/b0;
+	double B = 1. - (a1 + a2 + a3);
+	double BE2 = B*B;
+
+	double MultM = 1./((1. + a1 - a2 + a3)*(1. - a1 - a2 - a3)*(1. + a2 + (a1 - a3)*a3));
+	double M11 = MultM*(-a3*a1 + 1. - a3*a3 - a2);
+	double M12 = MultM*(a3 + a1)*(a2 + a3*a1);
+	double M13 = MultM*a3*(a1 + a3*a2);
+	double M21 = MultM*(a1 + a3*a2);
+	double M22 = -MultM*(a2 - 1.)*(a2 + a3*a1);
+	double M23 = -MultM*a3*(a3*a1 + a3*a3 + a2 - 1.);
+	double M31 = MultM*(a3*a1 + a2 + a1*a1 - a2*a2);
+	double M32 = MultM*(a1*a2 + a3*a2*a2 - a1*a3*a3 - a3*a3*a3 - a3*a2 + a3);
+	double M33 = MultM*a3*(a1 + a3*a2);
+
+	double *arW = new double[Np];
+	if(arW == 0) return MEMORY_ALLOCATION_FAILURE;
+
+	long nLines = nLines1*nLines2;
+	long Np_mi_1 = Np - 1;
+	for(long iLine=0; iLine<nLines; iLine++)
+	{
+		float *pL = pData + (iLine/nLines2)*PerLines1 + (iLine%nLines2)*PerLines2;
+
+		float *t = pL;
+		double *tW = arW;
+		for(long ip=0; ip<Np; ip++) { *(tW++) = *t; t += PerP;}
+
+		double uSt = 0., uFi = 0.;
+		if(PadWithEdgeValues) { uSt = arW[0]; uFi = arW[Np_mi_1];}
+
+		//causal pass (not normalized), started from the steady state corresponding to uSt
+		double w1 = uSt/B, w2 = w1, w3 = w1;
+		tW = arW;
+		for(long ip=0; ip<Np; ip++)
+		{
+			double w = *tW + a1*w1 + a2*w2 + a3*w3;
+			*(tW++) = w; w3 = w2; w2 = w1; w1 = w;
+		}
+
+		//anti-causal pass, started from the exact values for the data extended by uFi
+		double uPlus = uFi/B, vPlus = uPlus/B;
+		double d1 = arW[Np_mi_1] - uPlus, d2 = arW[Np - 2] - uPlus, d3 = arW[Np - 3] - uPlus;
+		double v1 = BE2*(M11*d1 + M12*d2 + M13*d3 + vPlus);
+		double v2 = BE2*(M21*d1 + M22*d2 + M23*d3 + vPlus);
+		double v3 = BE2*(M31*d1 + M32*d2 + M33*d3 + vPlus);
+		arW[Np_mi_1] = v1;
+		tW = arW + (Np - 2);
+		for(long ip=Np-2; ip>=0; ip--)
+		{
+			double v = BE2*(*tW) + a1*v1 + a2*v2 + a3*v3;
+			*(tW--) = v; v3 = v2; v2 = v1; v1 = v;
+		}
+
+		t = pL; tW = arW;
+		for(long ip=0; ip<Np; ip++) { *t = (float)(*(tW++)); t += PerP;}
+	}
+
+	delete[] arW;
+	return 0;
+}
+
+//*************************************************************************
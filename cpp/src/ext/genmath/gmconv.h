@@ -0,0 +1,58 @@
+/************************************************************************//**
+ * File: gmconv.h
+ * Description: Separable convolution of real data with Gaussian kernel (header)
+ * Project: Synchrotron Radiation Workshop
+ * First release: 2016
+ *
+ * Copyright (C) Brookhaven National Laboratory, Upton, NY, USA
+ * All Rights Reserved
+ *
+ * @author O.Chubar
+ * @version 1.0
+ ***************************************************************************/
+
+#ifndef __GMCONV_H
+#define __GMCONV_H
+
+#include "gmfft.h"
+
+//*************************************************************************
+
+struct CGenMathConvGaussInfo {
+	float* pData; //real data to be convolved "in place"; may be a number of planes interleaved with other data
+	long Nx, Ny; //numbers of points in one plane vs x and y
+	long PerX, PerY; //strides (in floats) between adjacent points vs x and y
+	long nBatch, PerBatch; //number of planes to be convolved and stride (in floats) between them
+	double xStep, yStep;
+	double Mxx, Myy; //second-order central moments (sigma^2) of the Gaussian kernel vs x and y; <= 0 means no convolution vs that coordinate
+
+	char PadWithEdgeValues; //1- data is assumed to be extended beyond the edges by edge values, 0- by zeros; the result is only computed on the input mesh (what spills beyond it is dropped)
+	char Method; //0- automatic choice, 1- FFT-based, 2- recursive filter (Young - van Vliet, with Triggs - Sdika boundary conditions)
+
+	CGenMathConvGaussInfo()
+	{
+		pData = 0;
+		Nx = Ny = 1; PerX = 1; PerY = 0;
+		nBatch = 1; PerBatch = 0;
+		xStep = yStep = 0.; Mxx = Myy = 0.;
+		PadWithEdgeValues = 1;
+		Method = 0;
+	}
+};
+
+//*************************************************************************
+
+class CGenMathConvGauss : public CGenMathFFT {
+
+	int ConvolveLinesFFT(float* pData, long Np, long PerP, long nLines1, long PerLines1, long nLines2, long PerLines2, double Step, double M, char PadWithEdgeValues);
+	int ConvolveLinesRecursive(float* pData, long Np, long PerP, long nLines1, long PerLines1, long nLines2, long PerLines2, double SigmaInSteps, char PadWithEdgeValues);
+	int ConvolveAlongOneAxis(float* pData, long Np, long PerP, long nLines1, long PerLines1, long nLines2, long PerLines2, double Step, double M, char PadWithEdgeValues, char Method);
+
+public:
+
+	int Convolve(CGenMathConvGaussInfo&);
+};
+
+//*************************************************************************
+
+#endif
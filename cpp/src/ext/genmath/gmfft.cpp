@@ -221,6 +221,7 @@ int CGenMathFFT2D::Make2DFFT(CGenMathFFT2DInfo& FFT2DInfo)
 		//end debug
 
 	SetupLimitsTr(FFT2DInfo);
+	HowMany = (FFT2DInfo.HowMany > 1)? FFT2DInfo.HowMany : 1;
 
 	double xStepNx = FFT2DInfo.Nx*FFT2DInfo.xStep;
 	double yStepNy = FFT2DInfo.Ny*FFT2DInfo.yStep;
@@ -257,39 +258,94 @@ int CGenMathFFT2D::Make2DFFT(CGenMathFFT2DInfo& FFT2DInfo)
 		if(ArrayShiftY == 0) return MEMORY_ALLOCATION_FAILURE;
 	}
 
+	float *arMultX = new float[Nx << 1];
+	float *arMultY = new float[Ny << 1];
+	if((arMultX == 0) || (arMultY == 0))
+	{
+		if(arMultX != 0) delete[] arMultX;
+		if(arMultY != 0) delete[] arMultY;
+		if(ArrayShiftX != 0) { delete[] ArrayShiftX; ArrayShiftX = 0;}
+		if(ArrayShiftY != 0) { delete[] ArrayShiftY; ArrayShiftY = 0;}
+		return MEMORY_ALLOCATION_FAILURE;
+	}
+
 	fftwnd_plan Plan2DFFT;
+	char SymX = 0, SymY = 0;
+	long iCenX = -1, iCenY = -1;
 	FFTW_COMPLEX *DataToFFT = (FFTW_COMPLEX*)(FFT2DInfo.pData);
 
 	char t0SignMult = (FFT2DInfo.Dir > 0)? -1 : 1;
 
 	if(NeedsShiftBeforeX) FillArrayShift('x', t0SignMult*x0_Before, FFT2DInfo.xStep);
 	if(NeedsShiftBeforeY) FillArrayShift('y', t0SignMult*y0_Before, FFT2DInfo.yStep);
-	if(NeedsShiftBeforeX || NeedsShiftBeforeY) TreatShifts(DataToFFT);
+	float *pShiftX = NeedsShiftBeforeX? ArrayShiftX : 0;
+	float *pShiftY = NeedsShiftBeforeY? ArrayShiftY : 0;
 
+	//Shifts, sign repair, normalization and optional external multipliers are all applied within one pass before and one pass after the FFT;
+	//the rotation of quadrants is done within the pass next to the FFT
+	double Mult = FFT2DInfo.xStep*FFT2DInfo.yStep;
 	if(FFT2DInfo.Dir > 0)
 	{
-		Plan2DFFT = fftw2d_create_plan(Ny, Nx, FFTW_FORWARD, FFTW_IN_PLACE);
-		if(Plan2DFFT == 0) return ERROR_IN_FFT;
-		fftwnd(Plan2DFFT, 1, DataToFFT, 1, 0, DataToFFT, 1, 0);
-		RepairSignAfter2DFFT(DataToFFT);
-		RotateDataAfter2DFFT(DataToFFT);
+		if((pShiftX != 0) || (pShiftY != 0) || (FFT2DInfo.pMultBeforeX != 0) || (FFT2DInfo.pMultBeforeY != 0))
+		{
+			FillArrayMult(Nx, arMultX, pShiftX, FFT2DInfo.pMultBeforeX, 1., 0, 0);
+			FillArrayMult(Ny, arMultY, pShiftY, FFT2DInfo.pMultBeforeY, 1., 0, 0);
+			MultDataBySepFactors(DataToFFT, arMultX, arMultY);
+		}
+
+		FindSymOfDataToFFT(FFT2DInfo, DataToFFT, SymX, iCenX, SymY, iCenY);
+		if(SymX || SymY)
+		{
+			int res = Make2DFFTWithSym(DataToFFT, FFT2DInfo.Dir, SymX, iCenX, SymY, iCenY);
+			if(res) { delete[] arMultX; delete[] arMultY; return res;}
+		}
+		else
+		{
+			Plan2DFFT = fftw2d_create_plan(Ny, Nx, FFTW_FORWARD, FFTW_IN_PLACE);
+			if(Plan2DFFT == 0) { delete[] arMultX; delete[] arMultY; return ERROR_IN_FFT;}
+			fftwnd(Plan2DFFT, (int)HowMany, DataToFFT, (int)HowMany, 1, DataToFFT, (int)HowMany, 1);
+			fftwnd_destroy_plan(Plan2DFFT);
+		}
+
+		if(NeedsShiftAfterX) FillArrayShift('x', t0SignMult*x0_After, FFT2DInfo.xStepTr);
+		if(NeedsShiftAfterY) FillArrayShift('y', t0SignMult*y0_After, FFT2DInfo.yStepTr);
+		//multipliers are defined vs points after the rotation, while the sign repair is vs points before it
+		FillArrayMult(Nx, arMultX, NeedsShiftAfterX? ArrayShiftX : 0, FFT2DInfo.pMultAfterX, Mult, 1, HalfNx);
+		FillArrayMult(Ny, arMultY, NeedsShiftAfterY? ArrayShiftY : 0, FFT2DInfo.pMultAfterY, 1., 1, HalfNy);
+		SwapHalvesOfArrayMult(Nx, arMultX);
+		SwapHalvesOfArrayMult(Ny, arMultY);
+		MultDataBySepFactorsAndRotate(DataToFFT, arMultX, arMultY);
 	}
 	else
 	{
-		Plan2DFFT = fftw2d_create_plan(Ny, Nx, FFTW_BACKWARD, FFTW_IN_PLACE);
-		if(Plan2DFFT == 0) return ERROR_IN_FFT;
-		RotateDataAfter2DFFT(DataToFFT);
-		RepairSignAfter2DFFT(DataToFFT);
-		fftwnd(Plan2DFFT, 1, DataToFFT, 1, 0, DataToFFT, 1, 0);
-	}
-	double Mult = FFT2DInfo.xStep*FFT2DInfo.yStep;
-	NormalizeDataAfter2DFFT(DataToFFT, Mult);
+		//multipliers are defined vs points before the rotation, while the sign repair is vs points after it
+		FillArrayMult(Nx, arMultX, pShiftX, FFT2DInfo.pMultBeforeX, 1., 1, HalfNx);
+		FillArrayMult(Ny, arMultY, pShiftY, FFT2DInfo.pMultBeforeY, 1., 1, HalfNy);
+		MultDataBySepFactorsAndRotate(DataToFFT, arMultX, arMultY);
+
+		FindSymOfDataToFFT(FFT2DInfo, DataToFFT, SymX, iCenX, SymY, iCenY);
+		if(SymX || SymY)
+		{
+			int res = Make2DFFTWithSym(DataToFFT, FFT2DInfo.Dir, SymX, iCenX, SymY, iCenY);
+			if(res) { delete[] arMultX; delete[] arMultY; return res;}
+		}
+		else
+		{
+			Plan2DFFT = fftw2d_create_plan(Ny, Nx, FFTW_BACKWARD, FFTW_IN_PLACE);
+			if(Plan2DFFT == 0) { delete[] arMultX; delete[] arMultY; return ERROR_IN_FFT;}
+			fftwnd(Plan2DFFT, (int)HowMany, DataToFFT, (int)HowMany, 1, DataToFFT, (int)HowMany, 1);
+			fftwnd_destroy_plan(Plan2DFFT);
+		}
 
-	if(NeedsShiftAfterX) FillArrayShift('x', t0SignMult*x0_After, FFT2DInfo.xStepTr);
-	if(NeedsShiftAfterY) FillArrayShift('y', t0SignMult*y0_After, FFT2DInfo.yStepTr);
-	if(NeedsShiftAfterX || NeedsShiftAfterY) TreatShifts(DataToFFT);
+		if(NeedsShiftAfterX) FillArrayShift('x', t0SignMult*x0_After, FFT2DInfo.xStepTr);
+		if(NeedsShiftAfterY) FillArrayShift('y', t0SignMult*y0_After, FFT2DInfo.yStepTr);
+		FillArrayMult(Nx, arMultX, NeedsShiftAfterX? ArrayShiftX : 0, FFT2DInfo.pMultAfterX, Mult, 0, 0);
+		FillArrayMult(Ny, arMultY, NeedsShiftAfterY? ArrayShiftY : 0, FFT2DInfo.pMultAfterY, 1., 0, 0);
+		MultDataBySepFactors(DataToFFT, arMultX, arMultY);
+	}
 
-	fftwnd_destroy_plan(Plan2DFFT);
+	delete[] arMultX;
+	delete[] arMultY;
 
 	if(ArrayShiftX != 0) 
 	{
@@ -302,6 +358,139 @@ int CGenMathFFT2D::Make2DFFT(CGenMathFFT2DInfo& FFT2DInfo)
 	return 0;
 }
 
+//*************************************************************************
+
+long CGenMathFFT2D::FindMirrorCenInd(double Start, double Step, long N)
+{//Returns iCen (0 <= iCen < N) such that the mirror of the point i vs the coordinate 0 of the mesh is (iCen - i) mod N,
+ //or -1 if the coordinate 0 is neither at a mesh point nor in the middle between two points
+	if((Step == 0.) || (N <= 0)) return -1;
+	double dCen = -2.*Start/Step;
+	long iCen = (long)((dCen >= 0.)? (dCen + 0.5) : (dCen - 0.5));
+	if(::fabs(dCen - iCen) > 1.E-03) return -1;
+	return ((iCen%N) + N)%N;
+}
+
+//*************************************************************************
+
+char CGenMathFFT2D::FindMirrorSym(FFTW_COMPLEX* pData, long nx, long ny, long howMany, char x_or_y, long iCen)
+{//Checks if the data (howMany sets interleaved point by point) satisfy f[i] = s*f[(iCen - i) mod n] vs x or y;
+ //returns s = 1 or -1, or 0 if the relative r.m.s. deviation from both is above the tolerance
+	const double RelTolE2 = 1.E-10;
+	if(iCen < 0) return 0;
+
+	long PerX = howMany, PerY = nx*howMany;
+	double SumE2 = 0., SumDifE2 = 0., SumSumE2 = 0.;
+#ifdef _OPENMP
+	#pragma omp parallel for reduction(+:SumE2,SumDifE2,SumSumE2)
+#endif
+	for(long iy=0; iy<ny; iy++)
+	{
+		long iyM = (x_or_y == 'y')? (iCen - iy + ny)%ny : iy;
+		FFTW_COMPLEX *t = pData + iy*PerY, *tRowM = pData + iyM*PerY;
+		for(long ix=0; ix<nx; ix++)
+		{
+			long ixM = (x_or_y == 'x')? (iCen - ix + nx)%nx : ix;
+			FFTW_COMPLEX *tM = tRowM + ixM*PerX;
+			for(long k=0; k<howMany; k++)
+			{
+				double Re = t->re, Im = t->im, ReM = tM->re, ImM = tM->im;
+				SumE2 += Re*Re + Im*Im;
+				SumDifE2 += (Re - ReM)*(Re - ReM) + (Im - ImM)*(Im - ImM);
+				SumSumE2 += (Re + ReM)*(Re + ReM) + (Im + ImM)*(Im + ImM);
+				t++; tM++;
+			}
+		}
+	}
+	double TolE2 = RelTolE2*SumE2;
+	if(SumDifE2 <= TolE2) return 1;
+	if(SumSumE2 <= TolE2) return -1;
+	return 0;
+}
+
+//*************************************************************************
+
+int CGenMathFFT2D::Make2DFFTWithSym(FFTW_COMPLEX* pData, char Dir, char SymX, long iCenX, char SymY, long iCenY)
+{//In-place 2D FFT, done by 1D FFTs along x (rows) and then along y (columns), of data with mirror symmetry
+ //f[ix,iy] = SymX*f[(iCenX - ix) mod Nx,iy] and/or f[ix,iy] = SymY*f[ix,(iCenY - iy) mod Ny] (SymX, SymY = 1, -1 or 0- no symmetry):
+ //rows related by the symmetry vs y are not transformed but copied, and so are the columns related by the symmetry vs x,
+ //using F[N - k] = s*exp(i*Dir*2*Pi*iCen*k/N)*F[k] for the FFT along x
+	fftw_direction DirFFTW = (Dir > 0)? FFTW_FORWARD : FFTW_BACKWARD;
+	fftw_plan PlanX = fftw_create_plan(Nx, DirFFTW, FFTW_ESTIMATE | FFTW_IN_PLACE);
+	if(PlanX == 0) return ERROR_IN_FFT;
+	fftw_plan PlanY = fftw_create_plan(Ny, DirFFTW, FFTW_ESTIMATE | FFTW_IN_PLACE);
+	if(PlanY == 0) { fftw_destroy_plan(PlanX); return ERROR_IN_FFT;}
+
+	long PerY = Nx*HowMany;
+
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
+	for(long iy=0; iy<Ny; iy++)
+	{
+		if(SymY && ((iCenY - iy + Ny)%Ny < iy)) continue;
+		fftw(PlanX, (int)HowMany, pData + iy*PerY, (int)HowMany, 1, 0, 1, 1);
+	}
+	if(SymY)
+	{
+		float s = (float)SymY;
+#ifdef _OPENMP
+		#pragma omp parallel for
+#endif
+		for(long iy=0; iy<Ny; iy++)
+		{
+			long iyM = (iCenY - iy + Ny)%Ny;
+			if(iyM >= iy) continue;
+			FFTW_COMPLEX *t = pData + iy*PerY, *tM = pData + iyM*PerY;
+			for(long i=0; i<PerY; i++) { t->re = s*tM->re; (t++)->im = s*((tM++)->im);}
+		}
+	}
+
+	long nxFFT = SymX? (HalfNx + 1) : Nx;
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
+	for(long ix=0; ix<nxFFT; ix++)
+	{
+		fftw(PlanY, (int)HowMany, pData + ix*HowMany, (int)PerY, 1, 0, 1, 1);
+	}
+	if(SymX)
+	{//multipliers for columns kx = HalfNx + 1,..., Nx - 1, obtained from columns Nx - kx
+		long nxM = Nx - HalfNx - 1;
+		float *arMult = new float[(nxM << 1) + 2];
+		if(arMult == 0) { fftw_destroy_plan(PlanX); fftw_destroy_plan(PlanY); return MEMORY_ALLOCATION_FAILURE;}
+		float *tMult = arMult;
+		for(long kx=HalfNx+1; kx<Nx; kx++)
+		{
+			float Cos = 1., Sin = 0.;
+			if(iCenX != 0) CosAndSin(Dir*TwoPI*((iCenX*(Nx - kx))%Nx)/Nx, Cos, Sin);
+			*(tMult++) = SymX*Cos; *(tMult++) = SymX*Sin;
+		}
+#ifdef _OPENMP
+		#pragma omp parallel for
+#endif
+		for(long iy=0; iy<Ny; iy++)
+		{
+			FFTW_COMPLEX *tRow = pData + iy*PerY;
+			float *tMult = arMult;
+			for(long kx=HalfNx+1; kx<Nx; kx++)
+			{
+				float MultRe = *(tMult++), MultIm = *(tMult++);
+				FFTW_COMPLEX *t = tRow + kx*HowMany, *tM = tRow + (Nx - kx)*HowMany;
+				for(long k=0; k<HowMany; k++)
+				{
+					float Re = tM->re, Im = (tM++)->im;
+					t->re = MultRe*Re - MultIm*Im; (t++)->im = MultRe*Im + MultIm*Re;
+				}
+			}
+		}
+		delete[] arMult;
+	}
+
+	fftw_destroy_plan(PlanX);
+	fftw_destroy_plan(PlanY);
+	return 0;
+}
+
 //*************************************************************************
 //Forward FFT: Int f(x)*exp(-i*2*Pi*qx*x)dx
 //Backward FFT: Int f(qx)*exp(i*2*Pi*qx*x)dqx
@@ -333,54 +522,53 @@ int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo)
 		if(m_ArrayShiftX == 0) return MEMORY_ALLOCATION_FAILURE;
 	}
 
-	fftw_plan Plan1DFFT;
 	FFTW_COMPLEX *DataToFFT = (FFTW_COMPLEX*)(FFT1DInfo.pInData);
 	FFTW_COMPLEX *OutDataFFT = (FFTW_COMPLEX*)(FFT1DInfo.pOutData);
-
 	char t0SignMult = (FFT1DInfo.Dir > 0)? -1 : 1;
-	if(NeedsShiftBeforeX) 
-	{
-		FillArrayShift(t0SignMult*x0_Before, FFT1DInfo.xStep);
-		TreatShift(DataToFFT, FFT1DInfo.HowMany);
-	}
-
-	if(FFT1DInfo.Dir > 0)
-	{
-		int flags = FFTW_ESTIMATE;
-		if(DataToFFT == OutDataFFT)
-		{
-			flags |= FFTW_IN_PLACE;
-		}
-		Plan1DFFT = fftw_create_plan(Nx, FFTW_FORWARD, flags);
-		if(Plan1DFFT == 0) return ERROR_IN_FFT;
 
-		fftw(Plan1DFFT, FFT1DInfo.HowMany, DataToFFT, 1, Nx, OutDataFFT, 1, Nx);
-		RepairSignAfter1DFFT(OutDataFFT, FFT1DInfo.HowMany);
-		RotateDataAfter1DFFT(OutDataFFT, FFT1DInfo.HowMany);
-	}
-	else
+	//Shifts, sign repair, rotation of halves and normalization are combined into multipliers vs points of one line,
+	//applied within one pass before and one pass after the FFT
+	long TwoNx = Nx << 1;
+	char RotBefore = (FFT1DInfo.Dir < 0)? 2 : 0, RotAfter = (FFT1DInfo.Dir > 0)? 1 : 0;
+	float *arMultBefore = 0, *arMultAfter = new float[TwoNx << 1];
+	if(arMultAfter == 0) { DeleteArrayShift(); return MEMORY_ALLOCATION_FAILURE;}
+	if(NeedsShiftBeforeX || RotBefore)
 	{
-		int flags = FFTW_ESTIMATE;
-		if(DataToFFT == OutDataFFT)
-		{
-			flags |= FFTW_IN_PLACE;
-		}
-		Plan1DFFT = fftw_create_plan(Nx, FFTW_BACKWARD, flags);
-		if(Plan1DFFT == 0) return ERROR_IN_FFT;
-
-		RotateDataAfter1DFFT(DataToFFT, FFT1DInfo.HowMany);
-		RepairSignAfter1DFFT(DataToFFT, FFT1DInfo.HowMany);
-		fftw(Plan1DFFT, FFT1DInfo.HowMany, DataToFFT, 1, Nx, OutDataFFT, 1, Nx);
+		arMultBefore = arMultAfter + TwoNx;
+		if(NeedsShiftBeforeX) FillArrayShift(t0SignMult*x0_Before, FFT1DInfo.xStep);
+		FillArrayMult1D(arMultBefore, NeedsShiftBeforeX? m_ArrayShiftX : 0, 1., RotBefore);
 	}
-	//double Mult = FFT1DInfo.xStep;
-	double Mult = FFT1DInfo.xStep*FFT1DInfo.MultExtra;
-	NormalizeDataAfter1DFFT(OutDataFFT, FFT1DInfo.HowMany, Mult);
-
-	if(NeedsShiftAfterX)
+	if(NeedsShiftAfterX) FillArrayShift(t0SignMult*x0_After, FFT1DInfo.xStepTr);
+	FillArrayMult1D(arMultAfter, NeedsShiftAfterX? m_ArrayShiftX : 0, FFT1DInfo.xStep*FFT1DInfo.MultExtra, RotAfter);
+
+	int flags = FFTW_ESTIMATE;
+	if(DataToFFT == OutDataFFT) flags |= FFTW_IN_PLACE;
+	fftw_plan Plan1DFFT = fftw_create_plan(Nx, (FFT1DInfo.Dir > 0)? FFTW_FORWARD : FFTW_BACKWARD, flags);
+	if(Plan1DFFT == 0) { delete[] arMultAfter; DeleteArrayShift(); return ERROR_IN_FFT;}
+
+	//Lines are processed by tiles fitting in cache; the tiles are independent and may be processed by different threads
+	const long MaxTileSizeCompl = 32768;
+	long nLinesPerTile = MaxTileSizeCompl/Nx;
+	if(nLinesPerTile < 1) nLinesPerTile = 1;
+	long nTiles = (FFT1DInfo.HowMany + nLinesPerTile - 1)/nLinesPerTile;
+
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
+	for(long iTile=0; iTile<nTiles; iTile++)
 	{
-		FillArrayShift(t0SignMult*x0_After, FFT1DInfo.xStepTr);
-		TreatShift(OutDataFFT, FFT1DInfo.HowMany);
+		long iLineSt = iTile*nLinesPerTile;
+		long nLinesTile = FFT1DInfo.HowMany - iLineSt;
+		if(nLinesTile > nLinesPerTile) nLinesTile = nLinesPerTile;
+		FFTW_COMPLEX *pInTile = DataToFFT + iLineSt*Nx, *pOutTile = OutDataFFT + iLineSt*Nx;
+
+		if(arMultBefore != 0) MultLinesByArrayMult1D(pInTile, nLinesTile, arMultBefore, RotBefore);
+		//in the in-place mode, FFTW uses the output pointer (if not 0) as work array
+		if(pOutTile == pInTile) fftw(Plan1DFFT, (int)nLinesTile, pInTile, 1, (int)Nx, 0, 1, (int)Nx);
+		else fftw(Plan1DFFT, (int)nLinesTile, pInTile, 1, (int)Nx, pOutTile, 1, (int)Nx);
+		MultLinesByArrayMult1D(pOutTile, nLinesTile, arMultAfter, RotAfter);
 	}
+	delete[] arMultAfter;
 
 	if(FFT1DInfo.TreatSharpEdges)
 	{
@@ -389,10 +577,69 @@ int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo)
 	}
 
 	fftw_destroy_plan(Plan1DFFT);
-	if(m_ArrayShiftX != 0) 
-	{
-		delete[] m_ArrayShiftX; m_ArrayShiftX = 0;
+	DeleteArrayShift();
+	return 0;
+}
+
+//*************************************************************************
+
+int CGenMathFFT1D::Make1DFFT_RealToCompl(CGenMathFFT1DInfo& FFT1DInfo)
+{//FFT of real data (Nx points, Nx even), done via complex FFT of Nx/2 points built from even and odd samples.
+ //Only the non-negative half of the spectrum is output: Nx/2 + 1 complex values at k*xStepTr, k = 0,...,Nx/2
+ //(the other half follows from the Hermitian symmetry); pOutData should hold HowMany*(Nx + 2) floats.
+ //Other conventions (direction, normalization, shift after) are the same as in Make1DFFT.
+	const double RelShiftTol = 1.E-06;
+
+	if(FFT1DInfo.UseGivenStartTrValue || FFT1DInfo.TreatSharpEdges || (FFT1DInfo.pInData == FFT1DInfo.pOutData)) return ERROR_IN_FFT;
+	SetupLimitsTr(FFT1DInfo);
+	long M = HalfNx, HalfM = M >> 1;
+
+	double xStepNx = FFT1DInfo.Nx*FFT1DInfo.xStep;
+	double x0_After = FFT1DInfo.xStart + 0.5*xStepNx;
+	char NeedsShift = FFT1DInfo.ApplyAutoShiftAfter && (::fabs(x0_After) > RelShiftTol*xStepNx);
+	char t0SignMult = (FFT1DInfo.Dir > 0)? -1 : 1;
+	int Sign = (FFT1DInfo.Dir > 0)? FFTW_FORWARD : FFTW_BACKWARD;
+
+	double *arW = new double[(M + 1) << 2];
+	if(arW == 0) return MEMORY_ALLOCATION_FAILURE;
+	double *arF = arW + ((M + 1) << 1);
+	double PhaseStep = NeedsShift? TwoPI*t0SignMult*x0_After*FFT1DInfo.xStepTr : 0.;
+	SetupAuxArraysForRealFFT(M, Sign, FFT1DInfo.xStep*FFT1DInfo.MultExtra, PhaseStep, arW, arF);
+
+	fftw_plan Plan1DFFT = fftw_create_plan(M, (fftw_direction)Sign, FFTW_ESTIMATE);
+	if(Plan1DFFT == 0) { delete[] arW; return ERROR_IN_FFT;}
+	fftw(Plan1DFFT, FFT1DInfo.HowMany, (FFTW_COMPLEX*)(FFT1DInfo.pInData), 1, M, (FFTW_COMPLEX*)(FFT1DInfo.pOutData), 1, M + 1);
+
+	for(long iLine=0; iLine<FFT1DInfo.HowMany; iLine++)
+	{//Z[k] = Fe[k] + i*Fo[k] => X[k] = Fe[k] + W^k*Fo[k], X[M-k] = conj(Fe[k] - W^k*Fo[k])
+		FFTW_COMPLEX *Z = (FFTW_COMPLEX*)(FFT1DInfo.pOutData) + iLine*(M + 1);
+
+		double Fe = Z[0].re, Fo = Z[0].im;
+		Z[0].re = (FFTW_REAL)((Fe + Fo)*arF[0]); Z[0].im = (FFTW_REAL)((Fe + Fo)*arF[1]);
+		long TwoM = M << 1;
+		Z[M].re = (FFTW_REAL)((Fe - Fo)*arF[TwoM]); Z[M].im = (FFTW_REAL)((Fe - Fo)*arF[TwoM + 1]);
+
+		for(long k=1; k<=HalfM; k++)
+		{
+			long kk = M - k, k2 = k << 1, kk2 = kk << 1;
+			double zRe = Z[k].re, zIm = Z[k].im, cRe = Z[kk].re, cIm = -Z[kk].im;
+			double FeRe = 0.5*(zRe + cRe), FeIm = 0.5*(zIm + cIm);
+			double FoRe = 0.5*(zIm - cIm), FoIm = -0.5*(zRe - cRe);
+			double wRe = arW[k2], wIm = arW[k2 + 1];
+			double TRe = wRe*FoRe - wIm*FoIm, TIm = wRe*FoIm + wIm*FoRe;
+
+			double xRe = FeRe + TRe, xIm = FeIm + TIm;
+			Z[k].re = (FFTW_REAL)(xRe*arF[k2] - xIm*arF[k2 + 1]); Z[k].im = (FFTW_REAL)(xRe*arF[k2 + 1] + xIm*arF[k2]);
+			if(kk != k)
+			{
+				xRe = FeRe - TRe; xIm = TIm - FeIm;
+				Z[kk].re = (FFTW_REAL)(xRe*arF[kk2] - xIm*arF[kk2 + 1]); Z[kk].im = (FFTW_REAL)(xRe*arF[kk2 + 1] + xIm*arF[kk2]);
+			}
+		}
 	}
+
+	fftw_destroy_plan(Plan1DFFT);
+	delete[] arW;
 	return 0;
 }
 
@@ -99,7 +99,26 @@ struct CGenMathFFT2DInfo {
 	long Nx, Ny;
 	char UseGivenStartTrValues;
 
-	CGenMathFFT2DInfo() { UseGivenStartTrValues = 0;}
+	//Number of 2D data sets interleaved point by point (e.g. photon energy slices of a wavefront, with energy being the fastest index):
+	//data sets are adjacent in memory, the stride between mesh points being HowMany complex values; all sets are transformed by one plan
+	long HowMany;
+
+	//Optional separable complex multipliers (Re, Im pairs; Nx values for x, Ny values for y) applied to the data
+	//before the FFT (vs points of the input mesh) and after it (vs points of the output mesh);
+	//they are applied within the passes required by the FFT itself, so that e.g. phase corrections do not require extra passes over the data.
+	float *pMultBeforeX, *pMultBeforeY, *pMultAfterX, *pMultAfterY;
+
+	//1- data are expected to be mirror-symmetric (even or odd) vs x = 0 / y = 0 of the input mesh; the symmetry is checked on the actual FFT input,
+	//and if it is confirmed, only a half of the 1D FFTs along the other coordinate is done, the rest being obtained from the symmetry (see Make2DFFT)
+	char SymX, SymY;
+
+	CGenMathFFT2DInfo() 
+	{ 
+		UseGivenStartTrValues = 0;
+		HowMany = 1;
+		pMultBeforeX = pMultBeforeY = pMultAfterX = pMultAfterY = 0;
+		SymX = SymY = 0;
+	}
 };
 
 //*************************************************************************
@@ -108,6 +127,7 @@ class CGenMathFFT2D : public CGenMathFFT {
 
 	long Nx, Ny;
 	long HalfNx, HalfNy;
+	long HowMany;
 	char NeedsShiftBeforeX, NeedsShiftBeforeY, NeedsShiftAfterX, NeedsShiftAfterY;
 	float *ArrayShiftX, *ArrayShiftY;
 
@@ -115,11 +135,30 @@ public:
 	CGenMathFFT2D()
 	{
 		NeedsShiftBeforeX = NeedsShiftBeforeY = NeedsShiftAfterX = NeedsShiftAfterY = 0;
+		HowMany = 1;
 	}
 
 	int Make2DFFT(CGenMathFFT2DInfo&);
 	int AuxDebug_TestFFT_Plans();
 
+	int Make2DFFTWithSym(FFTW_COMPLEX* pData, char Dir, char SymX, long iCenX, char SymY, long iCenY);
+	void FindSymOfDataToFFT(CGenMathFFT2DInfo& FFT2DInfo, FFTW_COMPLEX* pData, char& SymX, long& iCenX, char& SymY, long& iCenY)
+	{//The symmetry is checked on the actual FFT input (after the pass before the FFT); the rotation of halves before the backward FFT does not change iCen (mod N) for even N
+		if((FFT2DInfo.Dir < 0) && ((Nx & 1) || (Ny & 1))) return;
+		if(FFT2DInfo.SymX)
+		{
+			iCenX = FindMirrorCenInd(FFT2DInfo.xStart, FFT2DInfo.xStep, Nx);
+			SymX = FindMirrorSym(pData, Nx, Ny, HowMany, 'x', iCenX);
+		}
+		if(FFT2DInfo.SymY)
+		{
+			iCenY = FindMirrorCenInd(FFT2DInfo.yStart, FFT2DInfo.yStep, Ny);
+			SymY = FindMirrorSym(pData, Nx, Ny, HowMany, 'y', iCenY);
+		}
+	}
+	static char FindMirrorSym(FFTW_COMPLEX* pData, long nx, long ny, long howMany, char x_or_y, long iCen);
+	static long FindMirrorCenInd(double Start, double Step, long N);
+
 	void SetupLimitsTr(CGenMathFFT2DInfo& FFT2DInfo)
 	{// Modify this if Make2DFFT is modified !
 		Nx = FFT2DInfo.Nx; Ny = FFT2DInfo.Ny; 
@@ -161,6 +200,99 @@ public:
 		CosAndSin(-q*t0TwoPI, *tm, *(tm+1));
 	}
 
+	void FillArrayMult(long N, float* pMult, float* pShift, float* pMultExtra, double Mult, char SignAlternates, long iSignSt)
+	{//Multiplier vs one coordinate: Mult*(Shift)*(MultExtra)*(-1)^(i + iSignSt); pShift, pMultExtra may be 0
+		float *t = pMult, *tShift = pShift, *tExtra = pMultExtra;
+		float s = ((SignAlternates != 0) && ((iSignSt & 1) != 0))? -1.f : 1.f;
+		for(long i=0; i<N; i++)
+		{
+			float re = (float)Mult, im = 0.;
+			if(tShift != 0) 
+			{ 
+				re = (float)(Mult*(*tShift)); im = (float)(Mult*(*(tShift+1))); tShift += 2;
+			}
+			if(tExtra != 0)
+			{
+				float reE = *(tExtra++), imE = *(tExtra++);
+				float reN = re*reE - im*imE;
+				im = re*imE + im*reE; re = reN;
+			}
+			*(t++) = s*re; *(t++) = s*im;
+			if(SignAlternates) s = -s;
+		}
+	}
+
+	void SwapHalvesOfArrayMult(long N, float* pMult)
+	{// Assumes N even !
+		long HalfN = N >> 1;
+		float *t1 = pMult, *t2 = pMult + (HalfN << 1);
+		for(long i=0; i<(HalfN << 1); i++)
+		{
+			float Buf = *t1; *(t1++) = *t2; *(t2++) = Buf;
+		}
+	}
+
+	void MultDataBySepFactors(FFTW_COMPLEX* pData, float* pMultX, float* pMultY)
+	{//The same factor is applied to all HowMany interleaved data sets at a mesh point
+		FFTW_COMPLEX *t = pData;
+		float *tMultY = pMultY;
+		for(long iy=0; iy<Ny; iy++)
+		{
+			float MultY_Re = *(tMultY++), MultY_Im = *(tMultY++);
+			float *tMultX = pMultX;
+			for(long ix=0; ix<Nx; ix++)
+			{
+				float MultX_Re = *(tMultX++), MultX_Im = *(tMultX++);
+				float MultRe = MultX_Re*MultY_Re - MultX_Im*MultY_Im;
+				float MultIm = MultX_Re*MultY_Im + MultX_Im*MultY_Re;
+				for(long k=0; k<HowMany; k++)
+				{
+					float NewRe = t->re*MultRe - t->im*MultIm;
+					t->im = t->re*MultIm + t->im*MultRe;
+					(t++)->re = NewRe;
+				}
+			}
+		}
+	}
+
+	void MultDataBySepFactorsAndRotate(FFTW_COMPLEX* pData, float* pMultX, float* pMultY)
+	{// Assumes Nx, Ny even ! Same as multiplication by separable factors (defined vs points before rotation) followed by RotateDataAfter2DFFT, in one pass.
+		long HalfNyNx = HalfNy*Nx, HalfNxHowMany = HalfNx*HowMany;
+		FFTW_COMPLEX *t1 = pData, *t2 = pData + (HalfNyNx + HalfNx)*HowMany;
+	    FFTW_COMPLEX *t3 = pData + HalfNxHowMany, *t4 = pData + HalfNyNx*HowMany;
+		float *tMultY1 = pMultY, *tMultY2 = pMultY + (HalfNy << 1);
+		for(long jj=0; jj<HalfNy; jj++)
+		{
+			float MultY1_Re = *(tMultY1++), MultY1_Im = *(tMultY1++);
+			float MultY2_Re = *(tMultY2++), MultY2_Im = *(tMultY2++);
+			float *tMultX1 = pMultX, *tMultX2 = pMultX + (HalfNx << 1);
+			for(long ii=0; ii<HalfNx; ii++)
+			{
+				float MultX1_Re = *(tMultX1++), MultX1_Im = *(tMultX1++);
+				float MultX2_Re = *(tMultX2++), MultX2_Im = *(tMultX2++);
+
+				float M1Re = MultX1_Re*MultY1_Re - MultX1_Im*MultY1_Im, M1Im = MultX1_Re*MultY1_Im + MultX1_Im*MultY1_Re; //at t1
+				float M2Re = MultX2_Re*MultY2_Re - MultX2_Im*MultY2_Im, M2Im = MultX2_Re*MultY2_Im + MultX2_Im*MultY2_Re; //at t2
+				float M3Re = MultX2_Re*MultY1_Re - MultX2_Im*MultY1_Im, M3Im = MultX2_Re*MultY1_Im + MultX2_Im*MultY1_Re; //at t3
+				float M4Re = MultX1_Re*MultY2_Re - MultX1_Im*MultY2_Im, M4Im = MultX1_Re*MultY2_Im + MultX1_Im*MultY2_Re; //at t4
+
+				for(long k=0; k<HowMany; k++)
+				{
+					float V1Re = t1->re*M1Re - t1->im*M1Im, V1Im = t1->re*M1Im + t1->im*M1Re;
+					float V2Re = t2->re*M2Re - t2->im*M2Im, V2Im = t2->re*M2Im + t2->im*M2Re;
+					t1->re = V2Re; (t1++)->im = V2Im;
+					t2->re = V1Re; (t2++)->im = V1Im;
+
+					float V3Re = t3->re*M3Re - t3->im*M3Im, V3Im = t3->re*M3Im + t3->im*M3Re;
+					float V4Re = t4->re*M4Re - t4->im*M4Im, V4Im = t4->re*M4Im + t4->im*M4Re;
+					t3->re = V4Re; (t3++)->im = V4Im;
+					t4->re = V3Re; (t4++)->im = V3Im;
+				}
+			}
+			t1 += HalfNxHowMany; t2 += HalfNxHowMany; t3 += HalfNxHowMany; t4 += HalfNxHowMany;
+		}
+	}
+
 	void RotateDataAfter2DFFT(FFTW_COMPLEX* pAfterFFT)
 	{// Assumes Nx, Ny even !
 		long HalfNyNx = HalfNy*Nx;
@@ -321,6 +453,7 @@ public:
 
 	int Make1DFFT(CGenMathFFT1DInfo&);
 	int Make1DFFT_InPlace(CGenMathFFT1DInfo& FFT1DInfo);
+	int Make1DFFT_RealToCompl(CGenMathFFT1DInfo&);
 
 	void SetupLimitsTr(CGenMathFFT1DInfo& FFT1DInfo)
 	{ // Modify this if Make1DFFT is modified !
@@ -358,6 +491,61 @@ public:
 		CosAndSin(-q*t0TwoPI, *tm, *(tm+1));
 	}
 
+	void DeleteArrayShift()
+	{
+		if(m_ArrayShiftX != 0) { delete[] m_ArrayShiftX; m_ArrayShiftX = 0;}
+	}
+
+	void FillArrayMult1D(float* pMult, float* pShift, double Mult, char RotType)
+	{//Multipliers vs points of one line after the (optional) swapping of its halves: Mult*(Shift)*(-1)^i;
+	 //RotType: 0- no swapping and no sign repair, 1- swapping after FFT (shift is defined vs points after the swapping, sign vs points before it),
+	 //2- swapping before FFT (shift is defined vs points before the swapping, sign vs points after it)
+		float *t = pMult;
+		for(long j=0; j<Nx; j++)
+		{
+			long jIn = (j < HalfNx)? (j + HalfNx) : (j - HalfNx);
+			long jShift = (RotType == 2)? jIn : j;
+			long jSign = (RotType == 1)? jIn : j;
+			float re = (float)Mult, im = 0.;
+			if(pShift != 0)
+			{
+				re = (float)(Mult*pShift[jShift << 1]); im = (float)(Mult*pShift[(jShift << 1) + 1]);
+			}
+			if((RotType != 0) && ((jSign & 1) != 0)) { re = -re; im = -im;}
+			*(t++) = re; *(t++) = im;
+		}
+	}
+
+	void MultLinesByArrayMult1D(FFTW_COMPLEX* pData, long nLines, float* pMult, char Rotate)
+	{// Assumes Nx even ! Multiplication of nLines adjacent lines by factors defined vs points after the (optional) swapping of halves of each line
+		for(long iLine=0; iLine<nLines; iLine++)
+		{
+			FFTW_COMPLEX *t1 = pData + iLine*Nx;
+			if(Rotate)
+			{
+				FFTW_COMPLEX *t2 = t1 + HalfNx;
+				float *tM1 = pMult, *tM2 = pMult + (HalfNx << 1);
+				for(long i=0; i<HalfNx; i++)
+				{
+					float M1Re = *(tM1++), M1Im = *(tM1++), M2Re = *(tM2++), M2Im = *(tM2++);
+					float V1Re = t1->re, V1Im = t1->im, V2Re = t2->re, V2Im = t2->im;
+					t1->re = V2Re*M1Re - V2Im*M1Im; (t1++)->im = V2Re*M1Im + V2Im*M1Re;
+					t2->re = V1Re*M2Re - V1Im*M2Im; (t2++)->im = V1Re*M2Im + V1Im*M2Re;
+				}
+			}
+			else
+			{
+				float *tM = pMult;
+				for(long i=0; i<Nx; i++)
+				{
+					float MRe = *(tM++), MIm = *(tM++);
+					float VRe = t1->re, VIm = t1->im;
+					t1->re = VRe*MRe - VIm*MIm; (t1++)->im = VRe*MIm + VIm*MRe;
+				}
+			}
+		}
+	}
+
 	void TreatShift(FFTW_COMPLEX* pData, long HowMany)
 	{
 		char NeedsShiftX = NeedsShiftBeforeX || NeedsShiftAfterX;
@@ -430,6 +618,18 @@ public:
 		}
 	}
 
+	void SetupAuxArraysForRealFFT(long M, int Sign, double Mult, double PhaseStep, double* arW, double* arF)
+	{//W^k = exp(Sign*i*Pi*k/M), and factors (-1)^k*Mult*exp(i*k*PhaseStep) restoring the centred mesh convention, k = 0,...,M
+		double PiDivM = PI/M;
+		for(long k=0; k<=M; k++)
+		{
+			double Ang = Sign*k*PiDivM;
+			*(arW++) = cos(Ang); *(arW++) = sin(Ang);
+			double Ph = k*PhaseStep, s = (k & 1)? -Mult : Mult;
+			*(arF++) = s*cos(Ph); *(arF++) = s*sin(Ph);
+		}
+	}
+
 	int SetupAuxDataForSharpEdgeCorr(CGenMathFFT1DInfo&, CGenMathAuxDataForSharpEdgeCorr1D&);
 	void MakeSharpEdgeCorr(CGenMathFFT1DInfo&, CGenMathAuxDataForSharpEdgeCorr1D&);
 
@@ -39,6 +39,8 @@ template<class T> class CGenMathIntRungeKutta {
 	double *m_y_ap, *m_dydx_ap;
 	double *m_xp_ap, **m_yp_ap, m_dxsav_ap; 
 	int m_count_ap, m_kmax_ap;
+	double *m_k_dp, *m_y_dp, *m_r_dp, m_MaxStep_dp; //Dormand-Prince stages, aux. vector and dense output coefficients
+	bool m_DenseOut;
 
 	T* m_PtrT;
 	void (T::*m_pFuncDerivF)(double in_x, double* in_F, double* out_dFdx);  
@@ -61,6 +63,9 @@ public:
 		m_PrecArr = 0;
 		m_dysav_rks5 = m_ysav_rks5 = m_ytemp_rks5 = 0;
 		m_y_ap = m_dydx_ap = 0;
+		m_k_dp = m_y_dp = m_r_dp = 0;
+		m_MaxStep_dp = 0.;
+		m_DenseOut = false;
 		if(onPrc)
 		{
             m_PrecArr = new double[amOfEq];
@@ -100,12 +105,27 @@ public:
 			if(m_y_ap != 0) delete[] m_y_ap;
 			if(m_dydx_ap != 0) delete[] m_dydx_ap;
 		}
+		if(m_k_dp != 0) delete[] m_k_dp;
+		if(m_y_dp != 0) delete[] m_y_dp;
+		if(m_r_dp != 0) delete[] m_r_dp;
+	}
+
+	void setDenseOutput(double maxStep =0.)
+	{//switches solve() to the adaptive Dormand-Prince 5(4) method with dense output (requires onPrc)
+		if(!m_OnPrc) return;
+		m_DenseOut = true;
+		m_MaxStep_dp = fabs(maxStep);
+		if(m_k_dp == 0) m_k_dp = new double[7*m_AmOfEq];
+		if(m_y_dp == 0) m_y_dp = new double[m_AmOfEq];
+		if(m_r_dp == 0) m_r_dp = new double[5*m_AmOfEq];
 	}
 
 	void solve(double* initCond, double xmin, double xmax, int np, double* res);
 	void stepRungeKutta4(double* y, double* dydx, double x, double h);
 	void stepRungeKutta5(double* y, double* dydx, double* x, double htry, double* hdid, double* hnext);
 	void autoPropagate(double* ystart, double x1, double x2, double h1, double hmin, int* nok, int* nbad);
+	void solveDormandPrince(double* initCond, double xmin, double xmax, int np, double* resArr);
+	double stepDormandPrince(double* y, double x, double h);
 
 
 	//static bool VectCheckIfCollinear(double xV1, double yV1, double zV1, double xV2, double yV2, double zV2, double RelPrec);
@@ -126,6 +146,8 @@ public:
 //-------------------------------------------------------------------------
 template <class T> void CGenMathIntRungeKutta<T>::solve(double* initCond, double xmin, double xmax, int np, double* resArr)
 {
+	if(m_DenseOut) { solveDormandPrince(initCond, xmin, xmax, np, resArr); return;}
+
 	double step_x = (xmax - xmin)/double(np - 1);
 	double x = xmin;
 
@@ -302,6 +324,7 @@ template <class T> void CGenMathIntRungeKutta<T>::autoPropagate(double* ystart,
                 m_xp_ap[++m_count_ap] = x;
 				for(i=0; i<m_AmOfEq; i++) m_yp_ap[i][m_count_ap] = m_y_ap[i];
 			}
+			return; //end of interval reached
 		}
 		if(fabs(hnext) <= hmin) throw GM_RK_STEP_SIZE_TOO_SMALL;
 		//if(fabs(hnext) <= hmin) { Send.ErrorMessage("Radia::Error200"); return 0;}
@@ -312,7 +335,140 @@ template <class T> void CGenMathIntRungeKutta<T>::autoPropagate(double* ystart,
 }
 
 //-------------------------------------------------------------------------
+// Adaptive integration by the embedded Runge-Kutta method of Dormand and Prince
+// (5th order solution, 4th order error estimate, "first same as last"),
+// E. Hairer, S.P. Norsett, G. Wanner, "Solving Ordinary Differential Equations I", Sec. II.5-6.
+// The step is not bound to the output mesh: it grows in regions of smooth solution
+// (up to m_MaxStep_dp, if defined) and shrinks where the error estimate requires;
+// the results at the mesh points are obtained by the 4th order continuous extension.
+// Arguments and resulting array are the same as in solve().
+//-------------------------------------------------------------------------
+template <class T> void CGenMathIntRungeKutta<T>::solveDormandPrince(double* initCond, double xmin, double xmax, int np, double* resArr)
+{
+	const double SAFETY = 0.9;
+	const double MIN_SCALE = 0.2, MAX_SCALE = 5.;
+	const double ERRCON = 1.889568E-04; //(MAX_SCALE/SAFETY)^(-5)
 
-#endif
+	int amOfEq_p_1 = m_AmOfEq + 1;
+	double *t_res = resArr;
+	*(t_res++) = xmin;
+	int k;
+	for(k=0; k<m_AmOfEq; k++) { m_Y[k] = initCond[k]; *(t_res++) = initCond[k];}
+	if(np <= 1) return;
+
+	double step_x = (xmax - xmin)/double(np - 1);
+	double dir = (xmax >= xmin)? 1. : -1.;
+	double minStepAllowed = (1.E-12)*fabs(step_x);
+	double maxStep = fabs(xmax - xmin);
+	if((m_MaxStep_dp > 0.) && (m_MaxStep_dp < maxStep)) maxStep = m_MaxStep_dp;
+	double maxNumSteps = double(m_MaxAutoStp)*double(np - 1); //same limit per mesh interval as in autoPropagate
+
+	double *k1 = m_k_dp, *k7 = m_k_dp + 6*m_AmOfEq;
+	double *r1 = m_r_dp, *r2 = r1 + m_AmOfEq, *r3 = r2 + m_AmOfEq, *r4 = r3 + m_AmOfEq, *r5 = r4 + m_AmOfEq;
+	const double d1 = -12715105075./11282082432., d3 = 87487479700./32700410799., d4 = -10690763975./1880347072.;
+	const double d5 = 701980252875./199316789632., d6 = -1453857185./822651844., d7 = 69997945./29380423.;
+
+	double x = xmin, h = fabs(step_x);
+	if(h > maxStep) h = maxStep;
+	(m_PtrT->*m_pFuncDerivF)(x, m_Y, k1);
+
+	int iRes = 1;
+	double numSteps = 0.;
+	bool prevRejected = false;
+	while(iRes < np)
+	{
+		if((numSteps += 1.) > maxNumSteps) throw GM_RK_MAX_NUM_STEPS_REACHED;
+
+		double hSgn = dir*h;
+		bool lastStep = ((x + hSgn - xmax)*dir >= 0.);
+		if(lastStep) hSgn = xmax - x;
 
+		double errmax = stepDormandPrince(m_Y, x, hSgn)/m_EpsTol;
+		if(errmax > 1.)
+		{
+			double scale = SAFETY*pow(errmax, -0.2);
+			h = fabs(hSgn)*((scale < MIN_SCALE)? MIN_SCALE : scale);
+			if(h <= minStepAllowed) throw GM_RK_STEP_SIZE_TOO_SMALL;
+			prevRejected = true;
+			continue;
+		}
+
+		double xNew = lastStep? xmax : (x + hSgn);
+		if(lastStep || ((xmin + iRes*step_x - xNew)*dir <= 0.))
+		{//coefficients of continuous extension; k7 is derivative at the end of the step
+			double *k3 = k1 + 2*m_AmOfEq, *k4 = k3 + m_AmOfEq, *k5 = k4 + m_AmOfEq, *k6 = k5 + m_AmOfEq;
+			for(k=0; k<m_AmOfEq; k++)
+			{
+				double yDif = m_y_dp[k] - m_Y[k], bspl = hSgn*k1[k] - yDif;
+				r1[k] = m_Y[k]; r2[k] = yDif; r3[k] = bspl;
+				r4[k] = yDif - hSgn*k7[k] - bspl;
+				r5[k] = hSgn*(d1*k1[k] + d3*k3[k] + d4*k4[k] + d5*k5[k] + d6*k6[k] + d7*k7[k]);
+			}
+			for(; iRes < np; iRes++)
+			{
+				double xRes = (iRes == np - 1)? xmax : (xmin + iRes*step_x);
+				if((xRes - xNew)*dir > 0.) break;
 
+				t_res = resArr + iRes*amOfEq_p_1;
+				*(t_res++) = xRes;
+				double th = (xRes - x)/hSgn, th1 = 1. - th;
+				for(k=0; k<m_AmOfEq; k++) *(t_res++) = r1[k] + th*(r2[k] + th1*(r3[k] + th*(r4[k] + th1*r5[k])));
+			}
+		}
+
+		x = xNew;
+		for(k=0; k<m_AmOfEq; k++) { m_Y[k] = m_y_dp[k]; k1[k] = k7[k];}
+
+		double scale = (errmax > ERRCON)? SAFETY*pow(errmax, -0.2) : MAX_SCALE;
+		if(prevRejected && (scale > 1.)) scale = 1.;
+		h = fabs(hSgn)*scale;
+		if(h > maxStep) h = maxStep;
+		prevRejected = false;
+	}
+}
+
+//-------------------------------------------------------------------------
+// One Dormand-Prince step from x to x + h; k1 (m_k_dp) must contain the derivatives at x on input.
+// The 5th order solution is put to m_y_dp, the derivatives at the end of the step - to the 7th stage
+// of m_k_dp; returns max. ratio of the error estimate to the absolute precision values.
+//-------------------------------------------------------------------------
+template <class T> double CGenMathIntRungeKutta<T>::stepDormandPrince(double* y, double x, double h)
+{
+	const double c2 = 0.2, c3 = 0.3, c4 = 0.8, c5 = 8./9.;
+	const double a21 = 0.2;
+	const double a31 = 3./40., a32 = 9./40.;
+	const double a41 = 44./45., a42 = -56./15., a43 = 32./9.;
+	const double a51 = 19372./6561., a52 = -25360./2187., a53 = 64448./6561., a54 = -212./729.;
+	const double a61 = 9017./3168., a62 = -355./33., a63 = 46732./5247., a64 = 49./176., a65 = -5103./18656.;
+	const double a71 = 35./384., a73 = 500./1113., a74 = 125./192., a75 = -2187./6784., a76 = 11./84.;
+	const double e1 = 71./57600., e3 = -71./16695., e4 = 71./1920., e5 = -17253./339200., e6 = 22./525., e7 = -1./40.;
+
+	int n = m_AmOfEq, i;
+	double *k1 = m_k_dp, *k2 = k1 + n, *k3 = k2 + n, *k4 = k3 + n, *k5 = k4 + n, *k6 = k5 + n, *k7 = k6 + n;
+	double *yt = m_y_dp;
+
+	for(i=0; i<n; i++) yt[i] = y[i] + h*a21*k1[i];
+	(m_PtrT->*m_pFuncDerivF)(x + c2*h, yt, k2);
+	for(i=0; i<n; i++) yt[i] = y[i] + h*(a31*k1[i] + a32*k2[i]);
+	(m_PtrT->*m_pFuncDerivF)(x + c3*h, yt, k3);
+	for(i=0; i<n; i++) yt[i] = y[i] + h*(a41*k1[i] + a42*k2[i] + a43*k3[i]);
+	(m_PtrT->*m_pFuncDerivF)(x + c4*h, yt, k4);
+	for(i=0; i<n; i++) yt[i] = y[i] + h*(a51*k1[i] + a52*k2[i] + a53*k3[i] + a54*k4[i]);
+	(m_PtrT->*m_pFuncDerivF)(x + c5*h, yt, k5);
+	for(i=0; i<n; i++) yt[i] = y[i] + h*(a61*k1[i] + a62*k2[i] + a63*k3[i] + a64*k4[i] + a65*k5[i]);
+	(m_PtrT->*m_pFuncDerivF)(x + h, yt, k6);
+	for(i=0; i<n; i++) yt[i] = y[i] + h*(a71*k1[i] + a73*k3[i] + a74*k4[i] + a75*k5[i] + a76*k6[i]);
+	(m_PtrT->*m_pFuncDerivF)(x + h, yt, k7);
+
+	double errmax = 0.;
+	for(i=0; i<n; i++)
+	{
+		double err = fabs(h*(e1*k1[i] + e3*k3[i] + e4*k4[i] + e5*k5[i] + e6*k6[i] + e7*k7[i])/m_PrecArr[i]);
+		if(errmax < err) errmax = err;
+	}
+	return errmax;
+}
+
+//-------------------------------------------------------------------------
+
+#endif
@@ -168,4 +168,224 @@ double CGenMathMeth::Integ1D_FuncDefByArray(float* FuncArr, long Np, double Step
 
 //-------------------------------------------------------------------------
 
+void CGenMathMeth::Integ1D_SetupWeightsFuncDefByArray(double* arW, long Np, double Step)
+{//Sets up weights arW[i] such that Sum(arW[i]*FuncArr[i]) is the same as Integ1D_FuncDefByArray(FuncArr, Np, Step);
+ //allows integrating "on the fly", without storing the function values
+	if(arW == 0) return;
+	for(long i=0; i<Np; i++) arW[i] = 0.;
+	if((Np < 2) || (Step == 0)) return;
 
+	bool NpIsEven = (Np == ((Np >> 1) << 1));
+	if(NpIsEven)
+	{//method of trapeth
+		for(long i=1; i<(Np - 1); i++) arW[i] = Step;
+		arW[0] = arW[Np - 1] = 0.5*Step;
+	}
+	else
+	{//the same points and coefficients as in the Simpson method of Integ1D_FuncDefByArray
+		double Step_d_3 = Step/3.;
+		long iLast = (Np - 3) & (~1L);
+		if(iLast <= 0) iLast = 2;
+		arW[0] = Step_d_3;
+		for(long i=1; i<iLast; i++) arW[i] = (i & 1)? 4.*Step_d_3 : 2.*Step_d_3;
+		arW[iLast] = Step_d_3;
+	}
+}
+
+//-------------------------------------------------------------------------
+
+
+
+bool CGenMathMeth::EigSymTridiag(double* d, double* e, int n, double* arZ)
+{//QL method with implicit shifts ("tqli" of Numerical Recipes), for symmetric tridiagonal matrix:
+ //d[0..n-1] - diagonal elements (replaced by eigenvalues), e[1..n-1] - sub-diagonal elements (e[0] is arbitrary; destroyed);
+ //the rotations are applied to the rows of arZ (n x n, if != 0), so that the i-th row becomes the i-th eigenvector
+ //if arZ contains the identity matrix on input, or the i-th eigenvector of the original (non-tridiagonal) matrix
+ //if it contains the transposed matrix of the reduction to the tridiagonal form
+	const int maxIter = 60;
+	if((d == 0) || (e == 0) || (n <= 0)) return false;
+
+	for(int i=1; i<n; i++) e[i - 1] = e[i];
+	e[n - 1] = 0.;
+
+	for(int l=0; l<n; l++)
+	{
+		int iter = 0, m;
+		do
+		{
+			for(m=l; m<(n - 1); m++)
+			{
+				double dd = ::fabs(d[m]) + ::fabs(d[m + 1]);
+				if(::fabs(e[m]) <= 1.e-15*dd) break;
+			}
+			if(m != l)
+			{
+				if(iter++ == maxIter) return false;
+				double g = (d[l + 1] - d[l])/(2.*e[l]);
+				double r = sqrt(g*g + 1.);
+				g = d[m] - d[l] + e[l]/(g + ((g >= 0.)? ::fabs(r) : -::fabs(r)));
+				double s = 1., c = 1., p = 0.;
+				int i;
+				for(i=m-1; i>=l; i--)
+				{
+					double f = s*e[i], b = c*e[i];
+					e[i + 1] = (r = sqrt(f*f + g*g));
+					if(r == 0.)
+					{
+						d[i + 1] -= p;
+						e[m] = 0.;
+						break;
+					}
+					s = f/r; c = g/r;
+					g = d[i + 1] - p;
+					r = (d[i] - g)*s + 2.*c*b;
+					d[i + 1] = g + (p = s*r);
+					g = c*r - b;
+
+					if(arZ != 0)
+					{
+						double *tZi = arZ + i*n, *tZi1 = tZi + n;
+						for(int k=0; k<n; k++)
+						{
+							f = tZi1[k];
+							tZi1[k] = s*tZi[k] + c*f;
+							tZi[k] = c*tZi[k] - s*f;
+						}
+					}
+				}
+				if((r == 0.) && (i >= l)) continue;
+				d[l] -= p; e[l] = g; e[m] = 0.;
+			}
+		}
+		while(m != l);
+	}
+	return true;
+}
+
+//-------------------------------------------------------------------------
+
+bool CGenMathMeth::EigSym(double* arA, int n, double* arEigVal)
+{//Eigenvalues and eigenvectors of real symmetric matrix arA (n x n, row-major):
+ //Householder reduction to tridiagonal form ("tred2" of Numerical Recipes), followed by EigSymTridiag;
+ //on return, the i-th row of arA is the eigenvector corresponding to arEigVal[i], eigenvalues being sorted in descending order
+	if((arA == 0) || (arEigVal == 0) || (n <= 0)) return false;
+	double *e = new double[n];
+	if(e == 0) return false;
+	double *d = arEigVal;
+
+	for(int i=n-1; i>0; i--)
+	{
+		int l = i - 1;
+		double h = 0., scale = 0.;
+		double *ai = arA + i*n;
+		if(l > 0)
+		{
+			for(int k=0; k<=l; k++) scale += ::fabs(ai[k]);
+			if(scale == 0.) e[i] = ai[l];
+			else
+			{
+				for(int k=0; k<=l; k++) { ai[k] /= scale; h += ai[k]*ai[k];}
+				double f = ai[l];
+				double g = (f >= 0.)? -sqrt(h) : sqrt(h);
+				e[i] = scale*g;
+				h -= f*g;
+				ai[l] = f - g;
+				f = 0.;
+				for(int j=0; j<=l; j++)
+				{
+					double *aj = arA + j*n;
+					aj[i] = ai[j]/h;
+					g = 0.;
+					for(int k=0; k<=j; k++) g += aj[k]*ai[k];
+					for(int k=j+1; k<=l; k++) g += arA[k*n + j]*ai[k];
+					e[j] = g/h;
+					f += e[j]*ai[j];
+				}
+				double hh = f/(h + h);
+				for(int j=0; j<=l; j++)
+				{
+					f = ai[j];
+					e[j] = g = e[j] - hh*f;
+					double *aj = arA + j*n;
+					for(int k=0; k<=j; k++) aj[k] -= (f*e[k] + g*ai[k]);
+				}
+			}
+		}
+		else e[i] = ai[l];
+		d[i] = h;
+	}
+	d[0] = 0.; e[0] = 0.;
+
+	for(int i=0; i<n; i++)
+	{//accumulation of transformations
+		double *ai = arA + i*n;
+		if(d[i] != 0.)
+		{
+			for(int j=0; j<i; j++)
+			{
+				double g = 0.;
+				for(int k=0; k<i; k++) g += ai[k]*arA[k*n + j];
+				for(int k=0; k<i; k++) arA[k*n + j] -= g*arA[k*n + i];
+			}
+		}
+		d[i] = ai[i];
+		ai[i] = 1.;
+		for(int j=0; j<i; j++) arA[j*n + i] = ai[j] = 0.;
+	}
+
+	for(int i=0; i<n; i++)
+	{//eigenvectors are the columns of the accumulated matrix; EigSymTridiag rotates rows
+		for(int j=i+1; j<n; j++) { double t = arA[i*n + j]; arA[i*n + j] = arA[j*n + i]; arA[j*n + i] = t;}
+	}
+
+	bool res = EigSymTridiag(d, e, n, arA);
+	delete[] e;
+	if(!res) return false;
+
+	for(int i=0; i<(n - 1); i++)
+	{//sorting by selection (rows are swapped at most n times)
+		int iMax = i;
+		for(int j=i+1; j<n; j++) if(d[j] > d[iMax]) iMax = j;
+		if(iMax == i) continue;
+		double t = d[i]; d[i] = d[iMax]; d[iMax] = t;
+		double *ai = arA + i*n, *aMax = arA + iMax*n;
+		for(int k=0; k<n; k++) { t = ai[k]; ai[k] = aMax[k]; aMax[k] = t;}
+	}
+	return true;
+}
+
+//-------------------------------------------------------------------------
+
+bool CGenMathMeth::GaussHermiteNodesWeights(int n, double* arX, double* arW)
+{//Nodes and weights of n-point Gauss-Hermite quadrature for the standard normal distribution (weights sum up to 1),
+ //from the eigenvalues and eigenvectors of the Jacobi matrix of the Hermite polynomials (Golub-Welsch)
+	if((n <= 0) || (arX == 0) || (arW == 0)) return false;
+	if(n == 1) { arX[0] = 0.; arW[0] = 1.; return true;}
+
+	double *e = new double[n];
+	double *arZ = new double[n*n];
+	if((e == 0) || (arZ == 0)) { if(e != 0) delete[] e; if(arZ != 0) delete[] arZ; return false;}
+
+	for(int i=0; i<n; i++)
+	{
+		arX[i] = 0.; e[i] = sqrt((double)i);
+		double *tZ = arZ + i*n;
+		for(int j=0; j<n; j++) tZ[j] = (i == j)? 1. : 0.;
+	}
+	bool res = EigSymTridiag(arX, e, n, arZ);
+	if(res)
+	{
+		for(int i=0; i<n; i++) arW[i] = arZ[i*n]*arZ[i*n];
+		for(int i=0; i<(n - 1); i++)
+		{//ascending order of nodes
+			int iMin = i;
+			for(int j=i+1; j<n; j++) if(arX[j] < arX[iMin]) iMin = j;
+			double t = arX[i]; arX[i] = arX[iMin]; arX[iMin] = t;
+			t = arW[i]; arW[i] = arW[iMin]; arW[iMin] = t;
+		}
+	}
+	delete[] e; delete[] arZ;
+	return res;
+}
+
+//-------------------------------------------------------------------------
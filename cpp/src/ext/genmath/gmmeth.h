@@ -159,6 +159,11 @@ public:
 	static double Integ1D_FuncWithEdgeDer(double (*pF)(double), double x1, double x2, double dFdx1, double dFdx2, double RelPrec);
 	static double Integ1D_FuncDefByArray(double* FuncArr, long Np, double Step);
 	static double Integ1D_FuncDefByArray(float* FuncArr, long Np, double Step);
+	static void Integ1D_SetupWeightsFuncDefByArray(double* arW, long Np, double Step);
+
+	static bool EigSymTridiag(double* d, double* e, int n, double* arZ);
+	static bool EigSym(double* arA, int n, double* arEigVal);
+	static bool GaussHermiteNodesWeights(int n, double* arX, double* arW);
 
 	template <class T> static T tabFunc2D(int ix, int iy, int nx, T* pF)
 	{//just function value
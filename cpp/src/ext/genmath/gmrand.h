@@ -29,6 +29,12 @@ class CGenMathRandLPTau {
 	long iQ, mQ;
 	long MaskArr[30], *MaskArrTrav;
 
+	long QuickInd; //index of the last point generated by LPTauQuick
+	long QuickDir[6][20]; //direction numbers (30-bit integers) for LPTauQuick
+	long QuickX[6]; //last point generated by LPTauQuick (30-bit integers, without shift)
+	long QuickShift[6]; //random digital shift (scrambling) applied by LPTauQuick
+	unsigned long QuickSeed;
+
 public:
 	CGenMathRandLPTau()
 	{
@@ -80,9 +86,28 @@ public:
 		MaskArrTrav = MaskArr;
 		iQ = 0; mQ = 1;
 
+		for(int j=0; j<6; j++)
+		{//the same generating matrices as in LPTauSlow: the l-th direction number is NR[j][l-1]/2^l
+			for(int l=0; l<20; l++) QuickDir[j][l] = NR[j][l] << (29 - l);
+		}
+		InitQuick(0);
+
 		srand(1);
 	}
 
+	void InitQuick(unsigned long seed)
+	{//Restarts the sequence of LPTauQuick; seed != 0 switches on scrambling by random digital shift (XOR of all points with a random vector)
+		QuickInd = 0;
+		QuickSeed = seed;
+		for(int j=0; j<6; j++) { QuickX[j] = 0; QuickShift[j] = 0;}
+		if(seed == 0) return;
+		for(int j=0; j<6; j++)
+		{//xorshift generator, independent of the state of rand()
+			seed ^= seed << 13; seed &= 0xFFFFFFFFUL; seed ^= seed >> 17; seed ^= seed << 5; seed &= 0xFFFFFFFFUL;
+			QuickShift[j] = (long)(seed & 0x3FFFFFFFUL);
+		}
+	}
+
 /**
 	void LPTauSlow(int n, double* Q)
 	{
@@ -128,8 +153,25 @@ public:
 	
 	double D(double x) { return x - long(x);}
 
-	void LPTauQuick(long i, int n, double q)
-	{
+	void LPTauQuick(int n, double* Q)
+	{//Same n-dimensional (n <= 6) points as LPTauSlow, in Gray-code order (I.A. Antonov, V.M. Saleev, USSR Comp. Math. Math. Phys. 19 (1979) 252):
+	 //each new point differs from the previous one by XOR with one direction number per dimension, so the cost does not grow with the index
+		if(n > 6) n = 6;
+		if((++QuickInd) >= (1L << 20))
+		{//the table of direction numbers is exhausted: the sequence is restarted with another shift
+			unsigned long NewSeed = QuickSeed + 0x9E3779B9UL;
+			InitQuick((NewSeed != 0)? NewSeed : 1);
+			QuickInd = 1;
+		}
+		int c = 0; //number of the lowest zero bit of QuickInd - 1
+		for(long i = QuickInd - 1; i & 1; i >>= 1) c++;
+
+		const double InvTwoE30 = 1./double(1L << 30);
+		for(int j=0; j<n; j++)
+		{
+			QuickX[j] ^= QuickDir[j][c];
+			Q[j] = ((QuickX[j] ^ QuickShift[j]) + 0.5)*InvTwoE30;
+		}
 	}
 
 	void SimpleRand(int n, double* Q)
@@ -174,19 +216,26 @@ public:
 		else
 		{
 			double g[1];
-			LPTau.LPTauSlow(1, g);
+			if(rand_mode == 2) LPTau.LPTauQuick(1, g);
+			else LPTau.LPTauSlow(1, g);
 			return g[0];
 		}
 	}
 
 	double NextRandStdN(int n, double* arrQ, char rand_mode = 1)
 	{// Calculates n standard random numbers (>0 and <1)
+	 // rand_mode: 0- rand(), 1- LPtau, 2- LPtau in Gray-code order, scrambled (see InitScrambledLPTau)
 
 		if(rand_mode == 0) 
 		{
 			for(int i=0; i<n; i++) arrQ[i] = InvRAND_MAX*rand();
 			return arrQ[0];
 		}
+		else if(rand_mode == 2)
+		{
+			LPTau.LPTauQuick(n, arrQ);
+			return arrQ[0];
+		}
 		else
 		{
 			LPTau.LPTauSlow(n, arrQ);
@@ -194,6 +243,11 @@ public:
 		}
 	}
 
+	void InitScrambledLPTau(unsigned long seed)
+	{// Restarts the sequence used at rand_mode = 2 (scrambled LPtau); seed = 0 means no scrambling
+		LPTau.InitQuick(seed);
+	}
+
 	//double NextStdRandLPTau()
 	//{// Returns standard random number (>0 and <1)
 	//	double g[1];
@@ -56,9 +56,9 @@ Handle NewHandle(long size)
 CObjCont<CGenObject> gSRObjects;
 
 #ifdef __IGOR_PRO__
-extern srTIntVect gVectWarnNos;
+extern thread_local srTIntVect gVectWarnNos;
 #else
-srTIntVect gVectWarnNos;
+thread_local srTIntVect gVectWarnNos;
 srTYield srYield;
 int gCallSpinProcess = 1;
 #endif
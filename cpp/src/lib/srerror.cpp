@@ -234,6 +234,11 @@ CErrWarn::CErrWarn()
 	error.push_back("Failed to interpolate electric field.\0"); //#178
 
 	error.push_back("Incorrect or insufficient parameters for magnetic field calculation.\0"); //#179
+	error.push_back("Incorrect or insufficient parameters for coherent-mode decomposition or for extraction of characteristics from coherent modes.\0"); //#180
+	error.push_back("Incorrect job handle or function, or failed to start worker thread for the job.\0"); //#181
+	error.push_back("Incorrect handle of compiled container of optical elements.\0"); //#182
+	error.push_back("Propagation through crystal requires both horizontal and vertical components of the electric field.\0"); //#183
+	error.push_back("Not enough memory to store the field samples for coherent-mode decomposition: reduce the numbers of quadrature nodes or the numbers of points of the mesh.\0"); //#184
 
 //};
 
@@ -29,10 +29,11 @@ struct srTParPrecElecFld {
 	double NxNzOversamplingFactor; //active if > 0
 	bool ShowProgrIndic;
 	char CalcTerminTerms;
+	double RelPrecMeshAdapt; //relative precision for adaptive refinement of observation mesh; active if > 0
 
 	//srTParPrecElecFld(int In_CreateNewWfrObj, int In_IntegMethNo, double In_RelPrecOrStep, double In_sStartInt, double In_sEndInt, double In_NxNzOversamplingFactor)
 	//srTParPrecElecFld(int In_IntegMethNo, double In_RelPrecOrStep, double In_sStartInt, double In_sEndInt, double In_NxNzOversamplingFactor, bool In_ShowProgrIndic = true)
-	srTParPrecElecFld(int In_IntegMethNo, double In_RelPrecOrStep, double In_sStartInt, double In_sEndInt, double In_NxNzOversamplingFactor, bool In_ShowProgrIndic = true, char In_CalcTerminTerms = 1)
+	srTParPrecElecFld(int In_IntegMethNo, double In_RelPrecOrStep, double In_sStartInt, double In_sEndInt, double In_NxNzOversamplingFactor, bool In_ShowProgrIndic = true, char In_CalcTerminTerms = 1, double In_RelPrecMeshAdapt = 0)
 	{
         //CreateNewWfrObj = In_CreateNewWfrObj;
         IntegMethNo = In_IntegMethNo; 
@@ -41,6 +42,7 @@ struct srTParPrecElecFld {
         NxNzOversamplingFactor = In_NxNzOversamplingFactor;
 		ShowProgrIndic = In_ShowProgrIndic;
 		CalcTerminTerms = In_CalcTerminTerms;
+		RelPrecMeshAdapt = In_RelPrecMeshAdapt;
 	}
 };
 
@@ -541,7 +543,7 @@ EXP int CALL srUtiFuncIntKnXn(double* ResInt, int type, double x1, double x2, do
 @param [in] arSigma RMS sizes of the n-d Gaussian distribution
 @param [in] n number of dimensions (n <= 6)
 @param [in] init initialization key (if(init), initialized the random generator)
-@param [in] rand_mode type of the random generator (0-standard, 1-LPtau)
+@param [in] rand_mode type of the random generator (0-standard, 1-LPtau, 2-LPtau in Gray-code order, i.e. faster)
 @return	integer error code
 @version	1.0 
 @see		... */
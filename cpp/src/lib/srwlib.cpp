@@ -22,18 +22,24 @@
 #include "srradint.h"
 #include "srradmnp.h"
 #include "sroptcnt.h"
+#include "srpropme.h"
 #include "srgsnbm.h"
 #include "srpersto.h"
 #include "srpowden.h"
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
 //-------------------------------------------------------------------------
 // Global Variables (used in SRW/SRWLIB, some may be obsolete)
 //-------------------------------------------------------------------------
 
 #ifdef __IGOR_PRO__
-extern vector<int> gVectWarnNos;
+extern thread_local vector<int> gVectWarnNos;
 #else
-vector<int> gVectWarnNos;
+thread_local vector<int> gVectWarnNos; //warnings are collected per thread, so that jobs run concurrently (see srwlJobStart) do not get each other's warnings
 srTYield srYield;
 int gCallSpinProcess = 1;
 int SpinProcess() { return 0;}
@@ -190,6 +196,8 @@ EXP int CALL srwlCalcPartTraj(SRWLPrtTrj* pTrj, SRWLMagFldC* pMagFld, double* pr
 	}
 	catch(int erNo) 
 	{ 
+		if(erNo == GM_RK_MAX_NUM_STEPS_REACHED) return SRW_GM_RK_MAX_NUM_STEPS_REACHED; //errors of automatic R-K integration (methods 2, 3) come from genmath
+		if(erNo == GM_RK_STEP_SIZE_TOO_SMALL) return SRW_GM_RK_STEP_SIZE_TOO_SMALL;
 		return erNo;
 	}
 	return 0;
@@ -223,6 +231,63 @@ EXP int CALL srwlCalcPartTrajFromKickMatr(SRWLPrtTrj* pTrj, SRWLKickM* arKickM,
 
 //-------------------------------------------------------------------------
 
+EXP int CALL srwlCalcPartTrajFromKickMatrMult(SRWLPrtTrj* arTrj, int nTrj, SRWLKickM* arKickM, int nKickM, double* precPar)
+{
+	if((arTrj == 0) || (nTrj <= 0) || (arKickM == 0) || (nKickM <= 0)) return SRWL_NO_FUNC_ARG_DATA;
+
+	const double sRelTol = 1.e-12;
+	SRWLPrtTrj &trj0 = arTrj[0];
+	double sAbsTol = sRelTol*(fabs(trj0.ctEnd - trj0.ctStart) + fabs(trj0.partInitCond.z));
+	for(int i=0; i<nTrj; i++)
+	{//all trajectories should be defined on the same mesh, and start from the same longitudinal position
+		SRWLPrtTrj *pTrj = arTrj + i;
+		if((pTrj->arX == 0) || (pTrj->arXp == 0) || (pTrj->arY == 0) || (pTrj->arYp == 0) || (pTrj->np <= 0)) return SRWL_INCORRECT_TRJ_STRUCT;
+		if((pTrj->np != trj0.np) || (fabs(pTrj->ctStart - trj0.ctStart) > sAbsTol) || (fabs(pTrj->ctEnd - trj0.ctEnd) > sAbsTol)) return SRWL_INCORRECT_TRJ_STRUCT;
+		if(fabs(pTrj->partInitCond.z - trj0.partInitCond.z) > sAbsTol) return SRWL_INCORRECT_TRJ_STRUCT;
+	}
+
+	double *arAux = 0;
+	double **arOut = 0;
+	try 
+	{
+		arAux = new double[7*nTrj];
+		arOut = new double*[6*nTrj];
+		double *arInitCond = arAux, *arInvBrho = arAux + 5*nTrj, *arGamEm2 = arAux + 6*nTrj;
+		double **arOutBtX = arOut, **arOutX = arOut + nTrj, **arOutBtY = arOut + 2*nTrj, **arOutY = arOut + 3*nTrj, **arOutBtZ = arOut + 4*nTrj, **arOutZ = arOut + 5*nTrj;
+
+		const double elecEn0 = 0.51099890221e-03; //[GeV]
+		for(int i=0; i<nTrj; i++)
+		{
+			SRWLPrtTrj *pTrj = arTrj + i;
+			SRWLParticle &part = pTrj->partInitCond;
+			double arMom1[] = {(part.gamma)*(part.relE0)*elecEn0, part.x, part.xp, part.y, part.yp, part.z};
+			srTEbmDat elecBeam(1., 1., arMom1, 6, 0, 0, part.z, part.nq);
+
+			double *pInitCond = arInitCond + 5*i;
+			pInitCond[0] = elecBeam.x0; pInitCond[1] = elecBeam.dxds0; pInitCond[2] = elecBeam.z0; pInitCond[3] = elecBeam.dzds0; pInitCond[4] = elecBeam.s0;
+			arInvBrho[i] = elecBeam.Inv_B_rho();
+			arGamEm2[i] = elecBeam.GammaEm2;
+
+			arOutBtX[i] = pTrj->arXp; arOutX[i] = pTrj->arX; arOutBtY[i] = pTrj->arYp; arOutY[i] = pTrj->arY; arOutBtZ[i] = pTrj->arZp; arOutZ[i] = pTrj->arZ;
+		}
+
+		srTGenTrjDat::CompTrjKickMatrMult(arKickM, nKickM, trj0.ctStart, trj0.ctEnd, trj0.np, precPar, nTrj, arInitCond, arInvBrho, arGamEm2, arOutBtX, arOutX, arOutBtY, arOutY, arOutBtZ, arOutZ);
+		delete[] arAux; arAux = 0;
+		delete[] arOut; arOut = 0;
+
+		UtiWarnCheck();
+	}
+	catch(int erNo) 
+	{ 
+		if(arAux != 0) delete[] arAux;
+		if(arOut != 0) delete[] arOut;
+		return erNo;
+	}
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
 EXP int CALL srwlCalcElecFieldSR(SRWLWfr* pWfr, SRWLPrtTrj* pTrj, SRWLMagFldC* pMagFld, double* precPar, int nPrecPar)
 {
 	if((pWfr == 0) || (precPar == 0)) return SRWL_INCORRECT_PARAM_FOR_SR_COMP;
@@ -285,12 +350,35 @@ EXP int CALL srwlCalcElecFieldSR(SRWLWfr* pWfr, SRWLPrtTrj* pTrj, SRWLMagFldC* p
 		char calcTerminTerms = 1; //by default do calculate two terminating terms 
 		if((nPrecPar <= 0) || (nPrecPar > 5)) calcTerminTerms = (char)precPar[5];
 
+		double relPrecMeshAdapt = 0.; //by default, the field is computed at all points of the observation mesh
+		if(nPrecPar > 7) relPrecMeshAdapt = precPar[7];
+
 		//srTParPrecElecFld precElecFld((int)precPar[0], precPar[1], precPar[2], precPar[3], precPar[6]);
 		//srTParPrecElecFld(int In_IntegMethNo, double In_RelPrecOrStep, double In_sStartInt, double In_sEndInt, double In_NxNzOversamplingFactor, bool In_ShowProgrIndic = true, char In_CalcTerminTerms = 1)
-		srTParPrecElecFld precElecFld((int)precPar[0], precPar[1], precPar[2], precPar[3], precPar[6], false, calcTerminTerms);
+		//srTParPrecElecFld precElecFld((int)precPar[0], precPar[1], precPar[2], precPar[3], precPar[6], false, calcTerminTerms);
+		srTParPrecElecFld precElecFld((int)precPar[0], precPar[1], precPar[2], precPar[3], precPar[6], false, calcTerminTerms, relPrecMeshAdapt);
+
+		//period folding (effective if precPar[8] > 0 and the field is one undulator): the entrance and exit parts (terminations and nPerSkip edge periods each)
+		//and 3 sampled central periods are integrated numerically; the other central periods are interpolated quadratically (approximate, see srTRadInt::ComputeElectricFieldFreqDomainPerFold)
+		double perFold = 0., sPerFoldStart = 0.;
+		int nPerFold = 0;
+		if((nPrecPar > 8) && (precPar[8] > 0) && fldIsDefined && (pMagFld->nElem == 1) && (pMagFld->arMagFldTypes[0] == 'u'))
+		{
+			SRWLMagFldU *pUnd = (SRWLMagFldU*)(pMagFld->arMagFld[0]);
+			const int nPerSkip = 2; //periods skipped at each edge of the central part, to exclude terminations and harmonic phase shifts
+			if((pUnd != 0) && (pUnd->per > 0) && (pUnd->nPer > 2*nPerSkip + 1))
+			{
+				perFold = pUnd->per;
+				nPerFold = pUnd->nPer - 2*nPerSkip;
+				double zcUnd = (pMagFld->arZc != 0)? pMagFld->arZc[0] : 0.;
+				sPerFoldStart = zcUnd - 0.5*pUnd->nPer*perFold + nPerSkip*perFold;
+			}
+		}
 
         srTRadInt RadInt;
-		RadInt.ComputeElectricFieldFreqDomain(&trjData, &auxSmp, &precElecFld, &wfr, 0);
+		char showProgressInd = (gpCompJob != 0)? 1 : 0; //progress is only reported to the job run by this thread (see srwlJobStart)
+		if(nPerFold > 0) RadInt.ComputeElectricFieldFreqDomainPerFold(&trjData, &auxSmp, &precElecFld, &wfr, perFold, sPerFoldStart, nPerFold, showProgressInd);
+		else RadInt.ComputeElectricFieldFreqDomain(&trjData, &auxSmp, &precElecFld, &wfr, showProgressInd);
 		wfr.OutSRWRadPtrs(*pWfr);
 		UtiWarnCheck();
 	}
@@ -527,6 +615,44 @@ EXP int CALL srwlCalcIntFromElecField(char* pInt, SRWLWfr* pWfr, char polar, cha
 
 //-------------------------------------------------------------------------
 
+EXP int CALL srwlCalcIntFromElecFieldMult(char** arInt, SRWLWfr* pWfr, int nInt, char* arPol, char* arIntType, char* arDepType, double* arE, double* arX, double* arY)
+{
+	if((pWfr == 0) || (arInt == 0) || (nInt <= 0) || (arPol == 0) || (arIntType == 0) || (arDepType == 0) || (arE == 0) || (arX == 0) || (arY == 0)) return SRWL_INCORRECT_PARAM_FOR_INT_EXTR;
+	for(int i=0; i<nInt; i++) if(arInt[i] == 0) return SRWL_INCORRECT_PARAM_FOR_INT_EXTR;
+
+	srTRadExtract *arRadExtract = 0;
+	try 
+	{
+		srTSRWRadStructAccessData wfr(pWfr);
+		CHGenObj hWfr(&wfr, true);
+		srTRadGenManip radGenManip(hWfr);
+
+		arRadExtract = new srTRadExtract[nInt];
+		for(int i=0; i<nInt; i++)
+		{
+			//Re-defining intType from SRWL convention to old SRW convention (as in srwlCalcIntFromElecField)
+			char intType = arIntType[i];
+			if(intType == 2) intType = 4;
+			else if(intType == 3) intType = 5;
+			else if(intType == 4) intType = 2;
+			else if(intType == 5) intType = 3;
+
+			arRadExtract[i] = srTRadExtract((int)arPol[i], (int)intType, (int)arDepType[i], wfr.Pres, arE[i], arX[i], arY[i], arInt[i]);
+		}
+		radGenManip.ExtractRadiationMult(arRadExtract, nInt);
+		UtiWarnCheck();
+	}
+	catch(int erNo) 
+	{
+		if(arRadExtract != 0) delete[] arRadExtract;
+		return erNo;
+	}
+	if(arRadExtract != 0) delete[] arRadExtract;
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
 EXP int CALL srwlResizeElecField(SRWLWfr* pWfr, char type, double* par)
 {
 	if((pWfr == 0) || (par == 0)) return SRWL_INCORRECT_PARAM_FOR_RESIZE;
@@ -631,6 +757,59 @@ EXP int CALL srwlPropagElecField(SRWLWfr* pWfr, SRWLOptC* pOpt)
 
 //-------------------------------------------------------------------------
 
+EXP int CALL srwlOptCompile(void** ppOptHndl, SRWLOptC* pOpt)
+{
+	if((ppOptHndl == 0) || (pOpt == 0)) return SRWL_INCORRECT_PARAM_FOR_WFR_PROP;
+	*ppOptHndl = 0;
+	try 
+	{
+		srTCompositeOptElem *pOptCont = new srTCompositeOptElem(*pOpt);
+		pOptCont->SetDataIsFixed();
+		*ppOptHndl = (void*)pOptCont;
+	}
+	catch(int erNo)
+	{
+		return erNo;
+	}
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlPropagElecFieldCompiled(SRWLWfr* pWfr, void* pOptHndl)
+{
+	if(pWfr == 0) return SRWL_INCORRECT_PARAM_FOR_WFR_PROP;
+	if(pOptHndl == 0) return SRWL_INCORRECT_OPT_HNDL;
+	srTCompositeOptElem *pOptCont = (srTCompositeOptElem*)pOptHndl;
+	int locErNo = 0;
+	try 
+	{
+		srTSRWRadStructAccessData wfr(pWfr);
+		if(locErNo = pOptCont->CheckRadStructForPropagation(&wfr)) return locErNo;
+		if(locErNo = pOptCont->PropagateRadiationGuided(wfr)) return locErNo;
+
+		wfr.OutSRWRadPtrs(*pWfr);
+
+		UtiWarnCheck();
+	}
+	catch(int erNo)
+	{
+		return erNo;
+	}
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlOptDelete(void* pOptHndl)
+{
+	if(pOptHndl == 0) return SRWL_INCORRECT_OPT_HNDL;
+	delete (srTCompositeOptElem*)pOptHndl;
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
 EXP int CALL srwlPropagRadMultiE(SRWLStokes* pStokes, SRWLWfr* pWfr0, SRWLOptC* pOpt, double* precPar, int (*pExtFunc)(int action, SRWLStokes* pStokesInst))
 {
 	if((pStokes == 0) || (pWfr0 == 0) || (pOpt == 0) || (precPar == 0)) return SRWL_INCORRECT_PARAM_FOR_WFR_PROP;
@@ -659,3 +838,216 @@ EXP int CALL srwlPropagRadMultiE(SRWLStokes* pStokes, SRWLWfr* pWfr0, SRWLOptC*
 }
 
 //-------------------------------------------------------------------------
+
+EXP int CALL srwlCalcCohModes(SRWLWfr* arModes, int* pnModes, double* arOcc, SRWLWfr* pWfr0, double* precPar)
+{
+	if((arModes == 0) || (pnModes == 0) || (*pnModes <= 0) || (arOcc == 0) || (pWfr0 == 0)) return SRWL_INCORRECT_PARAM_FOR_COH_MODES;
+	int nModesIn = *pnModes, nModes = nModesIn;
+	double arPrecPar[] = {5, 5, 3, 0}; //defaults: numbers of quadrature nodes vs x & x', y & y', relative energy; minimal occupation of modes
+	if(precPar != 0) for(int i=0; i<4; i++) arPrecPar[i] = precPar[i];
+
+	vector<srTSRWRadStructAccessData*> vModesLoc;
+	int locErNo = 0;
+	try 
+	{
+		srTSRWRadStructAccessData wfr0(pWfr0);
+		srTEbmDat ebm;
+		if(locErNo = wfr0.OutElectronBeamStruct(ebm)) throw locErNo;
+		vModesLoc.reserve(nModesIn);
+		for(int k=0; k<nModesIn; k++) vModesLoc.push_back(new srTSRWRadStructAccessData(arModes + k));
+		srTSRWRadStructAccessData **arModesLoc = &vModesLoc[0];
+
+		if(locErNo = srTPropagMultiE::DecomposeCohModes(wfr0, ebm, arModesLoc, nModes, arOcc, arPrecPar)) throw locErNo;
+		for(int k=0; k<nModesIn; k++) arModesLoc[k]->OutSRWRadPtrs(arModes[k]);
+		*pnModes = nModes;
+
+		UtiWarnCheck();
+	}
+	catch(int erNo) 
+	{
+		locErNo = erNo;
+	}
+	catch(...)
+	{
+		locErNo = MEMORY_ALLOCATION_FAILURE;
+	}
+	for(int k=0; k<(int)vModesLoc.size(); k++) delete vModesLoc[k];
+	return locErNo;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlPropagCohModes(SRWLWfr* arModes, int nModes, SRWLOptC* pOpt)
+{
+	if((arModes == 0) || (nModes <= 0) || (pOpt == 0)) return SRWL_INCORRECT_PARAM_FOR_WFR_PROP;
+	int locErNo = 0;
+	try 
+	{
+		srTCompositeOptElem optCont(*pOpt);
+		for(int k=0; k<nModes; k++)
+		{
+			srTSRWRadStructAccessData wfr(arModes + k);
+			if(locErNo = optCont.CheckRadStructForPropagation(&wfr)) return locErNo;
+			if(locErNo = optCont.PropagateRadiationGuided(wfr)) return locErNo;
+			wfr.OutSRWRadPtrs(arModes[k]);
+		}
+		UtiWarnCheck();
+	}
+	catch(int erNo)
+	{
+		return erNo;
+	}
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlCalcIntFromCohModes(char* pInt, SRWLWfr* arModes, int nModes, char pol, char intType, char depType, double e, double x, double y)
+{
+	if((pInt == 0) || (arModes == 0) || (nModes <= 0)) return SRWL_INCORRECT_PARAM_FOR_COH_MODES;
+
+	srTSRWRadStructAccessData **arModesLoc = new srTSRWRadStructAccessData*[nModes];
+	for(int k=0; k<nModes; k++) arModesLoc[k] = 0;
+	int locErNo = 0;
+	try 
+	{
+		for(int k=0; k<nModes; k++) arModesLoc[k] = new srTSRWRadStructAccessData(arModes + k);
+		srTPropagMultiE::ExtractIntFromCohModes(arModesLoc, nModes, (int)pol, (int)intType, (int)depType, e, x, y, (float*)pInt);
+		UtiWarnCheck();
+	}
+	catch(int erNo) 
+	{
+		locErNo = erNo;
+	}
+	for(int k=0; k<nModes; k++) if(arModesLoc[k] != 0) delete arModesLoc[k];
+	delete[] arModesLoc;
+	return locErNo;
+}
+
+//-------------------------------------------------------------------------
+
+struct srTWorkerJob : public srTCompJob {
+	int (*pFunc)(void*);
+	void *pData;
+	int Result;
+	bool Finished; //protected by Mutex
+	std::mutex Mutex;
+	std::condition_variable CondFinished;
+	std::thread Thread;
+
+	srTWorkerJob(int (*In_pFunc)(void*), void* In_pData) : srTCompJob()
+	{
+		pFunc = In_pFunc; pData = In_pData; Result = 0; Finished = false;
+	}
+};
+
+//-------------------------------------------------------------------------
+
+static void RunWorkerJob(srTWorkerJob* pJob)
+{
+	gpCompJob = pJob;
+	int res = 0;
+	try 
+	{
+		res = (*(pJob->pFunc))(pJob->pData);
+	}
+	catch(int erNo) 
+	{
+		res = erNo;
+	}
+	catch(...) 
+	{
+		res = SRWL_INCORRECT_JOB;
+	}
+	gpCompJob = 0;
+	{
+		std::lock_guard<std::mutex> lock(pJob->Mutex);
+		pJob->Result = res;
+		pJob->Finished = true;
+	}
+	pJob->CondFinished.notify_all();
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlJobStart(void** ppJob, int (*pFunc)(void* pData), void* pData)
+{
+	if((ppJob == 0) || (pFunc == 0)) return SRWL_INCORRECT_JOB;
+	*ppJob = 0;
+	srTWorkerJob *pJob = 0;
+	try 
+	{
+		pJob = new srTWorkerJob(pFunc, pData);
+		pJob->Thread = std::thread(RunWorkerJob, pJob);
+	}
+	catch(...) 
+	{
+		if(pJob != 0) delete pJob;
+		return SRWL_INCORRECT_JOB;
+	}
+	*ppJob = (void*)pJob;
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlJobGetStatus(void* pJob, char* pFinished, double* pProgress, int* pRes)
+{
+	if(pJob == 0) return SRWL_INCORRECT_JOB;
+	srTWorkerJob *pWorkerJob = (srTWorkerJob*)pJob;
+
+	bool finished = false;
+	int res = 0;
+	{
+		std::lock_guard<std::mutex> lock(pWorkerJob->Mutex);
+		finished = pWorkerJob->Finished; res = pWorkerJob->Result;
+	}
+	if(pFinished != 0) *pFinished = finished? 1 : 0;
+	if(pRes != 0) *pRes = res;
+	if(pProgress != 0)
+	{
+		long totPoints = pWorkerJob->TotPoints.load(std::memory_order_relaxed);
+		long curPoint = pWorkerJob->CurPoint.load(std::memory_order_relaxed);
+		*pProgress = 0.;
+		if(finished) *pProgress = 1.;
+		else if(totPoints > 0) *pProgress = (curPoint >= totPoints)? 1. : ((double)curPoint)/((double)totPoints);
+	}
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlJobWait(void* pJob, double timeOut, char* pFinished)
+{
+	if(pJob == 0) return SRWL_INCORRECT_JOB;
+	srTWorkerJob *pWorkerJob = (srTWorkerJob*)pJob;
+
+	std::unique_lock<std::mutex> lock(pWorkerJob->Mutex);
+	if(timeOut < 0.) pWorkerJob->CondFinished.wait(lock, [pWorkerJob]{ return pWorkerJob->Finished;});
+	else pWorkerJob->CondFinished.wait_for(lock, std::chrono::duration<double>(timeOut), [pWorkerJob]{ return pWorkerJob->Finished;});
+	if(pFinished != 0) *pFinished = pWorkerJob->Finished? 1 : 0;
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlJobCancel(void* pJob)
+{
+	if(pJob == 0) return SRWL_INCORRECT_JOB;
+	((srTWorkerJob*)pJob)->CancelRequested.store(true, std::memory_order_relaxed);
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlJobDelete(void* pJob)
+{
+	if(pJob == 0) return SRWL_INCORRECT_JOB;
+	srTWorkerJob *pWorkerJob = (srTWorkerJob*)pJob;
+	pWorkerJob->CancelRequested.store(true, std::memory_order_relaxed);
+	if(pWorkerJob->Thread.joinable()) pWorkerJob->Thread.join();
+	delete pWorkerJob;
+	return 0;
+}
+
+//-------------------------------------------------------------------------
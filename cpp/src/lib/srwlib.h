@@ -440,6 +440,8 @@ typedef struct SRWLStructOpticsGrating SRWLOptG;
 /**
  * Optical Element:
  * Ideal Crystal
+ * (the reflection coefficients are calculated exactly on a coarse angular mesh and interpolated where it is accurate enough;
+ * the tolerance is divided by the relative precision of the propagation parameters of the element, arProp[i][2] in SRWLOptC)
  */
 struct SRWLStructOpticsCrystal {
 	double dSp; /* crystal reflecting planes d-spacing (units?) */
@@ -521,11 +523,12 @@ EXP int CALL srwlCalcMagFld(SRWLMagFldC* pDispMagFld, SRWLMagFldC* pMagFld);
  * @param [in] precPar (optional) method ID and precision parameters; 
  *             if(precPar == 0) default 4th-order Runge-Kutta method is used; otherwise:
  *             precPar[0] is number of precision parameters that will follow
- *             [1] method number: 1- 4th-order Runge-Kutta; 2- 5th-order Runge-Kutta;
- *             [2] interpolation method to use for tabulated magnetic field: 1- simple bi-linear (3D); 2- bi-quadratic (3D); 3- bi-cubic (3D); 4- 1D cubic spline + 2D bi-cubic
- *             [3],[4],[5],[6],[7]: absolute precision values for X[m],X'[rad],Y[m],Y'[rad],Z[m] (yet to be tested!!) - to be taken into account only for R-K fifth order or higher
- *             [8]: rel. tolerance for R-K fifth order or higher (default = 1) 
- *             [9]: max. number of auto-steps for R-K fifth order or higher (default = 5000)
+ *             [1] method number: 1- 4th-order Runge-Kutta; 2- 5th-order Runge-Kutta; 3- adaptive 5th-order Runge-Kutta (Dormand-Prince) with dense output (step is not bound to the trajectory mesh);
+ *             [2],[3],[4],[5],[6]: absolute precision values for X[m],X'[rad],Y[m],Y'[rad],Z[m] (yet to be tested!!) - to be taken into account only for R-K fifth order or higher (default: 1e-09 for all, used if less than 5 values are given)
+ *             [7]: rel. tolerance for R-K fifth order or higher (default = 1) 
+ *             [8]: max. number of auto-steps (per trajectory mesh interval) for R-K fifth order or higher (default = 5000)
+ *             [9]: max. step [m] for method 3 (default: 10 steps of the trajectory mesh); should be smaller than the shortest magnetic element
+ *             (interpolation method for tabulated magnetic field is defined in the 3D field structure)
  * @return	integer error (>0) or warnig (<0) code
  * @see ...
  */
@@ -543,6 +546,19 @@ EXP int CALL srwlCalcPartTraj(SRWLPrtTrj* pTrj, SRWLMagFldC* pMagFld, double* pr
  */
 EXP int CALL srwlCalcPartTrajFromKickMatr(SRWLPrtTrj* pTrj, SRWLKickM* arKickM, int nKickM, double* precPar =0);
 
+/** 
+ * Calculates trajectories of many charged particles (e.g. of an ensemble for multi-electron calculations) from an array of kick matrices;
+ * all particles are pushed through each kick matrix at once, so that the kick matrix data is interpolated for the whole ensemble while it is in cache
+ * @param [in, out] arTrj array of resulting trajectory structures (as pTrj in srwlCalcPartTrajFromKickMatr); all trajectories should have the same mesh (np, ctStart, ctEnd) and the same initial longitudinal position (partInitCond.z)
+ * @param [in] nTrj number of trajectories (particles)
+ * @param [in] arKickM array of kick matrix structures
+ * @param [in] nKickM number of kick matrices in the array
+ * @param [in] precPar (optional) precision parameters, as in srwlCalcPartTrajFromKickMatr
+ * @return	integer error (>0) or warnig (<0) code
+ * @see srwlCalcPartTrajFromKickMatr
+ */
+EXP int CALL srwlCalcPartTrajFromKickMatrMult(SRWLPrtTrj* arTrj, int nTrj, SRWLKickM* arKickM, int nKickM, double* precPar =0);
+
 /** 
  * Calculates Electric Field (Wavefront) of Synchrotron Radiation by a relativistic charged particle traveling in external 3D magnetic field
  * @param [in, out] pWfr pointer to resulting Wavefront structure; all data arrays should be allocated in a calling function/application; the mesh, presentation, etc., should be specified in this structure at input
@@ -556,7 +572,8 @@ EXP int CALL srwlCalcPartTrajFromKickMatr(SRWLPrtTrj* pTrj, SRWLKickM* arKickM,
  *			  [4]: number of points to use for trajectory calculation 
  *			  [5]: calculate terminating terms or not: 0- don't calculate two terms, 1- do calculate two terms, 2- calculate only upstream term, 3- calculate only downstream term 
  *			  [6]: sampling factor (for propagation, effective if > 0)
- *			  [7]: ... 
+ *			  [7]: relative precision for adaptive refinement of the observation mesh (effective if > 0 and nPrecPar > 7): the field is computed on a coarse mesh, which is refined only where interpolation error exceeds this fraction of max. field; the rest of the mesh is filled by interpolation
+ *			  [8]: use period folding (effective if > 0 and nPrecPar > 8, for pMagFld containing one undulator): the entrance and exit parts (including 2 edge periods at each side) and 3 periods of the central part (first, middle, last) are integrated numerically; the contributions of the other central periods are obtained by quadratic interpolation of the de-phased period integrals vs period number and summed with the exact phases at the period starts (approximate: accuracy depends on how slowly the de-phased period integral varies along the undulator, i.e. on the observation distance and angles)
  * @param [in] nPrecPar number of precision parameters 
  * @return	integer error (>0) or warnig (<0) code
  * @see ...
@@ -620,9 +637,9 @@ EXP int CALL srwlCalcPowDenSR(SRWLStokes* pStokes, SRWLPartBeam* pElBeam, SRWLPr
  *             6- Total
  * @param [in] intType "type" of a characteristic to be extracted: 
  *             0- "Single-Electron" Intensity; 
- *             1- "Multi-Electron" Intensity; 
+ *             1- "Multi-Electron" Intensity (convolution of the Single-Electron one with the electron beam transverse distribution, on the wavefront mesh: the intensity spilled by the convolution outside the mesh is not represented, so the mesh should cover the Multi-Electron distribution); 
  *             2- "Single-Electron" Flux; 
- *             3- "Multi-Electron" Flux; 
+ *             3- "Multi-Electron" Flux (through the wavefront mesh: the intensity spread by the convolution beyond the mesh is not counted); 
  *             4- "Single-Electron" Radiation Phase; 
  *             5- Re(E): Real part of Single-Electron Electric Field;
  *             6- Im(E): Imaginary part of Single-Electron Electric Field;
@@ -643,6 +660,23 @@ EXP int CALL srwlCalcPowDenSR(SRWLStokes* pStokes, SRWLPartBeam* pElBeam, SRWLPr
  */
 EXP int CALL srwlCalcIntFromElecField(char* pInt, SRWLWfr* pWfr, char pol, char intType, char depType, double e, double x, double y);
 
+/** 
+ * Calculates/extracts several characteristics (e.g. Intensity of different polarization components, its cuts vs different arguments) from pre-calculated Electric Field at once;
+ * the single-electron characteristics are extracted in one pass over the Electric Field data
+ * @param [out] arInt array of pointers to resulting Intensity (or other characteristic) arrays, one per extraction (each as pInt in srwlCalcIntFromElecField)
+ * @param [in] pWfr pointer to pre-calculated Wavefront structure
+ * @param [in] nInt number of extractions
+ * @param [in] arPol array of polarization components to extract (nInt values; see pol in srwlCalcIntFromElecField)
+ * @param [in] arIntType array of "types" of characteristics to be extracted (nInt values; see intType in srwlCalcIntFromElecField)
+ * @param [in] arDepType array of types of dependence to extract (nInt values; see depType in srwlCalcIntFromElecField)
+ * @param [in] arE array of photon energies (to keep fixed; nInt values)
+ * @param [in] arX array of horizontal positions (to keep fixed; nInt values)
+ * @param [in] arY array of vertical positions (to keep fixed; nInt values)
+ * @return	integer error (>0) or warnig (<0) code
+ * @see srwlCalcIntFromElecField
+ */
+EXP int CALL srwlCalcIntFromElecFieldMult(char** arInt, SRWLWfr* pWfr, int nInt, char* arPol, char* arIntType, char* arDepType, double* arE, double* arX, double* arY);
+
 /** 
  * "Resizes" Electric Field Wavefront vs transverse positions / angles or photon energy / time
  * @param [in, out] pWfr pointer to pre-calculated Wavefront structure
@@ -676,6 +710,37 @@ EXP int CALL srwlSetRepresElecField(SRWLWfr* pWfr, char repr);
  */
 EXP int CALL srwlPropagElecField(SRWLWfr* pWfr, SRWLOptC* pOpt);
 
+/** 
+ * "Compiles" container of optical elements into a native object kept between propagations (e.g. of many wavefronts through the same beamline);
+ * the object keeps the optical elements with their propagation parameters, so that they are not set up again for each propagation.
+ * Of the auxiliary data derived from the elements' data, only the transmission resampled on the wavefront mesh (SRWLOptT, including height-profile
+ * errors of mirrors set up as transmission elements) is kept and reused as long as the wavefront mesh does not change; other elements
+ * (e.g. drifts, lenses, apertures, analytical mirrors, gratings, crystals) keep no such data, so their propagation cost is not reduced by compiling.
+ * Arrays referenced by the container (e.g. transmission or height profile data) are not copied: they must not be deleted or modified while the handle is used.
+ * The same handle should not be used by concurrent propagations.
+ * @param [out] ppOptHndl pointer to the handle of the compiled container (to be released by srwlOptDelete)
+ * @param [in] pOpt pointer to container of optical elements
+ * @return	integer error (>0) or warnig (<0) code
+ * @see srwlPropagElecFieldCompiled, srwlOptDelete
+ */
+EXP int CALL srwlOptCompile(void** ppOptHndl, SRWLOptC* pOpt);
+
+/** 
+ * "Propagates" Electric Field Wavefront through Optical Elements and free spaces of a container compiled by srwlOptCompile
+ * @param [in, out] pWfr pointer to pre-calculated Wavefront structure
+ * @param [in] pOptHndl handle of the compiled container of optical elements
+ * @return	integer error (>0) or warnig (<0) code
+ * @see srwlPropagElecField, srwlOptCompile
+ */
+EXP int CALL srwlPropagElecFieldCompiled(SRWLWfr* pWfr, void* pOptHndl);
+
+/** 
+ * Releases container of optical elements compiled by srwlOptCompile
+ * @param [in] pOptHndl handle of the compiled container of optical elements
+ * @return	integer error (>0) or warnig (<0) code
+ */
+EXP int CALL srwlOptDelete(void* pOptHndl);
+
 /** TEST
  * "Propagates" multple Electric Field Wavefronts from different electrons through Optical Elements and free spaces
  * @param [in, out] pWfr0 pointer to pre-calculated Wavefront structure from an average electron
@@ -690,6 +755,111 @@ EXP int CALL srwlPropagElecField(SRWLWfr* pWfr, SRWLOptC* pOpt);
  */
 EXP int CALL srwlPropagRadMultiE(SRWLStokes* pStokes, SRWLWfr* pWfr0, SRWLOptC* pOpt, double* precPar, int (*pExtFunc)(int action, SRWLStokes* pStokesInst));
 
+/** 
+ * Decomposes Cross-Spectral Density of radiation emitted by finite-emittance electron beam into coherent modes.
+ * The Cross-Spectral Density is built from the Electric Field of the average electron (pWfr0) and the 2nd order moments of the electron beam (pWfr0->partBeam),
+ * by shifting and tilting the field as for off-axis electrons (at the nodes of Gauss-Hermite quadrature over the electron beam phase space),
+ * and it is diagonalized at each photon energy without being formed explicitly.
+ * The Electric Field of each mode is scaled by the square root of its eigenvalue, so that the sum of "single-electron" intensities of the modes
+ * (also after propagation) is the "multi-electron" intensity.
+ * @param [in, out] arModes array of *pnModes Wavefront structures with the same numbers of points vs photon energy, horizontal and vertical positions as pWfr0, to receive the modes
+ * @param [in, out] pnModes pointer to the number of modes to compute; on return: the maximal number of modes kept at one photon energy
+ * @param [out] arOcc array of occupations of the modes (eigenvalues relative to their sum): arOcc[ie*(*pnModes) + k] for mode k at photon energy ie (*pnModes being the input value)
+ * @param [in] pWfr0 pointer to pre-calculated Wavefront structure from the average electron (in coordinate representation, in frequency domain)
+ * @param [in] precPar precision parameters (array of 4 values, can be 0 for defaults):
+ *             precPar[0]: number of quadrature nodes per horizontal phase-space variable (default 5)
+ *             [1]: number of quadrature nodes per vertical phase-space variable (default 5)
+ *             [2]: number of quadrature nodes vs relative energy spread (default 3; effective only if pWfr0 contains several photon energies:
+ *                  the field of an electron with relative energy deviation dg is approximated by the field of the average electron at photon energy e/(1 + dg)^2)
+ *             [3]: minimal occupation of the modes to keep (default 0)
+ *             All the field samples at one photon energy are kept in memory: up to 8*precPar[0]^2*precPar[1]^2*precPar[2]*nx*ny bytes per polarization component
+ *             (about 5.4 GB with the default values and a 600x600 mesh); if this memory can't be allocated, the function fails without computing anything
+ * @return	integer error (>0) or warnig (<0) code
+ * @see ...
+ */
+EXP int CALL srwlCalcCohModes(SRWLWfr* arModes, int* pnModes, double* arOcc, SRWLWfr* pWfr0, double* precPar);
+
+/** 
+ * "Propagates" coherent modes (e.g. computed by srwlCalcCohModes) through Optical Elements and free spaces
+ * @param [in, out] arModes array of Wavefront structures of the modes
+ * @param [in] nModes number of modes
+ * @param [in] pOpt pointer to container of optical elements the propagation should be done through (set up once for all the modes)
+ * @return	integer error (>0) or warnig (<0) code
+ * @see srwlPropagElecField
+ */
+EXP int CALL srwlPropagCohModes(SRWLWfr* arModes, int nModes, SRWLOptC* pOpt);
+
+/** 
+ * Calculates/extracts Intensity or Mutual Intensity of partially-coherent radiation represented by coherent modes with the same mesh
+ * @param [out] pInt pointer to resulting Intensity, Mutual Intensity or Degree of Coherence (float array)
+ * @param [in] arModes array of Wavefront structures of the modes
+ * @param [in] nModes number of modes
+ * @param [in] pol polarization component to extract (see srwlCalcIntFromElecField)
+ * @param [in] intType "type" of a characteristic to be extracted: 
+ *             0- "Multi-Electron" Intensity (sum of intensities of the modes);
+ *             1- Mutual Intensity J(r1,r2) = Sum(E*(r1)E(r2)) over the modes, as complex array with J(i1,i2) at [2*(i1 + i2*n)];
+ *             2- Degree of Coherence |J(r1,r2)|/sqrt(J(r1,r1)J(r2,r2));
+ * @param [in] depType type of dependence to extract: as in srwlCalcIntFromElecField for intType = 0;
+ *             for intType = 1 or 2: 1- vs x1&x2 (at given e and y), 2- vs y1&y2 (at given e and x);
+ * @param [in] e photon energy (to keep fixed)
+ * @param [in] x horizontal position (to keep fixed)
+ * @param [in] y vertical position (to keep fixed)
+ * @return	integer error (>0) or warnig (<0) code
+ * @see srwlCalcIntFromElecField
+ */
+EXP int CALL srwlCalcIntFromCohModes(char* pInt, SRWLWfr* arModes, int nModes, char pol, char intType, char depType, double e, double x, double y);
+
+/** 
+ * Starts a computation on a worker thread owned by the library, and returns without waiting for it to finish.
+ * The computation is done by an external function, which would usually call one or several srwl* functions;
+ * while it runs, its progress can be polled (srwlJobGetStatus) and it can be cancelled (srwlJobCancel):
+ * the calculation functions then return with error code of aborted computation at their next check.
+ * Data passed to the job must not be accessed by other threads before the job is finished.
+ * Several jobs may run concurrently: warnings, random number generators and progress state are kept per thread;
+ * however, the same data (wavefronts, optical elements, compiled optical containers, magnetic field structures) must not be used by concurrent jobs.
+ * Progress is reported by srwlCalcElecFieldSR (observation points), srwlPropagElecField, srwlPropagElecFieldCompiled and srwlPropagCohModes
+ * (optical elements passed, for each mode in the latter case) and srwlCalcCohModes (photon energies processed); the other functions do not report it.
+ * @param [out] ppJob pointer to the handle of the job (to be released by srwlJobDelete)
+ * @param [in] pFunc pointer to the external function performing the computation (its return value is kept as result of the job)
+ * @param [in] pData pointer to data passed to pFunc
+ * @return	integer error (>0) or warnig (<0) code
+ * @see srwlJobGetStatus, srwlJobWait, srwlJobCancel, srwlJobDelete
+ */
+EXP int CALL srwlJobStart(void** ppJob, int (*pFunc)(void* pData), void* pData);
+
+/** 
+ * Gets the status of a job started by srwlJobStart (without waiting)
+ * @param [in] pJob handle of the job
+ * @param [out] pFinished 1 if the job is finished, 0 otherwise (can be 0)
+ * @param [out] pProgress relative progress (0 to 1) of the current stage of the computation, as reported by calculation functions which support it (can be 0)
+ * @param [out] pRes result of the job function, valid if the job is finished (can be 0)
+ * @return	integer error (>0) or warnig (<0) code
+ */
+EXP int CALL srwlJobGetStatus(void* pJob, char* pFinished, double* pProgress, int* pRes);
+
+/** 
+ * Waits for a job started by srwlJobStart to finish
+ * @param [in] pJob handle of the job
+ * @param [in] timeOut max. time to wait [s]; if < 0, the time is not limited
+ * @param [out] pFinished 1 if the job is finished, 0 if the time-out was reached (can be 0)
+ * @return	integer error (>0) or warnig (<0) code
+ */
+EXP int CALL srwlJobWait(void* pJob, double timeOut, char* pFinished);
+
+/** 
+ * Requests cancellation of a job started by srwlJobStart (without waiting for it to finish)
+ * @param [in] pJob handle of the job
+ * @return	integer error (>0) or warnig (<0) code
+ */
+EXP int CALL srwlJobCancel(void* pJob);
+
+/** 
+ * Releases a job started by srwlJobStart; if the job is still running, it is cancelled, and the function waits for it to finish
+ * @param [in] pJob handle of the job
+ * @return	integer error (>0) or warnig (<0) code
+ */
+EXP int CALL srwlJobDelete(void* pJob);
+
 /***************************************************************************/
 
 #ifdef __cplusplus  
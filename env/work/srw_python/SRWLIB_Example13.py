@@ -0,0 +1,91 @@
+#############################################################################
+# SRWLIB Example#13: Comparing trajectory integration methods (accuracy and computation time)
+# v 0.01
+#############################################################################
+
+from __future__ import print_function #Python 2.7 compatibility
+from srwlib import *
+import time
+
+print('SRWLIB Python Example # 13:')
+print('Comparing 4th-order, 5th-order and adaptive (Dormand-Prince) Runge-Kutta trajectory integration vs a reference solution')
+
+#**********************Initial Conditions for Particle Trajectory Calculation
+part = SRWLParticle()
+part.x = 0.0001 #Initial Transverse Coordinates [m]
+part.y = 0.0001
+part.xp = 0 #Initial Transverse Velocities
+part.yp = 0
+part.gamma = 3/0.51099890221e-03 #Relative Energy
+part.relE0 = 1 #Electron Rest Mass
+part.nq = -1 #Electron Charge
+
+#**********************Magnetic Field: dipoles with long drifts between them, quadrupoles and an undulator
+numDip = 20 #Number of Dipoles
+dipLen = 0.5 #Dipole Length [m]
+dipDist = 2.5 #Distance between Dipole Centers [m]
+und = SRWLMagFldU([SRWLMagFldH(1, 'v', 0.8, 0, 1)], 0.02, 100) #Undulator
+undLen = 102*0.02
+arFld = []; arZc = []
+zc = -0.5*(numDip - 1)*dipDist
+for i in range(numDip):
+    sgn = 1 if(i%2 == 0) else -1
+    arFld.append(SRWLMagFldM(sgn*0.02, 1, 'n', dipLen)); arZc.append(zc) #weak dipoles with alternating signs
+    if(i == numDip//2):
+        arFld.append(und); arZc.append(zc + 0.5*dipDist)
+    elif(i%4 == 1):
+        arFld.append(SRWLMagFldM(0.5*sgn, 2, 'n', 0.2)); arZc.append(zc + 0.5*dipDist) #quadrupoles
+    zc += dipDist
+nFld = len(arFld)
+magFldCnt = SRWLMagFldC(arFld, array('d', [0]*nFld), array('d', [0]*nFld), array('d', arZc))
+
+sRange = numDip*dipDist + 2. #Longitudinal range of trajectory calculation [m]
+part.z = -0.5*sRange #Initial Longitudinal Coordinate
+
+def CalcTraj(_np, _arPrecPar):
+    """Calculates trajectory on a mesh with _np points and returns it together with computation time [s]"""
+    trj = SRWLPrtTrj()
+    trj.partInitCond = part
+    trj.allocate(_np)
+    trj.ctStart = 0
+    trj.ctEnd = sRange
+    t0 = time.time()
+    srwl.CalcPartTraj(trj, magFldCnt, _arPrecPar)
+    return trj, time.time() - t0
+
+def MaxErr(_trj, _trjRef):
+    """Max. deviations of horizontal and vertical positions and angles from the reference trajectory, at the mesh points of _trj"""
+    per = (_trjRef.np - 1)//(_trj.np - 1)
+    errX = 0; errXp = 0; errY = 0; errYp = 0
+    for i in range(_trj.np):
+        iRef = i*per
+        errX = max(errX, abs(_trj.arX[i] - _trjRef.arX[iRef])); errXp = max(errXp, abs(_trj.arXp[i] - _trjRef.arXp[iRef]))
+        errY = max(errY, abs(_trj.arY[i] - _trjRef.arY[iRef])); errYp = max(errYp, abs(_trj.arYp[i] - _trjRef.arYp[iRef]))
+    return errX, errXp, errY, errYp
+
+#**********************Reference: 4th-order Runge-Kutta on a very fine mesh
+npRef = 1600001
+print('   Calculating reference trajectory (4th-order R-K, ', npRef, ' points) ... ', sep='', end='')
+trjRef, tRef = CalcTraj(npRef, [1])
+print('done in', round(tRef, 3), 's')
+
+#**********************Methods to compare: [number of points, precision parameters, description]
+#Numbers of field evaluations are not returned by srwl.CalcPartTraj; for the fixed-step method it is 4 per mesh step,
+#for the adaptive ones it is roughly proportional to the computation time printed below.
+#Precision parameters: [0]: method (1- 4th-order R-K, 2- 5th-order R-K, 3- adaptive 5th-order R-K with dense output);
+#[1]-[5]: absolute precision values for X[m],X'[rad],Y[m],Y'[rad],Z[m]; [6]: rel. tolerance; [7]: max. number of auto-steps; [8]: max. step [m] (for method 3)
+absPrec = [1.e-08, 1.e-08, 1.e-08, 1.e-08, 1.e-08]
+arCases = [
+    [16001, [1], '4th-order R-K (fixed step)'],
+    [160001, [1], '4th-order R-K (fixed step)'],
+    [16001, [2] + absPrec + [1.], '5th-order R-K (adaptive within mesh steps)'],
+    [2001, [3] + absPrec + [1.e-02], 'Dormand-Prince, tol. 1e-2'],
+    [2001, [3] + absPrec + [1.e-04], 'Dormand-Prince, tol. 1e-4'],
+    [2001, [3], 'Dormand-Prince, default abs. precision'],
+]
+
+print('   Method                                        Points    Time [s]   Max. errors: X [m]  X\' [rad]  Y [m]  Y\' [rad]')
+for case in arCases:
+    trj, t = CalcTraj(case[0], case[1])
+    err = MaxErr(trj, trjRef)
+    print('   {:45s} {:7d}  {:9.4f}   {:9.2e} {:9.2e} {:9.2e} {:9.2e}'.format(case[2], case[0], t, err[0], err[1], err[2], err[3]))